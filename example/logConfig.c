@@ -33,5 +33,5 @@
 
 #include "logConfig.h"
 
-LogCategory Network = {"Network", DEFAULT_LOG_LEVEL};
-LogCategory GUI = {"GUI", DEFAULT_LOG_LEVEL};
+LOG_CATEGORY(Network, DEFAULT_LOG_LEVEL);
+LOG_CATEGORY(GUI, DEFAULT_LOG_LEVEL);
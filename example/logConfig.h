@@ -47,9 +47,11 @@
 #define DEFAULT_LOG_LEVEL (LEVEL_MAX)
 
 /**
- * Configured categories for sample project
+ * Configured categories for sample project, only listed where ::initLogger cannot discover them
  */
+#ifndef LOG_CATEGORY_SECTION
 #define LOG_CATEGORIES &Network, &GUI
+#endif
 
 extern LogCategory Network; /**< Category to log events related to the network connectivity */
 extern LogCategory GUI;     /**< Category to log events related to the Graphical User Interface */
@@ -34,6 +34,7 @@
 #include <string.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <time.h>
 #include "logConfig.h"
 #include "stdout.h"
 #include "slf4ecCtrl.h"
@@ -41,12 +42,18 @@
 /**
  * Logger to Std Out.
  */
-static Logger StdOut = {"StdOut", &initStdOut, 0, FORMAT_FULL, LEVEL_MAX, &logToStdOut};
+static Logger StdOut = {.loggerName = "StdOut", .initFct = &initStdOut, .initArgs = 0, .format = FORMAT_FULL, .currentLogLevel = LEVEL_MAX, .publishFctV2 = &logToStdOutV2};
 
+#ifdef LOG_CATEGORIES
 static LogCategory* const categories[] = {LOG_CATEGORIES};
+static const uint16_t categoriesLength = sizeof(categories) / sizeof(LogCategory*);
+#else
+// Categories defined with LOG_CATEGORY are found by initLogger
+static LogCategory* const* const categories = NULL;
+static const uint16_t categoriesLength = 0;
+#endif
 static Logger* const loggers[] = {&StdOut};
-static const uint8_t categoriesLength = sizeof(categories) / sizeof(LogCategory*);
-static const uint8_t loggersLength = sizeof(loggers) / sizeof(Logger*);
+static const uint16_t loggersLength = sizeof(loggers) / sizeof(Logger*);
 
 static uint64_t getTimestamp(void)
 {
@@ -55,12 +62,27 @@ static uint64_t getTimestamp(void)
 
 const GetLogTimestamp logTimeApi = &getTimestamp;
 
+#ifdef USE_LOG_STATS
+static uint64_t getTick(void)
+{
+    return (uint64_t) clock();
+}
+
+const GetLogTimestamp logTickApi = &getTick;
+
+static LogHistogram stdOutLatency;
+#endif
+
 int main()
 {
     Logger* const* curLoggers = NULL;
     int nbLoggers = 0;
     int i = 0;
 
+#ifdef USE_LOG_STATS
+    StdOut.histogram = &stdOutLatency;
+#endif
+
     if (initLogger(categoriesLength, categories, loggersLength, loggers) != LOG_OK)
     {
         printf("Failed to initialize logging\n");
@@ -109,7 +131,30 @@ int main()
 
     logOff(Network, "This line is kept in source code but removed at compilation. It only documents an older log that was removed");
 
+    // Time a section of code, its records show how long it took
+    LogSpan span;
+    logSpanBegin(span, Network, LEVEL_DEBUG, "shutdown");
     logInfo(GUI, "Application stopping...");
+    logSpanEnd(span);
+
+#ifdef USE_LOG_STATS
+    // Statistics show what logging cost the application
+    LoggerStats stdOutStats;
+    LogStats stats;
+    getLogStats(&stats);
+    getLoggerStats(&StdOut, &stdOutStats);
+    printf("%" PRIuPTR " info calls, %" PRIuPTR " records (%" PRIuPTR " bytes) published to StdOut in %" PRIuPTR " ticks\n",
+           stats.calls[LEVEL_INFO], stdOutStats.published, stdOutStats.bytes, stdOutStats.publishTime);
+
+    LogLatency latency;
+    getLoggerLatency(&StdOut, &latency);
+    printf("StdOut latency: p50=%" PRIu64 " p99=%" PRIu64 " max=%" PRIu64 " ticks\n", latency.p50, latency.p99, latency.max);
+#endif
+
+#ifdef USE_LOG_PROFILER
+    // The call sites that logged the most
+    dumpLogProfile(&StdOut, 3, PROFILE_BY_CALLS);
+#endif
 
     return 0;
 }
@@ -34,6 +34,10 @@
 #ifndef SIMPLE_LOG_H_
 #define SIMPLE_LOG_H_
 
+#ifdef LOG_HPP_
+#error "slf4ec/log.h cannot be used along with slf4ec/log.hpp, include only one of them"
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -274,7 +278,40 @@ extern "C" {
  * @retval false if the @p logLevel is NOT active for the given @p category.
  */
 #define logIsActive(logCategory, logLevel) \
-    ((logCategory).currentLogLevel >= logLevel)
+    ((logCategory).currentLogLevel >= logLevel || logThreadLevelAllows(&(logCategory), logLevel))
+
+/**
+ * Begins a span of time, published as a record with ::LOG_RECORD_SPAN_BEGIN. A span being filtered costs as much as a
+ * log call being filtered, and nothing when @p logLevel is above @p COMPILED_LOG_LEVEL.
+ * Spans of a thread are expected to nest, as tools reading traces pair them per thread.
+ * @code
+ * LogSpan span;
+ * logSpanBegin(span, netCategory, LEVEL_DEBUG, "parseRequest");
+ * ...
+ * logSpanEnd(span);
+ * @endcode
+ *
+ * @param [out] span ::LogSpan to begin, to be given to logSpanEnd()
+ * @param [in] logCategory ::LogCategory to log against
+ * @param [in] logLevel LogLevel of the records of the span
+ * @param [in] name Name of the span, must remain valid until the span ends
+ * @retval ::LOG_OK Begun successfully, or filtered.
+ * @retval ::LOG_INVALID_PARAMETER @p name is NULL.
+ * @retval ::LOG_NOT_INITIALIZED ::initLogger must be called prior to logging.
+ */
+#define logSpanBegin(span, logCategory, logLevel, name) \
+    (((logLevel) <= COMPILED_LOG_LEVEL) ? spanBegin(&(span), &(logCategory), logLevel, name) : noSpan(&(span)))
+
+/**
+ * Ends a span begun with logSpanBegin(), published as a record with ::LOG_RECORD_SPAN_END holding its duration.
+ * Nothing is published when the span was filtered, or already ended.
+ *
+ * @param [in,out] span ::LogSpan to end
+ * @retval ::LOG_OK Ended successfully, or filtered.
+ * @retval ::LOG_NOT_INITIALIZED ::initLogger must be called prior to logging.
+ */
+#define logSpanEnd(span) \
+    spanEnd(&(span))
 
 #ifdef __cplusplus
 }
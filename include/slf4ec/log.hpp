@@ -0,0 +1,500 @@
+/**
+ * @file
+ *
+ * C++ logging API, checking format strings against their arguments at compile time
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef LOG_HPP_
+#define LOG_HPP_
+
+#if __cplusplus < 201402L
+#error "slf4ec/log.hpp requires C++14 or later"
+#endif
+
+#ifdef SIMPLE_LOG_H_
+#error "slf4ec/log.hpp replaces slf4ec/log.h, include only one of them"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "slf4ec/slf4ec.h"
+
+#ifndef COMPILED_LOG_LEVEL
+#define COMPILED_LOG_LEVEL LEVEL_MAX
+#endif
+
+/**
+ * @file
+ *
+ * Same API as slf4ec/log.h, as function templates in the slf4ec namespace:
+ * @code
+ * slf4ec::logInfo(category, "Sent %u bytes to %s", size, address);
+ * @endcode
+ * Calls are not limited to 64 arguments. Location information is captured at the call site when @p USE_LOCATION_INFO
+ * is defined and calls above @p COMPILED_LOG_LEVEL compile to nothing, as with the macros.
+ *
+ * In C++20, the format string must be a literal and is checked against the type of the arguments at compile time. A
+ * mismatch fails the build on a call to one of the functions of slf4ec::formatError, naming the problem. Earlier
+ * standards only reject arguments that cannot be passed to a C variadic function.
+ */
+
+#if defined(__cpp_consteval)
+#define SLF4EC_FORMAT_CHECK consteval
+#else
+#define SLF4EC_FORMAT_CHECK constexpr
+#endif
+
+namespace slf4ec
+{
+/**
+ * Not defined on purpose: reached from a format check, they fail the build with a self-explanatory name.
+ */
+namespace formatError
+{
+void tooFewArguments();
+void tooManyArguments();
+void argumentTypeMismatch();
+void unsupportedConversion();
+}  // namespace formatError
+
+namespace detail
+{
+enum class ArgKind
+{
+    INTEGER,
+    FLOATING,
+    STRING,
+    POINTER,
+    UNSUPPORTED
+};
+
+struct ArgType
+{
+    ArgKind kind;
+    std::size_t size;
+};
+
+template <typename T>
+constexpr ArgType argType()
+{
+    using U = std::decay_t<T>;
+    using Pointee = std::remove_cv_t<std::remove_pointer_t<U>>;
+
+    return std::is_enum<U>::value ? ArgType{ArgKind::INTEGER, sizeof(U)}
+                                  : std::is_integral<U>::value ? ArgType{ArgKind::INTEGER, sizeof(U)}
+                                                               : std::is_floating_point<U>::value ? ArgType{ArgKind::FLOATING, (sizeof(U) < sizeof(double)) ? sizeof(double) : sizeof(U)}
+                                                                                                  : (std::is_pointer<U>::value && std::is_same<Pointee, char>::value) ? ArgType{ArgKind::STRING, sizeof(U)}
+                                                                                                                                                                      : (std::is_pointer<U>::value || std::is_null_pointer<U>::value) ? ArgType{ArgKind::POINTER, sizeof(void*)}
+                                                                                                                                                                                                                                      : ArgType{ArgKind::UNSUPPORTED, 0};
+}
+
+enum class FormatStatus
+{
+    OK,
+    TOO_FEW_ARGUMENTS,
+    TOO_MANY_ARGUMENTS,
+    TYPE_MISMATCH,
+    UNSUPPORTED_CONVERSION
+};
+
+constexpr bool isDigit(const char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/**
+ * Size expected for an integer argument, according to the length modifier. 0 for anything promoted to int.
+ */
+constexpr std::size_t integerSize(const char length, const bool isDoubled)
+{
+    return (length == 'l') ? (isDoubled ? sizeof(long long) : sizeof(long))
+                           : (length == 'z') ? sizeof(std::size_t)
+                                             : (length == 'j') ? sizeof(std::intmax_t)
+                                                               : (length == 't') ? sizeof(std::ptrdiff_t)
+                                                                                 : 0;
+}
+
+constexpr bool isIntegerMatching(const ArgType& type, const std::size_t size)
+{
+    return type.kind == ArgKind::INTEGER && ((size == 0) ? type.size <= sizeof(int) : type.size == size);
+}
+
+/**
+ * Walk a printf format string, checking each conversion against the type of its argument.
+ */
+constexpr FormatStatus checkFormat(const char* format, const ArgType* types, const std::size_t nbArgs)
+{
+    std::size_t arg = 0;
+
+    while (*format != '\0')
+    {
+        if (*format++ != '%')
+        {
+            continue;
+        }
+        if (*format == '%')
+        {
+            format++;
+            continue;
+        }
+
+        while (*format == '-' || *format == '+' || *format == ' ' || *format == '#' || *format == '0')
+        {
+            format++;
+        }
+
+        // Width, then precision, either of which can be taken from an int argument
+        for (int field = 0; field < 2; field++)
+        {
+            if (field == 1)
+            {
+                if (*format != '.')
+                {
+                    break;
+                }
+                format++;
+            }
+
+            if (*format == '*')
+            {
+                if (arg >= nbArgs)
+                {
+                    return FormatStatus::TOO_FEW_ARGUMENTS;
+                }
+                if (!isIntegerMatching(types[arg++], 0))
+                {
+                    return FormatStatus::TYPE_MISMATCH;
+                }
+                format++;
+            }
+            while (isDigit(*format))
+            {
+                format++;
+            }
+        }
+
+        char length = '\0';
+        bool isDoubled = false;
+        if (*format == 'h' || *format == 'l' || *format == 'L' || *format == 'z' || *format == 'j' || *format == 't')
+        {
+            length = *format++;
+            if ((length == 'h' || length == 'l') && *format == length)
+            {
+                isDoubled = true;
+                format++;
+            }
+        }
+
+        const char conversion = *format;
+        if (conversion == '\0')
+        {
+            return FormatStatus::UNSUPPORTED_CONVERSION;
+        }
+        format++;
+
+        if (arg >= nbArgs)
+        {
+            return FormatStatus::TOO_FEW_ARGUMENTS;
+        }
+        const ArgType type = types[arg++];
+        bool isMatching = false;
+
+        switch (conversion)
+        {
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+            case 'c':
+                isMatching = length != 'L' && isIntegerMatching(type, integerSize(length, isDoubled));
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                isMatching = type.kind == ArgKind::FLOATING && type.size == ((length == 'L') ? sizeof(long double) : sizeof(double));
+                break;
+            case 's':
+                isMatching = length == '\0' && type.kind == ArgKind::STRING;
+                break;
+            case 'p':
+                isMatching = length == '\0' && (type.kind == ArgKind::STRING || type.kind == ArgKind::POINTER);
+                break;
+            default:
+                // Including %n, loggers are not expected to write back
+                return FormatStatus::UNSUPPORTED_CONVERSION;
+        }
+
+        if (!isMatching)
+        {
+            return FormatStatus::TYPE_MISMATCH;
+        }
+    }
+
+    return (arg < nbArgs) ? FormatStatus::TOO_MANY_ARGUMENTS : FormatStatus::OK;
+}
+
+template <typename... Args>
+struct ArgTypes
+{
+    static constexpr ArgType types[sizeof...(Args) + 1] = {argType<Args>()..., ArgType{ArgKind::UNSUPPORTED, 0}};
+};
+
+template <typename... Args>
+constexpr ArgType ArgTypes<Args...>::types[sizeof...(Args) + 1];
+
+template <typename T>
+constexpr bool isSupported()
+{
+    return argType<T>().kind != ArgKind::UNSUPPORTED;
+}
+
+constexpr bool allOf()
+{
+    return true;
+}
+
+template <typename... Bools>
+constexpr bool allOf(const bool first, const Bools... others)
+{
+    return first && allOf(others...);
+}
+
+/**
+ * Scoped enumerations are not promoted by C variadic functions, pass their value instead.
+ */
+template <typename T, std::enable_if_t<std::is_enum<T>::value, int> = 0>
+constexpr std::underlying_type_t<T> toVarArg(const T value)
+{
+    return static_cast<std::underlying_type_t<T>>(value);
+}
+
+template <typename T, std::enable_if_t<!std::is_enum<T>::value, int> = 0>
+constexpr const T& toVarArg(const T& value)
+{
+    return value;
+}
+
+template <typename T>
+struct Identity
+{
+    using type = T;
+};
+}  // namespace detail
+
+/**
+ * Format string of a log call, along with its location. Built implicitly from a string literal at the call site.
+ *
+ * @tparam Args Types of the arguments the format string is checked against
+ */
+template <typename... Args>
+class FormatString
+{
+   public:
+    template <std::size_t N>
+    SLF4EC_FORMAT_CHECK FormatString(const char(&format)[N],
+                                     const char* const file = __builtin_FILE(),
+                                     const uint32_t line = __builtin_LINE(),
+                                     const char* const function = __builtin_FUNCTION())
+        : format(format), file(file), line(line), function(function)
+    {
+        static_assert(detail::allOf(detail::isSupported<Args>()...),
+                      "Only integers, enumerations, floating point values and pointers can be logged");
+#if defined(__cpp_consteval)
+        switch (detail::checkFormat(format, detail::ArgTypes<Args...>::types, sizeof...(Args)))
+        {
+            case detail::FormatStatus::TOO_FEW_ARGUMENTS:
+                formatError::tooFewArguments();
+                break;
+            case detail::FormatStatus::TOO_MANY_ARGUMENTS:
+                formatError::tooManyArguments();
+                break;
+            case detail::FormatStatus::TYPE_MISMATCH:
+                formatError::argumentTypeMismatch();
+                break;
+            case detail::FormatStatus::UNSUPPORTED_CONVERSION:
+                formatError::unsupportedConversion();
+                break;
+            case detail::FormatStatus::OK:
+            default:
+                break;
+        }
+#endif
+    }
+
+    const char* const format;
+    const char* const file;
+    const uint32_t line;
+    const char* const function;
+};
+
+/**
+ * Format string checked against @p Args, which are not deduced from it.
+ */
+template <typename... Args>
+using Format = typename detail::Identity<FormatString<std::decay_t<Args>...>>::type;
+
+namespace detail
+{
+template <typename... Args>
+inline LogResult log(const LogCategory& category, const uint8_t level, const FormatString<std::decay_t<Args>...>& format, const Args&... args)
+{
+#ifdef USE_LOCATION_INFO
+    return yfLog1(format.file, format.line, format.function, &category, level, format.format, toVarArg(args)...);
+#else
+    return nfLog1(&category, level, format.format, toVarArg(args)...);
+#endif
+}
+}  // namespace detail
+
+/**
+ * Will not log anything, essentially a NOP. To be used when documenting a previously existing log. See ::LEVEL_OFF
+ */
+template <typename... Args>
+inline LogResult logOff(const LogCategory& category, Format<Args...> format, const Args&...)
+{
+    (void) category;
+    (void) format;
+    return noLog();
+}
+
+/**
+ * Logs fatal information. See ::LEVEL_FATAL
+ *
+ * @param [in] category ::LogCategory to log against
+ * @param [in] format Format string, checked against @p args
+ * @param [in] args Values of the conversions of @p format
+ * @retval ::LOG_OK Logged successfully.
+ * @retval ::LOG_NOT_INITIALIZED ::initLogger must be called prior to logging.
+ */
+template <typename... Args>
+inline LogResult logFatal(const LogCategory& category, Format<Args...> format, const Args&... args)
+{
+    return (LEVEL_FATAL <= COMPILED_LOG_LEVEL) ? detail::log(category, LEVEL_FATAL, format, args...) : noLog();
+}
+
+/**
+ * Logs error information. See ::LEVEL_ERROR and ::logFatal
+ */
+template <typename... Args>
+inline LogResult logError(const LogCategory& category, Format<Args...> format, const Args&... args)
+{
+    return (LEVEL_ERROR <= COMPILED_LOG_LEVEL) ? detail::log(category, LEVEL_ERROR, format, args...) : noLog();
+}
+
+/**
+ * Logs warning information. See ::LEVEL_WARN and ::logFatal
+ */
+template <typename... Args>
+inline LogResult logWarn(const LogCategory& category, Format<Args...> format, const Args&... args)
+{
+    return (LEVEL_WARN <= COMPILED_LOG_LEVEL) ? detail::log(category, LEVEL_WARN, format, args...) : noLog();
+}
+
+/**
+ * Logs general information. See ::LEVEL_INFO and ::logFatal
+ */
+template <typename... Args>
+inline LogResult logInfo(const LogCategory& category, Format<Args...> format, const Args&... args)
+{
+    return (LEVEL_INFO <= COMPILED_LOG_LEVEL) ? detail::log(category, LEVEL_INFO, format, args...) : noLog();
+}
+
+/**
+ * Logs debug information. See ::LEVEL_DEBUG and ::logFatal
+ */
+template <typename... Args>
+inline LogResult logDebug(const LogCategory& category, Format<Args...> format, const Args&... args)
+{
+    return (LEVEL_DEBUG <= COMPILED_LOG_LEVEL) ? detail::log(category, LEVEL_DEBUG, format, args...) : noLog();
+}
+
+/**
+ * Logs trace information. See ::LEVEL_TRACE and ::logFatal
+ */
+template <typename... Args>
+inline LogResult logTrace(const LogCategory& category, Format<Args...> format, const Args&... args)
+{
+    return (LEVEL_TRACE <= COMPILED_LOG_LEVEL) ? detail::log(category, LEVEL_TRACE, format, args...) : noLog();
+}
+
+/**
+ * Logs test information. See ::LEVEL_TEST and ::logFatal
+ */
+template <typename... Args>
+inline LogResult logTest(const LogCategory& category, Format<Args...> format, const Args&... args)
+{
+    return (LEVEL_TEST <= COMPILED_LOG_LEVEL) ? detail::log(category, LEVEL_TEST, format, args...) : noLog();
+}
+
+/**
+ * Check if a given LogLevel is active for a given LogCategory. See ::logIsActive
+ */
+inline bool logIsActive(const LogCategory& category, const uint8_t level)
+{
+    return category.currentLogLevel >= level || logThreadLevelAllows(&category, level);
+}
+
+/**
+ * Span of time lasting as long as the object, see ::logSpanBegin. Named in the block it traces:
+ * @code
+ * slf4ec::Span span(netCategory, LEVEL_DEBUG, "parseRequest");
+ * @endcode
+ */
+class Span
+{
+   public:
+    Span(const LogCategory& category, const uint8_t level, const char* const name)
+    {
+        (void) ((level <= COMPILED_LOG_LEVEL) ? spanBegin(&span, &category, level, name) : noSpan(&span));
+    }
+
+    ~Span()
+    {
+        (void) spanEnd(&span);
+    }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+   private:
+    LogSpan span;
+};
+}  // namespace slf4ec
+
+#endif /* LOG_HPP_ */
@@ -0,0 +1,103 @@
+/**
+ * @file
+ *
+ * LZ77 block compression used by the file logger
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef LOG_COMPRESS_H_
+#define LOG_COMPRESS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include "slf4ec/slf4ecTypes.h"
+
+/*
+ * Blocks are encoded as a sequence of LZ4 style commands. Each starts with a token whose upper nibble is the number of
+ * literals and lower nibble the match length minus LOG_COMPRESS_MIN_MATCH, 15 meaning more length bytes follow (each
+ * added, 255 meaning yet another one). Literals are followed by a 16 bits little endian offset and the extra match
+ * length bytes. The last command holds literals only.
+ */
+
+#define LOG_COMPRESS_MIN_MATCH (4)              /**< Shortest match encoded */
+#define LOG_COMPRESS_MAX_INPUT (UINT16_MAX + 1) /**< Largest block that can be compressed */
+
+/**
+ * Number of bits of the hash table used to find matches. More bits find more matches at the cost of a bigger table.
+ */
+#ifndef LOG_COMPRESS_HASH_BITS
+#define LOG_COMPRESS_HASH_BITS (12)
+#endif
+
+/**
+ * Working memory of the compressor. Large enough that it should not be put on the stack of small targets.
+ */
+typedef struct
+{
+    uint16_t positions[1u << LOG_COMPRESS_HASH_BITS]; /**< Last position of each hashed sequence */
+} LogCompressTable;
+
+/**
+ * Largest size a compressed block can have. Data is never expanded beyond this bound.
+ */
+#define LOG_COMPRESS_BOUND(size) ((size) + (size) / 255 + 16)
+
+/**
+ * Compress a block. Blocks are independent of each other.
+ *
+ * @param [in] src Data to compress
+ * @param [in] srcSize Size of @p src, at most ::LOG_COMPRESS_MAX_INPUT
+ * @param [out] dst Compressed data
+ * @param [in] dstCapacity Size of @p dst
+ * @param [in] table Working memory
+ * @return Size of the compressed data. 0 when the data is too large or cannot be made smaller than @p dstCapacity.
+ */
+size_t logCompress(const uint8_t* const src, const size_t srcSize, uint8_t* const dst, const size_t dstCapacity, LogCompressTable* const table);
+
+/**
+ * Decompress a block produced by ::logCompress.
+ *
+ * @param [in] src Compressed data
+ * @param [in] srcSize Size of @p src
+ * @param [out] dst Decompressed data
+ * @param [in] dstSize Size of the data once decompressed
+ * @retval ::LOG_OK @p src decompressed successfully.
+ * @retval ::LOG_INVALID_PARAMETER when @p src is corrupted or does not decompress to exactly @p dstSize bytes.
+ */
+LogResult logDecompress(const uint8_t* const src, const size_t srcSize, uint8_t* const dst, const size_t dstSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LOG_COMPRESS_H_ */
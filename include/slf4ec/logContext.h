@@ -0,0 +1,137 @@
+/**
+ * @file
+ *
+ * Diagnostic context attached to the records logged by a thread
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef LOG_CONTEXT_H_
+#define LOG_CONTEXT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include "slf4ec/slf4ecTypes.h"
+
+/*
+ * Each thread has its own context: a name, an identifier and a stack of key-value pairs (request, connection, ...).
+ * Records logged by the thread point to it so loggers using ::FORMAT_CONTEXT render it without it being repeated in
+ * every format string. Nothing is copied nor allocated when logging.
+ * Without threads, a single context is shared with interrupts.
+ */
+
+/**
+ * Largest context rendered by ::logFormatContext that loggers are expected to handle. Longer contexts are truncated.
+ */
+#ifndef LOG_CONTEXT_MAX_LENGTH
+#define LOG_CONTEXT_MAX_LENGTH (256)
+#endif
+
+/**
+ * Render a context as "[name:threadId]{key=value key=value}". The name is omitted when not set and the braces when no
+ * entries are pushed.
+ *
+ * @param [out] buffer Where to render the context, always terminated when @p capacity is not 0
+ * @param [in] capacity Size of @p buffer
+ * @param [in] context Context to render
+ * @return Length of the rendered context, excluding the terminating character. Like snprintf, can be @p capacity or more
+ * when truncated.
+ */
+size_t logFormatContext(char* const buffer, const size_t capacity, const LogContext* const context);
+
+#ifdef USE_LOG_CONTEXT
+
+/**
+ * Add a key-value pair to the context of the calling thread. Neither string is copied.
+ *
+ * @param [in] key Name of the value
+ * @param [in] value Value, must remain valid until popped
+ * @retval ::LOG_OK @p key and @p value pushed successfully.
+ * @retval ::LOG_INVALID_PARAMETER when @p key or @p value is NULL.
+ * @retval ::LOG_OUT_OF_MEMORY when ::LOG_CONTEXT_MAX_ENTRIES entries are already pushed.
+ */
+LogResult logContextPush(const char* const key, const char* const value);
+
+/**
+ * Remove the last pair pushed to the context of the calling thread.
+ *
+ * @param [in] key Name of the value, to catch unbalanced push and pop
+ * @retval ::LOG_OK Last pair removed successfully.
+ * @retval ::LOG_INVALID_PARAMETER when the last pair pushed is not named @p key, in which case nothing is removed.
+ */
+LogResult logContextPop(const char* const key);
+
+/**
+ * Name the calling thread in its context.
+ *
+ * @param [in] name Name of the thread, copied and truncated to ::LOG_CONTEXT_NAME_LENGTH. NULL to clear it.
+ */
+void logContextSetThreadName(const char* const name);
+
+/**
+ * Obtain the context of the calling thread.
+ *
+ * @return Context of the calling thread, valid until the thread exits
+ */
+const LogContext* logGetContext(void);
+
+#else
+
+static inline LogResult logContextPush(const char* const key, const char* const value)
+{
+    (void) key;
+    (void) value;
+    return LOG_OK;
+}
+
+static inline LogResult logContextPop(const char* const key)
+{
+    (void) key;
+    return LOG_OK;
+}
+
+static inline void logContextSetThreadName(const char* const name)
+{
+    (void) name;
+}
+
+static inline const LogContext* logGetContext(void)
+{
+    return NULL;
+}
+
+#endif /* USE_LOG_CONTEXT */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LOG_CONTEXT_H_ */
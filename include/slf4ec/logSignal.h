@@ -0,0 +1,149 @@
+/**
+ * @file
+ *
+ * Logging from signal handlers
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef LOG_SIGNAL_H_
+#define LOG_SIGNAL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdarg.h>
+#include <stddef.h>
+#include "slf4ec/slf4ecTypes.h"
+
+/*
+ * The regular logging path is not async-signal-safe: loggers use stdio and the library may allocate. ::logSignalSafe
+ * can be called from a signal handler (or an interrupt): it formats with a reentrant subset of printf, then either writes
+ * the record with write(2) or stores it in a preallocated lock-free buffer, later published to the configured loggers by
+ * ::drainSignalLog. Neither path allocates, locks nor uses stdio. logTimeApi must be async-signal-safe as well, as
+ * clock_gettime is.
+ */
+
+/**
+ * Number of records the deferred buffer can hold. Must be a power of 2.
+ */
+#ifndef LOG_SIGNAL_SLOTS
+#define LOG_SIGNAL_SLOTS (64)
+#endif
+
+/**
+ * Maximum length of a record, including the terminating character. Longer records are truncated.
+ */
+#ifndef LOG_SIGNAL_RECORD_SIZE
+#define LOG_SIGNAL_RECORD_SIZE (256)
+#endif
+
+/**
+ * Where records logged with ::logSignalSafe go
+ */
+typedef enum
+{
+    LOG_SIGNAL_WRITE = 0, /**< Written immediately to a file descriptor, formatted as the stdout logger does */
+    LOG_SIGNAL_DEFER      /**< Stored until ::drainSignalLog publishes them to the configured loggers */
+} LogSignalMode;
+
+/**
+ * Configuration of the signal-safe path
+ */
+typedef struct
+{
+    LogSignalMode mode; /**< Where records go */
+    int fd;             /**< File descriptor written to with ::LOG_SIGNAL_WRITE, e.g. STDERR_FILENO */
+    /**
+     * With ::LOG_SIGNAL_DEFER, start a thread draining the buffer as soon as records are stored. Otherwise, the
+     * application calls ::drainSignalLog itself. Only available on hosts with POSIX threads.
+     */
+    uint8_t startDrainThread;
+} LogSignalConfig;
+
+/**
+ * Configure the signal-safe path. Must not be called from a signal handler.
+ *
+ * @param [in] config Configuration
+ * @retval ::LOG_OK Configured successfully.
+ * @retval ::LOG_INVALID_PARAMETER when @p config is NULL or not supported on this target.
+ * @retval ::LOG_ALREADY_INITIALIZED when already configured, see ::closeSignalLog.
+ * @retval ::LOG_OUT_OF_MEMORY when the drain thread cannot be started.
+ */
+LogResult initSignalLog(const LogSignalConfig* const config);
+
+/**
+ * Log from a signal handler. Async-signal-safe and lock-free.
+ *
+ * Supported conversions are %d, %i, %u, %x, %X, %o, %c, %s, %p and %%, with the '-' and '0' flags, a width and the hh,
+ * h, l, ll, z, j and t length modifiers.
+ *
+ * @param [in] category ::LogCategory to log against
+ * @param [in] level LogLevel of the record
+ * @param [in] formatStr Format string
+ * @retval ::LOG_OK Logged, or filtered by the level of @p category.
+ * @retval ::LOG_NOT_INITIALIZED ::initSignalLog was not called.
+ * @retval ::LOG_INVALID_PARAMETER when @p category or @p formatStr is NULL or @p level is out of range.
+ * @retval ::LOG_OUT_OF_MEMORY when the deferred buffer is full. The record is dropped and counted.
+ */
+LogResult logSignalSafe(const LogCategory* const category, const uint8_t level, const char* const formatStr, ...);
+
+/**
+ * Publish the deferred records to the configured loggers, oldest first. Must not be called from a signal handler.
+ *
+ * @return Number of records published
+ */
+uint32_t drainSignalLog(void);
+
+/**
+ * Number of records dropped because the deferred buffer was full.
+ */
+uint32_t getSignalLogDropped(void);
+
+/**
+ * Drain the remaining records, stop the drain thread and allow ::initSignalLog to be called again.
+ */
+void closeSignalLog(void);
+
+/**
+ * Async-signal-safe version of vsnprintf, limited to the conversions supported by ::logSignalSafe.
+ *
+ * @param [out] buffer Where to format, always terminated when @p capacity is not 0
+ * @param [in] capacity Size of @p buffer
+ * @param [in] formatStr Format string
+ * @param [in] args Arguments of @p formatStr
+ * @return Number of characters written, excluding the terminating character. Output is truncated to fit.
+ */
+size_t logSignalFormatv(char* const buffer, const size_t capacity, const char* const formatStr, va_list args);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LOG_SIGNAL_H_ */
@@ -0,0 +1,126 @@
+/**
+ * @file
+ *
+ * Logger deferring the formatting of records to a drain thread
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ASYNC_LOGGER_H_
+#define ASYNC_LOGGER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "slf4ec/slf4ecTypes.h"
+
+/*
+ * Logging threads only capture their records, the formatting and the output being left to a drain thread.
+ * A record cannot be handed over as is: its arguments (and strings they point to, e.g. a buffer on the stack) are
+ * gone by the time the drain thread gets to it. Each record is instead copied into an arena owned by the logging
+ * thread, walking its format string to take the arguments by value and copying the strings, so the copy is
+ * self-contained. An arena is a ring with a single producer: records are appended by bumping its tail, and the drain
+ * thread reclaims everything it published at once by moving its head. Nothing is allocated per record, only an arena
+ * per thread, reused by the next thread once its owner exits.
+ * Records logged while the arena of their thread is full are dropped and counted.
+ * Records are handed to the target logger as their message formatted with "%s", except for the records of spans.
+ */
+#define ASYNC_DEFAULT_ARENA_SIZE (1u << 16) /**< Default AsyncLoggerConfig::arenaSize */
+#define ASYNC_MIN_ARENA_SIZE (4096u)        /**< Smallest AsyncLoggerConfig::arenaSize */
+#define ASYNC_MAX_ARENA_SIZE (1u << 30)     /**< Largest AsyncLoggerConfig::arenaSize */
+
+/**
+ * Parameters of the asynchronous logger, to be given as the Logger::initArgs
+ */
+typedef struct
+{
+    /**
+     * Logger the records are published to from the drain thread, initialized by this logger. Its currentLogLevel
+     * applies, its categoryFilter does not. Must not be configured itself.
+     */
+    Logger* target;
+    uint32_t arenaSize;   /**< Bytes of the arena of each logging thread, a power of 2. 0 for ::ASYNC_DEFAULT_ARENA_SIZE. */
+    uint32_t drainPeriod; /**< Milliseconds between drains. 0 to only drain with ::flushAsyncLogger. */
+} AsyncLoggerConfig;
+
+/**
+ * Function to be called when initializing this logger (for logger configuration)
+ *
+ * @remark There can only be one asynchronous logger.
+ *
+ * @param [in] param Pointer to an ::AsyncLoggerConfig.
+ */
+void initAsyncLogger(const void* const param);
+
+/**
+ * Function to be called when recording a log (for logger configuration)
+ *
+ * @param [in] logRecord Pointer to the record to be logged.
+ * @param [in] format Ignored, the format of the target logger applies.
+ */
+void logToAsync(const LogRecord* const logRecord, const LogFormat format);
+
+/**
+ * Version of ::logToAsync taking a ::LogRecordV2 (for logger configuration, as publishFctV2)
+ *
+ * @param [in] logRecord Pointer to the record to be logged.
+ * @param [in] format Ignored, the format of the target logger applies.
+ */
+void logToAsyncV2(const LogRecordV2* const logRecord, const LogFormat format);
+
+/**
+ * Whether the asynchronous logger is ready to receive records.
+ *
+ * @retval ::LOG_OK The logger is initialized.
+ * @retval ::LOG_INVALID_PARAMETER The configuration is not valid.
+ * @retval ::LOG_NOT_INITIALIZED The logger was not initialized.
+ * @retval ::LOG_OUT_OF_MEMORY The drain thread could not be started.
+ */
+LogResult getAsyncLoggerStatus(void);
+
+/**
+ * Number of records dropped because the arena of their thread was full, or could not be allocated.
+ */
+uint64_t getAsyncLoggerDropped(void);
+
+/**
+ * Publish the records captured so far to the target logger, from the calling thread.
+ */
+void flushAsyncLogger(void);
+
+/**
+ * Stop the drain thread and publish the records left. Records logged afterwards are dropped.
+ */
+void closeAsyncLogger(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ASYNC_LOGGER_H_ */
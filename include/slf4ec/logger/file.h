@@ -0,0 +1,298 @@
+/**
+ * @file
+ *
+ * Logger writing to a file, optionally as compressed blocks
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FILE_LOGGER_H_
+#define FILE_LOGGER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "slf4ec/slf4ecTypes.h"
+
+/**
+ * How records are stored in the file
+ */
+typedef enum
+{
+    FILE_ENCODING_TEXT = 0,  /**< Plain text, as printed by the stdout logger */
+    FILE_ENCODING_BLOCKS,    /**< Text gathered in self-describing blocks */
+    FILE_ENCODING_COMPRESSED /**< Text gathered in self-describing blocks, each compressed independently */
+} FileEncoding;
+
+/**
+ * Parameters of the file logger, to be given as the Logger::initArgs
+ */
+typedef struct
+{
+    const char* path;      /**< File to append to. */
+    FileEncoding encoding; /**< How records are stored. */
+    uint32_t blockSize;    /**< Bytes of text gathered before being written. 0 for ::FILE_DEFAULT_BLOCK_SIZE. */
+    uint64_t rotateBytes;  /**< Rotate once the file holds this many bytes. 0 to not rotate by size. */
+    uint32_t rotateAfter;  /**< Rotate once the file was written to for this many seconds. 0 to not rotate by time. */
+    uint32_t keepFiles;    /**< Rotated files kept, the oldest being deleted first. 0 to keep them all. */
+    uint64_t keepBytes;    /**< Total size of the rotated files kept, the oldest being deleted first. 0 for no limit. */
+    bool rotateOnRequest;  /**< Rotate when ::requestFileRotation is called, implied by rotateBytes and rotateAfter. */
+    bool compressArchives; /**< Rewrite rotated text files as compressed blocks. */
+} FileLoggerConfig;
+
+#define FILE_DEFAULT_BLOCK_SIZE (32768u) /**< Default FileLoggerConfig::blockSize */
+#define FILE_MAX_BLOCK_SIZE (65536u)     /**< Largest FileLoggerConfig::blockSize */
+
+/*
+ * Rotation
+ *
+ * Rotation happens on the writer thread, before writing a block, so producers never wait for it: the writer swaps
+ * the file for one opened ahead of time by an archival thread. The archival thread, running at the lowest priority,
+ * then appends the index of the rotated file, syncs and closes it, renames it to "<path>.<n>", <n> growing with each
+ * rotation, and deletes the oldest rotated files beyond FileLoggerConfig::keepFiles and FileLoggerConfig::keepBytes.
+ * With FileLoggerConfig::compressArchives, a rotated text file is then rewritten as ::FILE_ENCODING_COMPRESSED blocks
+ * cut at line ends, under the same name. Those blocks match every query as text carries no summary. Files written as
+ * blocks are archived as they are, being already compressed or not as their encoding asked for.
+ * The next file is opened as "<path>.next", and renamed to "<path>" once it is in use.
+ * When the next file is not ready yet (e.g. rotations in quick succession), the rotation is deferred to a later block.
+ * Rotation requires POSIX threads.
+ */
+#define FILE_NEXT_SUFFIX ".next" /**< Suffix of the file opened ahead of the next rotation */
+
+/*
+ * Every block starts with a header, all fields being little endian:
+ *   - magic         4 bytes, ::FILE_BLOCK_MAGIC
+ *   - version       1 byte
+ *   - flags         1 byte, ::FILE_BLOCK_COMPRESSED
+ *   - headerSize    2 bytes, allows newer versions to append fields
+ *   - rawSize       4 bytes, size of the text
+ *   - storedSize    4 bytes, size of the data following the header
+ *   - checksum      4 bytes, FNV-1a of the text
+ *   - minTimestamp  8 bytes, earliest timestamp of the records (since version 2)
+ *   - maxTimestamp  8 bytes, latest timestamp of the records
+ *   - minLevel      1 byte, most severe level of the records
+ *   - maxLevel      1 byte, least severe level of the records
+ *   - reserved      2 bytes
+ *   - categories    32 bytes, bitmap of the LogCategory::index of the records
+ * Blocks only contain whole records so each can be decoded on its own, even when the file is truncated.
+ *
+ * When the logger is closed, an index of the blocks written is appended:
+ *   - magic         4 bytes, ::FILE_INDEX_MAGIC
+ *   - nbBlocks      4 bytes
+ *   - entries       ::FILE_INDEX_ENTRY_SIZE bytes per block: offset (8 bytes) followed by the header fields from
+ *                   minTimestamp to categories
+ *   - trailer       ::FILE_TRAILER_SIZE bytes: ::FILE_TRAILER_MAGIC, nbBlocks (4 bytes) and offset of the index (8 bytes)
+ * Readers find the index from the end of the file, and scan the block headers when there is none (e.g. after a crash).
+ */
+#define FILE_BLOCK_MAGIC "SLFB"
+#define FILE_BLOCK_VERSION (2)
+#define FILE_BLOCK_HEADER_SIZE (72)
+#define FILE_BLOCK_V1_HEADER_SIZE (20)
+#define FILE_BLOCK_COMPRESSED (0x01)
+#define FILE_INDEX_MAGIC "SLFI"
+#define FILE_INDEX_ENTRY_SIZE (60)
+#define FILE_TRAILER_MAGIC "SLFX"
+#define FILE_TRAILER_SIZE (16)
+
+#define FILE_BLOCK_CATEGORY_BITS (256)  /**< Number of categories told apart by a block */
+#define FILE_BLOCK_OTHER_CATEGORY (255) /**< Bit set for categories not configured or with an index beyond the bitmap */
+
+/**
+ * What a block contains, allowing readers to skip it without decoding its text
+ */
+typedef struct
+{
+    uint64_t minTimestamp;                            /**< Earliest timestamp of the records */
+    uint64_t maxTimestamp;                            /**< Latest timestamp of the records */
+    uint8_t minLevel;                                 /**< Most severe level of the records */
+    uint8_t maxLevel;                                 /**< Least severe level of the records */
+    uint8_t categories[FILE_BLOCK_CATEGORY_BITS / 8]; /**< Bitmap of the LogCategory::index of the records */
+} FileBlockSummary;
+
+/**
+ * Header of a block, as decoded by ::readFileBlock
+ */
+typedef struct
+{
+    uint8_t version;
+    uint8_t flags;
+    uint16_t headerSize;
+    uint32_t rawSize;
+    uint32_t storedSize;
+    uint32_t checksum;
+    FileBlockSummary summary; /**< Matches everything for blocks written before version 2 */
+} FileBlockHeader;
+
+/**
+ * Entry of the index of a file
+ */
+typedef struct
+{
+    uint64_t offset; /**< Position of the block header in the file */
+    FileBlockSummary summary;
+} FileBlockIndex;
+
+/**
+ * Index of the blocks of a file, loaded by ::openFileIndex
+ */
+typedef struct
+{
+    FILE* file;
+    uint32_t nbBlocks;
+    FileBlockIndex* blocks;
+    uint64_t* latestUpTo;   /**< Latest timestamp of the blocks up to each block, for binary searches */
+    uint64_t* earliestFrom; /**< Earliest timestamp of the blocks from each block onward */
+} FileIndex;
+
+/**
+ * Blocks to look for with ::findFileBlock
+ */
+typedef struct
+{
+    uint64_t from; /**< Earliest timestamp wanted */
+    uint64_t to;   /**< Latest timestamp wanted */
+    int category;  /**< LogCategory::index wanted, negative for all categories */
+    uint8_t level; /**< Least severe level wanted */
+} FileQuery;
+
+/**
+ * Function to be called when initializing this logger (for logger configuration)
+ *
+ * @remark There can only be one file logger.
+ *
+ * @param [in] param Pointer to a ::FileLoggerConfig.
+ */
+void initFileLogger(const void* const param);
+
+/**
+ * Function to be called when recording a log (for logger configuration)
+ *
+ * @param [in] logRecord Pointer to the record to be logged.
+ * @param [in] format Format to be used when recording this log.
+ */
+void logToFile(const LogRecord* const logRecord, const LogFormat format);
+
+/**
+ * Version of ::logToFile taking a ::LogRecordV2 (for logger configuration, as publishFctV2)
+ *
+ * @param [in] logRecord Pointer to the record to be logged.
+ * @param [in] format Format to be used when recording this log.
+ */
+void logToFileV2(const LogRecordV2* const logRecord, const LogFormat format);
+
+/**
+ * Whether the file logger is ready to receive records.
+ *
+ * @retval ::LOG_OK The file is open.
+ * @retval ::LOG_INVALID_PARAMETER The configuration is not valid, or asks for rotation without POSIX threads.
+ * @retval ::LOG_NOT_INITIALIZED The logger was not initialized or the file could not be opened.
+ * @retval ::LOG_OUT_OF_MEMORY The buffers could not be allocated.
+ */
+LogResult getFileLoggerStatus(void);
+
+/**
+ * Write the records gathered so far, and wait for them to be handed to the file system.
+ */
+void flushFileLogger(void);
+
+/**
+ * Ask for the file to be rotated before the next block is written, whatever the size and age of the file.
+ *
+ * @remark Async-signal-safe, meant to be called from a SIGHUP handler.
+ *
+ * @retval ::LOG_OK The file is rotated before the next block.
+ * @retval ::LOG_INVALID_PARAMETER The file logger is not open, or was configured without rotation.
+ */
+LogResult requestFileRotation(void);
+
+/**
+ * Flush and close the file. Records logged afterwards are dropped.
+ */
+void closeFileLogger(void);
+
+/**
+ * Read the next block of a file written with ::FILE_ENCODING_BLOCKS or ::FILE_ENCODING_COMPRESSED.
+ * Indexes found along the way are skipped.
+ *
+ * @param [in] file File positioned at the start of a block
+ * @param [out] header Header of the block
+ * @param [out] text Text of the block
+ * @param [in] capacity Size of @p text, ::FILE_MAX_BLOCK_SIZE is always enough
+ * @return true when a block was read. false at the end of the file or when the block is truncated or corrupted.
+ */
+bool readFileBlock(FILE* const file, FileBlockHeader* const header, uint8_t* const text, const size_t capacity);
+
+/**
+ * Load the index of a file written with ::FILE_ENCODING_BLOCKS or ::FILE_ENCODING_COMPRESSED.
+ * When the file has no index (e.g. the logger was not closed), the block headers are scanned instead.
+ *
+ * @param [in] file File to index. Must remain open until ::closeFileIndex
+ * @param [out] index Index of the file
+ * @retval ::LOG_OK Index loaded successfully.
+ * @retval ::LOG_INVALID_PARAMETER when @p file or @p index is NULL.
+ * @retval ::LOG_OUT_OF_MEMORY when the index cannot be allocated.
+ */
+LogResult openFileIndex(FILE* const file, FileIndex* const index);
+
+/**
+ * Release an index loaded by ::openFileIndex. The file is not closed.
+ *
+ * @param [in] index Index to release
+ */
+void closeFileIndex(FileIndex* const index);
+
+/**
+ * Find the next block that may hold records matching a query. Only the index is read.
+ *
+ * @param [in] index Index of the file
+ * @param [in] query Records looked for
+ * @param [in] start Position of the first block to consider. 0 to start a search, or the previous result + 1
+ * @return Position of the block within the index. FileIndex::nbBlocks when no other block can match.
+ */
+uint32_t findFileBlock(const FileIndex* const index, const FileQuery* const query, const uint32_t start);
+
+/**
+ * Read a block found by ::findFileBlock.
+ *
+ * @param [in] index Index of the file
+ * @param [in] block Position of the block within the index
+ * @param [out] header Header of the block
+ * @param [out] text Text of the block
+ * @param [in] capacity Size of @p text, ::FILE_MAX_BLOCK_SIZE is always enough
+ * @return true when the block was read. false when it is truncated or corrupted.
+ */
+bool readIndexedBlock(const FileIndex* const index, const uint32_t block, FileBlockHeader* const header, uint8_t* const text, const size_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FILE_LOGGER_H_ */
@@ -0,0 +1,171 @@
+/**
+ * @file
+ *
+ * Logger writing to a shared memory ring, drained by a collector process
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef SHM_LOGGER_H_
+#define SHM_LOGGER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "slf4ec/slf4ecTypes.h"
+
+/*
+ * Each process writes its records, formatted as by the file logger, into its own ring of POSIX shared memory.
+ * Producers only format and copy: logging makes no system call. A collector process (utils/logCollector) maps the
+ * rings and writes what they hold to the final sinks in large batches. The ring outlives the process, so the records
+ * of a worker that crashed are still collected; the collector removes the ring once its producer is gone and the
+ * ring is empty.
+ *
+ * Ring layout: a header of ::SHM_RING_HEADER_SIZE bytes followed by the data area. Records are stored as entries made
+ * of a 4 bytes header (size of the entry and flags) followed by the text, padded to 8 bytes. An entry is never split
+ * by the end of the data area, a padding entry fills the end instead.
+ */
+
+#define SHM_RING_PREFIX "/slf4ec."      /**< Prefix of the rings, followed by the process ID unless named otherwise */
+#define SHM_RING_MAGIC "SLFR"           /**< Set once a ring is ready to be read */
+#define SHM_RING_VERSION (1)            /**< Version of the ring layout */
+#define SHM_RING_HEADER_SIZE (256)      /**< Bytes before the data area */
+#define SHM_DEFAULT_CAPACITY (1u << 20) /**< Default ShmLoggerConfig::capacity */
+#define SHM_MIN_CAPACITY (4096u)        /**< Smallest ShmLoggerConfig::capacity */
+#define SHM_MAX_CAPACITY (1u << 30)     /**< Largest ShmLoggerConfig::capacity */
+#define SHM_MAX_RECORD_SIZE (1024u)     /**< Longer records are truncated */
+#define SHM_RING_NAME_LENGTH (64)       /**< Longest ring name, including the terminating character */
+
+/**
+ * Parameters of the shared memory logger, to be given as the Logger::initArgs
+ */
+typedef struct
+{
+    const char* name;  /**< Name of the ring, starting with '/'. NULL for ::SHM_RING_PREFIX followed by the process ID. */
+    uint32_t capacity; /**< Bytes of the data area, a power of 2. 0 for ::SHM_DEFAULT_CAPACITY. */
+} ShmLoggerConfig;
+
+/**
+ * Ring mapped by a reader, see ::openShmRing
+ */
+typedef struct
+{
+    char name[SHM_RING_NAME_LENGTH];
+    void* header; /**< Mapped ring */
+    size_t size;  /**< Size of the mapping */
+} ShmRing;
+
+/**
+ * Function to be called when initializing this logger (for logger configuration)
+ *
+ * @remark There can only be one shared memory logger per process.
+ *
+ * @param [in] param Pointer to a ::ShmLoggerConfig.
+ */
+void initShmLogger(const void* const param);
+
+/**
+ * Function to be called when recording a log (for logger configuration)
+ *
+ * @param [in] logRecord Pointer to the record to be logged.
+ * @param [in] format Format to be used when recording this log.
+ */
+void logToShm(const LogRecord* const logRecord, const LogFormat format);
+
+/**
+ * Version of ::logToShm taking a ::LogRecordV2 (for logger configuration, as publishFctV2)
+ *
+ * @param [in] logRecord Pointer to the record to be logged.
+ * @param [in] format Format to be used when recording this log.
+ */
+void logToShmV2(const LogRecordV2* const logRecord, const LogFormat format);
+
+/**
+ * Whether the shared memory logger is ready to receive records.
+ *
+ * @retval ::LOG_OK The ring is mapped.
+ * @retval ::LOG_INVALID_PARAMETER The configuration is not valid or shared memory is not supported on this target.
+ * @retval ::LOG_NOT_INITIALIZED The logger was not initialized or the ring could not be created.
+ */
+LogResult getShmLoggerStatus(void);
+
+/**
+ * Unmap the ring. It is left for the collector, records logged afterwards are dropped.
+ */
+void closeShmLogger(void);
+
+/**
+ * Map a ring for reading.
+ *
+ * @param [in] name Name of the ring, starting with '/'
+ * @param [out] ring Mapped ring
+ * @retval ::LOG_OK Ring mapped successfully.
+ * @retval ::LOG_INVALID_PARAMETER when @p name or @p ring is NULL, or when @p name is not a ring of a known version.
+ * @retval ::LOG_NOT_INITIALIZED when the ring does not exist or is not ready yet.
+ */
+LogResult openShmRing(const char* const name, ShmRing* const ring);
+
+/**
+ * Copy the records available in a ring and release their space to the producers.
+ * There must be a single reader per ring.
+ *
+ * Records being written by a producer that is gone (e.g. crashed while logging) are skipped.
+ *
+ * @param [in] ring Ring to read
+ * @param [out] buffer Where the records are copied, one line each
+ * @param [in] capacity Size of @p buffer, at least ::SHM_MAX_RECORD_SIZE
+ * @return Number of bytes copied. 0 when no record is available.
+ */
+size_t readShmRing(ShmRing* const ring, char* const buffer, const size_t capacity);
+
+/**
+ * Whether the process writing to a ring is gone, in which case no more records will be added.
+ */
+bool isShmRingOrphaned(const ShmRing* const ring);
+
+/**
+ * Number of records dropped by the producers because the ring was full, or skipped by the reader.
+ */
+uint64_t getShmRingDropped(const ShmRing* const ring);
+
+/**
+ * Unmap a ring.
+ *
+ * @param [in] ring Ring to close
+ * @param [in] remove Also remove the ring from the system, once it is orphaned and read
+ */
+void closeShmRing(ShmRing* const ring, const bool remove);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SHM_LOGGER_H_ */
@@ -48,6 +48,14 @@ extern "C" {
  */
 void logToStdOut(const LogRecord* const logRecord, const LogFormat format);
 
+/**
+ * Version of ::logToStdOut taking a ::LogRecordV2 (for logger configuration, as publishFctV2)
+ *
+ * @param [in] logRecord Pointer to the record to be logged.
+ * @param [in] format Format to be used when recording this log.
+ */
+void logToStdOutV2(const LogRecordV2* const logRecord, const LogFormat format);
+
 /**
  * Function to be called when initializing this logger (for logger configuration)
  *
@@ -0,0 +1,106 @@
+/**
+ * @file
+ *
+ * Logger writing records as Chrome trace events, for chrome://tracing or Perfetto
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TRACE_LOGGER_H_
+#define TRACE_LOGGER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "slf4ec/slf4ecTypes.h"
+
+/*
+ * The file is a JSON array of trace events, which both tools open as is, even when the logger was not closed:
+ *   - records with ::LOG_RECORD_SPAN_BEGIN and ::LOG_RECORD_SPAN_END become duration events ("ph":"B" and "ph":"E")
+ *     on the thread that began the span, named after the span
+ *   - other records become instant events ("ph":"i") on the thread that logged them, named after their message
+ * The category of an event is the name of its LogCategory, and its timestamp the one of its record, in microseconds.
+ */
+#define TRACE_DEFAULT_UNITS_PER_SECOND (1000000u) /**< Default TraceLoggerConfig::unitsPerSecond, for timestamps in microseconds */
+#define TRACE_MAX_EVENT_SIZE (1024u)              /**< Longer events have their name truncated */
+
+/**
+ * Parameters of the trace logger, to be given as the Logger::initArgs
+ */
+typedef struct
+{
+    const char* path;        /**< File to write, replaced if it exists. */
+    uint64_t unitsPerSecond; /**< Number of ::logTimeApi units in a second. 0 for ::TRACE_DEFAULT_UNITS_PER_SECOND. */
+} TraceLoggerConfig;
+
+/**
+ * Function to be called when initializing this logger (for logger configuration)
+ *
+ * @remark There can only be one trace logger.
+ *
+ * @param [in] param Pointer to a ::TraceLoggerConfig.
+ */
+void initTraceLogger(const void* const param);
+
+/**
+ * Function to be called when recording a log (for logger configuration).
+ * Records do not carry whether they belong to a span in this version, see ::logToTraceV2.
+ *
+ * @param [in] logRecord Pointer to the record to be logged.
+ * @param [in] format Ignored, events hold the message only.
+ */
+void logToTrace(const LogRecord* const logRecord, const LogFormat format);
+
+/**
+ * Version of ::logToTrace taking a ::LogRecordV2 (for logger configuration, as publishFctV2)
+ *
+ * @param [in] logRecord Pointer to the record to be logged.
+ * @param [in] format Ignored, events hold the message only.
+ */
+void logToTraceV2(const LogRecordV2* const logRecord, const LogFormat format);
+
+/**
+ * Whether the trace logger is ready to receive records.
+ *
+ * @retval ::LOG_OK The file is open.
+ * @retval ::LOG_INVALID_PARAMETER The configuration is not valid.
+ * @retval ::LOG_NOT_INITIALIZED The logger was not initialized or the file could not be opened.
+ */
+LogResult getTraceLoggerStatus(void);
+
+/**
+ * Terminate the array of events and close the file. Records logged afterwards are dropped.
+ */
+void closeTraceLogger(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRACE_LOGGER_H_ */
@@ -0,0 +1,141 @@
+/**
+ * @file
+ *
+ * Logger appending text to a file through io_uring
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef URING_LOGGER_H_
+#define URING_LOGGER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include "slf4ec/slf4ecTypes.h"
+
+/*
+ * Records are formatted as by the file logger into one of several buffers. Once full, a buffer is written at its
+ * offset in the file while producers fill the next one, so several writes can be in flight. On Linux, writes are
+ * submitted through io_uring from buffers registered with the kernel: no thread is involved and a full buffer costs a
+ * single system call. Elsewhere, or when io_uring is not available (old kernel, seccomp filter, memlock limit), each
+ * buffer is written with pwrite by the producer filling it up.
+ *
+ * With a UringLoggerConfig::flushPeriod, a flusher thread writes the filling buffer every period, so records of a quiet
+ * process do not wait for a buffer to fill up.
+ *
+ * Records at UringLoggerConfig::syncLevel or more severe are on disk when their log call returns. Producers waiting
+ * for the disk share a single fdatasync: the one issuing it covers every record written before, the others wait for
+ * it rather than issuing their own (group commit).
+ */
+
+#define URING_DEFAULT_BUFFER_SIZE (65536u) /**< Default UringLoggerConfig::bufferSize */
+#define URING_MAX_BUFFER_SIZE (1u << 24)   /**< Largest UringLoggerConfig::bufferSize */
+#define URING_DEFAULT_NB_BUFFERS (4u)      /**< Default UringLoggerConfig::nbBuffers */
+#define URING_MAX_BUFFERS (16u)            /**< Largest UringLoggerConfig::nbBuffers */
+
+/**
+ * How the buffers are written
+ */
+typedef enum
+{
+    URING_BACKEND_NONE = 0, /**< The logger is not initialized */
+    URING_BACKEND_IO_URING, /**< Asynchronously, through io_uring */
+    URING_BACKEND_PWRITE    /**< Synchronously, with pwrite */
+} UringBackend;
+
+/**
+ * Parameters of the io_uring file logger, to be given as the Logger::initArgs
+ */
+typedef struct
+{
+    const char* path;     /**< File to append to. */
+    uint32_t bufferSize;  /**< Bytes of text gathered before being written. 0 for ::URING_DEFAULT_BUFFER_SIZE. */
+    uint8_t nbBuffers;    /**< Buffers filled or being written, at least 2. 0 for ::URING_DEFAULT_NB_BUFFERS. */
+    uint8_t syncLevel;    /**< Records at this level or more severe are synced to disk. LEVEL_OFF to never sync. */
+    bool forcePwrite;     /**< Use pwrite even when io_uring is available. */
+    uint32_t flushPeriod; /**< Milliseconds records may wait for their buffer to fill up. 0 to wait for ::flushUringLogger. */
+} UringLoggerConfig;
+
+/**
+ * Function to be called when initializing this logger (for logger configuration)
+ *
+ * @remark There can only be one io_uring file logger.
+ *
+ * @param [in] param Pointer to a ::UringLoggerConfig.
+ */
+void initUringLogger(const void* const param);
+
+/**
+ * Function to be called when recording a log (for logger configuration)
+ *
+ * @param [in] logRecord Pointer to the record to be logged.
+ * @param [in] format Format to be used when recording this log.
+ */
+void logToUring(const LogRecord* const logRecord, const LogFormat format);
+
+/**
+ * Version of ::logToUring taking a ::LogRecordV2 (for logger configuration, as publishFctV2)
+ *
+ * @param [in] logRecord Pointer to the record to be logged.
+ * @param [in] format Format to be used when recording this log.
+ */
+void logToUringV2(const LogRecordV2* const logRecord, const LogFormat format);
+
+/**
+ * Whether the io_uring file logger is ready to receive records.
+ *
+ * @retval ::LOG_OK The file is open.
+ * @retval ::LOG_INVALID_PARAMETER The configuration is not valid or files are not supported on this target.
+ * @retval ::LOG_NOT_INITIALIZED The logger was not initialized or the file could not be opened.
+ * @retval ::LOG_OUT_OF_MEMORY The buffers could not be allocated.
+ */
+LogResult getUringLoggerStatus(void);
+
+/**
+ * How the io_uring file logger writes its buffers.
+ */
+UringBackend getUringLoggerBackend(void);
+
+/**
+ * Write the records gathered so far, and wait for the writes to complete.
+ */
+void flushUringLogger(void);
+
+/**
+ * Flush and close the file. Records logged afterwards are dropped.
+ */
+void closeUringLogger(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* URING_LOGGER_H_ */
@@ -38,6 +38,7 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
 #include "slf4ec/slf4ecTypes.h"
 
 #if defined(UNIT_TESTING) && !defined(USE_LOCATION_INFO)
@@ -116,11 +117,66 @@ LogResult yfLog1(const char* file, const uint32_t line, const char* function, co
 LogResult yfLogv(const char* file, const uint32_t line, const char* function, const LogCategory* category, const uint8_t level, const char* formatStr, va_list vaList);
 #endif
 
+/**
+ * Private function called by macros to check the level override of the calling thread.
+ */
+bool logThreadLevelAllows(const LogCategory* category, const uint8_t level);
+
+/*
+ * Categories are gathered in a section by an ELF linker, where ::initLogger discovers them
+ */
+#if defined(__GNUC__) && defined(__ELF__)
+#define LOG_CATEGORY_SECTION "slf4ec_categories"
+#define _logRegisterCategory(name)                                                                                       \
+    static LogCategory* const _logRegistered##name __attribute__((used, section(LOG_CATEGORY_SECTION), aligned(sizeof(void*)))) = &name
+#else
+#define _logRegisterCategory(name) extern LogCategory name
+#endif
+
+/**
+ * Define a category configured by ::initLogger without being listed. Elsewhere than on ELF targets, it must still be listed.
+ *
+ * @code
+ * LOG_CATEGORY(Network, LEVEL_INFO);
+ * @endcode
+ *
+ * @param name Name of the category variable, also used as the name of the category
+ * @param level Initial level of the category
+ */
+#define LOG_CATEGORY(name, level)         \
+    LogCategory name = {#name, level, 0}; \
+    _logRegisterCategory(name)
+
+/*
+ * Call sites need GCC's statement expressions and an ELF linker to gather their descriptors in a section
+ */
+#if defined(USE_CALL_SITES) && defined(__GNUC__) && defined(__ELF__) && !defined(__cplusplus)
+#define LOG_CALL_SITE_SECTION "slf4ec_sites"
+
+/**
+ * Private function called by macros to log from a call site that may log.
+ */
+LogResult siteLog0(LogCallSite* site, const LogCategory* category, const char* msg);
+LogResult siteLog1(LogCallSite* site, const LogCategory* category, const char* formatStr, ...);
+LogResult siteLogv(LogCallSite* site, const LogCategory* category, const char* formatStr, va_list vaList);
+#endif
+
 /**
  * Private function called by macros when logging is not compiled in.
  */
 LogResult noLog();
 
+/**
+ * Private functions called by macros to begin and end a ::LogSpan.
+ */
+LogResult spanBegin(LogSpan* span, const LogCategory* category, const uint8_t level, const char* name);
+LogResult spanEnd(LogSpan* span);
+
+/**
+ * Private function called by macros when a span is not compiled in.
+ */
+LogResult noSpan(LogSpan* span);
+
 /*
  ************************************************************
  * Handles log levels available at compile time
@@ -242,7 +298,42 @@ LogResult noLog();
  ************************************************************
  */
 
+#ifdef LOG_CALL_SITE_SECTION
 #ifdef USE_LOCATION_INFO
+#define LOG_SITE_HAS_LOCATION (1)
+#else
+#define LOG_SITE_HAS_LOCATION (0)
+#endif
+
+// Only string literals are kept as the format of a site, anything else cannot initialize it
+#define LOG_SITE_FORMAT(formatStr) __builtin_choose_expr(__builtin_constant_p(formatStr), (formatStr), (const char*) 0)
+#define LOG_SITE_FIRST(first, ...) first
+
+#ifdef USE_LOG_STATS
+// Discarded calls are counted, so every call reaches SLF4EC which checks the remembered verdict itself
+#define LOG_SITE_SKIPS(site, logCategory) (0)
+#else
+// A site remembering it is disabled for the category does not even call SLF4EC
+#define LOG_SITE_SKIPS(site, logCategory) (__atomic_load_n(&(site).disabledFor, __ATOMIC_RELAXED) == &(logCategory))
+#endif
+
+#define _logSite(siteFct, logCategory, level, formatStr, ...)                                                            \
+    __extension__({                                                                                                      \
+        static LogCallSite _logCallSite __attribute__((used, section(LOG_CALL_SITE_SECTION), aligned(sizeof(void*)))) =  \
+            {__FILE__, FUNCTION, LOG_SITE_FORMAT(formatStr), __LINE__, level,                                            \
+             LOG_SITE_HAS_LOCATION, LOG_SITE_DEFAULT, NULL};                                                             \
+        !LOG_SITE_SKIPS(_logCallSite, logCategory)                                                                       \
+            ? siteFct(&_logCallSite, &logCategory, __VA_ARGS__)                                                          \
+            : LOG_OK;                                                                                                    \
+    })
+
+#define _log0(logCategory, level, ...) \
+    _logSite(siteLog0, logCategory, level, LOG_SITE_FIRST(__VA_ARGS__, ), __VA_ARGS__)
+#define _log1(logCategory, level, ...) \
+    _logSite(siteLog1, logCategory, level, LOG_SITE_FIRST(__VA_ARGS__, ), __VA_ARGS__)
+#define _logv(logCategory, level, fmt, vaList) \
+    _logSite(siteLogv, logCategory, level, fmt, fmt, vaList)
+#elif defined(USE_LOCATION_INFO)
 #define _log0(logCategory, level, ...) \
     yfLog0(__FILE__, __LINE__, FUNCTION, &logCategory, level, __VA_ARGS__)
 #define _log1(logCategory, level, ...) \
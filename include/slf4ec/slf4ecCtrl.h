@@ -53,18 +53,21 @@ extern const GetLogTimestamp logTimeApi;  /**< Access to the configured timeApi
 
 /**
  * Initialize logging by specifying which logging categories are available and loggers for output.
+ * Categories defined with ::LOG_CATEGORY are configured as well, after @p categories, without having to be listed.
+ * Nothing is allocated unless categories are both listed and defined with ::LOG_CATEGORY.
  *
  * @remark This function is not thread safe.
  *
  * @param [in] nbCategories Number of categories in the @p categories parameter
- * @param [in] categories Configured categories
+ * @param [in] categories Configured categories, can be NULL when every category is defined with ::LOG_CATEGORY
  * @param [in] nbLoggers Number of loggers in the @p loggers parameter
  * @param [in] loggers Configured loggers
  * @retval ::LOG_OK Logging initialized successfully.
- * @retval ::LOG_INVALID_PARAMETER when @p categories or @p loggers are not valid.
+ * @retval ::LOG_INVALID_PARAMETER when @p categories or @p loggers are not valid, or when there are too many categories.
+ * @retval ::LOG_OUT_OF_MEMORY when the categories defined with ::LOG_CATEGORY cannot be gathered.
  * @retval ::LOG_ALREADY_INITIALIZED ::initLogger was already called previously.
  */
-LogResult initLogger(const uint8_t nbCategories, LogCategory* const* categories, const uint8_t nbLoggers, Logger* const* loggers);
+LogResult initLogger(const uint16_t nbCategories, LogCategory* const* categories, const uint16_t nbLoggers, Logger* const* loggers);
 
 /**
  * Set the LogLevel for all categories.
@@ -80,18 +83,304 @@ LogResult setLevels(const uint8_t level);
 /**
  * Retrieve the list of configured categories.
  *
+ * @remark The array remains valid after categories are added at runtime, but will not list them.
+ *
  * @param [out] categories Pointer to an array of configured categories
  * @return Number of configured categories
  */
-uint8_t getCategories(LogCategory* const** categories);
+uint16_t getCategories(LogCategory* const** categories);
 
 /**
  * Retrieve the list of configured loggers.
  *
+ * @remark The array is only valid until the next call to ::addLogger, ::removeLogger or ::replaceLogger.
+ *
  * @param [out] loggers Pointer to an array of configured loggers
  * @return Number of configured loggers
  */
-uint8_t getLoggers(Logger* const** loggers);
+uint16_t getLoggers(Logger* const** loggers);
+
+/**
+ * Make the calling thread log more than the levels of the categories, e.g. to trace a single request.
+ * A category is active for the thread at the most verbose of its own level and of the override. Other threads are not
+ * affected, and cost a single load when no thread has an override. Loggers keep on filtering with their own level.
+ * To have records logged on behalf of the thread by another thread follow the override, obtain it with
+ * ::getThreadLevelOverride and set it on the other thread for the time it works on behalf of this one.
+ * As long as a thread has an override, call sites are evaluated on every call. With POSIX threads, the override of a
+ * thread is removed when it exits.
+ *
+ * @param [in] levelOverride Override of the calling thread, copied. NULL or a level of ::LEVEL_OFF to remove it.
+ * @retval ::LOG_OK Override set successfully.
+ * @retval ::LOG_INVALID_PARAMETER when the level doesn't exist or the categories are missing.
+ */
+LogResult setThreadLevelOverride(const LogLevelOverride* const levelOverride);
+
+/**
+ * Retrieve the level override of the calling thread.
+ *
+ * @param [out] levelOverride Override of the calling thread, with a level of ::LEVEL_OFF when there is none
+ * @retval ::LOG_OK Override obtained successfully.
+ * @retval ::LOG_INVALID_PARAMETER when @p levelOverride is NULL.
+ */
+LogResult getThreadLevelOverride(LogLevelOverride* const levelOverride);
+
+/*
+ * Runtime configuration changes
+ *
+ * Logging threads are never blocked by these functions: they keep on using the configuration that was current
+ * when their log call started. Changes are serialized between themselves and return once the previous
+ * configuration is no longer in use, which means they must not be called from a logger nor from interrupt context.
+ * Unlike ::initLogger, these functions allocate memory.
+ */
+
+/**
+ * Add a logger at runtime. Its initFct is called before it starts receiving records.
+ *
+ * @param [in] logger Logger to add
+ * @retval ::LOG_OK @p logger added successfully.
+ * @retval ::LOG_NOT_INITIALIZED ::initLogger was not called.
+ * @retval ::LOG_INVALID_PARAMETER when @p logger is not valid, is already configured or when too many loggers are configured.
+ * @retval ::LOG_OUT_OF_MEMORY when the new configuration cannot be allocated.
+ */
+LogResult addLogger(Logger* const logger);
+
+/**
+ * Remove a logger at runtime. Once this returns, @p logger no longer receives records and can be released.
+ *
+ * @param [in] logger Logger to remove
+ * @retval ::LOG_OK @p logger removed successfully.
+ * @retval ::LOG_NOT_INITIALIZED ::initLogger was not called.
+ * @retval ::LOG_INVALID_PARAMETER when @p logger is not configured.
+ * @retval ::LOG_OUT_OF_MEMORY when the new configuration cannot be allocated.
+ */
+LogResult removeLogger(const Logger* const logger);
+
+/**
+ * Replace a logger at runtime, keeping its position. Records are published to either logger, never both nor none.
+ * Once this returns, @p oldLogger no longer receives records and can be released.
+ *
+ * @param [in] oldLogger Logger to replace
+ * @param [in] newLogger Logger taking its place. Its initFct is called before it starts receiving records.
+ * @retval ::LOG_OK @p oldLogger replaced successfully.
+ * @retval ::LOG_NOT_INITIALIZED ::initLogger was not called.
+ * @retval ::LOG_INVALID_PARAMETER when @p oldLogger is not configured or when @p newLogger is not valid or already configured.
+ * @retval ::LOG_OUT_OF_MEMORY when the new configuration cannot be allocated.
+ */
+LogResult replaceLogger(const Logger* const oldLogger, Logger* const newLogger);
+
+/**
+ * Register a category at runtime. Its index is assigned and ::setLevels applies to it from now on.
+ *
+ * @param [in] category Category to register
+ * @retval ::LOG_OK @p category registered successfully.
+ * @retval ::LOG_NOT_INITIALIZED ::initLogger was not called.
+ * @retval ::LOG_INVALID_PARAMETER when @p category is NULL, already registered or when too many categories are configured.
+ * @retval ::LOG_OUT_OF_MEMORY when the new configuration cannot be allocated.
+ */
+LogResult addCategory(LogCategory* const category);
+
+/**
+ * Convert a ::LogRecord to a ::LogRecordV2, for loggers implementing ::PublishLogV2 that keep a ::PublishLog entry point.
+ *
+ * @param [in] record Record to convert
+ * @param [out] recordV2 Converted record. Its vaList points to the one of @p record.
+ */
+void logRecordToV2(const LogRecord* const record, LogRecordV2* const recordV2);
+
+#ifdef USE_CALL_SITES
+/*
+ * Call sites
+ *
+ * Each log call owns a ::LogCallSite caching whether it logs, so a call that does not log costs a single load.
+ * The cache is refreshed when levels change through ::setLevels or when sites are controlled. Code changing
+ * LogCategory::currentLogLevel directly must call ::invalidateCallSites afterwards.
+ * Calls made by disabled sites are not accounted for in the statistics.
+ */
+
+/**
+ * Retrieve every call site of the program.
+ *
+ * @remark Only the sites of the executable or shared library holding SLF4EC are listed.
+ *
+ * @param [out] sites Pointer to an array of call sites
+ * @return Number of call sites
+ */
+size_t getCallSites(LogCallSite** const sites);
+
+/**
+ * Control the call sites matching a query, e.g. to enable the debug logs of a single function without lowering
+ * the level of its category. Can be called before ::initLogger.
+ *
+ * @param [in] query Sites to control
+ * @param [in] control How the matching sites decide whether to log
+ * @param [out] nbSites Number of matching sites. Can be NULL.
+ * @retval ::LOG_OK The matching sites are controlled by @p control.
+ * @retval ::LOG_INVALID_PARAMETER when @p query is NULL or @p control doesn't exist.
+ */
+LogResult setCallSites(const LogSiteQuery* const query, const LogSiteControl control, uint32_t* const nbSites);
+
+/**
+ * Make every call site evaluate again whether it logs, on its next call.
+ */
+void invalidateCallSites(void);
+#endif
+
+#ifdef USE_LOG_STATS
+/**
+ * Access to the configured tick counter used to time the loggers (e.g. a cycle counter).
+ * Must be monotonic and should have a much finer resolution than ::logTimeApi.
+ */
+extern const GetLogTimestamp logTickApi;
+
+/**
+ * Take a snapshot of the global logging statistics.
+ *
+ * @remark Counters are monotonic. Take two snapshots and subtract them to obtain rates.
+ *
+ * @param [out] stats Snapshot of the statistics
+ * @retval ::LOG_OK Snapshot taken successfully.
+ * @retval ::LOG_INVALID_PARAMETER when @p stats is NULL.
+ */
+LogResult getLogStats(LogStats* const stats);
+
+/**
+ * Take a snapshot of the statistics of a category.
+ *
+ * @param [in] category Category for which statistics are requested
+ * @param [out] stats Snapshot of the statistics
+ * @retval ::LOG_OK Snapshot taken successfully.
+ * @retval ::LOG_INVALID_PARAMETER when @p category is not configured or beyond LOG_STATS_MAX_CATEGORIES, or when @p stats is NULL.
+ */
+LogResult getCategoryStats(const LogCategory* const category, LogCategoryStats* const stats);
+
+/**
+ * Take a snapshot of the statistics of a logger, summing the counters of every thread.
+ * Statistics are kept for the first LOG_STATS_MAX_LOGGERS loggers ever configured.
+ *
+ * @param [in] logger Logger for which statistics are requested
+ * @param [out] stats Snapshot of the statistics
+ * @retval ::LOG_OK Snapshot taken successfully.
+ * @retval ::LOG_INVALID_PARAMETER when @p logger was never configured or is beyond LOG_STATS_MAX_LOGGERS, or when @p logger or @p stats is NULL.
+ */
+LogResult getLoggerStats(const Logger* const logger, LoggerStats* const stats);
+
+/**
+ * Report the number of bytes emitted for the record being published.
+ * To be called by a logger from within its ::PublishLog function, ignored otherwise.
+ *
+ * @param [in] nbBytes Number of bytes emitted
+ */
+void logReportBytes(const size_t nbBytes);
+
+/**
+ * Record a value in a histogram. Lock-free, can be called from any thread.
+ *
+ * @param [in] histogram Histogram to record into
+ * @param [in] value Value to record. Saturates at ::LOG_HISTOGRAM_MAX_VALUE
+ */
+void logHistogramRecord(LogHistogram* const histogram, const uint64_t value);
+
+/**
+ * Obtain the value below which a proportion of the recorded values fall.
+ *
+ * @param [in] histogram Histogram to query
+ * @param [in] ppm Proportion, in parts per million (e.g. 999000 for the 99.9th percentile)
+ * @return Highest value equivalent to the bucket reaching @p ppm, never above the highest recorded value. 0 when the histogram is empty.
+ */
+uint64_t logHistogramPercentile(const LogHistogram* const histogram, const uint32_t ppm);
+
+/**
+ * Clear a histogram.
+ *
+ * @remark Values recorded concurrently with the reset may or may not be kept.
+ *
+ * @param [in] histogram Histogram to clear
+ */
+void logHistogramReset(LogHistogram* const histogram);
+
+/**
+ * Summarize the publishFct duration histogram of a logger.
+ *
+ * @param [in] logger Logger to query
+ * @param [out] latency Summary of the histogram, in ::logTickApi units
+ * @retval ::LOG_OK Summary obtained successfully.
+ * @retval ::LOG_INVALID_PARAMETER when @p logger or @p latency is NULL, or when @p logger has no histogram.
+ */
+LogResult getLoggerLatency(const Logger* const logger, LogLatency* const latency);
+#endif
+
+#ifdef USE_LOG_PROFILER
+/*
+ * Profiler
+ *
+ * Accounts for every log call in a table of the calling thread, by call site (file and line), so the statements behind
+ * the log volume can be found. Requires USE_LOG_STATS, and USE_LOCATION_INFO or call sites to tell sites apart: calls
+ * without location are accounted for together. Each thread profiles up to LOG_PROFILER_MAX_SITES sites, calls of the
+ * sites beyond are accounted for along with the calls without location.
+ */
+
+/**
+ * Report the worst call sites since logging started.
+ *
+ * @remark Allocates memory to merge the tables of the threads.
+ *
+ * @param [out] sites Worst sites, worst first
+ * @param [in,out] nbSites Capacity of @p sites, then number of sites reported
+ * @param [in] order How the sites are ranked
+ * @retval ::LOG_OK Report obtained successfully.
+ * @retval ::LOG_INVALID_PARAMETER when @p sites or @p nbSites is NULL, or when @p order doesn't exist.
+ * @retval ::LOG_OUT_OF_MEMORY when the report cannot be allocated.
+ */
+LogResult getLogProfile(LogSiteProfile* const sites, size_t* const nbSites, const LogProfileOrder order);
+
+/**
+ * Publish the worst call sites since the previous dump to a logger, one record per site, e.g.
+ * "main.c:42 (main) calls=1200 published=1200 bytes=96000 time=5300".
+ *
+ * @remark Allocates memory to merge the tables of the threads.
+ *
+ * @param [in] logger Logger receiving the report, already initialized. Does not need to be configured.
+ * @param [in] nbSites Maximum number of sites reported
+ * @param [in] order How the sites are ranked
+ * @retval ::LOG_OK Report published successfully.
+ * @retval ::LOG_INVALID_PARAMETER when @p logger is not valid or when @p order doesn't exist.
+ * @retval ::LOG_OUT_OF_MEMORY when the report cannot be allocated.
+ */
+LogResult dumpLogProfile(Logger* const logger, const size_t nbSites, const LogProfileOrder order);
+
+/**
+ * Start a thread calling ::dumpLogProfile periodically. Only available on hosts with POSIX threads.
+ *
+ * @param [in] logger Logger receiving the reports, already initialized. Does not need to be configured.
+ * @param [in] periodMs Time between two reports, in milliseconds
+ * @param [in] nbSites Maximum number of sites per report
+ * @param [in] order How the sites are ranked
+ * @retval ::LOG_OK Thread started successfully.
+ * @retval ::LOG_INVALID_PARAMETER when @p logger is not valid, @p periodMs is 0, @p order doesn't exist or when not
+ * supported on this target.
+ * @retval ::LOG_ALREADY_INITIALIZED when the thread is already started, see ::stopLogProfileDump.
+ * @retval ::LOG_OUT_OF_MEMORY when the thread cannot be started.
+ */
+LogResult startLogProfileDump(Logger* const logger, const uint32_t periodMs, const size_t nbSites, const LogProfileOrder order);
+
+/**
+ * Stop the thread started by ::startLogProfileDump.
+ */
+void stopLogProfileDump(void);
+#endif
+
+#ifdef USE_LOG_DEDUP
+/**
+ * Publish the summaries of the duplicates a logger suppressed and did not report yet. Meant to be called periodically
+ * when runs of duplicates must be reported even if no other record follows them.
+ *
+ * @param [in] logger Logger to flush
+ * @retval ::LOG_OK Summaries published successfully.
+ * @retval ::LOG_INVALID_PARAMETER when @p logger is NULL or does not suppress duplicates.
+ * @retval ::LOG_NOT_INITIALIZED when logging is not initialized.
+ */
+LogResult flushLogDuplicates(Logger* const logger);
+#endif
 
 #ifdef __cplusplus
 }
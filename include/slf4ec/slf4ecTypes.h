@@ -105,8 +105,9 @@ extern "C" {
  */
 typedef enum
 {
-    FORMAT_FULL = 0,    /**< Outputs all details */
-    FORMAT_MSG_ONLY = 1 /**< Outputs only the message */
+    FORMAT_FULL = 0,     /**< Outputs all details */
+    FORMAT_MSG_ONLY = 1, /**< Outputs only the message */
+    FORMAT_CONTEXT = 2   /**< Outputs all details along with the thread and its diagnostic context */
 } LogFormat;
 
 /**
@@ -117,7 +118,8 @@ typedef enum
     LOG_OK = 0,              /**< No error */
     LOG_NOT_INITIALIZED,     /**< Not initialized */
     LOG_ALREADY_INITIALIZED, /**< Already initialized */
-    LOG_INVALID_PARAMETER    /**< Invalid parameter */
+    LOG_INVALID_PARAMETER,   /**< Invalid parameter */
+    LOG_OUT_OF_MEMORY        /**< Memory allocation failed */
 } LogResult;
 
 /**
@@ -127,10 +129,241 @@ typedef struct
 {
     const char* const name;  /**< Name for this category. */
     uint8_t currentLogLevel; /**< Current logging level for this category. */
+    uint16_t index;          /**< Position of this category within the configured categories. Assigned by ::initLogger or ::addCategory. */
 } LogCategory;
 
 /**
- * Packages data for the loggers
+ * Maximum number of key-value pairs in the diagnostic context of a thread.
+ */
+#ifndef LOG_CONTEXT_MAX_ENTRIES
+#define LOG_CONTEXT_MAX_ENTRIES (8)
+#endif
+
+/**
+ * Maximum length of a thread name, including the terminating character. Longer names are truncated.
+ */
+#ifndef LOG_CONTEXT_NAME_LENGTH
+#define LOG_CONTEXT_NAME_LENGTH (16)
+#endif
+
+/**
+ * Key-value pair of a diagnostic context. Neither string is copied.
+ */
+typedef struct
+{
+    const char* key;   /**< Name of the value, e.g. "request". */
+    const char* value; /**< Value, must remain valid until popped. */
+} LogContextEntry;
+
+/**
+ * Diagnostic context of a thread, see ::logContextPush
+ */
+typedef struct
+{
+    uint32_t threadId;                                /**< Identifier of the thread, obtained once. */
+    char threadName[LOG_CONTEXT_NAME_LENGTH];         /**< Name given with ::logContextSetThreadName. Empty if none. */
+    uint8_t nbEntries;                                /**< Number of entries pushed. */
+    LogContextEntry entries[LOG_CONTEXT_MAX_ENTRIES]; /**< Entries, oldest first. */
+} LogContext;
+
+/**
+ * Level override of a thread, see ::setThreadLevelOverride
+ */
+typedef struct
+{
+    uint8_t level;                  /**< Level logged by the thread whatever the level of the categories. ::LEVEL_OFF for no override. */
+    uint16_t nbCategories;          /**< Number of categories in categories. 0 to override every category. */
+    LogCategory* const* categories; /**< Categories overridden. Referenced, not copied. */
+} LogLevelOverride;
+
+#ifdef USE_CALL_SITES
+/**
+ * How a call site decides whether to log, see ::setCallSites
+ */
+typedef enum
+{
+    LOG_SITE_DEFAULT = 0, /**< Logs according to the level of its category. */
+    LOG_SITE_ENABLED,     /**< Always logs, whatever the level of its category. */
+    LOG_SITE_DISABLED     /**< Never logs. */
+} LogSiteControl;
+
+/**
+ * Descriptor of a log call site. The logging macros place one per call in the "slf4ec_sites" linker section.
+ */
+typedef struct
+{
+    const char* file;      /**< Path to the source code file of the call. */
+    const char* function;  /**< Name of the function making the call. */
+    const char* formatStr; /**< Format String of the call. NULL when it is not a string literal. */
+    uint32_t line;         /**< Line number of the call. */
+    uint8_t level;         /**< LogLevel of the call. */
+    uint8_t hasLocation;   /**< Whether records of this site carry its location, i.e. the call was built with @p USE_LOCATION_INFO. */
+    uint8_t control;       /**< ::LogSiteControl of this site. */
+    /**
+     * Category for which the site was found not to log, the macros skipping the call when logging against it.
+     * NULL once levels or controls change, until the next call of the site.
+     */
+    const LogCategory* disabledFor;
+} LogCallSite;
+
+/**
+ * Selects call sites. Fields left NULL or 0 match any site.
+ */
+typedef struct
+{
+    const char* file;     /**< End of the path of the source code file, e.g. "net/socket.c". */
+    const char* function; /**< Name of the function. */
+    uint32_t firstLine;   /**< First line of the range. */
+    uint32_t lastLine;    /**< Last line of the range. */
+    const char* format;   /**< Substring of the Format String. Sites whose format is not a string literal never match. */
+} LogSiteQuery;
+#endif
+
+#ifdef USE_LOG_STATS
+/**
+ * Counter used by the logging statistics. Native word size so it can be updated atomically on every target.
+ */
+typedef uintptr_t LogCounter;
+
+/**
+ * Statistics of a single LogCategory
+ */
+typedef struct
+{
+    LogCounter calls;    /**< Number of log calls made against this category. */
+    LogCounter filtered; /**< Number of log calls discarded because of the category's currentLogLevel. */
+} LogCategoryStats;
+
+/**
+ * Statistics of a single Logger
+ */
+typedef struct
+{
+    LogCounter published;   /**< Number of records handed to the logger's publishFct. */
+    LogCounter bytes;       /**< Number of bytes reported by the logger through ::logReportBytes. */
+    LogCounter publishTime; /**< Cumulative time spent in the logger's publishFct, in ::logTickApi units. */
+} LoggerStats;
+
+/**
+ * Number of bits of precision kept by a ::LogHistogram. Each power of 2 is divided in 2^(bits-1) linear buckets.
+ * Default of 5 bits gives a relative error below 6.25%.
+ */
+#ifndef LOG_HISTOGRAM_SUB_BUCKET_BITS
+#define LOG_HISTOGRAM_SUB_BUCKET_BITS (5)
+#endif
+
+#define LOG_HISTOGRAM_SUB_BUCKETS (1u << LOG_HISTOGRAM_SUB_BUCKET_BITS) /**< Linear buckets below the first power of 2 */
+#define LOG_HISTOGRAM_MAX_VALUE (UINT32_MAX)                            /**< Values above are recorded as this value */
+
+/**
+ * Number of buckets needed to cover values up to ::LOG_HISTOGRAM_MAX_VALUE
+ */
+#define LOG_HISTOGRAM_NB_BUCKETS \
+    (LOG_HISTOGRAM_SUB_BUCKETS + (32 - LOG_HISTOGRAM_SUB_BUCKET_BITS) * (LOG_HISTOGRAM_SUB_BUCKETS / 2))
+
+/**
+ * Log-linear histogram of durations, in ::logTickApi units.
+ * Recording is lock-free so a histogram can be shared by any number of threads.
+ */
+typedef struct
+{
+    LogCounter count;                             /**< Number of recorded values. */
+    LogCounter max;                               /**< Highest recorded value. */
+    LogCounter buckets[LOG_HISTOGRAM_NB_BUCKETS]; /**< Number of recorded values per bucket. */
+} LogHistogram;
+
+/**
+ * Summary of a ::LogHistogram, as returned by ::getLoggerLatency
+ */
+typedef struct
+{
+    LogCounter count; /**< Number of recorded values. */
+    uint64_t p50;     /**< Median. */
+    uint64_t p99;     /**< 99th percentile. */
+    uint64_t p999;    /**< 99.9th percentile. */
+    uint64_t max;     /**< Highest recorded value. */
+} LogLatency;
+
+/**
+ * Global logging statistics. Each array is indexed by log level.
+ */
+typedef struct
+{
+    LogCounter calls[LEVEL_MAX + 1];              /**< Number of log calls. */
+    LogCounter filteredByCategory[LEVEL_MAX + 1]; /**< Number of log calls discarded because of the category's currentLogLevel. */
+    LogCounter filteredByLogger[LEVEL_MAX + 1];   /**< Number of times a record was not handed to a logger because of the logger's currentLogLevel. */
+    LogCounter published[LEVEL_MAX + 1];          /**< Number of times a record was handed to a logger. */
+} LogStats;
+#endif
+
+#ifdef USE_LOG_PROFILER
+/**
+ * Cost of a log call site, as accounted for by the profiler. Sites are told apart by file and line.
+ */
+typedef struct
+{
+    const char* file;       /**< Path to the source code file of the site. NULL for calls without location or beyond the profiled sites. */
+    const char* function;   /**< Name of the function of the site. NULL along with file. */
+    uint32_t line;          /**< Line number of the site. */
+    LogCounter calls;       /**< Number of log calls, including the ones discarded because of the category's currentLogLevel. */
+    LogCounter published;   /**< Number of times a record of the site was handed to a logger. */
+    LogCounter bytes;       /**< Number of bytes reported by the loggers through ::logReportBytes for the records of the site. */
+    LogCounter publishTime; /**< Cumulative time spent formatting and publishing the records of the site, in ::logTickApi units. */
+} LogSiteProfile;
+
+/**
+ * Order of the sites reported by the profiler, worst first
+ */
+typedef enum
+{
+    PROFILE_BY_CALLS = 0, /**< Most calls first */
+    PROFILE_BY_BYTES,     /**< Most bytes first */
+    PROFILE_BY_TIME       /**< Most time first */
+} LogProfileOrder;
+#endif
+
+#ifdef USE_LOG_DEDUP
+/**
+ * Number of categories whose previous record is remembered by a ::LogDedup. Categories share slots beyond.
+ */
+#ifndef LOG_DEDUP_SLOTS
+#define LOG_DEDUP_SLOTS (16)
+#endif
+
+/**
+ * Previous record of a category, as remembered by a ::LogDedup. Maintained by SLF4EC.
+ */
+typedef struct
+{
+    uint64_t hash;               /**< Hash of the call site, level and arguments of the record. */
+    uint64_t since;              /**< Timestamp of the record, or of the last summary of its duplicates. */
+    const LogCategory* category; /**< Category of the record. NULL when the slot is unused. */
+    const char* formatStr;       /**< Format string of the record. */
+    const char* file;            /**< Source file of the record. NULL without location. */
+    uint32_t line;               /**< Source line of the record. 0 without location. */
+    uint32_t length;             /**< Number of bytes hashed, the arguments of the record included. */
+    uint32_t repeated;           /**< Number of duplicates suppressed since. */
+    uint8_t level;               /**< Level of the record. */
+    uint8_t busy;                /**< Whether a thread is using the slot. */
+} LogDedupSlot;
+
+/**
+ * Suppression of the consecutive duplicates of a logger, see Logger::dedup.
+ * A record duplicates the previous record of its category when it comes from the same call site, with the same level
+ * and the same arguments. Duplicates are counted rather than published, then summarized by a "Last message repeated N
+ * times" record once a different record of the category arrives, once a duplicate arrives @p summaryPeriod after the
+ * previous summary, or when ::flushLogDuplicates is called.
+ */
+typedef struct
+{
+    uint64_t summaryPeriod;              /**< Time between summaries of a run of duplicates, in ::logTimeApi units. 0 to wait for the run to end. */
+    uint32_t suppressed;                 /**< Number of duplicates suppressed overall. Maintained by SLF4EC. */
+    LogDedupSlot slots[LOG_DEDUP_SLOTS]; /**< Previous record per category, indexed by LogCategory::index. Maintained by SLF4EC. */
+} LogDedup;
+#endif
+
+/**
+ * Packages data for the loggers, version 1. See ::LogRecordV2 for new loggers.
  */
 typedef struct
 {
@@ -157,8 +390,56 @@ typedef struct
     const uint8_t* const level;        /**< LogLevel for this event. */
     const char* const formatStr;       /**< Format String for this event. */
     va_list* const vaList;             /**< Argument list for this event. */
+
+    /**
+     * Diagnostic context of the thread logging this event. Only valid while the record is being published.
+     * NULL if @p USE_LOG_CONTEXT is not defined.
+     */
+    const LogContext* const context;
 } LogRecord;
 
+#define LOG_RECORD_HAS_LOCATION (0x01) /**< LogRecordV2::file, LogRecordV2::line and LogRecordV2::function are set */
+#define LOG_RECORD_HAS_CONTEXT (0x02)  /**< LogRecordV2::context is set */
+#define LOG_RECORD_SPAN_BEGIN (0x04)   /**< Record opening a ::LogSpan, formatted with ::LOG_SPAN_BEGIN_FORMAT */
+#define LOG_RECORD_SPAN_END (0x08)     /**< Record closing a ::LogSpan, formatted with ::LOG_SPAN_END_FORMAT */
+
+/*
+ * Format of the records of a span. Loggers printing them need nothing special, loggers tracing them (see
+ * slf4ec/logger/trace.h) read their arguments in this order.
+ */
+#define LOG_SPAN_BEGIN_FORMAT "Span %s begins on thread %" PRIu32               /**< Arguments: name, thread */
+#define LOG_SPAN_END_FORMAT "Span %s ends on thread %" PRIu32 " after %" PRIu64 /**< Arguments: name, thread, duration */
+
+/**
+ * Packages data for the loggers, version 2. Scalars are held by value and presence is given by flags rather than by NULL
+ * pointers. Fits in a single 64 bytes cache line on 64 bits targets.
+ */
+typedef struct
+{
+    uint64_t timestamp;          /**< Timestamp of this event. */
+    const LogCategory* category; /**< LogCategory of this event. */
+    const char* formatStr;       /**< Format String for this event. */
+    va_list* vaList;             /**< Argument list for this event. Shared by every logger, copy it before use. */
+    const char* file;            /**< Path to the source code file where this event occurred. See ::LOG_RECORD_HAS_LOCATION */
+    const char* function;        /**< Name of the function within which the event occurred. See ::LOG_RECORD_HAS_LOCATION */
+    const LogContext* context;   /**< Diagnostic context of the thread logging this event. See ::LOG_RECORD_HAS_CONTEXT */
+    uint32_t line;               /**< Line number within the source code file. See ::LOG_RECORD_HAS_LOCATION */
+    uint8_t level;               /**< LogLevel for this event. */
+    uint8_t flags;               /**< Combination of the LOG_RECORD_ flags, telling which optional fields are set and what the record is. */
+} LogRecordV2;
+
+/**
+ * Span of time traced through the loggers, see ::logSpanBegin. Maintained by SLF4EC.
+ */
+typedef struct
+{
+    const LogCategory* category; /**< Category of the span. NULL when the span is not active. */
+    const char* name;            /**< Name of the span, must remain valid until the span ends. */
+    uint64_t start;              /**< Timestamp of the record opening the span. */
+    uint32_t threadId;           /**< Thread that opened the span. */
+    uint8_t level;               /**< Level of the records of the span. */
+} LogSpan;
+
 /**
  * Called method inside a logger to output the information.
  * A logger must implement this.
@@ -168,6 +449,14 @@ typedef struct
  */
 typedef void (*const PublishLog)(const LogRecord* const logRecord, const LogFormat logFormat);
 
+/**
+ * Version of ::PublishLog taking a ::LogRecordV2.
+ *
+ * @param [in] logRecord Information on the event. This parameter is guaranteed to always hold a valid value so checks for NULL are unnecessary.
+ * @param [in] logFormat Format to be used with this event
+ */
+typedef void (*const PublishLogV2)(const LogRecordV2* const logRecord, const LogFormat logFormat);
+
 /**
  * Method called to initialize a logger.
  *
@@ -192,7 +481,25 @@ typedef struct
     const void* const initArgs;   /**< Arguments needed to initialize this logger. */
     const LogFormat format;       /**< Format to be used with this logger. */
     uint8_t currentLogLevel;      /**< Current LogLevel for this logger. Anything below will not be logged. */
-    const PublishLog publishFct;  /**< Function to be called to output the event. */
+    const PublishLog publishFct;  /**< Function to be called to output the event. See publishFctV2. */
+    /**
+     * Optional list of the categories this logger is restricted to. NULL to receive every category.
+     * Compiled into a routing table when the logger is configured, so it cannot change afterwards.
+     */
+    LogCategory* const* const categoryFilter;
+    const uint16_t nbCategoryFilter; /**< Number of categories in categoryFilter. */
+    /**
+     * Function to be called to output the event, taking a ::LogRecordV2. Used instead of publishFct when set, in which case
+     * publishFct can be NULL.
+     */
+    const PublishLogV2 publishFctV2;
+#ifdef USE_LOG_STATS
+    uint16_t statsIndex;     /**< Position of this logger's counters in the statistics, plus 1. Assigned by SLF4EC, leave to 0. */
+    LogHistogram* histogram; /**< Optional histogram of the publishFct duration. NULL to disable. See ::getLoggerLatency */
+#endif
+#ifdef USE_LOG_DEDUP
+    LogDedup* dedup; /**< Optional suppression of consecutive duplicates. NULL to publish every record. */
+#endif
 } Logger;
 
 #ifdef __cplusplus
@@ -0,0 +1,187 @@
+/**
+ * @file
+ *
+ * Log-linear histograms used to track the latency of loggers
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "slf4ec/slf4ecCtrl.h"
+#include "slf4ecPrivate.h"
+
+#ifdef USE_LOG_STATS
+
+#define HALF_SUB_BUCKETS (LOG_HISTOGRAM_SUB_BUCKETS / 2)
+
+static inline uint_fast8_t mostSignificantBit(const uint32_t value)
+{
+#if defined(__GNUC__)
+    return (uint_fast8_t)(31 - __builtin_clz(value));
+#else
+    uint_fast8_t msb = 0;
+    uint32_t remaining = value;
+    while (remaining >>= 1)
+    {
+        msb++;
+    }
+    return msb;
+#endif
+}
+
+/*
+ * Values below LOG_HISTOGRAM_SUB_BUCKETS each have their own bucket.
+ * Above, each power of 2 is split in HALF_SUB_BUCKETS buckets of equal width.
+ */
+static inline uint_fast16_t bucketIndex(const uint32_t value)
+{
+    uint_fast16_t index;
+
+    if (value < LOG_HISTOGRAM_SUB_BUCKETS)
+    {
+        index = value;
+    }
+    else
+    {
+        const uint_fast8_t group = mostSignificantBit(value) - (LOG_HISTOGRAM_SUB_BUCKET_BITS - 1);
+        const uint32_t top = value >> group;
+        index = LOG_HISTOGRAM_SUB_BUCKETS + (group - 1) * HALF_SUB_BUCKETS + (top - HALF_SUB_BUCKETS);
+    }
+
+    return index;
+}
+
+static inline uint64_t bucketHighestValue(const uint_fast16_t index)
+{
+    uint64_t highest;
+
+    if (index < LOG_HISTOGRAM_SUB_BUCKETS)
+    {
+        highest = index;
+    }
+    else
+    {
+        const uint_fast8_t group = (index - LOG_HISTOGRAM_SUB_BUCKETS) / HALF_SUB_BUCKETS + 1;
+        const uint64_t top = (index - LOG_HISTOGRAM_SUB_BUCKETS) % HALF_SUB_BUCKETS + HALF_SUB_BUCKETS;
+        highest = ((top + 1) << group) - 1;
+    }
+
+    return highest;
+}
+
+void logHistogramRecord(LogHistogram* const histogram, const uint64_t value)
+{
+    const uint32_t saturated = value > LOG_HISTOGRAM_MAX_VALUE ? LOG_HISTOGRAM_MAX_VALUE : (uint32_t) value;
+    LogCounter max = LOG_ATOMIC_LOAD(histogram->max);
+
+    LOG_ATOMIC_ADD(histogram->buckets[bucketIndex(saturated)], 1);
+    LOG_ATOMIC_ADD(histogram->count, 1);
+
+    while (saturated > max && !LOG_ATOMIC_CAS(histogram->max, max, saturated))
+    {
+        // max was refreshed by the failed compare and swap
+    }
+}
+
+uint64_t logHistogramPercentile(const LogHistogram* const histogram, const uint32_t ppm)
+{
+    uint64_t total = 0;
+    uint64_t value = 0;
+    uint_fast16_t i;
+
+    // Counting from the buckets themselves keeps the result coherent while values are being recorded
+    for (i = 0; i < LOG_HISTOGRAM_NB_BUCKETS; i++)
+    {
+        total += LOG_ATOMIC_LOAD(histogram->buckets[i]);
+    }
+
+    if (total > 0)
+    {
+        const uint64_t boundedPpm = ppm > 1000000 ? 1000000 : ppm;
+        uint64_t target = (total * boundedPpm + 999999) / 1000000;
+        uint64_t seen = 0;
+        const uint64_t max = LOG_ATOMIC_LOAD(histogram->max);
+
+        if (target == 0)
+        {
+            target = 1;
+        }
+
+        for (i = 0; i < LOG_HISTOGRAM_NB_BUCKETS; i++)
+        {
+            seen += LOG_ATOMIC_LOAD(histogram->buckets[i]);
+            if (seen >= target)
+            {
+                value = bucketHighestValue(i);
+                break;
+            }
+        }
+
+        if (value > max)
+        {
+            value = max;
+        }
+    }
+
+    return value;
+}
+
+void logHistogramReset(LogHistogram* const histogram)
+{
+    uint_fast16_t i;
+
+    for (i = 0; i < LOG_HISTOGRAM_NB_BUCKETS; i++)
+    {
+        LOG_ATOMIC_STORE(histogram->buckets[i], 0);
+    }
+    LOG_ATOMIC_STORE(histogram->count, 0);
+    LOG_ATOMIC_STORE(histogram->max, 0);
+}
+
+LogResult getLoggerLatency(const Logger* const logger, LogLatency* const latency)
+{
+    LogResult returnCode = LOG_OK;
+
+    if (logger == NULL || latency == NULL || logger->histogram == NULL)
+    {
+        returnCode = LOG_INVALID_PARAMETER;
+    }
+    else
+    {
+        const LogHistogram* const histogram = logger->histogram;
+
+        latency->count = LOG_ATOMIC_LOAD(histogram->count);
+        latency->p50 = logHistogramPercentile(histogram, 500000);
+        latency->p99 = logHistogramPercentile(histogram, 990000);
+        latency->p999 = logHistogramPercentile(histogram, 999000);
+        latency->max = LOG_ATOMIC_LOAD(histogram->max);
+    }
+
+    return returnCode;
+}
+
+#endif /* USE_LOG_STATS */
@@ -0,0 +1,563 @@
+/**
+ * @file
+ *
+ * Capture of records into self-contained entries, for deferred formatting
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "slf4ecPrivate.h"
+
+#define SLOT_SIZE (8u)            /**< Every field of an entry starts on a slot */
+#define NULL_STRING (UINT32_MAX)  /**< Length stored for a NULL string */
+#define MAX_SPEC_LENGTH (32)      /**< Longest conversion specification, once '*' are replaced by their value */
+#define MAX_MESSAGE_LENGTH (2048) /**< Longer messages are truncated when formatted */
+
+/*
+ * An entry holds, each field starting on a slot:
+ *   - a CapturedRecord
+ *   - the thread name and the key and value of each entry of the context, if the record has one
+ *   - the format string, or the formatted message when CapturedRecord::isFormatted
+ *   - the arguments, in the order the format string takes them: integers as intmax_t or uintmax_t, floating point
+ *     values as double or long double, pointers as is, strings as their length followed by their characters
+ */
+typedef struct
+{
+    uint64_t timestamp;
+    const LogCategory* category;
+    const char* file;
+    const char* function;
+    uint32_t line;
+    uint32_t threadId; /**< LogContext::threadId, when the record has a context */
+    uint8_t level;
+    uint8_t flags;       /**< LogRecordV2::flags */
+    uint8_t isFormatted; /**< The arguments could not be taken, the message was formatted instead */
+    uint8_t nbEntries;   /**< LogContext::nbEntries, when the record has a context */
+} CapturedRecord;
+
+typedef struct
+{
+    uint8_t* buffer;
+    size_t capacity;
+    size_t used;
+    bool isFull; /**< Set once a field did not fit, the following ones are ignored */
+} Writer;
+
+typedef struct
+{
+    const uint8_t* buffer;
+    size_t used;
+} Reader;
+
+static inline size_t slots(const size_t size)
+{
+    return (size + SLOT_SIZE - 1) & ~(size_t)(SLOT_SIZE - 1);
+}
+
+static void* reserve(Writer* const writer, const size_t size)
+{
+    void* field = NULL;
+
+    if (!writer->isFull && slots(size) <= writer->capacity - writer->used)
+    {
+        field = &writer->buffer[writer->used];
+        writer->used += slots(size);
+    }
+    else
+    {
+        writer->isFull = true;
+    }
+
+    return field;
+}
+
+static void putBytes(Writer* const writer, const void* const value, const size_t size)
+{
+    void* const field = reserve(writer, size);
+
+    if (field != NULL)
+    {
+        memcpy(field, value, size);
+    }
+}
+
+/**
+ * Copy a string, up to @p maxLength characters as with a printf precision
+ */
+static void putString(Writer* const writer, const char* const string, const size_t maxLength)
+{
+    const size_t length = (string != NULL) ? strnlen(string, maxLength) : 0;
+    const uint32_t stored = (string != NULL) ? (uint32_t) length : NULL_STRING;
+
+    putBytes(writer, &stored, sizeof(stored));
+    if (string != NULL)
+    {
+        char* const field = reserve(writer, length + 1);
+
+        if (field != NULL)
+        {
+            memcpy(field, string, length);
+            field[length] = '\0';
+        }
+    }
+}
+
+static void getBytes(Reader* const reader, void* const value, const size_t size)
+{
+    memcpy(value, &reader->buffer[reader->used], size);
+    reader->used += slots(size);
+}
+
+static const char* getString(Reader* const reader)
+{
+    const char* string = NULL;
+    uint32_t length;
+
+    getBytes(reader, &length, sizeof(length));
+    if (length != NULL_STRING)
+    {
+        string = (const char*) &reader->buffer[reader->used];
+        reader->used += slots((size_t) length + 1);
+    }
+
+    return string;
+}
+
+/**
+ * Take the arguments of a format string by value.
+ *
+ * @return Whether every argument could be taken
+ */
+static bool captureArguments(Writer* const writer, const char* format, va_list* const args)
+{
+    bool isCaptured = true;
+
+    while (isCaptured && !writer->isFull && (format = strchr(format, '%')) != NULL)
+    {
+        const char* const spec = format + 1;
+        size_t maxLength = SIZE_MAX;
+        bool isPrecisionTaken = false;
+        LogConversion conversion;
+        const char* star;
+
+        format = logParseConversion(spec, &conversion, NULL);
+
+        // Widths and precisions given as '*' come first, in the order printf takes them
+        for (star = spec; star < format; star++)
+        {
+            if (*star == '*')
+            {
+                const intmax_t value = va_arg(*args, int);
+
+                putBytes(writer, &value, sizeof(value));
+                if (star[-1] == '.')
+                {
+                    isPrecisionTaken = true;
+                    maxLength = (value >= 0) ? (size_t) value : SIZE_MAX;
+                }
+            }
+        }
+        if (conversion.hasPrecision && !isPrecisionTaken)
+        {
+            maxLength = conversion.precision;
+        }
+
+        switch (conversion.conversion)
+        {
+            case 'd':
+            case 'i':
+            {
+                const intmax_t value = logSignedArgument(conversion.length, args);
+                putBytes(writer, &value, sizeof(value));
+                break;
+            }
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+            {
+                const uintmax_t value = logUnsignedArgument(conversion.length, args);
+                putBytes(writer, &value, sizeof(value));
+                break;
+            }
+            case 'c':
+            {
+                const intmax_t value = va_arg(*args, int);
+                isCaptured = (conversion.length == LOG_LENGTH_NONE);
+                putBytes(writer, &value, sizeof(value));
+                break;
+            }
+            case 's':
+                // Wide strings are left to vsnprintf
+                isCaptured = (conversion.length == LOG_LENGTH_NONE);
+                if (isCaptured)
+                {
+                    putString(writer, va_arg(*args, const char*), maxLength);
+                }
+                break;
+            case 'p':
+            {
+                const void* const value = va_arg(*args, void*);
+                putBytes(writer, &value, sizeof(value));
+                break;
+            }
+            case 'e':
+            case 'E':
+            case 'f':
+            case 'F':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                if (conversion.length == LOG_LENGTH_LONG_DOUBLE)
+                {
+                    const long double value = va_arg(*args, long double);
+                    putBytes(writer, &value, sizeof(value));
+                }
+                else
+                {
+                    const double value = va_arg(*args, double);
+                    putBytes(writer, &value, sizeof(value));
+                }
+                break;
+            case '%':
+                break;
+            default:
+                // '%n', end of string or a conversion whose argument cannot be taken
+                isCaptured = false;
+                break;
+        }
+    }
+
+    return isCaptured;
+}
+
+size_t logCaptureRecord(void* const buffer, const size_t capacity, const LogRecordV2* const record)
+{
+    Writer writer = {(uint8_t*) buffer, capacity, 0, false};
+    CapturedRecord* const header = reserve(&writer, sizeof(CapturedRecord));
+    const LogContext* const context = ((record->flags & LOG_RECORD_HAS_CONTEXT) != 0) ? record->context : NULL;
+    uint_fast8_t i;
+    va_list args;
+
+    if (header == NULL)
+    {
+        return 0;
+    }
+
+    header->timestamp = record->timestamp;
+    header->category = record->category;
+    header->file = record->file;
+    header->function = record->function;
+    header->line = record->line;
+    header->threadId = (context != NULL) ? context->threadId : 0;
+    header->level = record->level;
+    header->flags = record->flags;
+    header->isFormatted = 0;
+    header->nbEntries = (context != NULL) ? context->nbEntries : 0;
+
+    // The entries of the context point to strings of the logging thread as well
+    if (context != NULL)
+    {
+        putString(&writer, context->threadName, sizeof(context->threadName) - 1);
+        for (i = 0; i < context->nbEntries; i++)
+        {
+            putString(&writer, context->entries[i].key, SIZE_MAX);
+            putString(&writer, context->entries[i].value, SIZE_MAX);
+        }
+    }
+
+    // The format string may not be a literal either
+    const size_t formatOffset = writer.used;
+    putString(&writer, record->formatStr, SIZE_MAX);
+
+    va_copy(args, *record->vaList);
+    const bool isCaptured = captureArguments(&writer, record->formatStr, &args);
+    va_end(args);
+
+    if (!isCaptured)
+    {
+        char message[MAX_MESSAGE_LENGTH];
+
+        va_copy(args, *record->vaList);
+        (void) vsnprintf(message, sizeof(message), record->formatStr, args);
+        va_end(args);
+
+        writer.used = formatOffset;
+        writer.isFull = false;
+        header->isFormatted = 1;
+        putString(&writer, message, SIZE_MAX);
+    }
+
+    return writer.isFull ? 0 : writer.used;
+}
+
+/**
+ * Rebuild the specification of a conversion, replacing each '*' by the value taken when capturing.
+ */
+static bool buildSpec(char* const spec, const char* const from, const char* const to, Reader* const reader)
+{
+    size_t length = 0;
+    const char* c;
+
+    for (c = from; c < to && length + 1 < MAX_SPEC_LENGTH; c++)
+    {
+        if (*c != '*')
+        {
+            spec[length++] = *c;
+        }
+        else
+        {
+            intmax_t value;
+
+            getBytes(reader, &value, sizeof(value));
+            if (c[-1] == '.' && value < 0)
+            {
+                // A negative precision is as if there was none
+                length--;
+            }
+            else
+            {
+                const int written = snprintf(&spec[length], MAX_SPEC_LENGTH - length, "%d", (int) value);
+                length += (written > 0) ? (size_t) written : 0;
+            }
+        }
+    }
+    spec[(length < MAX_SPEC_LENGTH) ? length : MAX_SPEC_LENGTH - 1] = '\0';
+
+    return c == to && length < MAX_SPEC_LENGTH;
+}
+
+static int formatSigned(char* const buffer, const size_t capacity, const char* const spec, const LogArgLength length, const intmax_t value)
+{
+    switch (length)
+    {
+        case LOG_LENGTH_LONG:
+            return snprintf(buffer, capacity, spec, (long) value);
+        case LOG_LENGTH_LONG_LONG:
+            return snprintf(buffer, capacity, spec, (long long) value);
+        case LOG_LENGTH_SIZE:
+        case LOG_LENGTH_PTRDIFF:
+            return snprintf(buffer, capacity, spec, (ptrdiff_t) value);
+        case LOG_LENGTH_MAX:
+            return snprintf(buffer, capacity, spec, value);
+        case LOG_LENGTH_NONE:
+        case LOG_LENGTH_CHAR:
+        case LOG_LENGTH_SHORT:
+        default:
+            return snprintf(buffer, capacity, spec, (int) value);
+    }
+}
+
+static int formatUnsigned(char* const buffer, const size_t capacity, const char* const spec, const LogArgLength length, const uintmax_t value)
+{
+    switch (length)
+    {
+        case LOG_LENGTH_LONG:
+            return snprintf(buffer, capacity, spec, (unsigned long) value);
+        case LOG_LENGTH_LONG_LONG:
+            return snprintf(buffer, capacity, spec, (unsigned long long) value);
+        case LOG_LENGTH_SIZE:
+            return snprintf(buffer, capacity, spec, (size_t) value);
+        case LOG_LENGTH_PTRDIFF:
+            return snprintf(buffer, capacity, spec, (ptrdiff_t) value);
+        case LOG_LENGTH_MAX:
+            return snprintf(buffer, capacity, spec, value);
+        case LOG_LENGTH_NONE:
+        case LOG_LENGTH_CHAR:
+        case LOG_LENGTH_SHORT:
+        default:
+            return snprintf(buffer, capacity, spec, (unsigned int) value);
+    }
+}
+
+/**
+ * Format a single conversion with its captured argument.
+ */
+static int formatArgument(char* const buffer, const size_t capacity, const char* const spec, const LogConversion* const conversion, Reader* const reader)
+{
+    switch (conversion->conversion)
+    {
+        case 'd':
+        case 'i':
+        {
+            intmax_t value;
+            getBytes(reader, &value, sizeof(value));
+            return formatSigned(buffer, capacity, spec, conversion->length, value);
+        }
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+        {
+            uintmax_t value;
+            getBytes(reader, &value, sizeof(value));
+            return formatUnsigned(buffer, capacity, spec, conversion->length, value);
+        }
+        case 'c':
+        {
+            intmax_t value;
+            getBytes(reader, &value, sizeof(value));
+            return snprintf(buffer, capacity, spec, (int) value);
+        }
+        case 's':
+            return snprintf(buffer, capacity, spec, getString(reader));
+        case 'p':
+        {
+            void* value;
+            getBytes(reader, &value, sizeof(value));
+            return snprintf(buffer, capacity, spec, value);
+        }
+        case '%':
+            return snprintf(buffer, capacity, "%%");
+        default:
+            if (conversion->length == LOG_LENGTH_LONG_DOUBLE)
+            {
+                long double value;
+                getBytes(reader, &value, sizeof(value));
+                return snprintf(buffer, capacity, spec, value);
+            }
+            else
+            {
+                double value;
+                getBytes(reader, &value, sizeof(value));
+                return snprintf(buffer, capacity, spec, value);
+            }
+    }
+}
+
+/**
+ * Format the message of an entry, the format string being walked again to take the arguments back in order.
+ */
+static void formatMessage(char* const buffer, const size_t capacity, const char* format, Reader* const reader)
+{
+    size_t length = 0;
+
+    buffer[0] = '\0';
+    while (*format != '\0' && length + 1 < capacity)
+    {
+        const char* const percent = strchr(format, '%');
+        const size_t literal = (percent != NULL) ? (size_t)(percent - format) : strlen(format);
+        const size_t copied = (literal < capacity - 1 - length) ? literal : capacity - 1 - length;
+        char spec[MAX_SPEC_LENGTH];
+        LogConversion conversion;
+
+        memcpy(&buffer[length], format, copied);
+        length += copied;
+        buffer[length] = '\0';
+        if (percent == NULL)
+        {
+            break;
+        }
+
+        format = logParseConversion(percent + 1, &conversion, NULL);
+        if (!buildSpec(spec, percent, format, reader))
+        {
+            break;
+        }
+
+        const int written = formatArgument(&buffer[length], capacity - length, spec, &conversion, reader);
+        if (written > 0)
+        {
+            length += ((size_t) written < capacity - length) ? (size_t) written : capacity - 1 - length;
+        }
+    }
+}
+
+static void replay(const LogReplayFct fct, void* const arg, LogRecordV2* const record, const char* const formatStr, ...)
+{
+    va_list args;
+
+    va_start(args, formatStr);
+    record->formatStr = formatStr;
+    record->vaList = &args;
+    fct(record, arg);
+    va_end(args);
+}
+
+void logReplayRecord(const void* const entry, const LogReplayFct fct, void* const arg)
+{
+    Reader reader = {(const uint8_t*) entry, 0};
+    CapturedRecord header;
+    LogContext context;
+    uint_fast8_t i;
+
+    getBytes(&reader, &header, sizeof(header));
+
+    LogRecordV2 record = {.timestamp = header.timestamp,
+                          .category = header.category,
+                          .file = header.file,
+                          .function = header.function,
+                          .context = NULL,
+                          .line = header.line,
+                          .level = header.level,
+                          .flags = header.flags};
+
+    if ((header.flags & LOG_RECORD_HAS_CONTEXT) != 0)
+    {
+        context.threadId = header.threadId;
+        context.nbEntries = header.nbEntries;
+        strcpy(context.threadName, getString(&reader));
+        for (i = 0; i < header.nbEntries; i++)
+        {
+            context.entries[i].key = getString(&reader);
+            context.entries[i].value = getString(&reader);
+        }
+        record.context = &context;
+    }
+
+    const char* const formatStr = getString(&reader);
+
+    if (header.isFormatted)
+    {
+        replay(fct, arg, &record, "%s", formatStr);
+    }
+    else if ((header.flags & (LOG_RECORD_SPAN_BEGIN | LOG_RECORD_SPAN_END)) != 0)
+    {
+        // Loggers tracing spans read their arguments, see LOG_SPAN_BEGIN_FORMAT and LOG_SPAN_END_FORMAT
+        const char* const name = getString(&reader);
+        uintmax_t threadId;
+        uintmax_t duration = 0;
+
+        getBytes(&reader, &threadId, sizeof(threadId));
+        if ((header.flags & LOG_RECORD_SPAN_END) != 0)
+        {
+            getBytes(&reader, &duration, sizeof(duration));
+        }
+        replay(fct, arg, &record, formatStr, name, (uint32_t) threadId, (uint64_t) duration);
+    }
+    else
+    {
+        char message[MAX_MESSAGE_LENGTH];
+
+        formatMessage(message, sizeof(message), formatStr, &reader);
+        replay(fct, arg, &record, "%s", message);
+    }
+}
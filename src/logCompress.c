@@ -0,0 +1,265 @@
+/**
+ * @file
+ *
+ * LZ77 block compression used by the file logger
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "slf4ec/logCompress.h"
+
+#define TOKEN_MAX (15)
+#define LAST_LITERALS (5)                         // Matches never end within these last bytes
+#define MATCH_LIMIT (LOG_COMPRESS_MIN_MATCH + 8)  // Matches never start within these last bytes
+#define SKIP_TRIGGER (6)                          // Step faster through data that does not compress
+
+static inline uint32_t read32(const uint8_t* const ptr)
+{
+    uint32_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+static inline uint32_t hashPosition(const uint8_t* const ptr)
+{
+    return (read32(ptr) * 2654435761u) >> (32 - LOG_COMPRESS_HASH_BITS);
+}
+
+/**
+ * Write a length beyond what fits in a token. Returns NULL if it does not fit.
+ */
+static uint8_t* writeLength(uint8_t* out, const uint8_t* const outEnd, size_t length)
+{
+    while (out != NULL && length >= 255)
+    {
+        if (out < outEnd)
+        {
+            *out++ = 255;
+            length -= 255;
+        }
+        else
+        {
+            out = NULL;
+        }
+    }
+
+    if (out != NULL && out < outEnd)
+    {
+        *out++ = (uint8_t) length;
+    }
+    else
+    {
+        out = NULL;
+    }
+
+    return out;
+}
+
+/**
+ * Write a command. A match length of 0 means literals only. Returns NULL if it does not fit.
+ */
+static uint8_t* writeCommand(uint8_t* out,
+                             const uint8_t* const outEnd,
+                             const uint8_t* const literals,
+                             const size_t nbLiterals,
+                             const uint16_t offset,
+                             const size_t matchLength)
+{
+    const size_t extraMatch = (matchLength > 0) ? matchLength - LOG_COMPRESS_MIN_MATCH : 0;
+    uint8_t* const token = out;
+
+    if ((size_t)(outEnd - out) < 1 + nbLiterals + 2)
+    {
+        return NULL;
+    }
+
+    out++;
+    *token = (uint8_t)(((nbLiterals < TOKEN_MAX) ? nbLiterals : TOKEN_MAX) << 4);
+    if (nbLiterals >= TOKEN_MAX)
+    {
+        out = writeLength(out, outEnd, nbLiterals - TOKEN_MAX);
+    }
+
+    if (out != NULL && (size_t)(outEnd - out) >= nbLiterals)
+    {
+        memcpy(out, literals, nbLiterals);
+        out += nbLiterals;
+
+        if (matchLength > 0)
+        {
+            if (outEnd - out >= 2)
+            {
+                *out++ = (uint8_t)(offset & 0xFF);
+                *out++ = (uint8_t)(offset >> 8);
+                *token |= (uint8_t)((extraMatch < TOKEN_MAX) ? extraMatch : TOKEN_MAX);
+                if (extraMatch >= TOKEN_MAX)
+                {
+                    out = writeLength(out, outEnd, extraMatch - TOKEN_MAX);
+                }
+            }
+            else
+            {
+                out = NULL;
+            }
+        }
+    }
+    else
+    {
+        out = NULL;
+    }
+
+    return out;
+}
+
+size_t logCompress(const uint8_t* const src, const size_t srcSize, uint8_t* const dst, const size_t dstCapacity, LogCompressTable* const table)
+{
+    const uint8_t* const outEnd = dst + dstCapacity;
+    uint8_t* out = dst;
+    size_t anchor = 0;
+    size_t position = 0;
+
+    if (srcSize > LOG_COMPRESS_MAX_INPUT)
+    {
+        return 0;
+    }
+
+    // Blocks are independent, positions from a previous block must not be matched
+    memset(table, 0, sizeof(LogCompressTable));
+
+    while (out != NULL && srcSize >= MATCH_LIMIT && position < srcSize - MATCH_LIMIT)
+    {
+        const uint32_t hash = hashPosition(&src[position]);
+        const size_t candidate = table->positions[hash];
+        table->positions[hash] = (uint16_t) position;
+
+        if (candidate < position && read32(&src[candidate]) == read32(&src[position]))
+        {
+            size_t length = LOG_COMPRESS_MIN_MATCH;
+            while (position + length < srcSize - LAST_LITERALS && src[candidate + length] == src[position + length])
+            {
+                length++;
+            }
+
+            out = writeCommand(out, outEnd, &src[anchor], position - anchor, (uint16_t)(position - candidate), length);
+            position += length;
+            anchor = position;
+        }
+        else
+        {
+            position += 1 + ((position - anchor) >> SKIP_TRIGGER);
+        }
+    }
+
+    if (out != NULL)
+    {
+        out = writeCommand(out, outEnd, &src[anchor], srcSize - anchor, 0, 0);
+    }
+
+    return (out != NULL) ? (size_t)(out - dst) : 0;
+}
+
+/**
+ * Read a length beyond what fits in a token. Returns false if the input ends first.
+ */
+static bool readLength(const uint8_t** const in, const uint8_t* const inEnd, size_t* const length)
+{
+    uint8_t byte;
+
+    do
+    {
+        if (*in >= inEnd)
+        {
+            return false;
+        }
+        byte = *(*in)++;
+        *length += byte;
+    } while (byte == 255);
+
+    return true;
+}
+
+LogResult logDecompress(const uint8_t* const src, const size_t srcSize, uint8_t* const dst, const size_t dstSize)
+{
+    const uint8_t* in = src;
+    const uint8_t* const inEnd = src + srcSize;
+    size_t written = 0;
+    bool isValid = true;
+
+    while (isValid && in < inEnd)
+    {
+        const uint8_t token = *in++;
+        size_t nbLiterals = token >> 4;
+        size_t matchLength = token & TOKEN_MAX;
+
+        if (nbLiterals == TOKEN_MAX)
+        {
+            isValid = readLength(&in, inEnd, &nbLiterals);
+        }
+
+        isValid = isValid && (size_t)(inEnd - in) >= nbLiterals && dstSize - written >= nbLiterals;
+        if (isValid)
+        {
+            memcpy(&dst[written], in, nbLiterals);
+            in += nbLiterals;
+            written += nbLiterals;
+        }
+
+        // The last command holds literals only
+        if (isValid && in < inEnd)
+        {
+            size_t offset = 0;
+
+            isValid = (inEnd - in) >= 2;
+            if (isValid)
+            {
+                offset = (size_t) in[0] | ((size_t) in[1] << 8);
+                in += 2;
+                if (matchLength == TOKEN_MAX)
+                {
+                    isValid = readLength(&in, inEnd, &matchLength);
+                }
+                matchLength += LOG_COMPRESS_MIN_MATCH;
+            }
+
+            isValid = isValid && offset > 0 && offset <= written && dstSize - written >= matchLength;
+            if (isValid)
+            {
+                // Byte by byte as the match may overlap what it is copying
+                size_t i;
+                for (i = 0; i < matchLength; i++, written++)
+                {
+                    dst[written] = dst[written - offset];
+                }
+            }
+        }
+    }
+
+    return (isValid && written == dstSize) ? LOG_OK : LOG_INVALID_PARAMETER;
+}
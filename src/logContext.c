@@ -0,0 +1,175 @@
+/**
+ * @file
+ *
+ * Diagnostic context attached to the records logged by a thread
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "slf4ec/logContext.h"
+#include "slf4ecPrivate.h"
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+size_t logFormatContext(char* const buffer, const size_t capacity, const LogContext* const context)
+{
+    size_t length = 0;
+    int written;
+    uint_fast8_t i;
+
+    if (context->threadName[0] != '\0')
+    {
+        written = snprintf(buffer, capacity, "[%s:%" PRIu32 "]", context->threadName, context->threadId);
+    }
+    else
+    {
+        written = snprintf(buffer, capacity, "[%" PRIu32 "]", context->threadId);
+    }
+    length += (written > 0) ? (size_t) written : 0;
+
+    for (i = 0; i < context->nbEntries; i++)
+    {
+        const size_t offset = (length < capacity) ? length : capacity;
+
+        written = snprintf(buffer + offset, capacity - offset, "%c%s=%s", (i == 0) ? '{' : ' ', context->entries[i].key,
+                           context->entries[i].value);
+        length += (written > 0) ? (size_t) written : 0;
+    }
+
+    if (context->nbEntries > 0)
+    {
+        if (length + 1 < capacity)
+        {
+            buffer[length] = '}';
+            buffer[length + 1] = '\0';
+        }
+        length++;
+    }
+
+    return length;
+}
+
+static LOG_THREAD_LOCAL uint32_t threadId = 0;
+
+#ifndef __linux__
+static uint32_t lastThreadId = 0;
+#endif
+
+uint32_t logThreadId(void)
+{
+    if (threadId == 0)
+    {
+#ifdef __linux__
+        // Same identifier as the one shown by the system tools
+        threadId = (uint32_t) syscall(SYS_gettid);
+#else
+        threadId = (uint32_t) LOG_ATOMIC_ADD(lastThreadId, 1) + 1;
+#endif
+    }
+
+    return threadId;
+}
+
+#ifdef USE_LOG_CONTEXT
+
+static LOG_THREAD_LOCAL LogContext threadContext;
+
+static LogContext* localContext(void)
+{
+    LogContext* const context = &threadContext;
+
+    if (context->threadId == 0)
+    {
+        context->threadId = logThreadId();
+    }
+
+    return context;
+}
+
+LogResult logContextPush(const char* const key, const char* const value)
+{
+    LogResult returnCode = LOG_OK;
+    LogContext* const context = localContext();
+
+    if (key == NULL || value == NULL)
+    {
+        returnCode = LOG_INVALID_PARAMETER;
+    }
+    else if (context->nbEntries >= LOG_CONTEXT_MAX_ENTRIES)
+    {
+        returnCode = LOG_OUT_OF_MEMORY;
+    }
+    else
+    {
+        context->entries[context->nbEntries].key = key;
+        context->entries[context->nbEntries].value = value;
+        context->nbEntries++;
+    }
+
+    return returnCode;
+}
+
+LogResult logContextPop(const char* const key)
+{
+    LogResult returnCode = LOG_OK;
+    LogContext* const context = localContext();
+
+    if (key == NULL || context->nbEntries == 0 || strcmp(context->entries[context->nbEntries - 1].key, key) != 0)
+    {
+        returnCode = LOG_INVALID_PARAMETER;
+    }
+    else
+    {
+        context->nbEntries--;
+    }
+
+    return returnCode;
+}
+
+void logContextSetThreadName(const char* const name)
+{
+    LogContext* const context = localContext();
+
+    context->threadName[0] = '\0';
+    if (name != NULL)
+    {
+        strncat(context->threadName, name, LOG_CONTEXT_NAME_LENGTH - 1);
+    }
+}
+
+const LogContext* logGetContext(void)
+{
+    return localContext();
+}
+
+#endif /* USE_LOG_CONTEXT */
@@ -0,0 +1,279 @@
+/**
+ * @file
+ *
+ * Suppression of consecutive duplicate records
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+#include "slf4ecPrivate.h"
+
+#ifdef USE_LOG_DEDUP
+
+#define FNV_OFFSET_BASIS (14695981039346656037ULL)
+#define FNV_PRIME (1099511628211ULL)
+
+/**
+ * Hash of a record, along with the number of bytes hashed so that records of different lengths never match.
+ */
+typedef struct
+{
+    uint64_t hash;
+    uint32_t length;
+} Fingerprint;
+
+static inline void hashBytes(Fingerprint* const fingerprint, const void* const data, const size_t size)
+{
+    const uint8_t* const bytes = data;
+    size_t i;
+
+    for (i = 0; i < size; i++)
+    {
+        fingerprint->hash = (fingerprint->hash ^ bytes[i]) * FNV_PRIME;
+    }
+    fingerprint->length += (uint32_t) size;
+}
+
+static inline void hashString(Fingerprint* const fingerprint, const char* string, const LogConversion* const conversion)
+{
+    size_t length = 0;
+
+    if (string == NULL)
+    {
+        hashBytes(fingerprint, &string, sizeof(string));
+        return;
+    }
+    while (string[length] != '\0' && (!conversion->hasPrecision || length < conversion->precision))
+    {
+        length++;
+    }
+    hashBytes(fingerprint, string, length);
+    hashBytes(fingerprint, &length, sizeof(length));
+}
+
+/**
+ * Hash the arguments of a record, as taken by its format string, rather than the formatted message.
+ *
+ * @return Whether the arguments could be hashed, not the case of the conversions that are not printed
+ */
+static bool hashArguments(Fingerprint* const fingerprint, const char* format, va_list* const args)
+{
+    bool isHashed = true;
+
+    while (isHashed && (format = strchr(format, '%')) != NULL)
+    {
+        LogConversion conversion;
+
+        format = logParseConversion(format + 1, &conversion, args);
+        hashBytes(fingerprint, &conversion.width, sizeof(conversion.width));
+        hashBytes(fingerprint, &conversion.precision, sizeof(conversion.precision));
+
+        switch (conversion.conversion)
+        {
+            case 'd':
+            case 'i':
+            {
+                const intmax_t value = logSignedArgument(conversion.length, args);
+                hashBytes(fingerprint, &value, sizeof(value));
+                break;
+            }
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+            {
+                const uintmax_t value = logUnsignedArgument(conversion.length, args);
+                hashBytes(fingerprint, &value, sizeof(value));
+                break;
+            }
+            case 'c':
+            {
+                const int value = va_arg(*args, int);
+                hashBytes(fingerprint, &value, sizeof(value));
+                break;
+            }
+            case 's':
+                hashString(fingerprint, va_arg(*args, const char*), &conversion);
+                break;
+            case 'p':
+            {
+                const void* const value = va_arg(*args, void*);
+                hashBytes(fingerprint, &value, sizeof(value));
+                break;
+            }
+            case 'e':
+            case 'E':
+            case 'f':
+            case 'F':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                if (conversion.length == LOG_LENGTH_LONG_DOUBLE)
+                {
+                    // Rounded, the padding bytes of a long double are not hashed
+                    const double value = (double) va_arg(*args, long double);
+                    hashBytes(fingerprint, &value, sizeof(value));
+                }
+                else
+                {
+                    const double value = va_arg(*args, double);
+                    hashBytes(fingerprint, &value, sizeof(value));
+                }
+                break;
+            case '%':
+                break;
+            default:
+                // '%n', end of string or a conversion whose argument cannot be taken
+                isHashed = false;
+                break;
+        }
+    }
+
+    return isHashed;
+}
+
+/**
+ * Hash what tells a record apart from the previous one: call site, level and arguments.
+ */
+static bool hashRecord(const LogRecordV2* const record, Fingerprint* const fingerprint)
+{
+    va_list args;
+
+    fingerprint->hash = FNV_OFFSET_BASIS;
+    fingerprint->length = 0;
+    hashBytes(fingerprint, &record->formatStr, sizeof(record->formatStr));
+    hashBytes(fingerprint, &record->level, sizeof(record->level));
+    if ((record->flags & LOG_RECORD_HAS_LOCATION) != 0)
+    {
+        hashBytes(fingerprint, &record->file, sizeof(record->file));
+        hashBytes(fingerprint, &record->line, sizeof(record->line));
+    }
+
+    va_copy(args, *record->vaList);
+    // Records of spans are never suppressed, a trace would lose its nesting
+    const bool isHashed = (record->flags & (LOG_RECORD_SPAN_BEGIN | LOG_RECORD_SPAN_END)) == 0 && hashArguments(fingerprint, record->formatStr, &args);
+    va_end(args);
+
+    return isHashed;
+}
+
+/**
+ * Whether the record remembered by a slot is the same as a new one. Besides the hash, the call site, level and length
+ * are compared so that a collision of the hash alone never suppresses a different record.
+ */
+static bool isSameRecord(const LogDedupSlot* const slot, const LogRecordV2* const record, const Fingerprint* const fingerprint)
+{
+    const bool hasLocation = (record->flags & LOG_RECORD_HAS_LOCATION) != 0;
+
+    return slot->category == record->category && slot->hash == fingerprint->hash && slot->length == fingerprint->length &&
+           slot->level == record->level && slot->formatStr == record->formatStr && slot->file == (hasLocation ? record->file : NULL) &&
+           slot->line == (hasLocation ? record->line : 0);
+}
+
+static bool lockSlot(LogDedupSlot* const slot)
+{
+    uint8_t expected = 0;
+
+    return LOG_ATOMIC_CAS(slot->busy, expected, 1);
+}
+
+static void unlockSlot(LogDedupSlot* const slot)
+{
+    LOG_ATOMIC_STORE_RELEASE(slot->busy, 0);
+}
+
+bool logDedupRecord(LogDedup* const dedup, const LogRecordV2* const record, LogRepeatedRun* const run)
+{
+    LogDedupSlot* const slot = &dedup->slots[record->category->index % LOG_DEDUP_SLOTS];
+    bool isDuplicate = false;
+    Fingerprint fingerprint;
+
+    run->repeated = 0;
+    const bool isHashed = hashRecord(record, &fingerprint);
+
+    if (lockSlot(slot))
+    {
+        if (isHashed && isSameRecord(slot, record, &fingerprint))
+        {
+            isDuplicate = true;
+            slot->repeated++;
+            if (dedup->summaryPeriod > 0 && record->timestamp - slot->since >= dedup->summaryPeriod)
+            {
+                run->category = slot->category;
+                run->level = slot->level;
+                run->repeated = slot->repeated;
+                slot->repeated = 0;
+                slot->since = record->timestamp;
+            }
+        }
+        else
+        {
+            run->category = slot->category;
+            run->level = slot->level;
+            run->repeated = slot->repeated;
+            // A record that cannot be compared never matches
+            slot->category = isHashed ? record->category : NULL;
+            slot->hash = fingerprint.hash;
+            slot->length = fingerprint.length;
+            slot->level = record->level;
+            slot->formatStr = record->formatStr;
+            slot->file = ((record->flags & LOG_RECORD_HAS_LOCATION) != 0) ? record->file : NULL;
+            slot->line = ((record->flags & LOG_RECORD_HAS_LOCATION) != 0) ? record->line : 0;
+            slot->repeated = 0;
+            slot->since = record->timestamp;
+        }
+        unlockSlot(slot);
+    }
+
+    if (isDuplicate)
+    {
+        LOG_ATOMIC_ADD(dedup->suppressed, 1);
+    }
+
+    return isDuplicate;
+}
+
+void logDedupTakeRun(LogDedup* const dedup, const size_t index, LogRepeatedRun* const run, const uint64_t timestamp)
+{
+    LogDedupSlot* const slot = &dedup->slots[index];
+
+    run->repeated = 0;
+    if (lockSlot(slot))
+    {
+        run->category = slot->category;
+        run->level = slot->level;
+        run->repeated = slot->repeated;
+        slot->repeated = 0;
+        slot->since = timestamp;
+        unlockSlot(slot);
+    }
+}
+
+#endif /* USE_LOG_DEDUP */
@@ -0,0 +1,181 @@
+/**
+ * @file
+ *
+ * Walking the conversions of printf format strings
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stddef.h>
+#include "slf4ecPrivate.h"
+
+static LogArgLength parseLength(const char** const format)
+{
+    LogArgLength length = LOG_LENGTH_NONE;
+
+    switch (**format)
+    {
+        case 'h':
+            length = ((*format)[1] == 'h') ? LOG_LENGTH_CHAR : LOG_LENGTH_SHORT;
+            break;
+        case 'l':
+            length = ((*format)[1] == 'l') ? LOG_LENGTH_LONG_LONG : LOG_LENGTH_LONG;
+            break;
+        case 'z':
+            length = LOG_LENGTH_SIZE;
+            break;
+        case 'j':
+            length = LOG_LENGTH_MAX;
+            break;
+        case 't':
+            length = LOG_LENGTH_PTRDIFF;
+            break;
+        case 'L':
+            length = LOG_LENGTH_LONG_DOUBLE;
+            break;
+        default:
+            break;
+    }
+
+    if (length != LOG_LENGTH_NONE)
+    {
+        *format += (length == LOG_LENGTH_CHAR || length == LOG_LENGTH_LONG_LONG) ? 2 : 1;
+    }
+
+    return length;
+}
+
+static size_t parseNumber(const char** const format, va_list* const args)
+{
+    size_t number = 0;
+
+    if (**format == '*')
+    {
+        if (args != NULL)
+        {
+            const int value = va_arg(*args, int);
+            number = (value > 0) ? (size_t) value : 0;
+        }
+        (*format)++;
+    }
+    while (**format >= '0' && **format <= '9')
+    {
+        number = number * 10 + (size_t)(**format - '0');
+        (*format)++;
+    }
+
+    return number;
+}
+
+const char* logParseConversion(const char* format, LogConversion* const conversion, va_list* const args)
+{
+    conversion->width = 0;
+    conversion->precision = 0;
+    conversion->hasPrecision = false;
+    conversion->isLeftAligned = false;
+    conversion->isZeroPadded = false;
+
+    for (;; format++)
+    {
+        if (*format == '-')
+        {
+            conversion->isLeftAligned = true;
+        }
+        else if (*format == '0')
+        {
+            conversion->isZeroPadded = true;
+        }
+        else if (*format != '+' && *format != ' ' && *format != '#')
+        {
+            break;
+        }
+    }
+    conversion->width = parseNumber(&format, args);
+    if (*format == '.')
+    {
+        format++;
+        conversion->hasPrecision = true;
+        conversion->precision = parseNumber(&format, args);
+    }
+
+    conversion->length = parseLength(&format);
+    conversion->conversion = *format;
+    if (*format != '\0')
+    {
+        format++;
+    }
+
+    return format;
+}
+
+intmax_t logSignedArgument(const LogArgLength length, va_list* const args)
+{
+    switch (length)
+    {
+        case LOG_LENGTH_CHAR:
+            return (signed char) va_arg(*args, int);
+        case LOG_LENGTH_SHORT:
+            return (short) va_arg(*args, int);
+        case LOG_LENGTH_LONG:
+            return va_arg(*args, long);
+        case LOG_LENGTH_LONG_LONG:
+            return va_arg(*args, long long);
+        case LOG_LENGTH_SIZE:
+        case LOG_LENGTH_PTRDIFF:
+            return va_arg(*args, ptrdiff_t);
+        case LOG_LENGTH_MAX:
+            return va_arg(*args, intmax_t);
+        case LOG_LENGTH_NONE:
+        default:
+            return va_arg(*args, int);
+    }
+}
+
+uintmax_t logUnsignedArgument(const LogArgLength length, va_list* const args)
+{
+    switch (length)
+    {
+        case LOG_LENGTH_CHAR:
+            return (unsigned char) va_arg(*args, unsigned int);
+        case LOG_LENGTH_SHORT:
+            return (unsigned short) va_arg(*args, unsigned int);
+        case LOG_LENGTH_LONG:
+            return va_arg(*args, unsigned long);
+        case LOG_LENGTH_LONG_LONG:
+            return va_arg(*args, unsigned long long);
+        case LOG_LENGTH_SIZE:
+            return va_arg(*args, size_t);
+        case LOG_LENGTH_PTRDIFF:
+            return (uintmax_t) va_arg(*args, ptrdiff_t);
+        case LOG_LENGTH_MAX:
+            return va_arg(*args, uintmax_t);
+        case LOG_LENGTH_NONE:
+        default:
+            return va_arg(*args, unsigned int);
+    }
+}
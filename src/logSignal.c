@@ -0,0 +1,548 @@
+/**
+ * @file
+ *
+ * Logging from signal handlers
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+#include "slf4ec/slf4ecCtrl.h"
+#include "slf4ec/logSignal.h"
+#include "slf4ecPrivate.h"
+
+#ifdef LOG_HAS_THREADS
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#if (LOG_SIGNAL_SLOTS & (LOG_SIGNAL_SLOTS - 1)) != 0
+#error "LOG_SIGNAL_SLOTS must be a power of 2"
+#endif
+
+/**
+ * Deferred record. The slot can be claimed by the producer at position 'sequence', and holds a record ready to be
+ * drained when 'sequence' is one past its position.
+ */
+typedef struct
+{
+    uint32_t sequence;
+    uint8_t level;
+    const LogCategory* category;
+    uint64_t timestamp;
+    char text[LOG_SIGNAL_RECORD_SIZE];
+} SignalSlot;
+
+typedef struct
+{
+    char* buffer;
+    size_t capacity;
+    size_t length;
+} Output;
+
+static SignalSlot slots[LOG_SIGNAL_SLOTS];
+static uint32_t tail = 0; /* Next position claimed by a producer */
+static uint32_t head = 0; /* Next position drained, only used by the consumer */
+static uint32_t dropped = 0;
+static uint8_t isConfigured = 0;
+static LogSignalConfig signalConfig;
+
+#ifdef LOG_HAS_THREADS
+static pthread_mutex_t drainMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t drainThread;
+static bool hasDrainThread = false;
+static uint8_t stopDrain = 0;
+static int wakeUpPipe[2] = {-1, -1};
+#endif
+
+/*
+ ************************************************************
+ * Reentrant formatting
+ ************************************************************
+ */
+
+static inline void put(Output* const output, const char c)
+{
+    if (output->length + 1 < output->capacity)
+    {
+        output->buffer[output->length++] = c;
+    }
+}
+
+static void pad(Output* const output, const char c, size_t count)
+{
+    while (count-- > 0)
+    {
+        put(output, c);
+    }
+}
+
+static void putString(Output* const output, const char* string, const LogConversion* const spec)
+{
+    size_t length = 0;
+
+    if (string == NULL)
+    {
+        string = "(null)";
+    }
+    while (string[length] != '\0' && (!spec->hasPrecision || length < spec->precision))
+    {
+        length++;
+    }
+
+    const size_t padding = (spec->width > length) ? spec->width - length : 0;
+    if (!spec->isLeftAligned)
+    {
+        pad(output, ' ', padding);
+    }
+    while (length-- > 0)
+    {
+        put(output, *string++);
+    }
+    if (spec->isLeftAligned)
+    {
+        pad(output, ' ', padding);
+    }
+}
+
+static void putNumber(Output* const output, uintmax_t value, const bool isNegative, const unsigned int base, const bool isUpper, const LogConversion* const spec)
+{
+    const char* const symbols = isUpper ? "0123456789ABCDEF" : "0123456789abcdef";
+    char digits[sizeof(uintmax_t) * 3 + 1];
+    size_t nbDigits = 0;
+
+    do
+    {
+        digits[nbDigits++] = symbols[value % base];
+        value /= base;
+    } while (value != 0);
+
+    const size_t length = nbDigits + (isNegative ? 1 : 0);
+    const size_t padding = (spec->width > length) ? spec->width - length : 0;
+
+    if (!spec->isLeftAligned && !spec->isZeroPadded)
+    {
+        pad(output, ' ', padding);
+    }
+    if (isNegative)
+    {
+        put(output, '-');
+    }
+    if (!spec->isLeftAligned && spec->isZeroPadded)
+    {
+        pad(output, '0', padding);
+    }
+    while (nbDigits > 0)
+    {
+        put(output, digits[--nbDigits]);
+    }
+    if (spec->isLeftAligned)
+    {
+        pad(output, ' ', padding);
+    }
+}
+
+size_t logSignalFormatv(char* const buffer, const size_t capacity, const char* const formatStr, va_list args)
+{
+    Output output = {buffer, capacity, 0};
+    const char* format = formatStr;
+    va_list ap;
+
+    // Taking the address of a va_list parameter is not portable, work on a copy
+    va_copy(ap, args);
+
+    while (*format != '\0')
+    {
+        if (*format != '%')
+        {
+            put(&output, *format++);
+            continue;
+        }
+        format++;
+
+        LogConversion spec;
+        format = logParseConversion(format, &spec, &ap);
+
+        const LogArgLength length = spec.length;
+        const char conversion = spec.conversion;
+
+        if (conversion == '\0')
+        {
+            break;
+        }
+
+        switch (conversion)
+        {
+            case 'd':
+            case 'i':
+            {
+                const intmax_t value = logSignedArgument(length, &ap);
+                putNumber(&output, (value < 0) ? -(uintmax_t) value : (uintmax_t) value, value < 0, 10, false, &spec);
+                break;
+            }
+            case 'u':
+                putNumber(&output, logUnsignedArgument(length, &ap), false, 10, false, &spec);
+                break;
+            case 'x':
+            case 'X':
+                putNumber(&output, logUnsignedArgument(length, &ap), false, 16, conversion == 'X', &spec);
+                break;
+            case 'o':
+                putNumber(&output, logUnsignedArgument(length, &ap), false, 8, false, &spec);
+                break;
+            case 'c':
+            {
+                const char c[2] = {(char) va_arg(ap, int), '\0'};
+                putString(&output, c, &spec);
+                break;
+            }
+            case 's':
+                putString(&output, va_arg(ap, const char*), &spec);
+                break;
+            case 'p':
+                put(&output, '0');
+                put(&output, 'x');
+                putNumber(&output, (uintptr_t) va_arg(ap, void*), false, 16, false, &spec);
+                break;
+            case '%':
+                put(&output, '%');
+                break;
+            default:
+                // Unsupported conversion, shown as is. Its argument cannot be skipped so stop there.
+                put(&output, '%');
+                put(&output, conversion);
+                format += strlen(format);
+                break;
+        }
+    }
+
+    va_end(ap);
+    if (capacity > 0)
+    {
+        buffer[output.length] = '\0';
+    }
+
+    return output.length;
+}
+
+/*
+ ************************************************************
+ * Output
+ ************************************************************
+ */
+
+#ifdef LOG_HAS_THREADS
+static size_t formatPrefix(char* const buffer, const size_t capacity, const char* const formatStr, ...)
+{
+    va_list args;
+
+    va_start(args, formatStr);
+    const size_t length = logSignalFormatv(buffer, capacity, formatStr, args);
+    va_end(args);
+
+    return length;
+}
+
+static void writeAll(const int fd, const char* data, size_t size)
+{
+    while (size > 0)
+    {
+        const ssize_t written = write(fd, data, size);
+
+        if (written > 0)
+        {
+            data += written;
+            size -= (size_t) written;
+        }
+        else if (written < 0 && errno != EINTR)
+        {
+            break;
+        }
+    }
+}
+
+static LogResult writeRecord(const LogCategory* const category, const uint8_t level, const char* const formatStr, va_list args)
+{
+    char record[LOG_SIGNAL_RECORD_SIZE];
+    size_t length = formatPrefix(record, sizeof(record) - 1, "[%s][%s][%llu] - ", logLevelNames[level], category->name,
+                                 (unsigned long long) logTimeApi());
+
+    length += logSignalFormatv(&record[length], sizeof(record) - 1 - length, formatStr, args);
+    record[length++] = '\n';
+    writeAll(signalConfig.fd, record, length);
+
+    return LOG_OK;
+}
+#endif
+
+static LogResult storeRecord(const LogCategory* const category, const uint8_t level, const char* const formatStr, va_list args)
+{
+    uint32_t position = LOG_ATOMIC_LOAD(tail);
+    SignalSlot* slot;
+
+    for (;;)
+    {
+        slot = &slots[position & (LOG_SIGNAL_SLOTS - 1)];
+        const int32_t difference = (int32_t)(LOG_ATOMIC_LOAD_ACQUIRE(slot->sequence) - position);
+
+        if (difference == 0)
+        {
+            if (LOG_ATOMIC_CAS(tail, position, position + 1))
+            {
+                break;
+            }
+            // position was refreshed by the failed compare and swap
+        }
+        else if (difference < 0)
+        {
+            // Not drained yet
+            LOG_ATOMIC_ADD(dropped, 1);
+            return LOG_OUT_OF_MEMORY;
+        }
+        else
+        {
+            position = LOG_ATOMIC_LOAD(tail);
+        }
+    }
+
+    slot->level = level;
+    slot->category = category;
+    slot->timestamp = logTimeApi();
+    (void) logSignalFormatv(slot->text, sizeof(slot->text), formatStr, args);
+    LOG_ATOMIC_STORE_RELEASE(slot->sequence, position + 1);
+
+#ifdef LOG_HAS_THREADS
+    if (wakeUpPipe[1] >= 0)
+    {
+        // Fails harmlessly when the pipe is full, the drain thread is awake then
+        const ssize_t written = write(wakeUpPipe[1], "", 1);
+        (void) written;
+    }
+#endif
+
+    return LOG_OK;
+}
+
+LogResult logSignalSafe(const LogCategory* const category, const uint8_t level, const char* const formatStr, ...)
+{
+    LogResult returnCode = LOG_OK;
+#ifdef LOG_HAS_THREADS
+    const int savedErrno = errno;
+#endif
+
+    if (category == NULL || formatStr == NULL || level == LEVEL_OFF || level > LEVEL_MAX)
+    {
+        returnCode = LOG_INVALID_PARAMETER;
+    }
+    else if (!LOG_ATOMIC_LOAD_ACQUIRE(isConfigured))
+    {
+        returnCode = LOG_NOT_INITIALIZED;
+    }
+    else if (LOG_ATOMIC_LOAD(category->currentLogLevel) >= level)
+    {
+        va_list args;
+
+        va_start(args, formatStr);
+#ifdef LOG_HAS_THREADS
+        if (signalConfig.mode == LOG_SIGNAL_WRITE)
+        {
+            returnCode = writeRecord(category, level, formatStr, args);
+        }
+        else
+#endif
+        {
+            returnCode = storeRecord(category, level, formatStr, args);
+        }
+        va_end(args);
+    }
+
+#ifdef LOG_HAS_THREADS
+    errno = savedErrno;
+#endif
+
+    return returnCode;
+}
+
+/*
+ ************************************************************
+ * Draining
+ ************************************************************
+ */
+
+uint32_t drainSignalLog(void)
+{
+    uint32_t nbDrained = 0;
+
+#ifdef LOG_HAS_THREADS
+    (void) pthread_mutex_lock(&drainMutex);
+#endif
+    for (;;)
+    {
+        SignalSlot* const slot = &slots[head & (LOG_SIGNAL_SLOTS - 1)];
+
+        if (LOG_ATOMIC_LOAD_ACQUIRE(slot->sequence) != head + 1)
+        {
+            break;
+        }
+
+        logPublishText(slot->category, slot->level, slot->timestamp, slot->text);
+        LOG_ATOMIC_STORE_RELEASE(slot->sequence, head + LOG_SIGNAL_SLOTS);
+        head++;
+        nbDrained++;
+    }
+#ifdef LOG_HAS_THREADS
+    (void) pthread_mutex_unlock(&drainMutex);
+#endif
+
+    return nbDrained;
+}
+
+uint32_t getSignalLogDropped(void)
+{
+    return LOG_ATOMIC_LOAD(dropped);
+}
+
+#ifdef LOG_HAS_THREADS
+static void* drainLoop(void* arg)
+{
+    char wakeUps[64];
+
+    (void) arg;
+    while (!LOG_ATOMIC_LOAD_ACQUIRE(stopDrain))
+    {
+        const ssize_t nbRead = read(wakeUpPipe[0], wakeUps, sizeof(wakeUps));
+
+        if (nbRead <= 0 && errno != EINTR)
+        {
+            break;
+        }
+        (void) drainSignalLog();
+    }
+
+    return NULL;
+}
+
+static LogResult startDrainThread(void)
+{
+    LogResult returnCode = LOG_OUT_OF_MEMORY;
+
+    if (pipe(wakeUpPipe) == 0)
+    {
+        // Signal handlers must never block on a full pipe
+        (void) fcntl(wakeUpPipe[1], F_SETFL, fcntl(wakeUpPipe[1], F_GETFL) | O_NONBLOCK);
+        LOG_ATOMIC_STORE(stopDrain, 0);
+        if (pthread_create(&drainThread, NULL, &drainLoop, NULL) == 0)
+        {
+            hasDrainThread = true;
+            returnCode = LOG_OK;
+        }
+        else
+        {
+            (void) close(wakeUpPipe[0]);
+            (void) close(wakeUpPipe[1]);
+            wakeUpPipe[0] = -1;
+            wakeUpPipe[1] = -1;
+        }
+    }
+
+    return returnCode;
+}
+#endif
+
+LogResult initSignalLog(const LogSignalConfig* const config)
+{
+    LogResult returnCode = LOG_OK;
+    uint32_t i;
+
+    if (config == NULL || (config->mode != LOG_SIGNAL_WRITE && config->mode != LOG_SIGNAL_DEFER))
+    {
+        returnCode = LOG_INVALID_PARAMETER;
+    }
+#ifndef LOG_HAS_THREADS
+    else if (config->mode == LOG_SIGNAL_WRITE || config->startDrainThread)
+    {
+        returnCode = LOG_INVALID_PARAMETER;
+    }
+#endif
+    else if (LOG_ATOMIC_LOAD(isConfigured))
+    {
+        returnCode = LOG_ALREADY_INITIALIZED;
+    }
+    else
+    {
+        signalConfig = *config;
+        for (i = 0; i < LOG_SIGNAL_SLOTS; i++)
+        {
+            slots[i].sequence = i;
+        }
+        head = 0;
+        tail = 0;
+
+#ifdef LOG_HAS_THREADS
+        if (config->mode == LOG_SIGNAL_DEFER && config->startDrainThread)
+        {
+            returnCode = startDrainThread();
+        }
+#endif
+        if (returnCode == LOG_OK)
+        {
+            LOG_ATOMIC_STORE_RELEASE(isConfigured, 1);
+        }
+    }
+
+    return returnCode;
+}
+
+void closeSignalLog(void)
+{
+    if (!LOG_ATOMIC_LOAD(isConfigured))
+    {
+        return;
+    }
+
+    LOG_ATOMIC_STORE_RELEASE(isConfigured, 0);
+
+#ifdef LOG_HAS_THREADS
+    if (hasDrainThread)
+    {
+        LOG_ATOMIC_STORE_RELEASE(stopDrain, 1);
+        const ssize_t written = write(wakeUpPipe[1], "", 1);
+        (void) written;
+        (void) pthread_join(drainThread, NULL);
+        (void) close(wakeUpPipe[0]);
+        (void) close(wakeUpPipe[1]);
+        wakeUpPipe[0] = -1;
+        wakeUpPipe[1] = -1;
+        hasDrainThread = false;
+    }
+#endif
+
+    (void) drainSignalLog();
+}
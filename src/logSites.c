@@ -0,0 +1,169 @@
+/**
+ * @file
+ *
+ * Registry of the log call sites
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "slf4ec/slf4ec.h"
+#include "slf4ec/slf4ecCtrl.h"
+#include "slf4ecPrivate.h"
+
+#ifdef USE_CALL_SITES
+
+#ifdef LOG_CALL_SITE_SECTION
+/*
+ * Bounds of the section gathering the sites, provided by the linker.
+ * Weak since the section does not exist when no site is compiled in.
+ */
+extern LogCallSite __start_slf4ec_sites[] __attribute__((weak));
+extern LogCallSite __stop_slf4ec_sites[] __attribute__((weak));
+#endif
+
+/*
+ * Incremented by every change invalidating the sites. A site evaluated while a change is made may remember a stale
+ * category after the change reset it: the generation tells it to evaluate again.
+ */
+static uint32_t generation = 0;
+
+size_t getCallSites(LogCallSite** const sites)
+{
+    size_t nbSites = 0;
+
+    *sites = NULL;
+#ifdef LOG_CALL_SITE_SECTION
+    if (__start_slf4ec_sites != NULL)
+    {
+        *sites = __start_slf4ec_sites;
+        nbSites = (size_t)(__stop_slf4ec_sites - __start_slf4ec_sites);
+    }
+#endif
+
+    return nbSites;
+}
+
+void invalidateCallSites(void)
+{
+    LogCallSite* sites;
+    const size_t nbSites = getCallSites(&sites);
+    size_t i;
+
+    (void) LOG_ATOMIC_ADD_SEQ_CST(generation, 1);
+    for (i = 0; i < nbSites; i++)
+    {
+        LOG_ATOMIC_STORE_SEQ_CST(sites[i].disabledFor, NULL);
+    }
+}
+
+bool logSiteIsEnabled(LogCallSite* const site, const LogCategory* const category)
+{
+    bool isEnabled;
+    uint32_t current;
+
+    do
+    {
+        current = LOG_ATOMIC_LOAD_SEQ_CST(generation);
+        const uint8_t control = LOG_ATOMIC_LOAD(site->control);
+        isEnabled = control == LOG_SITE_ENABLED ||
+                    (control == LOG_SITE_DEFAULT && (LOG_ATOMIC_LOAD(category->currentLogLevel) >= site->level ||
+                                                     logThreadLevelAllows(category, site->level)));
+
+        // A site disabled for this thread may not be for a thread with an override
+        if (isEnabled || (control == LOG_SITE_DEFAULT && LOG_ATOMIC_LOAD_SEQ_CST(logNbLevelOverrides) != 0))
+        {
+            // Forget a verdict stored by a previous iteration, before the change
+            if (LOG_ATOMIC_LOAD_SEQ_CST(site->disabledFor) == category)
+            {
+                LOG_ATOMIC_STORE_SEQ_CST(site->disabledFor, NULL);
+            }
+            break;
+        }
+        LOG_ATOMIC_STORE_SEQ_CST(site->disabledFor, category);
+    } while (LOG_ATOMIC_LOAD_SEQ_CST(generation) != current);
+
+    return isEnabled;
+}
+
+/**
+ * Whether the path @p path ends with @p end, on a directory boundary.
+ */
+static bool isPathEnding(const char* const path, const char* const end)
+{
+    const size_t pathLength = strlen(path);
+    const size_t endLength = strlen(end);
+
+    return pathLength >= endLength && strcmp(&path[pathLength - endLength], end) == 0 &&
+           (pathLength == endLength || path[pathLength - endLength - 1] == '/' || path[pathLength - endLength - 1] == '\\');
+}
+
+static bool isSiteMatching(const LogCallSite* const site, const LogSiteQuery* const query)
+{
+    return (query->file == NULL || isPathEnding(site->file, query->file)) &&
+           (query->function == NULL || strcmp(site->function, query->function) == 0) &&
+           (query->firstLine == 0 || site->line >= query->firstLine) && (query->lastLine == 0 || site->line <= query->lastLine) &&
+           (query->format == NULL || (site->formatStr != NULL && strstr(site->formatStr, query->format) != NULL));
+}
+
+LogResult setCallSites(const LogSiteQuery* const query, const LogSiteControl control, uint32_t* const nbSites)
+{
+    LogResult returnCode = LOG_OK;
+
+    if (query == NULL || (control != LOG_SITE_DEFAULT && control != LOG_SITE_ENABLED && control != LOG_SITE_DISABLED))
+    {
+        returnCode = LOG_INVALID_PARAMETER;
+    }
+    else
+    {
+        LogCallSite* sites;
+        const size_t nbAllSites = getCallSites(&sites);
+        uint32_t nbMatching = 0;
+        size_t i;
+
+        for (i = 0; i < nbAllSites; i++)
+        {
+            if (isSiteMatching(&sites[i], query))
+            {
+                LOG_ATOMIC_STORE(sites[i].control, (uint8_t) control);
+                nbMatching++;
+            }
+        }
+        invalidateCallSites();
+
+        if (nbSites != NULL)
+        {
+            *nbSites = nbMatching;
+        }
+    }
+
+    return returnCode;
+}
+
+#endif /* USE_CALL_SITES */
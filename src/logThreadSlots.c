@@ -0,0 +1,140 @@
+/**
+ * @file
+ *
+ * Slots owned by a single thread
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "slf4ecPrivate.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef LOG_HAS_THREADS
+static pthread_mutex_t keysMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void releaseSlot(void* slot)
+{
+    // The content is kept as is, the next thread claiming the slot carries on from there
+    LOG_ATOMIC_STORE_RELEASE(((LogThreadSlot*) slot)->inUse, 0);
+}
+
+/**
+ * Create the key releasing the slots of a pool, once.
+ */
+static void createKey(LogThreadSlots* const pool)
+{
+    if (!LOG_ATOMIC_LOAD_ACQUIRE(pool->hasKey))
+    {
+        (void) pthread_mutex_lock(&keysMutex);
+        if (!pool->hasKey && pthread_key_create(&pool->key, &releaseSlot) == 0)
+        {
+            LOG_ATOMIC_STORE_RELEASE(pool->hasKey, 1);
+        }
+        (void) pthread_mutex_unlock(&keysMutex);
+    }
+}
+#endif
+
+static LogThreadSlot* claimReleasedSlot(LogThreadSlots* const pool)
+{
+    LogThreadSlot* slot;
+
+    for (slot = LOG_ATOMIC_LOAD_ACQUIRE(pool->all); slot != NULL; slot = slot->next)
+    {
+        uint8_t expected = 0;
+        if (LOG_ATOMIC_CAS(slot->inUse, expected, 1))
+        {
+            break;
+        }
+    }
+
+    return slot;
+}
+
+static LogThreadSlot* allocateSlot(LogThreadSlots* const pool)
+{
+    LogThreadSlot* slot = NULL;
+
+#ifdef LOG_HAS_THREADS
+    if (pool->alignment != 0)
+    {
+        const size_t size = (pool->size + pool->alignment - 1) / pool->alignment * pool->alignment;
+        void* memory = NULL;
+
+        if (posix_memalign(&memory, pool->alignment, size) == 0)
+        {
+            slot = memset(memory, 0, size);
+        }
+    }
+    else
+#endif
+    {
+        slot = calloc(1, pool->size);
+    }
+
+    if (slot != NULL && pool->init != NULL && !pool->init(slot))
+    {
+        free(slot);
+        slot = NULL;
+    }
+
+    if (slot != NULL)
+    {
+        slot->inUse = 1;
+        slot->next = LOG_ATOMIC_LOAD(pool->all);
+        // Sequentially consistent so that scanning the slots can be ordered with other sequentially consistent accesses
+        while (!LOG_ATOMIC_CAS_SEQ_CST(pool->all, slot->next, slot))
+        {
+            // slot->next was refreshed by the failed compare and swap
+        }
+    }
+
+    return slot;
+}
+
+LogThreadSlot* logThreadSlotAcquire(LogThreadSlots* const pool)
+{
+    LogThreadSlot* slot = claimReleasedSlot(pool);
+
+    if (slot == NULL)
+    {
+        slot = allocateSlot(pool);
+    }
+
+#ifdef LOG_HAS_THREADS
+    createKey(pool);
+    if (slot != NULL && LOG_ATOMIC_LOAD_ACQUIRE(pool->hasKey))
+    {
+        (void) pthread_setspecific(pool->key, slot);
+    }
+#endif
+
+    return slot;
+}
@@ -0,0 +1,395 @@
+/**
+ * @file
+ *
+ * Logger deferring the formatting of records to a drain thread
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "slf4ec/slf4ecCtrl.h"
+#include "slf4ec/logger/async.h"
+#include "../slf4ecPrivate.h"
+
+#ifdef LOG_HAS_THREADS
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#endif
+
+#define ENTRY_PADDING (0x80000000u)   /**< The entry fills the end of the arena, it holds no record */
+#define ENTRY_SIZE_MASK (0x7FFFFFFFu) /**< Size of the entry, header included */
+#define ENTRY_HEADER_SIZE (8u)        /**< Keeps the records aligned on 8 bytes */
+
+/**
+ * Arena of a logging thread. Positions only grow, their offset in the data being the position modulo the capacity.
+ */
+typedef struct Arena
+{
+    LogThreadSlot slot; /**< Slot of the arena in the pool of every arena ever allocated */
+    uint8_t* data;
+    uint32_t capacity; /**< Size of the data, a power of 2 */
+    uint64_t tail;     /**< Position up to which records were appended, only written by the owner */
+    uint64_t head;     /**< Position up to which records were published, only written by the drain */
+} Arena;
+
+/**
+ * State of the asynchronous logger
+ */
+typedef struct
+{
+    Logger* target; /**< NULL while records are not accepted */
+    uint32_t arenaSize;
+    uint32_t drainPeriod;
+    uint64_t dropped;
+    LogResult status;
+} AsyncLogger;
+
+static AsyncLogger asyncLogger = {NULL, ASYNC_DEFAULT_ARENA_SIZE, 0, 0, LOG_NOT_INITIALIZED};
+static bool initArena(LogThreadSlot* slot);
+static LogThreadSlots allArenas = LOG_THREAD_SLOTS(Arena, 0, &initArena);
+static LOG_THREAD_LOCAL Arena* threadArena = NULL;
+
+#ifdef LOG_HAS_THREADS
+static pthread_mutex_t drainMutex = PTHREAD_MUTEX_INITIALIZER; /**< Held while draining */
+static pthread_mutex_t drainerMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t drainerChanged = PTHREAD_COND_INITIALIZER;
+static pthread_t drainer;
+static bool hasDrainer = false;
+static bool stopDrainer = false;
+#endif
+
+static bool initArena(LogThreadSlot* slot)
+{
+    Arena* const arena = (Arena*) slot;
+
+    arena->capacity = asyncLogger.arenaSize;
+    arena->data = malloc(arena->capacity);
+
+    return arena->data != NULL;
+}
+
+static Arena* acquireArena(void)
+{
+    // Records left by an exited thread are drained as usual, the next thread claiming its arena appends after them
+    Arena* const arena = (Arena*) logThreadSlotAcquire(&allArenas);
+
+    threadArena = arena;
+    return arena;
+}
+
+static bool isValidSize(const uint32_t size)
+{
+    return size >= ASYNC_MIN_ARENA_SIZE && size <= ASYNC_MAX_ARENA_SIZE && (size & (size - 1)) == 0;
+}
+
+/**
+ * Capture a record at an offset of the arena, leaving room for the header of its entry.
+ *
+ * @return Size of the entry, 0 if it does not fit in @p room
+ */
+static size_t captureAt(Arena* const arena, const uint32_t offset, const uint64_t room, const LogRecordV2* const record)
+{
+    size_t size = 0;
+
+    if (room > ENTRY_HEADER_SIZE)
+    {
+        size = logCaptureRecord(&arena->data[offset + ENTRY_HEADER_SIZE], (size_t)(room - ENTRY_HEADER_SIZE), record);
+    }
+
+    return (size > 0) ? size + ENTRY_HEADER_SIZE : 0;
+}
+
+static bool append(Arena* const arena, const LogRecordV2* const record)
+{
+    const uint64_t tail = arena->tail;
+    const uint64_t available = arena->capacity - (tail - LOG_ATOMIC_LOAD_ACQUIRE(arena->head));
+    const uint32_t offset = (uint32_t)(tail & (arena->capacity - 1));
+    const uint32_t contiguous = arena->capacity - offset;
+    uint32_t padding = 0;
+
+    // Captured in place, records are never split
+    size_t size = captureAt(arena, offset, (contiguous < available) ? contiguous : available, record);
+    if (size == 0 && contiguous < available)
+    {
+        padding = contiguous;
+        size = captureAt(arena, 0, available - contiguous, record);
+    }
+
+    if (size > 0)
+    {
+        const uint32_t paddingEntry = ENTRY_PADDING | padding;
+        const uint32_t entry = (uint32_t) size;
+
+        if (padding > 0)
+        {
+            memcpy(&arena->data[offset], &paddingEntry, sizeof(paddingEntry));
+        }
+        memcpy(&arena->data[(tail + padding) & (arena->capacity - 1)], &entry, sizeof(entry));
+        LOG_ATOMIC_STORE_RELEASE(arena->tail, tail + padding + size);
+    }
+
+    return size > 0;
+}
+
+/**
+ * Hand a replayed record to the target logger, through the legacy record if it only implements ::PublishLog.
+ */
+static void publishToTarget(const LogRecordV2* const record, void* const arg)
+{
+    const Logger* const target = (const Logger*) arg;
+
+    if (LOG_ATOMIC_LOAD(target->currentLogLevel) >= record->level)
+    {
+        if (target->publishFctV2 != NULL)
+        {
+            target->publishFctV2(record, target->format);
+        }
+        else
+        {
+            const bool hasLocation = (record->flags & LOG_RECORD_HAS_LOCATION) != 0;
+            const LogRecord legacy = {.file = hasLocation ? record->file : NULL,
+                                      .line = hasLocation ? &record->line : NULL,
+                                      .function = hasLocation ? record->function : NULL,
+                                      .timestamp = &record->timestamp,
+                                      .category = record->category,
+                                      .level = &record->level,
+                                      .formatStr = record->formatStr,
+                                      .vaList = record->vaList,
+                                      .context = (record->flags & LOG_RECORD_HAS_CONTEXT) ? record->context : NULL};
+
+            target->publishFct(&legacy, target->format);
+        }
+    }
+}
+
+static void drainArena(Arena* const arena, Logger* const target)
+{
+    const uint64_t tail = LOG_ATOMIC_LOAD_ACQUIRE(arena->tail);
+    uint64_t position = arena->head;
+
+    while (position < tail)
+    {
+        const uint8_t* const entry = &arena->data[position & (arena->capacity - 1)];
+        uint32_t header;
+
+        memcpy(&header, entry, sizeof(header));
+        if ((header & ENTRY_PADDING) == 0)
+        {
+            logReplayRecord(&entry[ENTRY_HEADER_SIZE], &publishToTarget, target);
+        }
+        position += header & ENTRY_SIZE_MASK;
+    }
+
+    // Everything published is reclaimed at once
+    LOG_ATOMIC_STORE_RELEASE(arena->head, tail);
+}
+
+static void drainAll(Logger* const target)
+{
+    Arena* arena;
+
+#ifdef LOG_HAS_THREADS
+    (void) pthread_mutex_lock(&drainMutex);
+#endif
+    for (arena = (Arena*) logThreadSlotsFirst(&allArenas); arena != NULL; arena = (Arena*) arena->slot.next)
+    {
+        drainArena(arena, target);
+    }
+#ifdef LOG_HAS_THREADS
+    (void) pthread_mutex_unlock(&drainMutex);
+#endif
+}
+
+#ifdef LOG_HAS_THREADS
+static void* drainLoop(void* arg)
+{
+    Logger* const target = (Logger*) arg;
+    struct timespec deadline;
+
+    (void) clock_gettime(CLOCK_REALTIME, &deadline);
+
+    (void) pthread_mutex_lock(&drainerMutex);
+    while (!stopDrainer)
+    {
+        deadline.tv_sec += (time_t)(asyncLogger.drainPeriod / 1000u);
+        deadline.tv_nsec += (long) (asyncLogger.drainPeriod % 1000u) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+
+        int waitResult = 0;
+        while (!stopDrainer && waitResult != ETIMEDOUT)
+        {
+            waitResult = pthread_cond_timedwait(&drainerChanged, &drainerMutex, &deadline);
+        }
+
+        if (!stopDrainer)
+        {
+            (void) pthread_mutex_unlock(&drainerMutex);
+            drainAll(target);
+            (void) pthread_mutex_lock(&drainerMutex);
+        }
+    }
+    (void) pthread_mutex_unlock(&drainerMutex);
+
+    return NULL;
+}
+
+static void stopDrain(void)
+{
+    (void) pthread_mutex_lock(&drainerMutex);
+    const bool isRunning = hasDrainer;
+    stopDrainer = true;
+    hasDrainer = false;
+    (void) pthread_cond_broadcast(&drainerChanged);
+    (void) pthread_mutex_unlock(&drainerMutex);
+
+    if (isRunning)
+    {
+        (void) pthread_join(drainer, NULL);
+    }
+}
+#endif
+
+void initAsyncLogger(const void* const param)
+{
+    const AsyncLoggerConfig* const config = (const AsyncLoggerConfig*) param;
+
+    if (asyncLogger.target != NULL)
+    {
+        return;
+    }
+
+    const uint32_t arenaSize = (config != NULL && config->arenaSize != 0) ? config->arenaSize : ASYNC_DEFAULT_ARENA_SIZE;
+
+    if (config == NULL || config->target == NULL || config->target->initFct == NULL ||
+        (config->target->publishFct == NULL && config->target->publishFctV2 == NULL) || !isValidSize(arenaSize))
+    {
+        asyncLogger.status = LOG_INVALID_PARAMETER;
+        return;
+    }
+#ifndef LOG_HAS_THREADS
+    if (config->drainPeriod != 0)
+    {
+        asyncLogger.status = LOG_INVALID_PARAMETER;
+        return;
+    }
+#endif
+
+    config->target->initFct(config->target->initArgs);
+    asyncLogger.arenaSize = arenaSize;
+    asyncLogger.drainPeriod = config->drainPeriod;
+    asyncLogger.status = LOG_OK;
+
+#ifdef LOG_HAS_THREADS
+    if (config->drainPeriod != 0)
+    {
+        (void) pthread_mutex_lock(&drainerMutex);
+        stopDrainer = false;
+        hasDrainer = (pthread_create(&drainer, NULL, &drainLoop, config->target) == 0);
+        (void) pthread_mutex_unlock(&drainerMutex);
+        if (!hasDrainer)
+        {
+            asyncLogger.status = LOG_OUT_OF_MEMORY;
+            return;
+        }
+    }
+#endif
+
+    LOG_ATOMIC_STORE_RELEASE(asyncLogger.target, config->target);
+}
+
+void logToAsync(const LogRecord* const logRecord, const LogFormat format)
+{
+    LogRecordV2 record;
+
+    logRecordToV2(logRecord, &record);
+    logToAsyncV2(&record, format);
+}
+
+void logToAsyncV2(const LogRecordV2* const logRecord, const LogFormat format)
+{
+    (void) format;
+
+    if (LOG_ATOMIC_LOAD_ACQUIRE(asyncLogger.target) == NULL)
+    {
+        return;
+    }
+
+    Arena* arena = threadArena;
+    if (arena == NULL)
+    {
+        arena = acquireArena();
+    }
+
+    if (arena == NULL || !append(arena, logRecord))
+    {
+        LOG_ATOMIC_ADD(asyncLogger.dropped, 1);
+    }
+}
+
+LogResult getAsyncLoggerStatus(void)
+{
+    return asyncLogger.status;
+}
+
+uint64_t getAsyncLoggerDropped(void)
+{
+    return LOG_ATOMIC_LOAD(asyncLogger.dropped);
+}
+
+void flushAsyncLogger(void)
+{
+    Logger* const target = LOG_ATOMIC_LOAD_ACQUIRE(asyncLogger.target);
+
+    if (target != NULL)
+    {
+        drainAll(target);
+    }
+}
+
+void closeAsyncLogger(void)
+{
+    Logger* const target = LOG_ATOMIC_LOAD(asyncLogger.target);
+
+    LOG_ATOMIC_STORE(asyncLogger.target, (Logger*) NULL);
+    asyncLogger.status = LOG_NOT_INITIALIZED;
+#ifdef LOG_HAS_THREADS
+    stopDrain();
+#endif
+    if (target != NULL)
+    {
+        drainAll(target);
+    }
+}
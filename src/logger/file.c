@@ -0,0 +1,1335 @@
+/**
+ * @file
+ *
+ * Logger writing to a file, optionally as compressed blocks
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#define _GNU_SOURCE /* syscall */
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "slf4ec/slf4ecCtrl.h"
+#include "slf4ec/logCompress.h"
+#include "slf4ec/logContext.h"
+#include "slf4ec/logger/file.h"
+#include "../slf4ecPrivate.h"
+
+#ifdef LOG_HAS_THREADS
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#ifdef USE_LOG_STATS
+#define REPORT_BYTES(nbBytes) logReportBytes((size_t)(nbBytes))
+#else
+#define REPORT_BYTES(nbBytes) (void)(nbBytes)
+#endif
+
+#define FNV_OFFSET_BASIS (2166136261u)
+#define FNV_PRIME (16777619u)
+#define SUMMARY_SIZE (FILE_INDEX_ENTRY_SIZE - 8)
+#define INDEX_HEADER_SIZE (8)
+
+/**
+ * State of the file logger.
+ *
+ * Producers format records in the filling buffer. Once full, it is swapped with the pending buffer which the writer
+ * thread encodes and writes while producers keep on filling. Without threads, blocks are written by the producer.
+ */
+typedef struct
+{
+    FILE* file;
+    FileEncoding encoding;
+    size_t blockSize;
+    LogResult status;
+    char* filling;
+    size_t fillingSize;
+    FileBlockSummary fillingSummary;
+    char* pending;
+    size_t pendingSize; /**< 0 once the writer is done with the pending buffer */
+    FileBlockSummary pendingSummary;
+    uint8_t* encoded; /**< Compressed block, only used by the writer */
+    LogCompressTable* table;
+    uint64_t offset;        /**< Position of the next block, only used by the writer */
+    FileBlockIndex* blocks; /**< Index of the blocks written, only used by the writer */
+    uint32_t nbBlocks;
+    uint32_t blocksCapacity;
+    uint8_t rotationRequested; /**< Set by ::requestFileRotation, cleared by the writer */
+#ifdef LOG_HAS_THREADS
+    pthread_mutex_t lock;
+    pthread_cond_t pendingChanged;
+    pthread_t writer;
+    bool hasWriter;
+    bool stopWriter;
+#endif
+} FileLogger;
+
+static FileLogger fileLogger = {
+    .status = LOG_NOT_INITIALIZED,
+#ifdef LOG_HAS_THREADS
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .pendingChanged = PTHREAD_COND_INITIALIZER,
+#endif
+};
+
+#ifdef LOG_HAS_THREADS
+/**
+ * File taken out of use by a rotation, left for the archival thread
+ */
+typedef struct
+{
+    FILE* file;             /**< NULL when there is nothing to archive */
+    FileBlockIndex* blocks; /**< Index of the blocks of the file, NULL for text */
+    uint32_t nbBlocks;
+    uint64_t offset; /**< Where the index goes */
+} ArchiveJob;
+
+/**
+ * Rotated file found on disk
+ */
+typedef struct
+{
+    uint32_t number;
+    uint64_t size;
+} RotatedFile;
+
+/**
+ * State of the rotation. The writer and the archival thread only exchange files under the rotation lock, which is
+ * never held during I/O, so the writer never waits for the archival thread.
+ */
+typedef struct
+{
+    bool isEnabled; /**< Read by ::requestFileRotation, possibly from a signal handler */
+    bool compressArchives;
+    uint64_t rotateBytes;
+    uint32_t rotateAfter;
+    uint32_t keepFiles;
+    uint64_t keepBytes;
+    time_t openedAt;   /**< When the file in use started receiving blocks, only used by the writer */
+    char* path;        /**< Name of the file in use, once renamed */
+    char* nextPath;    /**< Name of the file opened ahead of the next rotation */
+    char* archivePath; /**< Room for the name of a rotated file */
+    char* directory;   /**< Where rotated files are looked for */
+    const char* base;  /**< Name of the file in use within the directory */
+    uint32_t sequence; /**< Number of the next rotated file, only used by the archival thread */
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    pthread_t archiver;
+    bool hasArchiver;
+    bool stop;
+    bool wantNext; /**< The writer needs a next file */
+    FILE* next;    /**< Opened ahead of the next rotation */
+    ArchiveJob job;
+} FileRotation;
+
+static FileRotation fileRotation = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .changed = PTHREAD_COND_INITIALIZER,
+};
+#endif
+
+static void lockFile(void)
+{
+#ifdef LOG_HAS_THREADS
+    (void) pthread_mutex_lock(&fileLogger.lock);
+#endif
+}
+
+static void unlockFile(void)
+{
+#ifdef LOG_HAS_THREADS
+    (void) pthread_mutex_unlock(&fileLogger.lock);
+#endif
+}
+
+static uint32_t checksum(const uint8_t* const data, const size_t size)
+{
+    uint32_t hash = FNV_OFFSET_BASIS;
+    size_t i;
+
+    for (i = 0; i < size; i++)
+    {
+        hash = (hash ^ data[i]) * FNV_PRIME;
+    }
+
+    return hash;
+}
+
+static void writeLE16(uint8_t* const out, const uint16_t value)
+{
+    out[0] = (uint8_t) value;
+    out[1] = (uint8_t)(value >> 8);
+}
+
+static void writeLE32(uint8_t* const out, const uint32_t value)
+{
+    writeLE16(out, (uint16_t) value);
+    writeLE16(&out[2], (uint16_t)(value >> 16));
+}
+
+static uint16_t readLE16(const uint8_t* const in)
+{
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+static uint32_t readLE32(const uint8_t* const in)
+{
+    return readLE16(in) | ((uint32_t) readLE16(&in[2]) << 16);
+}
+
+static void writeLE64(uint8_t* const out, const uint64_t value)
+{
+    writeLE32(out, (uint32_t) value);
+    writeLE32(&out[4], (uint32_t)(value >> 32));
+}
+
+static uint64_t readLE64(const uint8_t* const in)
+{
+    return readLE32(in) | ((uint64_t) readLE32(&in[4]) << 32);
+}
+
+static void resetSummary(FileBlockSummary* const summary)
+{
+    memset(summary, 0, sizeof(FileBlockSummary));
+    summary->minTimestamp = UINT64_MAX;
+    summary->minLevel = UINT8_MAX;
+}
+
+/**
+ * Summary matching every record, for blocks that do not have one.
+ */
+static void fullSummary(FileBlockSummary* const summary)
+{
+    summary->minTimestamp = 0;
+    summary->maxTimestamp = UINT64_MAX;
+    summary->minLevel = 0;
+    summary->maxLevel = UINT8_MAX;
+    memset(summary->categories, 0xFF, sizeof(summary->categories));
+}
+
+static void addToSummary(FileBlockSummary* const summary, const LogRecordV2* const record)
+{
+    LogCategory* const* categories;
+    const uint16_t nbCategories = getCategories(&categories);
+    const uint8_t level = record->level;
+    unsigned int bit = record->category->index;
+
+    if (bit >= nbCategories || categories[bit] != record->category || bit >= FILE_BLOCK_OTHER_CATEGORY)
+    {
+        bit = FILE_BLOCK_OTHER_CATEGORY;
+    }
+
+    summary->minTimestamp = (record->timestamp < summary->minTimestamp) ? record->timestamp : summary->minTimestamp;
+    summary->maxTimestamp = (record->timestamp > summary->maxTimestamp) ? record->timestamp : summary->maxTimestamp;
+    summary->minLevel = (level < summary->minLevel) ? level : summary->minLevel;
+    summary->maxLevel = (level > summary->maxLevel) ? level : summary->maxLevel;
+    summary->categories[bit / 8] |= (uint8_t)(1u << (bit % 8));
+}
+
+static void writeSummary(uint8_t* const out, const FileBlockSummary* const summary)
+{
+    writeLE64(out, summary->minTimestamp);
+    writeLE64(&out[8], summary->maxTimestamp);
+    out[16] = summary->minLevel;
+    out[17] = summary->maxLevel;
+    out[18] = 0;
+    out[19] = 0;
+    memcpy(&out[20], summary->categories, sizeof(summary->categories));
+}
+
+static void readSummary(const uint8_t* const in, FileBlockSummary* const summary)
+{
+    summary->minTimestamp = readLE64(in);
+    summary->maxTimestamp = readLE64(&in[8]);
+    summary->minLevel = in[16];
+    summary->maxLevel = in[17];
+    memcpy(summary->categories, &in[20], sizeof(summary->categories));
+}
+
+/**
+ * Remember where a block was written. The index is simply not written if it cannot grow.
+ */
+static void indexBlock(const uint64_t offset, const FileBlockSummary* const summary)
+{
+    if (fileLogger.nbBlocks == fileLogger.blocksCapacity && fileLogger.blocks != NULL)
+    {
+        const uint32_t capacity = fileLogger.blocksCapacity * 2;
+        FileBlockIndex* const blocks = realloc(fileLogger.blocks, capacity * sizeof(FileBlockIndex));
+
+        if (blocks == NULL)
+        {
+            free(fileLogger.blocks);
+        }
+        fileLogger.blocks = blocks;
+        fileLogger.blocksCapacity = capacity;
+    }
+
+    if (fileLogger.blocks != NULL)
+    {
+        fileLogger.blocks[fileLogger.nbBlocks].offset = offset;
+        fileLogger.blocks[fileLogger.nbBlocks].summary = *summary;
+        fileLogger.nbBlocks++;
+    }
+}
+
+/**
+ * Append the index of the blocks written and the trailer pointing to it.
+ */
+static void writeIndex(FILE* const file, const FileBlockIndex* const blocks, const uint32_t nbBlocks, const uint64_t offset)
+{
+    uint8_t entry[FILE_INDEX_ENTRY_SIZE];
+    uint32_t i;
+
+    memcpy(entry, FILE_INDEX_MAGIC, 4);
+    writeLE32(&entry[4], nbBlocks);
+    (void) fwrite(entry, 1, INDEX_HEADER_SIZE, file);
+
+    for (i = 0; i < nbBlocks; i++)
+    {
+        writeLE64(entry, blocks[i].offset);
+        writeSummary(&entry[8], &blocks[i].summary);
+        (void) fwrite(entry, 1, FILE_INDEX_ENTRY_SIZE, file);
+    }
+
+    memcpy(entry, FILE_TRAILER_MAGIC, 4);
+    writeLE32(&entry[4], nbBlocks);
+    writeLE64(&entry[8], offset);
+    (void) fwrite(entry, 1, FILE_TRAILER_SIZE, file);
+}
+
+/**
+ * Write a block of text to @p file, compressed with @p table into @p encoded when given and smaller.
+ * Returns the size of the block in the file.
+ */
+static size_t putBlock(FILE* const file,
+                       const char* const text,
+                       const size_t size,
+                       const FileBlockSummary* const summary,
+                       uint8_t* const encoded,
+                       LogCompressTable* const table)
+{
+    const uint8_t* stored = (const uint8_t*) text;
+    size_t storedSize = size;
+    uint8_t header[FILE_BLOCK_HEADER_SIZE];
+
+    header[5] = 0;
+    if (table != NULL)
+    {
+        const size_t compressedSize = logCompress((const uint8_t*) text, size, encoded, LOG_COMPRESS_BOUND(size), table);
+
+        // Text that does not compress is stored as is
+        if (compressedSize > 0 && compressedSize < size)
+        {
+            stored = encoded;
+            storedSize = compressedSize;
+            header[5] = FILE_BLOCK_COMPRESSED;
+        }
+    }
+
+    memcpy(header, FILE_BLOCK_MAGIC, 4);
+    header[4] = FILE_BLOCK_VERSION;
+    writeLE16(&header[6], FILE_BLOCK_HEADER_SIZE);
+    writeLE32(&header[8], (uint32_t) size);
+    writeLE32(&header[12], (uint32_t) storedSize);
+    writeLE32(&header[16], checksum((const uint8_t*) text, size));
+    writeSummary(&header[FILE_BLOCK_V1_HEADER_SIZE], summary);
+
+    (void) fwrite(header, 1, sizeof(header), file);
+    (void) fwrite(stored, 1, storedSize, file);
+
+    return sizeof(header) + storedSize;
+}
+
+/**
+ * Encode and write a block of text. Only called by the writer.
+ */
+static void writeBlock(const char* const text, const size_t size, const FileBlockSummary* const summary)
+{
+    if (fileLogger.encoding == FILE_ENCODING_TEXT)
+    {
+        (void) fwrite(text, 1, size, fileLogger.file);
+        fileLogger.offset += size;
+        return;
+    }
+
+    indexBlock(fileLogger.offset, summary);
+    fileLogger.offset += putBlock(fileLogger.file, text, size, summary, fileLogger.encoded,
+                                  (fileLogger.encoding == FILE_ENCODING_COMPRESSED) ? fileLogger.table : NULL);
+}
+
+#ifdef LOG_HAS_THREADS
+/**
+ * List the rotated files, named after the file in use followed by a number. Returns how many were found.
+ */
+static size_t listRotatedFiles(RotatedFile** const files)
+{
+    DIR* const directory = opendir(fileRotation.directory);
+    const size_t baseLength = strlen(fileRotation.base);
+    const struct dirent* entry;
+    size_t nbFiles = 0;
+    size_t capacity = 0;
+
+    *files = NULL;
+    while (directory != NULL && (entry = readdir(directory)) != NULL)
+    {
+        const char* const suffix = &entry->d_name[baseLength + 1];
+        char* end;
+        struct stat status;
+
+        if (strncmp(entry->d_name, fileRotation.base, baseLength) != 0 || entry->d_name[baseLength] != '.' || *suffix < '0' ||
+            *suffix > '9')
+        {
+            continue;
+        }
+        const unsigned long number = strtoul(suffix, &end, 10);
+        if (*end != '\0' || number > UINT32_MAX)
+        {
+            continue;
+        }
+
+        if (nbFiles == capacity)
+        {
+            capacity = (capacity == 0) ? 16 : capacity * 2;
+            RotatedFile* const grown = realloc(*files, capacity * sizeof(RotatedFile));
+            if (grown == NULL)
+            {
+                break;
+            }
+            *files = grown;
+        }
+        (void) snprintf(fileRotation.archivePath, strlen(fileRotation.path) + 32, "%s/%s", fileRotation.directory, entry->d_name);
+        (*files)[nbFiles].number = (uint32_t) number;
+        (*files)[nbFiles].size = (stat(fileRotation.archivePath, &status) == 0) ? (uint64_t) status.st_size : 0;
+        nbFiles++;
+    }
+
+    if (directory != NULL)
+    {
+        (void) closedir(directory);
+    }
+    return nbFiles;
+}
+
+static int compareNewestFirst(const void* const a, const void* const b)
+{
+    const uint32_t first = ((const RotatedFile*) a)->number;
+    const uint32_t second = ((const RotatedFile*) b)->number;
+
+    return (first < second) - (first > second);
+}
+
+/**
+ * Delete the oldest rotated files beyond the retention limits.
+ */
+static void applyRetention(void)
+{
+    RotatedFile* files;
+    uint64_t total = 0;
+    size_t i;
+
+    if (fileRotation.keepFiles == 0 && fileRotation.keepBytes == 0)
+    {
+        return;
+    }
+
+    const size_t nbFiles = listRotatedFiles(&files);
+    qsort(files, nbFiles, sizeof(RotatedFile), &compareNewestFirst);
+    for (i = 0; i < nbFiles; i++)
+    {
+        total += files[i].size;
+        if ((fileRotation.keepFiles != 0 && i >= fileRotation.keepFiles) || (fileRotation.keepBytes != 0 && total > fileRotation.keepBytes))
+        {
+            (void) snprintf(fileRotation.archivePath, strlen(fileRotation.path) + 32, "%s.%" PRIu32, fileRotation.path, files[i].number);
+            (void) remove(fileRotation.archivePath);
+        }
+    }
+    free(files);
+}
+
+/**
+ * Rewrite a rotated text file as compressed blocks, cut at line ends unless a line is longer than a block.
+ * The text is kept when it cannot be rewritten.
+ */
+static void compressArchive(const char* const path)
+{
+    const size_t blockSize = fileLogger.blockSize;
+    const size_t pathLength = strlen(path);
+    char* const compressedPath = malloc(pathLength + sizeof(".z"));
+    char* const text = malloc(blockSize);
+    uint8_t* const encoded = malloc(LOG_COMPRESS_BOUND(blockSize));
+    LogCompressTable* const table = malloc(sizeof(LogCompressTable));
+    FILE* const in = fopen(path, "rb");
+    FILE* out = NULL;
+    FileBlockIndex* blocks = NULL;
+    uint32_t nbBlocks = 0;
+    uint32_t capacity = 0;
+    uint64_t offset = 0;
+    size_t filled = 0;
+    FileBlockSummary summary;
+    bool isOk = compressedPath != NULL && text != NULL && encoded != NULL && table != NULL && in != NULL;
+
+    if (isOk)
+    {
+        strcpy(compressedPath, path);
+        strcat(compressedPath, ".z");
+        out = fopen(compressedPath, "wb");
+        isOk = (out != NULL);
+    }
+
+    fullSummary(&summary);
+    while (isOk)
+    {
+        filled += fread(&text[filled], 1, blockSize - filled, in);
+        if (filled == 0)
+        {
+            break;
+        }
+
+        size_t size = filled;
+        if (filled == blockSize)
+        {
+            while (size > 0 && text[size - 1] != '\n')
+            {
+                size--;
+            }
+            size = (size == 0) ? filled : size;
+        }
+
+        if (nbBlocks == capacity)
+        {
+            capacity = (capacity == 0) ? 16 : capacity * 2;
+            FileBlockIndex* const grown = realloc(blocks, capacity * sizeof(FileBlockIndex));
+            isOk = (grown != NULL);
+            blocks = isOk ? grown : blocks;
+        }
+        if (isOk)
+        {
+            blocks[nbBlocks].offset = offset;
+            blocks[nbBlocks].summary = summary;
+            nbBlocks++;
+            offset += putBlock(out, text, size, &summary, encoded, table);
+            memmove(text, &text[size], filled - size);
+            filled -= size;
+        }
+    }
+
+    if (isOk)
+    {
+        writeIndex(out, blocks, nbBlocks, offset);
+        isOk = (ferror(in) == 0) && (fflush(out) == 0) && (ferror(out) == 0) && (fsync(fileno(out)) == 0);
+    }
+    if (out != NULL)
+    {
+        isOk = (fclose(out) == 0) && isOk;
+    }
+    if (in != NULL)
+    {
+        (void) fclose(in);
+    }
+    if (isOk)
+    {
+        (void) rename(compressedPath, path);
+    }
+    else if (compressedPath != NULL)
+    {
+        (void) remove(compressedPath);
+    }
+
+    free(blocks);
+    free(table);
+    free(encoded);
+    free(text);
+    free(compressedPath);
+}
+
+/**
+ * Finish a rotated file and give it its final name. The file in use takes its name.
+ */
+static void archiveFile(const ArchiveJob* const job)
+{
+    if (job->blocks != NULL && job->nbBlocks > 0)
+    {
+        writeIndex(job->file, job->blocks, job->nbBlocks, job->offset);
+    }
+    free(job->blocks);
+    (void) fflush(job->file);
+    (void) fsync(fileno(job->file));
+    (void) fclose(job->file);
+
+    (void) snprintf(fileRotation.archivePath, strlen(fileRotation.path) + 32, "%s.%" PRIu32, fileRotation.path, fileRotation.sequence++);
+    (void) rename(fileRotation.path, fileRotation.archivePath);
+    (void) rename(fileRotation.nextPath, fileRotation.path);
+    if (fileRotation.compressArchives)
+    {
+        compressArchive(fileRotation.archivePath);
+    }
+    applyRetention();
+}
+
+static void* archiverThread(void* arg)
+{
+    (void) arg;
+
+#ifdef __linux__
+    // Lowest priority, niceness being per thread on Linux. Unlike SCHED_IDLE, a busy producer cannot starve it
+    (void) setpriority(PRIO_PROCESS, (id_t) syscall(SYS_gettid), 19);
+#endif
+
+    (void) pthread_mutex_lock(&fileRotation.lock);
+    for (;;)
+    {
+        while (!fileRotation.stop && fileRotation.job.file == NULL && !(fileRotation.wantNext && fileRotation.next == NULL))
+        {
+            (void) pthread_cond_wait(&fileRotation.changed, &fileRotation.lock);
+        }
+        if (fileRotation.stop && fileRotation.job.file == NULL)
+        {
+            break;
+        }
+
+        const ArchiveJob job = fileRotation.job;
+        const bool openNext = !fileRotation.stop;
+        (void) pthread_mutex_unlock(&fileRotation.lock);
+
+        if (job.file != NULL)
+        {
+            archiveFile(&job);
+        }
+        // Once the previous next file was renamed
+        FILE* const next = openNext ? fopen(fileRotation.nextPath, (fileLogger.encoding == FILE_ENCODING_TEXT) ? "w" : "wb") : NULL;
+
+        (void) pthread_mutex_lock(&fileRotation.lock);
+        fileRotation.job.file = NULL;
+        if (openNext)
+        {
+            // Not retried until the writer needs it again
+            fileRotation.next = next;
+            fileRotation.wantNext = false;
+        }
+    }
+    (void) pthread_mutex_unlock(&fileRotation.lock);
+
+    return NULL;
+}
+
+/**
+ * Swap the file for the next one if it is time to. Only called by the writer, before writing a block.
+ */
+static void rotateIfNeeded(void)
+{
+    const bool isRequested = LOG_ATOMIC_LOAD(fileLogger.rotationRequested) != 0;
+
+    if (!LOG_ATOMIC_LOAD(fileRotation.isEnabled) || fileLogger.offset == 0 ||
+        (!isRequested && (fileRotation.rotateBytes == 0 || fileLogger.offset < fileRotation.rotateBytes) &&
+         (fileRotation.rotateAfter == 0 || time(NULL) - fileRotation.openedAt < (time_t) fileRotation.rotateAfter)))
+    {
+        return;
+    }
+
+    (void) pthread_mutex_lock(&fileRotation.lock);
+    FILE* const next = fileRotation.next;
+    if (next != NULL && fileRotation.job.file == NULL)
+    {
+        fileRotation.job.file = fileLogger.file;
+        fileRotation.job.blocks = fileLogger.blocks;
+        fileRotation.job.nbBlocks = fileLogger.nbBlocks;
+        fileRotation.job.offset = fileLogger.offset;
+        fileRotation.next = NULL;
+    }
+    // Without a next file, the rotation is tried again with the next block
+    fileRotation.wantNext = true;
+    (void) pthread_cond_signal(&fileRotation.changed);
+    (void) pthread_mutex_unlock(&fileRotation.lock);
+
+    if (next != NULL)
+    {
+        fileLogger.file = next;
+        fileLogger.offset = 0;
+        fileLogger.nbBlocks = 0;
+        if (fileLogger.encoding != FILE_ENCODING_TEXT)
+        {
+            fileLogger.blocksCapacity = 16;
+            fileLogger.blocks = malloc(fileLogger.blocksCapacity * sizeof(FileBlockIndex));
+        }
+        fileRotation.openedAt = time(NULL);
+        LOG_ATOMIC_STORE(fileLogger.rotationRequested, 0);
+    }
+}
+
+/**
+ * Start the archival thread, which opens the first next file right away.
+ */
+static void startRotation(const FileLoggerConfig* const config)
+{
+    const size_t length = strlen(config->path);
+    const char* const slash = strrchr(config->path, '/');
+    RotatedFile* files;
+    size_t i;
+
+    fileRotation.rotateBytes = config->rotateBytes;
+    fileRotation.rotateAfter = config->rotateAfter;
+    fileRotation.keepFiles = config->keepFiles;
+    fileRotation.keepBytes = config->keepBytes;
+    fileRotation.compressArchives = config->compressArchives && fileLogger.encoding == FILE_ENCODING_TEXT;
+    fileRotation.openedAt = time(NULL);
+    fileRotation.path = malloc(length + 1);
+    fileRotation.nextPath = malloc(length + sizeof(FILE_NEXT_SUFFIX));
+    fileRotation.archivePath = malloc(length + 32);
+    fileRotation.directory = malloc((slash != NULL) ? (size_t)(slash - config->path) + 2 : 2);
+    if (fileRotation.path == NULL || fileRotation.nextPath == NULL || fileRotation.archivePath == NULL || fileRotation.directory == NULL)
+    {
+        return;
+    }
+
+    strcpy(fileRotation.path, config->path);
+    strcpy(fileRotation.nextPath, config->path);
+    strcat(fileRotation.nextPath, FILE_NEXT_SUFFIX);
+    if (slash != NULL)
+    {
+        // "/" for files at the root
+        const size_t directoryLength = (slash == config->path) ? 1 : (size_t)(slash - config->path);
+        memcpy(fileRotation.directory, config->path, directoryLength);
+        fileRotation.directory[directoryLength] = '\0';
+        fileRotation.base = &fileRotation.path[slash - config->path + 1];
+    }
+    else
+    {
+        strcpy(fileRotation.directory, ".");
+        fileRotation.base = fileRotation.path;
+    }
+
+    // Numbering goes on after the files rotated by previous runs
+    const size_t nbFiles = listRotatedFiles(&files);
+    fileRotation.sequence = 1;
+    for (i = 0; i < nbFiles; i++)
+    {
+        fileRotation.sequence = (files[i].number >= fileRotation.sequence) ? files[i].number + 1 : fileRotation.sequence;
+    }
+    free(files);
+
+    fileRotation.stop = false;
+    fileRotation.wantNext = true;
+    fileRotation.next = NULL;
+    fileRotation.job.file = NULL;
+    fileRotation.hasArchiver = (pthread_create(&fileRotation.archiver, NULL, &archiverThread, NULL) == 0);
+    LOG_ATOMIC_STORE(fileRotation.isEnabled, fileRotation.hasArchiver);
+}
+
+/**
+ * Stop the archival thread once it archived the last rotated file. Only called once the writer is stopped.
+ */
+static void stopRotation(void)
+{
+    if (fileRotation.hasArchiver)
+    {
+        (void) pthread_mutex_lock(&fileRotation.lock);
+        fileRotation.stop = true;
+        (void) pthread_cond_signal(&fileRotation.changed);
+        (void) pthread_mutex_unlock(&fileRotation.lock);
+        (void) pthread_join(fileRotation.archiver, NULL);
+        fileRotation.hasArchiver = false;
+    }
+
+    if (fileRotation.next != NULL)
+    {
+        (void) fclose(fileRotation.next);
+        (void) remove(fileRotation.nextPath);
+        fileRotation.next = NULL;
+    }
+
+    LOG_ATOMIC_STORE(fileRotation.isEnabled, false);
+    free(fileRotation.path);
+    free(fileRotation.nextPath);
+    free(fileRotation.archivePath);
+    free(fileRotation.directory);
+    fileRotation.path = NULL;
+    fileRotation.nextPath = NULL;
+    fileRotation.archivePath = NULL;
+    fileRotation.directory = NULL;
+}
+
+static void* writerThread(void* arg)
+{
+    (void) arg;
+
+    lockFile();
+    for (;;)
+    {
+        while (fileLogger.pendingSize == 0 && !fileLogger.stopWriter)
+        {
+            (void) pthread_cond_wait(&fileLogger.pendingChanged, &fileLogger.lock);
+        }
+
+        if (fileLogger.pendingSize == 0)
+        {
+            break;
+        }
+
+        // Producers never touch the pending buffer while its size is not 0
+        const size_t size = fileLogger.pendingSize;
+        unlockFile();
+        rotateIfNeeded();
+        writeBlock(fileLogger.pending, size, &fileLogger.pendingSummary);
+        (void) fflush(fileLogger.file);
+        lockFile();
+
+        fileLogger.pendingSize = 0;
+        (void) pthread_cond_broadcast(&fileLogger.pendingChanged);
+    }
+    unlockFile();
+
+    return NULL;
+}
+#endif
+
+/**
+ * Hand the filling buffer over to the writer. Must be called with the file locked.
+ */
+static void handOff(void)
+{
+#ifdef LOG_HAS_THREADS
+    if (fileLogger.hasWriter)
+    {
+        while (fileLogger.pendingSize != 0)
+        {
+            (void) pthread_cond_wait(&fileLogger.pendingChanged, &fileLogger.lock);
+        }
+
+        char* const filled = fileLogger.filling;
+        fileLogger.filling = fileLogger.pending;
+        fileLogger.pending = filled;
+        fileLogger.pendingSize = fileLogger.fillingSize;
+        fileLogger.pendingSummary = fileLogger.fillingSummary;
+        fileLogger.fillingSize = 0;
+        resetSummary(&fileLogger.fillingSummary);
+        (void) pthread_cond_broadcast(&fileLogger.pendingChanged);
+        return;
+    }
+#endif
+
+    writeBlock(fileLogger.filling, fileLogger.fillingSize, &fileLogger.fillingSummary);
+    fileLogger.fillingSize = 0;
+    resetSummary(&fileLogger.fillingSummary);
+}
+
+void initFileLogger(const void* const param)
+{
+    const FileLoggerConfig* const config = (const FileLoggerConfig*) param;
+
+    if (fileLogger.file != NULL)
+    {
+        return;
+    }
+
+    if (config == NULL || config->path == NULL || config->blockSize > FILE_MAX_BLOCK_SIZE
+#ifndef LOG_HAS_THREADS
+        || config->rotateBytes != 0 || config->rotateAfter != 0 || config->rotateOnRequest
+#endif
+        )
+    {
+        fileLogger.status = LOG_INVALID_PARAMETER;
+        return;
+    }
+
+    fileLogger.encoding = config->encoding;
+    fileLogger.blockSize = (config->blockSize == 0) ? FILE_DEFAULT_BLOCK_SIZE : config->blockSize;
+    fileLogger.fillingSize = 0;
+    fileLogger.pendingSize = 0;
+    resetSummary(&fileLogger.fillingSummary);
+    fileLogger.filling = malloc(fileLogger.blockSize);
+#ifdef LOG_HAS_THREADS
+    fileLogger.pending = malloc(fileLogger.blockSize);
+#endif
+    if (fileLogger.encoding == FILE_ENCODING_COMPRESSED)
+    {
+        fileLogger.encoded = malloc(LOG_COMPRESS_BOUND(fileLogger.blockSize));
+        fileLogger.table = malloc(sizeof(LogCompressTable));
+    }
+    if (fileLogger.encoding != FILE_ENCODING_TEXT)
+    {
+        // Grows as blocks are written
+        fileLogger.nbBlocks = 0;
+        fileLogger.blocksCapacity = 16;
+        fileLogger.blocks = malloc(fileLogger.blocksCapacity * sizeof(FileBlockIndex));
+    }
+
+    fileLogger.status = LOG_OUT_OF_MEMORY;
+    if (fileLogger.filling != NULL &&
+#ifdef LOG_HAS_THREADS
+        fileLogger.pending != NULL &&
+#endif
+        (fileLogger.encoding != FILE_ENCODING_COMPRESSED || (fileLogger.encoded != NULL && fileLogger.table != NULL)))
+    {
+        fileLogger.file = fopen(config->path, (fileLogger.encoding == FILE_ENCODING_TEXT) ? "a" : "ab");
+        fileLogger.status = (fileLogger.file != NULL) ? LOG_OK : LOG_NOT_INITIALIZED;
+    }
+
+    if (fileLogger.status == LOG_OK)
+    {
+        // Appended after whatever the file already holds, which counts towards its rotation
+        const long end = (fseek(fileLogger.file, 0, SEEK_END) == 0) ? ftell(fileLogger.file) : -1;
+        fileLogger.offset = (end > 0) ? (uint64_t) end : 0;
+    }
+
+    if (fileLogger.status == LOG_OK)
+    {
+#ifdef LOG_HAS_THREADS
+        // Rotation happens on the writer, set up before it starts
+        LOG_ATOMIC_STORE(fileLogger.rotationRequested, 0);
+        if (config->rotateBytes != 0 || config->rotateAfter != 0 || config->rotateOnRequest)
+        {
+            startRotation(config);
+        }
+
+        // Blocks are written by the producers if the writer cannot be started
+        fileLogger.stopWriter = false;
+        fileLogger.hasWriter = (pthread_create(&fileLogger.writer, NULL, &writerThread, NULL) == 0);
+        if (!fileLogger.hasWriter)
+        {
+            stopRotation();
+        }
+#endif
+    }
+    else
+    {
+        closeFileLogger();
+    }
+}
+
+void logToFile(const LogRecord* const logRecord, const LogFormat format)
+{
+    LogRecordV2 record;
+
+    logRecordToV2(logRecord, &record);
+    logToFileV2(&record, format);
+}
+
+void logToFileV2(const LogRecordV2* const logRecord, const LogFormat format)
+{
+    size_t length = 0;
+
+    lockFile();
+    if (fileLogger.status == LOG_OK)
+    {
+        length = logFormatLine(&fileLogger.filling[fileLogger.fillingSize], fileLogger.blockSize - fileLogger.fillingSize,
+                               logRecord, format);
+
+        if (length > fileLogger.blockSize - fileLogger.fillingSize && fileLogger.fillingSize > 0)
+        {
+            handOff();
+            length = logFormatLine(fileLogger.filling, fileLogger.blockSize, logRecord, format);
+        }
+
+        // Records larger than a block are truncated so blocks keep whole records
+        if (length > fileLogger.blockSize)
+        {
+            length = fileLogger.blockSize;
+            fileLogger.filling[length - 1] = '\n';
+        }
+
+        fileLogger.fillingSize += length;
+        if (fileLogger.encoding != FILE_ENCODING_TEXT)
+        {
+            addToSummary(&fileLogger.fillingSummary, logRecord);
+        }
+        if (fileLogger.fillingSize == fileLogger.blockSize)
+        {
+            handOff();
+        }
+    }
+    unlockFile();
+
+    REPORT_BYTES(length);
+}
+
+LogResult getFileLoggerStatus(void)
+{
+    return fileLogger.status;
+}
+
+void flushFileLogger(void)
+{
+    lockFile();
+    if (fileLogger.status == LOG_OK)
+    {
+        if (fileLogger.fillingSize > 0)
+        {
+            handOff();
+        }
+
+#ifdef LOG_HAS_THREADS
+        while (fileLogger.pendingSize != 0)
+        {
+            (void) pthread_cond_wait(&fileLogger.pendingChanged, &fileLogger.lock);
+        }
+#endif
+        (void) fflush(fileLogger.file);
+    }
+    unlockFile();
+}
+
+LogResult requestFileRotation(void)
+{
+    LogResult returnCode = LOG_INVALID_PARAMETER;
+
+#ifdef LOG_HAS_THREADS
+    if (LOG_ATOMIC_LOAD(fileRotation.isEnabled))
+    {
+        LOG_ATOMIC_STORE(fileLogger.rotationRequested, 1);
+        returnCode = LOG_OK;
+    }
+#endif
+
+    return returnCode;
+}
+
+void closeFileLogger(void)
+{
+    flushFileLogger();
+
+    lockFile();
+    const LogResult status = fileLogger.status;
+    fileLogger.status = LOG_NOT_INITIALIZED;
+#ifdef LOG_HAS_THREADS
+    fileLogger.stopWriter = true;
+    (void) pthread_cond_broadcast(&fileLogger.pendingChanged);
+#endif
+    unlockFile();
+
+#ifdef LOG_HAS_THREADS
+    if (fileLogger.hasWriter)
+    {
+        (void) pthread_join(fileLogger.writer, NULL);
+        fileLogger.hasWriter = false;
+    }
+    stopRotation();
+#endif
+
+    if (fileLogger.file != NULL)
+    {
+        if (fileLogger.encoding != FILE_ENCODING_TEXT && fileLogger.blocks != NULL && fileLogger.nbBlocks > 0)
+        {
+            writeIndex(fileLogger.file, fileLogger.blocks, fileLogger.nbBlocks, fileLogger.offset);
+        }
+        (void) fclose(fileLogger.file);
+        fileLogger.file = NULL;
+    }
+
+    free(fileLogger.filling);
+    free(fileLogger.pending);
+    free(fileLogger.encoded);
+    free(fileLogger.table);
+    free(fileLogger.blocks);
+    fileLogger.blocks = NULL;
+    fileLogger.filling = NULL;
+    fileLogger.pending = NULL;
+    fileLogger.encoded = NULL;
+    fileLogger.table = NULL;
+
+    // Keep the reason why the logger could not be opened
+    if (status != LOG_OK)
+    {
+        fileLogger.status = status;
+    }
+}
+
+/**
+ * Read the header of the next block, skipping indexes. Returns false at the end of the file or on anything else.
+ */
+static bool readBlockHeader(FILE* const file, FileBlockHeader* const header)
+{
+    uint8_t raw[FILE_BLOCK_HEADER_SIZE];
+    bool isValid = (fread(raw, 1, INDEX_HEADER_SIZE, file) == INDEX_HEADER_SIZE);
+
+    while (isValid && memcmp(raw, FILE_INDEX_MAGIC, 4) == 0)
+    {
+        // An index left by a previous run of the logger, the blocks that follow were appended afterwards
+        const long indexSize = (long) readLE32(&raw[4]) * FILE_INDEX_ENTRY_SIZE + FILE_TRAILER_SIZE;
+        isValid = fseek(file, indexSize, SEEK_CUR) == 0 && fread(raw, 1, INDEX_HEADER_SIZE, file) == INDEX_HEADER_SIZE;
+    }
+
+    isValid = isValid && memcmp(raw, FILE_BLOCK_MAGIC, 4) == 0 &&
+              fread(&raw[INDEX_HEADER_SIZE], 1, FILE_BLOCK_V1_HEADER_SIZE - INDEX_HEADER_SIZE, file) ==
+                  FILE_BLOCK_V1_HEADER_SIZE - INDEX_HEADER_SIZE;
+
+    if (isValid)
+    {
+        header->version = raw[4];
+        header->flags = raw[5];
+        header->headerSize = readLE16(&raw[6]);
+        header->rawSize = readLE32(&raw[8]);
+        header->storedSize = readLE32(&raw[12]);
+        header->checksum = readLE32(&raw[16]);
+        isValid = header->headerSize >= FILE_BLOCK_V1_HEADER_SIZE;
+    }
+
+    if (isValid && header->headerSize >= FILE_BLOCK_HEADER_SIZE)
+    {
+        // Newer versions may append fields to the header
+        isValid = fread(&raw[FILE_BLOCK_V1_HEADER_SIZE], 1, SUMMARY_SIZE, file) == SUMMARY_SIZE &&
+                  (header->headerSize == FILE_BLOCK_HEADER_SIZE ||
+                   fseek(file, header->headerSize - FILE_BLOCK_HEADER_SIZE, SEEK_CUR) == 0);
+        readSummary(&raw[FILE_BLOCK_V1_HEADER_SIZE], &header->summary);
+    }
+    else if (isValid)
+    {
+        isValid = (header->headerSize == FILE_BLOCK_V1_HEADER_SIZE ||
+                   fseek(file, header->headerSize - FILE_BLOCK_V1_HEADER_SIZE, SEEK_CUR) == 0);
+        fullSummary(&header->summary);
+    }
+
+    return isValid;
+}
+
+bool readFileBlock(FILE* const file, FileBlockHeader* const header, uint8_t* const text, const size_t capacity)
+{
+    bool isValid = readBlockHeader(file, header) && header->rawSize <= capacity;
+
+    if (isValid && (header->flags & FILE_BLOCK_COMPRESSED) != 0)
+    {
+        uint8_t* const compressed = malloc(header->storedSize);
+
+        isValid = compressed != NULL && fread(compressed, 1, header->storedSize, file) == header->storedSize &&
+                  logDecompress(compressed, header->storedSize, text, header->rawSize) == LOG_OK;
+        free(compressed);
+    }
+    else if (isValid)
+    {
+        isValid = header->storedSize == header->rawSize && fread(text, 1, header->rawSize, file) == header->rawSize;
+    }
+
+    return isValid && checksum(text, header->rawSize) == header->checksum;
+}
+
+static bool addIndexEntry(FileIndex* const index, uint32_t* const capacity, const FileBlockIndex* const entry)
+{
+    if (index->nbBlocks == *capacity)
+    {
+        FileBlockIndex* const blocks = realloc(index->blocks, (*capacity * 2 + 16) * sizeof(FileBlockIndex));
+
+        if (blocks == NULL)
+        {
+            return false;
+        }
+        index->blocks = blocks;
+        *capacity = *capacity * 2 + 16;
+    }
+
+    index->blocks[index->nbBlocks++] = *entry;
+    return true;
+}
+
+/**
+ * Load the index pointed to by the trailer of the file.
+ */
+static LogResult loadIndex(FileIndex* const index)
+{
+    LogResult returnCode = LOG_INVALID_PARAMETER;
+    uint8_t raw[FILE_INDEX_ENTRY_SIZE];
+    uint32_t i;
+
+    if (fseek(index->file, -FILE_TRAILER_SIZE, SEEK_END) == 0 && fread(raw, 1, FILE_TRAILER_SIZE, index->file) == FILE_TRAILER_SIZE &&
+        memcmp(raw, FILE_TRAILER_MAGIC, 4) == 0)
+    {
+        const uint32_t nbBlocks = readLE32(&raw[4]);
+        const uint64_t offset = readLE64(&raw[8]);
+
+        if (fseek(index->file, (long) offset, SEEK_SET) == 0 && fread(raw, 1, INDEX_HEADER_SIZE, index->file) == INDEX_HEADER_SIZE &&
+            memcmp(raw, FILE_INDEX_MAGIC, 4) == 0 && readLE32(&raw[4]) == nbBlocks)
+        {
+            index->blocks = malloc((nbBlocks > 0 ? nbBlocks : 1) * sizeof(FileBlockIndex));
+            returnCode = (index->blocks != NULL) ? LOG_OK : LOG_OUT_OF_MEMORY;
+
+            for (i = 0; returnCode == LOG_OK && i < nbBlocks; i++)
+            {
+                if (fread(raw, 1, FILE_INDEX_ENTRY_SIZE, index->file) == FILE_INDEX_ENTRY_SIZE)
+                {
+                    index->blocks[i].offset = readLE64(raw);
+                    readSummary(&raw[8], &index->blocks[i].summary);
+                }
+                else
+                {
+                    returnCode = LOG_INVALID_PARAMETER;
+                }
+            }
+            index->nbBlocks = (returnCode == LOG_OK) ? nbBlocks : 0;
+        }
+    }
+
+    return returnCode;
+}
+
+/**
+ * Rebuild the index from the block headers, for files that were not closed properly or that were appended to.
+ */
+static LogResult scanIndex(FileIndex* const index)
+{
+    LogResult returnCode = LOG_OK;
+    FileBlockHeader header;
+    FileBlockIndex entry;
+    uint32_t capacity = 0;
+    long offset = 0;
+
+    free(index->blocks);
+    index->blocks = NULL;
+    index->nbBlocks = 0;
+
+    bool isValid = fseek(index->file, 0, SEEK_SET) == 0;
+    while (isValid && returnCode == LOG_OK)
+    {
+        isValid = readBlockHeader(index->file, &header);
+        if (isValid)
+        {
+            // Indexes are skipped by readBlockHeader, the block starts right before its header
+            offset = ftell(index->file) - (long) header.headerSize;
+            entry.offset = (uint64_t) offset;
+            entry.summary = header.summary;
+            isValid = fseek(index->file, (long) header.storedSize, SEEK_CUR) == 0;
+            returnCode = addIndexEntry(index, &capacity, &entry) ? LOG_OK : LOG_OUT_OF_MEMORY;
+        }
+    }
+
+    return returnCode;
+}
+
+/**
+ * Whether blocks were written before the ones covered by the index (i.e. the file was appended to).
+ */
+static bool isIndexPartial(const FileIndex* const index)
+{
+    return index->nbBlocks == 0 || index->blocks[0].offset != 0;
+}
+
+LogResult openFileIndex(FILE* const file, FileIndex* const index)
+{
+    LogResult returnCode = LOG_INVALID_PARAMETER;
+    uint32_t i;
+
+    if (file != NULL && index != NULL)
+    {
+        memset(index, 0, sizeof(FileIndex));
+        index->file = file;
+
+        // The trailer only covers the blocks of the last run of the logger, scan when earlier runs wrote blocks too
+        returnCode = loadIndex(index);
+        if (returnCode != LOG_OUT_OF_MEMORY && (returnCode != LOG_OK || isIndexPartial(index)))
+        {
+            returnCode = scanIndex(index);
+        }
+
+        if (returnCode == LOG_OK && index->nbBlocks > 0)
+        {
+            index->latestUpTo = malloc(index->nbBlocks * sizeof(uint64_t));
+            index->earliestFrom = malloc(index->nbBlocks * sizeof(uint64_t));
+            returnCode = (index->latestUpTo != NULL && index->earliestFrom != NULL) ? LOG_OK : LOG_OUT_OF_MEMORY;
+        }
+
+        // Timestamps are not strictly ordered between blocks, searches rely on these monotonic bounds instead
+        for (i = 0; returnCode == LOG_OK && i < index->nbBlocks; i++)
+        {
+            const uint64_t latest = index->blocks[i].summary.maxTimestamp;
+            const uint64_t earliest = index->blocks[index->nbBlocks - 1 - i].summary.minTimestamp;
+
+            index->latestUpTo[i] = (i > 0 && index->latestUpTo[i - 1] > latest) ? index->latestUpTo[i - 1] : latest;
+            index->earliestFrom[index->nbBlocks - 1 - i] =
+                (i > 0 && index->earliestFrom[index->nbBlocks - i] < earliest) ? index->earliestFrom[index->nbBlocks - i] : earliest;
+        }
+
+        if (returnCode != LOG_OK)
+        {
+            closeFileIndex(index);
+        }
+    }
+
+    return returnCode;
+}
+
+void closeFileIndex(FileIndex* const index)
+{
+    if (index != NULL)
+    {
+        free(index->blocks);
+        free(index->latestUpTo);
+        free(index->earliestFrom);
+        index->blocks = NULL;
+        index->latestUpTo = NULL;
+        index->earliestFrom = NULL;
+        index->nbBlocks = 0;
+    }
+}
+
+static bool isBlockMatching(const FileBlockSummary* const summary, const FileQuery* const query)
+{
+    unsigned int bit = (query->category < FILE_BLOCK_OTHER_CATEGORY) ? (unsigned int) query->category : FILE_BLOCK_OTHER_CATEGORY;
+
+    return summary->minTimestamp <= query->to && summary->maxTimestamp >= query->from && summary->minLevel <= query->level &&
+           (query->category < 0 || (summary->categories[bit / 8] & (1u << (bit % 8))) != 0);
+}
+
+uint32_t findFileBlock(const FileIndex* const index, const FileQuery* const query, const uint32_t start)
+{
+    uint32_t low = start;
+    uint32_t high = index->nbBlocks;
+
+    // First block that may hold records at or after the start of the query
+    while (low < high)
+    {
+        const uint32_t middle = low + (high - low) / 2;
+        if (index->latestUpTo[middle] < query->from)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    while (low < index->nbBlocks && index->earliestFrom[low] <= query->to && !isBlockMatching(&index->blocks[low].summary, query))
+    {
+        low++;
+    }
+
+    return (low < index->nbBlocks && index->earliestFrom[low] <= query->to) ? low : index->nbBlocks;
+}
+
+bool readIndexedBlock(const FileIndex* const index, const uint32_t block, FileBlockHeader* const header, uint8_t* const text, const size_t capacity)
+{
+    return block < index->nbBlocks && fseek(index->file, (long) index->blocks[block].offset, SEEK_SET) == 0 &&
+           readFileBlock(index->file, header, text, capacity);
+}
@@ -0,0 +1,92 @@
+/**
+ * @file
+ *
+ * Formatting of records as text lines, shared by the loggers
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "slf4ec/slf4ecCtrl.h"
+#include "slf4ec/logContext.h"
+#include "../slf4ecPrivate.h"
+
+size_t logFormatLine(char* const buffer, const size_t capacity, const LogRecordV2* const record, const LogFormat format)
+{
+    int prefixLength = 0;
+
+    if (format != FORMAT_MSG_ONLY)
+    {
+        char context[LOG_CONTEXT_MAX_LENGTH] = "";
+
+        if (format == FORMAT_CONTEXT && (record->flags & LOG_RECORD_HAS_CONTEXT) != 0)
+        {
+            (void) logFormatContext(context, sizeof(context), record->context);
+        }
+
+        if ((record->flags & LOG_RECORD_HAS_LOCATION) == 0)
+        {
+            prefixLength = snprintf(buffer, capacity, "[%s][%s][%" PRIu64 "]%s - ", logLevelNames[record->level],
+                                    record->category->name, record->timestamp, context);
+        }
+        else
+        {
+            const size_t fileLength = strlen(record->file);
+            const size_t fctLength = strlen(record->function);
+
+            prefixLength = snprintf(buffer, capacity, "[%s][%s][%" PRIu64 "]%s%s:%" PRIu32 "(%s) - ",
+                                    logLevelNames[record->level], record->category->name, record->timestamp, context,
+                                    record->file + (fileLength > MAX_FILE_LENGTH ? (fileLength - MAX_FILE_LENGTH) : 0),
+                                    record->line,
+                                    record->function + (fctLength > MAX_FCT_LENGHT ? (fctLength - MAX_FCT_LENGHT) : 0));
+        }
+    }
+
+    const size_t prefix = (prefixLength > 0) ? (size_t) prefixLength : 0;
+    const size_t offset = (prefix < capacity) ? prefix : capacity;
+
+    // Other loggers use the same arguments, do not consume them
+    va_list args;
+    va_copy(args, *record->vaList);
+    const int msgLength = vsnprintf(buffer + offset, capacity - offset, record->formatStr, args);
+    va_end(args);
+
+    const size_t length = prefix + ((msgLength > 0) ? (size_t) msgLength : 0);
+
+    // Replace the terminating character by the new line
+    if (length < capacity)
+    {
+        buffer[length] = '\n';
+    }
+
+    return length + 1;
+}
@@ -0,0 +1,447 @@
+/**
+ * @file
+ *
+ * Logger writing to a shared memory ring, drained by a collector process
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "slf4ec/slf4ecCtrl.h"
+#include "slf4ec/logger/shm.h"
+#include "../slf4ecPrivate.h"
+
+#ifdef LOG_HAS_THREADS
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef USE_LOG_STATS
+#define REPORT_BYTES(nbBytes) logReportBytes((size_t)(nbBytes))
+#else
+#define REPORT_BYTES(nbBytes) (void)(nbBytes)
+#endif
+
+#define ENTRY_COMMITTED (0x80000000u) /**< The entry can be read */
+#define ENTRY_PADDING (0x40000000u)   /**< The entry fills the end of the data area, its size includes the header */
+#define ENTRY_SIZE_MASK (0x3FFFFFFFu) /**< Length of the text, or size of the padding */
+#define ENTRY_HEADER_SIZE (4u)
+#define ENTRY_ALIGNMENT (8u)
+
+/**
+ * Header of a ring, shared between the producer and the reader. Positions only grow, their offset in the data area
+ * being the position modulo the capacity. Each side writes its own cache line.
+ */
+typedef struct
+{
+    uint32_t magic;    /**< ::SHM_RING_MAGIC, set last */
+    uint32_t version;  /**< ::SHM_RING_VERSION */
+    uint32_t capacity; /**< Size of the data area */
+    uint32_t pid;      /**< Process writing to the ring */
+    uint64_t dropped;  /**< Records dropped because the ring was full, or skipped by the reader */
+    uint8_t reserved0[40];
+    uint64_t tail; /**< Position up to which producers claimed space */
+    uint8_t reserved1[56];
+    uint64_t head; /**< Position up to which the reader released space */
+    uint8_t reserved2[120];
+} RingHeader;
+
+_Static_assert(sizeof(RingHeader) == SHM_RING_HEADER_SIZE, "Ring header does not match SHM_RING_HEADER_SIZE");
+
+/**
+ * State of the shared memory logger
+ */
+typedef struct
+{
+    RingHeader* ring;
+    size_t size; /**< Size of the mapping */
+    LogResult status;
+} ShmLogger;
+
+static ShmLogger shmLogger = {NULL, 0, LOG_NOT_INITIALIZED};
+
+static inline uint32_t entrySize(const uint32_t length)
+{
+    return (ENTRY_HEADER_SIZE + length + ENTRY_ALIGNMENT - 1) & ~(ENTRY_ALIGNMENT - 1);
+}
+
+static inline uint8_t* ringData(RingHeader* const ring)
+{
+    return (uint8_t*) ring + SHM_RING_HEADER_SIZE;
+}
+
+static inline uint32_t* entryAt(RingHeader* const ring, const uint64_t position)
+{
+    return (uint32_t*) &ringData(ring)[position & (ring->capacity - 1)];
+}
+
+static bool isValidCapacity(const uint32_t capacity)
+{
+    return capacity >= SHM_MIN_CAPACITY && capacity <= SHM_MAX_CAPACITY && (capacity & (capacity - 1)) == 0;
+}
+
+#ifdef LOG_HAS_THREADS
+/**
+ * Create the shared memory of a ring. A ring left with the same name is replaced.
+ */
+static RingHeader* createRing(const char* const name, const size_t size)
+{
+    void* mapping = MAP_FAILED;
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+
+    if (fd < 0 && errno == EEXIST)
+    {
+        (void) shm_unlink(name);
+        fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    }
+
+    if (fd >= 0)
+    {
+        if (ftruncate(fd, (off_t) size) == 0)
+        {
+            mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        (void) close(fd);
+        if (mapping == MAP_FAILED)
+        {
+            (void) shm_unlink(name);
+        }
+    }
+
+    return (mapping != MAP_FAILED) ? (RingHeader*) mapping : NULL;
+}
+#endif
+
+void initShmLogger(const void* const param)
+{
+    const ShmLoggerConfig* const config = (const ShmLoggerConfig*) param;
+
+    if (shmLogger.ring != NULL)
+    {
+        return;
+    }
+
+    const uint32_t capacity = (config != NULL && config->capacity != 0) ? config->capacity : SHM_DEFAULT_CAPACITY;
+
+    if (config == NULL || !isValidCapacity(capacity) ||
+        (config->name != NULL && (config->name[0] != '/' || strlen(config->name) >= SHM_RING_NAME_LENGTH)))
+    {
+        shmLogger.status = LOG_INVALID_PARAMETER;
+        return;
+    }
+
+#ifdef LOG_HAS_THREADS
+    char name[SHM_RING_NAME_LENGTH];
+    const size_t size = SHM_RING_HEADER_SIZE + capacity;
+    uint32_t magic;
+
+    if (config->name != NULL)
+    {
+        strcpy(name, config->name);
+    }
+    else
+    {
+        (void) snprintf(name, sizeof(name), SHM_RING_PREFIX "%ld", (long) getpid());
+    }
+
+    // The shared memory starts zeroed: the ring is empty
+    RingHeader* const ring = createRing(name, size);
+    if (ring == NULL)
+    {
+        shmLogger.status = LOG_NOT_INITIALIZED;
+        return;
+    }
+
+    ring->version = SHM_RING_VERSION;
+    ring->capacity = capacity;
+    ring->pid = (uint32_t) getpid();
+    memcpy(&magic, SHM_RING_MAGIC, sizeof(magic));
+    LOG_ATOMIC_STORE_RELEASE(ring->magic, magic);
+
+    shmLogger.size = size;
+    shmLogger.ring = ring;
+    shmLogger.status = LOG_OK;
+#else
+    shmLogger.status = LOG_INVALID_PARAMETER;
+#endif
+}
+
+void logToShm(const LogRecord* const logRecord, const LogFormat format)
+{
+    LogRecordV2 record;
+
+    logRecordToV2(logRecord, &record);
+    logToShmV2(&record, format);
+}
+
+void logToShmV2(const LogRecordV2* const logRecord, const LogFormat format)
+{
+    RingHeader* const ring = shmLogger.ring;
+    char text[SHM_MAX_RECORD_SIZE];
+    uint32_t padding;
+
+    if (ring == NULL)
+    {
+        return;
+    }
+
+    size_t length = logFormatLine(text, sizeof(text), logRecord, format);
+    if (length >= sizeof(text))
+    {
+        // Truncated, still ends the line
+        length = sizeof(text);
+        text[length - 1] = '\n';
+    }
+
+    const uint32_t size = entrySize((uint32_t) length);
+    uint64_t tail = LOG_ATOMIC_LOAD(ring->tail);
+
+    for (;;)
+    {
+        const uint32_t offset = (uint32_t)(tail & (ring->capacity - 1));
+
+        padding = (offset + size > ring->capacity) ? ring->capacity - offset : 0;
+        if (tail + padding + size - LOG_ATOMIC_LOAD_ACQUIRE(ring->head) > ring->capacity)
+        {
+            LOG_ATOMIC_ADD(ring->dropped, 1);
+            return;
+        }
+        if (LOG_ATOMIC_CAS(ring->tail, tail, tail + padding + size))
+        {
+            break;
+        }
+        // tail was refreshed by the failed compare and swap
+    }
+
+    if (padding > 0)
+    {
+        LOG_ATOMIC_STORE_RELEASE(*entryAt(ring, tail), ENTRY_COMMITTED | ENTRY_PADDING | padding);
+    }
+
+    // Sized first, so the reader can skip the entry if this process dies before committing it
+    uint32_t* const entry = entryAt(ring, tail + padding);
+    LOG_ATOMIC_STORE(*entry, (uint32_t) length);
+    memcpy(&entry[1], text, length);
+    LOG_ATOMIC_STORE_RELEASE(*entry, ENTRY_COMMITTED | (uint32_t) length);
+
+    REPORT_BYTES(length);
+}
+
+LogResult getShmLoggerStatus(void)
+{
+    return shmLogger.status;
+}
+
+void closeShmLogger(void)
+{
+    RingHeader* const ring = shmLogger.ring;
+
+    shmLogger.ring = NULL;
+    shmLogger.status = LOG_NOT_INITIALIZED;
+#ifdef LOG_HAS_THREADS
+    if (ring != NULL)
+    {
+        (void) munmap(ring, shmLogger.size);
+    }
+#else
+    (void) ring;
+#endif
+}
+
+/*
+ ************************************************************
+ * Reader
+ ************************************************************
+ */
+
+LogResult openShmRing(const char* const name, ShmRing* const ring)
+{
+    LogResult returnCode = LOG_INVALID_PARAMETER;
+
+    if (name == NULL || ring == NULL || name[0] != '/' || strlen(name) >= SHM_RING_NAME_LENGTH)
+    {
+        return returnCode;
+    }
+
+#ifdef LOG_HAS_THREADS
+    struct stat status;
+    const int fd = shm_open(name, O_RDWR, 0);
+
+    returnCode = LOG_NOT_INITIALIZED;
+    if (fd >= 0)
+    {
+        void* mapping = MAP_FAILED;
+
+        if (fstat(fd, &status) == 0 && status.st_size >= (off_t)(SHM_RING_HEADER_SIZE + SHM_MIN_CAPACITY))
+        {
+            mapping = mmap(NULL, (size_t) status.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        (void) close(fd);
+
+        if (mapping != MAP_FAILED)
+        {
+            RingHeader* const header = (RingHeader*) mapping;
+            const uint32_t magic = LOG_ATOMIC_LOAD_ACQUIRE(header->magic);
+
+            if (memcmp(&magic, SHM_RING_MAGIC, sizeof(magic)) != 0)
+            {
+                // Still being created, or not a ring
+                (void) munmap(mapping, (size_t) status.st_size);
+            }
+            else if (header->version != SHM_RING_VERSION || !isValidCapacity(header->capacity) ||
+                     SHM_RING_HEADER_SIZE + (off_t) header->capacity != status.st_size)
+            {
+                (void) munmap(mapping, (size_t) status.st_size);
+                returnCode = LOG_INVALID_PARAMETER;
+            }
+            else
+            {
+                strcpy(ring->name, name);
+                ring->header = mapping;
+                ring->size = (size_t) status.st_size;
+                returnCode = LOG_OK;
+            }
+        }
+    }
+#endif
+
+    return returnCode;
+}
+
+bool isShmRingOrphaned(const ShmRing* const ring)
+{
+#ifdef LOG_HAS_THREADS
+    const RingHeader* const header = (const RingHeader*) ring->header;
+
+    return kill((pid_t) header->pid, 0) != 0 && errno == ESRCH;
+#else
+    (void) ring;
+    return false;
+#endif
+}
+
+/**
+ * Zero the space of consumed entries, so their headers read as not committed once reused.
+ */
+static void clearRange(RingHeader* const header, uint64_t from, const uint64_t to)
+{
+    while (from < to)
+    {
+        const uint32_t offset = (uint32_t)(from & (header->capacity - 1));
+        const uint64_t contiguous = header->capacity - offset;
+        const uint64_t length = (to - from < contiguous) ? to - from : contiguous;
+
+        memset(&ringData(header)[offset], 0, (size_t) length);
+        from += length;
+    }
+}
+
+size_t readShmRing(ShmRing* const ring, char* const buffer, const size_t capacity)
+{
+    RingHeader* const header = (RingHeader*) ring->header;
+    const uint64_t start = LOG_ATOMIC_LOAD(header->head);
+    const uint64_t tail = LOG_ATOMIC_LOAD_ACQUIRE(header->tail);
+    uint64_t head = start;
+    size_t copied = 0;
+
+    while (head != tail)
+    {
+        uint32_t* const entry = entryAt(header, head);
+        const uint32_t value = LOG_ATOMIC_LOAD_ACQUIRE(*entry);
+        const uint32_t length = value & ENTRY_SIZE_MASK;
+
+        if ((value & ENTRY_COMMITTED) == 0)
+        {
+            // Still being written. Only skipped once its producer is gone.
+            if (!isShmRingOrphaned(ring))
+            {
+                break;
+            }
+
+            LOG_ATOMIC_ADD(header->dropped, 1);
+            if (length == 0)
+            {
+                // Died before sizing the entry: the entries after it cannot be found
+                head = tail;
+                break;
+            }
+            head += entrySize(length);
+        }
+        else if ((value & ENTRY_PADDING) != 0)
+        {
+            head += length;
+        }
+        else if (copied + length <= capacity)
+        {
+            memcpy(&buffer[copied], &entry[1], length);
+            copied += length;
+            head += entrySize(length);
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if (head != start)
+    {
+        clearRange(header, start, head);
+        LOG_ATOMIC_STORE_RELEASE(header->head, head);
+    }
+
+    return copied;
+}
+
+uint64_t getShmRingDropped(const ShmRing* const ring)
+{
+    const RingHeader* const header = (const RingHeader*) ring->header;
+
+    return LOG_ATOMIC_LOAD(header->dropped);
+}
+
+void closeShmRing(ShmRing* const ring, const bool remove)
+{
+#ifdef LOG_HAS_THREADS
+    RingHeader* const header = (RingHeader*) ring->header;
+
+    if (remove && isShmRingOrphaned(ring) && LOG_ATOMIC_LOAD(header->head) == LOG_ATOMIC_LOAD(header->tail))
+    {
+        (void) shm_unlink(ring->name);
+    }
+    (void) munmap(ring->header, ring->size);
+#else
+    (void) remove;
+#endif
+    ring->header = NULL;
+}
@@ -41,16 +41,23 @@
 #endif
 
 #include "slf4ec/slf4ecCtrl.h"
+#include "slf4ec/logContext.h"
 #include "slf4ec/logger/stdout.h"
 
-static void logFull(const LogRecord* const logRecord);
-static void logMsgOnly(const LogRecord* const logRecord);
+static void logFull(const LogRecordV2* const logRecord, const LogFormat format);
+static void logMsgOnly(const LogRecordV2* const logRecord);
 
-#define PRINTF_WITH_LOCATION "[%s][%s][%" PRIu64 "]%s:%" PRIu32 "(%s) - ", logLevelNames[*record->level], record->category->name, *record->timestamp, \
-                             record->file + (fileLength > MAX_FILE_LENGTH ? (fileLength - MAX_FILE_LENGTH) : 0), *record->line,                       \
+#define PRINTF_WITH_LOCATION "[%s][%s][%" PRIu64 "]%s%s:%" PRIu32 "(%s) - ", logLevelNames[record->level], record->category->name, record->timestamp, context, \
+                             record->file + (fileLength > MAX_FILE_LENGTH ? (fileLength - MAX_FILE_LENGTH) : 0), record->line,                                 \
                              record->function + (fctLength > MAX_FCT_LENGHT ? (fctLength - MAX_FCT_LENGHT) : 0)
-#define PRINTF_WITHOUT_LOCATION "[%s][%s][%" PRIu64 "] - ", logLevelNames[*record->level], record->category->name, *record->timestamp
-#define VPRINTF record->formatStr, *record->vaList
+#define PRINTF_WITHOUT_LOCATION "[%s][%s][%" PRIu64 "]%s - ", logLevelNames[record->level], record->category->name, record->timestamp, context
+#define VPRINTF record->formatStr, args
+
+#ifdef USE_LOG_STATS
+#define REPORT_BYTES(nbBytes) logReportBytes((size_t)(nbBytes))
+#else
+#define REPORT_BYTES(nbBytes) (void)(nbBytes)
+#endif
 
 void initStdOut(const void* const param)
 {
@@ -59,6 +66,14 @@ void initStdOut(const void* const param)
 }
 
 void logToStdOut(const LogRecord* const logRecord, const LogFormat format)
+{
+    LogRecordV2 record;
+
+    logRecordToV2(logRecord, &record);
+    logToStdOutV2(&record, format);
+}
+
+void logToStdOutV2(const LogRecordV2* const logRecord, const LogFormat format)
 {
     switch (format)
     {
@@ -66,14 +81,19 @@ void logToStdOut(const LogRecord* const logRecord, const LogFormat format)
             logMsgOnly(logRecord);
             break;
         case FORMAT_FULL:
+        case FORMAT_CONTEXT:
         default:
-            logFull(logRecord);
+            logFull(logRecord, format);
             break;
     }
 }
 
-static void logMsgOnly(const LogRecord* const record)
+static void logMsgOnly(const LogRecordV2* const record)
 {
+    // Other loggers use the same arguments, do not consume them
+    va_list args;
+    va_copy(args, *record->vaList);
+
 #ifdef UNIT_TESTING
     char suffixMsg[4096] = {0};
     char fullMsg[8192] = {0};
@@ -83,16 +103,28 @@ static void logMsgOnly(const LogRecord* const record)
     strcat(fullMsg, "\n");
 
     outputMessage(fullMsg);
+    REPORT_BYTES(strlen(fullMsg));
 #else
-    vprintf(VPRINTF);
-    printf("\n");
+    int nbBytes = vprintf(VPRINTF);
+    nbBytes += printf("\n");
+    REPORT_BYTES(nbBytes);
 #endif
+    va_end(args);
 }
 
 // SONAR cannot parse this function
-static void logFull(const LogRecord* const record)
+static void logFull(const LogRecordV2* const record, const LogFormat format)
 {
-    if (record->file == NULL || record->line == NULL || record->function == NULL)
+    char context[LOG_CONTEXT_MAX_LENGTH] = "";
+    va_list args;
+    va_copy(args, *record->vaList);
+
+    if (format == FORMAT_CONTEXT && (record->flags & LOG_RECORD_HAS_CONTEXT) != 0)
+    {
+        (void) logFormatContext(context, sizeof(context), record->context);
+    }
+
+    if ((record->flags & LOG_RECORD_HAS_LOCATION) == 0)
     {
 #ifdef UNIT_TESTING
         char suffixMsg[4096] = {0};
@@ -104,10 +136,12 @@ static void logFull(const LogRecord* const record)
         strcat(fullMsg, "\n");
 
         outputMessage(fullMsg);
+        REPORT_BYTES(strlen(fullMsg));
 #else
-        printf(PRINTF_WITHOUT_LOCATION);
-        vprintf(VPRINTF);
-        printf("\n");
+        int nbBytes = printf(PRINTF_WITHOUT_LOCATION);
+        nbBytes += vprintf(VPRINTF);
+        nbBytes += printf("\n");
+        REPORT_BYTES(nbBytes);
 #endif
     }
     else
@@ -125,10 +159,13 @@ static void logFull(const LogRecord* const record)
         strcat(fullMsg, "\n");
 
         outputMessage(fullMsg);
+        REPORT_BYTES(strlen(fullMsg));
 #else
-        printf(PRINTF_WITH_LOCATION);
-        vprintf(VPRINTF);
-        printf("\n");
+        int nbBytes = printf(PRINTF_WITH_LOCATION);
+        nbBytes += vprintf(VPRINTF);
+        nbBytes += printf("\n");
+        REPORT_BYTES(nbBytes);
 #endif
     }
+    va_end(args);
 }
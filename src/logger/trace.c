@@ -0,0 +1,244 @@
+/**
+ * @file
+ *
+ * Logger writing records as Chrome trace events
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "slf4ec/slf4ecCtrl.h"
+#include "slf4ec/logger/trace.h"
+#include "../slf4ecPrivate.h"
+
+#ifdef __unix__
+#include <unistd.h>
+#endif
+
+#ifdef USE_LOG_STATS
+#define REPORT_BYTES(nbBytes) logReportBytes((size_t)(nbBytes))
+#else
+#define REPORT_BYTES(nbBytes) (void)(nbBytes)
+#endif
+
+// Leaves enough room for the other fields of an event
+#define MAX_NAME_LENGTH (TRACE_MAX_EVENT_SIZE / 2) /**< Longest name of an event, once escaped */
+#define MAX_CATEGORY_LENGTH (128)                  /**< Longest category of an event, once escaped */
+
+/**
+ * State of the trace logger
+ */
+typedef struct
+{
+    FILE* file;
+    uint64_t unitsPerSecond;
+    uint32_t pid;
+    LogResult status;
+} TraceLogger;
+
+static TraceLogger traceLogger = {NULL, TRACE_DEFAULT_UNITS_PER_SECOND, 0, LOG_NOT_INITIALIZED};
+
+/**
+ * Copy a string as the content of a JSON string, truncated to whole characters.
+ *
+ * @return Length of the escaped string, excluding the terminating character
+ */
+static size_t escapeJson(char* const buffer, const size_t capacity, const char* text)
+{
+    size_t length = 0;
+
+    for (; *text != '\0'; text++)
+    {
+        const unsigned char c = (unsigned char) *text;
+        char escaped[8];
+        size_t size = 1;
+
+        escaped[0] = (char) c;
+        if (c == '"' || c == '\\')
+        {
+            escaped[0] = '\\';
+            escaped[1] = (char) c;
+            size = 2;
+        }
+        else if (c < 0x20)
+        {
+            size = (size_t) snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+        }
+
+        if (length + size >= capacity)
+        {
+            break;
+        }
+        memcpy(&buffer[length], escaped, size);
+        length += size;
+    }
+    buffer[length] = '\0';
+
+    return length;
+}
+
+/**
+ * Write a timestamp in microseconds, keeping nanoseconds as decimals.
+ */
+static int formatTimestamp(char* const buffer, const size_t capacity, const uint64_t timestamp)
+{
+    const uint64_t unitsPerSecond = traceLogger.unitsPerSecond;
+    const uint64_t remainder = timestamp % unitsPerSecond;
+    const uint64_t micros = (timestamp / unitsPerSecond) * 1000000u + (remainder * 1000000u) / unitsPerSecond;
+    const uint64_t nanos = (((remainder * 1000000u) % unitsPerSecond) * 1000u) / unitsPerSecond;
+
+    return snprintf(buffer, capacity, "%" PRIu64 ".%03" PRIu64, micros, nanos);
+}
+
+static void writeEvent(const char* const event, const size_t length)
+{
+    FILE* const file = traceLogger.file;
+
+    // A single write per event so events of concurrent threads do not interleave
+    if (file != NULL && fwrite(event, 1, length, file) == length)
+    {
+        REPORT_BYTES(length);
+    }
+}
+
+void initTraceLogger(const void* const param)
+{
+    const TraceLoggerConfig* const config = (const TraceLoggerConfig*) param;
+    char event[TRACE_MAX_EVENT_SIZE];
+
+    if (traceLogger.file != NULL)
+    {
+        return;
+    }
+
+    if (config == NULL || config->path == NULL)
+    {
+        traceLogger.status = LOG_INVALID_PARAMETER;
+        return;
+    }
+
+    FILE* const file = fopen(config->path, "w");
+    if (file == NULL)
+    {
+        traceLogger.status = LOG_NOT_INITIALIZED;
+        return;
+    }
+
+    traceLogger.unitsPerSecond = (config->unitsPerSecond != 0) ? config->unitsPerSecond : TRACE_DEFAULT_UNITS_PER_SECOND;
+#ifdef __unix__
+    traceLogger.pid = (uint32_t) getpid();
+#else
+    traceLogger.pid = 1;
+#endif
+
+    // Every event written afterwards starts with a comma
+    const int length = snprintf(event, sizeof(event), "[{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%" PRIu32 ",\"args\":{\"name\":\"slf4ec\"}}",
+                                traceLogger.pid);
+    (void) fwrite(event, 1, (size_t) length, file);
+
+    traceLogger.file = file;
+    traceLogger.status = LOG_OK;
+}
+
+void logToTrace(const LogRecord* const logRecord, const LogFormat format)
+{
+    LogRecordV2 record;
+
+    logRecordToV2(logRecord, &record);
+    logToTraceV2(&record, format);
+}
+
+void logToTraceV2(const LogRecordV2* const logRecord, const LogFormat format)
+{
+    char event[TRACE_MAX_EVENT_SIZE];
+    char name[MAX_NAME_LENGTH];
+    char category[MAX_CATEGORY_LENGTH];
+    char timestamp[32];
+    const char* phase;
+    uint32_t threadId;
+    va_list args;
+
+    (void) format;
+    if (traceLogger.file == NULL)
+    {
+        return;
+    }
+
+    va_copy(args, *logRecord->vaList);
+    if ((logRecord->flags & (LOG_RECORD_SPAN_BEGIN | LOG_RECORD_SPAN_END)) != 0)
+    {
+        // Arguments of LOG_SPAN_BEGIN_FORMAT and LOG_SPAN_END_FORMAT, the span being drawn on the thread that began it
+        const char* const spanName = va_arg(args, const char*);
+
+        threadId = va_arg(args, uint32_t);
+        phase = ((logRecord->flags & LOG_RECORD_SPAN_BEGIN) != 0) ? "\"ph\":\"B\"" : "\"ph\":\"E\"";
+        (void) escapeJson(name, sizeof(name), spanName);
+    }
+    else
+    {
+        char message[MAX_NAME_LENGTH];
+
+        threadId = ((logRecord->flags & LOG_RECORD_HAS_CONTEXT) != 0) ? logRecord->context->threadId : logThreadId();
+        phase = "\"ph\":\"i\",\"s\":\"t\"";
+        (void) vsnprintf(message, sizeof(message), logRecord->formatStr, args);
+        (void) escapeJson(name, sizeof(name), message);
+    }
+    va_end(args);
+
+    (void) escapeJson(category, sizeof(category), logRecord->category->name);
+    (void) formatTimestamp(timestamp, sizeof(timestamp), logRecord->timestamp);
+
+    const int length = snprintf(event, sizeof(event), ",\n{\"name\":\"%s\",\"cat\":\"%s\",%s,\"ts\":%s,\"pid\":%" PRIu32 ",\"tid\":%" PRIu32 "}",
+                                name, category, phase, timestamp, traceLogger.pid, threadId);
+    if (length > 0)
+    {
+        writeEvent(event, (size_t) length);
+    }
+}
+
+LogResult getTraceLoggerStatus(void)
+{
+    return traceLogger.status;
+}
+
+void closeTraceLogger(void)
+{
+    FILE* const file = traceLogger.file;
+
+    traceLogger.file = NULL;
+    traceLogger.status = LOG_NOT_INITIALIZED;
+    if (file != NULL)
+    {
+        (void) fputs("\n]\n", file);
+        (void) fclose(file);
+    }
+}
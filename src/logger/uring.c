@@ -0,0 +1,705 @@
+/**
+ * @file
+ *
+ * Logger appending text to a file through io_uring, falling back on pwrite
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "slf4ec/slf4ecCtrl.h"
+#include "slf4ec/logger/uring.h"
+#include "../slf4ecPrivate.h"
+
+#ifdef LOG_HAS_THREADS
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+// clang-format off
+#if __has_include(<linux/io_uring.h>)
+// clang-format on
+#define URING_SUPPORTED
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+#endif
+#endif
+
+#ifdef USE_LOG_STATS
+#define REPORT_BYTES(nbBytes) logReportBytes((size_t)(nbBytes))
+#else
+#define REPORT_BYTES(nbBytes) (void)(nbBytes)
+#endif
+
+#define BUFFER_ALIGNMENT (4096u)
+
+#ifdef URING_SUPPORTED
+/**
+ * Rings shared with the kernel. Only accessed with the logger locked.
+ */
+typedef struct
+{
+    int fd;
+    bool fixedBuffers; /**< Buffers are registered with the kernel */
+    uint32_t* sqHead;
+    uint32_t* sqTail;
+    uint32_t sqMask;
+    uint32_t* sqArray;
+    struct io_uring_sqe* sqes;
+    uint32_t* cqHead;
+    uint32_t* cqTail;
+    uint32_t cqMask;
+    struct io_uring_cqe* cqes;
+    void* sqRing;
+    size_t sqRingSize;
+    void* cqRing;
+    size_t cqRingSize;
+    size_t sqesSize;
+} Uring;
+#endif
+
+/**
+ * State of the io_uring file logger.
+ *
+ * Producers format records in the filling buffer. Once full, its write is submitted and producers move on to the
+ * next buffer, waiting for its previous write to complete if needed.
+ */
+typedef struct
+{
+    int fd;
+    LogResult status;
+    UringBackend backend;
+    uint8_t syncLevel;
+    uint8_t nbBuffers;
+    uint8_t filling; /**< Buffer being filled */
+    uint8_t nbInFlight;
+    size_t bufferSize;
+    uint8_t* memory;                     /**< All the buffers, one after the other */
+    size_t sizes[URING_MAX_BUFFERS];     /**< Bytes held by each buffer, until written */
+    uint64_t offsets[URING_MAX_BUFFERS]; /**< Where each buffer in flight is written */
+    bool inFlight[URING_MAX_BUFFERS];
+    uint64_t submitted; /**< Offset of the next write */
+    uint64_t durable;   /**< Offset up to which the file is synced */
+    bool syncing;       /**< A producer is syncing the file, without holding the lock */
+    uint32_t flushPeriod;
+#ifdef URING_SUPPORTED
+    Uring ring;
+#endif
+#ifdef LOG_HAS_THREADS
+    pthread_mutex_t lock;
+    pthread_cond_t syncDone;
+    pthread_cond_t flusherChanged; /**< Signaled with the logger locked to stop the flusher */
+    pthread_t flusher;
+    bool hasFlusher;
+    bool stopFlusher;
+#endif
+} UringLogger;
+
+static UringLogger uringLogger = {
+    .fd = -1,
+    .status = LOG_NOT_INITIALIZED,
+#ifdef URING_SUPPORTED
+    .ring.fd = -1,
+#endif
+#ifdef LOG_HAS_THREADS
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .syncDone = PTHREAD_COND_INITIALIZER,
+    .flusherChanged = PTHREAD_COND_INITIALIZER,
+#endif
+};
+
+void logToUring(const LogRecord* const logRecord, const LogFormat format)
+{
+    LogRecordV2 record;
+
+    logRecordToV2(logRecord, &record);
+    logToUringV2(&record, format);
+}
+
+LogResult getUringLoggerStatus(void)
+{
+    return uringLogger.status;
+}
+
+UringBackend getUringLoggerBackend(void)
+{
+    return uringLogger.backend;
+}
+
+#ifdef LOG_HAS_THREADS
+
+static inline uint8_t* bufferAt(const uint8_t buffer)
+{
+    return &uringLogger.memory[buffer * uringLogger.bufferSize];
+}
+
+static int syncFile(const int fd)
+{
+#ifdef __APPLE__
+    return fsync(fd);
+#else
+    return fdatasync(fd);
+#endif
+}
+
+/**
+ * Write synchronously. Errors are ignored, as with the file logger.
+ */
+static void writeAt(const uint8_t* data, size_t size, uint64_t offset)
+{
+    while (size > 0)
+    {
+        const ssize_t written = pwrite(uringLogger.fd, data, size, (off_t) offset);
+
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (written <= 0)
+        {
+            break;
+        }
+        data += written;
+        size -= (size_t) written;
+        offset += (uint64_t) written;
+    }
+}
+
+#ifdef URING_SUPPORTED
+static int uringSetup(const unsigned int entries, struct io_uring_params* const params)
+{
+    return (int) syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int uringEnter(const int fd, const unsigned int toSubmit, const unsigned int minComplete, const unsigned int flags)
+{
+    int result;
+
+    do
+    {
+        result = (int) syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, NULL, 0);
+    } while (result < 0 && errno == EINTR);
+
+    return result;
+}
+
+static void closeUring(Uring* const ring)
+{
+    if (ring->sqes != MAP_FAILED)
+    {
+        (void) munmap(ring->sqes, ring->sqesSize);
+    }
+    if (ring->cqRing != MAP_FAILED && ring->cqRing != ring->sqRing)
+    {
+        (void) munmap(ring->cqRing, ring->cqRingSize);
+    }
+    if (ring->sqRing != MAP_FAILED)
+    {
+        (void) munmap(ring->sqRing, ring->sqRingSize);
+    }
+    if (ring->fd >= 0)
+    {
+        (void) close(ring->fd);
+    }
+    ring->fd = -1;
+}
+
+/**
+ * Create the rings and register the buffers. Unregistered buffers are still written, with a copy by the kernel.
+ */
+static bool openUring(Uring* const ring)
+{
+    struct io_uring_params params;
+    struct iovec buffers[URING_MAX_BUFFERS];
+    uint8_t i;
+
+    memset(&params, 0, sizeof(params));
+    ring->sqRing = MAP_FAILED;
+    ring->cqRing = MAP_FAILED;
+    ring->sqes = MAP_FAILED;
+    // Never more writes in flight than buffers, the queues cannot overflow
+    ring->fd = uringSetup(uringLogger.nbBuffers, &params);
+    if (ring->fd < 0)
+    {
+        return false;
+    }
+
+    ring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    ring->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0)
+    {
+        ring->sqRingSize = (ring->cqRingSize > ring->sqRingSize) ? ring->cqRingSize : ring->sqRingSize;
+        ring->cqRingSize = ring->sqRingSize;
+    }
+
+    ring->sqRing = mmap(NULL, ring->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0)
+    {
+        ring->cqRing = ring->sqRing;
+    }
+    else
+    {
+        ring->cqRing = mmap(NULL, ring->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+    }
+    ring->sqes = mmap(NULL, ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqRing == MAP_FAILED || ring->cqRing == MAP_FAILED || ring->sqes == MAP_FAILED)
+    {
+        closeUring(ring);
+        return false;
+    }
+
+    ring->sqHead = (uint32_t*) ((uint8_t*) ring->sqRing + params.sq_off.head);
+    ring->sqTail = (uint32_t*) ((uint8_t*) ring->sqRing + params.sq_off.tail);
+    ring->sqMask = *(uint32_t*) ((uint8_t*) ring->sqRing + params.sq_off.ring_mask);
+    ring->sqArray = (uint32_t*) ((uint8_t*) ring->sqRing + params.sq_off.array);
+    ring->cqHead = (uint32_t*) ((uint8_t*) ring->cqRing + params.cq_off.head);
+    ring->cqTail = (uint32_t*) ((uint8_t*) ring->cqRing + params.cq_off.tail);
+    ring->cqMask = *(uint32_t*) ((uint8_t*) ring->cqRing + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*) ((uint8_t*) ring->cqRing + params.cq_off.cqes);
+
+    for (i = 0; i < uringLogger.nbBuffers; i++)
+    {
+        buffers[i].iov_base = bufferAt(i);
+        buffers[i].iov_len = uringLogger.bufferSize;
+    }
+    ring->fixedBuffers =
+        syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_BUFFERS, buffers, (unsigned int) uringLogger.nbBuffers) == 0;
+
+    return true;
+}
+
+/**
+ * Queue the write of a buffer and hand it to the kernel.
+ */
+static bool submitWrite(const uint8_t buffer)
+{
+    Uring* const ring = &uringLogger.ring;
+    const uint32_t tail = *ring->sqTail;
+    const uint32_t index = tail & ring->sqMask;
+    struct io_uring_sqe* const sqe = &ring->sqes[index];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = ring->fixedBuffers ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    sqe->fd = uringLogger.fd;
+    sqe->addr = (uint64_t)(uintptr_t) bufferAt(buffer);
+    sqe->len = (uint32_t) uringLogger.sizes[buffer];
+    sqe->off = uringLogger.offsets[buffer];
+    sqe->buf_index = buffer;
+    sqe->user_data = buffer;
+    ring->sqArray[index] = index;
+    LOG_ATOMIC_STORE_RELEASE(*ring->sqTail, tail + 1);
+
+    if (uringEnter(ring->fd, 1, 0, 0) == 1)
+    {
+        return true;
+    }
+
+    // Not consumed by the kernel, withdraw it so it is never written twice
+    if (LOG_ATOMIC_LOAD_ACQUIRE(*ring->sqHead) == tail)
+    {
+        LOG_ATOMIC_STORE_RELEASE(*ring->sqTail, tail);
+    }
+    return false;
+}
+
+static void completeWrite(const uint8_t buffer, const int32_t result)
+{
+    const size_t size = uringLogger.sizes[buffer];
+    const size_t written = (result > 0) ? (size_t) result : 0;
+
+    if (written < size)
+    {
+        // Short or failed write, finished synchronously
+        writeAt(&bufferAt(buffer)[written], size - written, uringLogger.offsets[buffer] + written);
+        if (result == -EINVAL || result == -EOPNOTSUPP)
+        {
+            // Operation not supported by this kernel
+            uringLogger.backend = URING_BACKEND_PWRITE;
+        }
+    }
+
+    uringLogger.sizes[buffer] = 0;
+    uringLogger.inFlight[buffer] = false;
+    uringLogger.nbInFlight--;
+}
+
+/**
+ * Handle the completed writes, waiting for at least one if asked to.
+ */
+static void reapCompletions(const bool wait)
+{
+    Uring* const ring = &uringLogger.ring;
+    uint32_t head = *ring->cqHead;
+
+    if (wait && head == LOG_ATOMIC_LOAD_ACQUIRE(*ring->cqTail))
+    {
+        (void) uringEnter(ring->fd, 0, 1, IORING_ENTER_GETEVENTS);
+    }
+
+    const uint32_t tail = LOG_ATOMIC_LOAD_ACQUIRE(*ring->cqTail);
+    while (head != tail)
+    {
+        const struct io_uring_cqe* const cqe = &ring->cqes[head & ring->cqMask];
+
+        completeWrite((uint8_t) cqe->user_data, cqe->res);
+        head++;
+    }
+    LOG_ATOMIC_STORE_RELEASE(*ring->cqHead, head);
+}
+#endif
+
+static void waitForBuffer(const uint8_t buffer)
+{
+#ifdef URING_SUPPORTED
+    while (uringLogger.inFlight[buffer])
+    {
+        reapCompletions(true);
+    }
+#else
+    (void) buffer;
+#endif
+}
+
+static void waitForWrites(void)
+{
+#ifdef URING_SUPPORTED
+    while (uringLogger.nbInFlight > 0)
+    {
+        reapCompletions(true);
+    }
+#endif
+}
+
+/**
+ * Write the filling buffer and move on to the next one. Must be called with the logger locked.
+ */
+static void submitFilling(void)
+{
+    const uint8_t buffer = uringLogger.filling;
+    const size_t size = uringLogger.sizes[buffer];
+    bool isSubmitted = false;
+
+    if (size == 0)
+    {
+        return;
+    }
+
+    uringLogger.offsets[buffer] = uringLogger.submitted;
+    uringLogger.submitted += size;
+
+#ifdef URING_SUPPORTED
+    if (uringLogger.backend == URING_BACKEND_IO_URING)
+    {
+        isSubmitted = submitWrite(buffer);
+        if (!isSubmitted)
+        {
+            uringLogger.backend = URING_BACKEND_PWRITE;
+        }
+    }
+#endif
+
+    if (isSubmitted)
+    {
+        uringLogger.inFlight[buffer] = true;
+        uringLogger.nbInFlight++;
+    }
+    else
+    {
+        writeAt(bufferAt(buffer), size, uringLogger.offsets[buffer]);
+        uringLogger.sizes[buffer] = 0;
+    }
+
+    uringLogger.filling = (uint8_t)((buffer + 1) % uringLogger.nbBuffers);
+    waitForBuffer(uringLogger.filling);
+}
+
+/**
+ * Make the file durable up to an offset. Must be called with the logger locked, which is released while syncing.
+ */
+static void syncUpTo(const uint64_t target)
+{
+    while (uringLogger.durable < target)
+    {
+        if (uringLogger.syncing)
+        {
+            // What the ongoing sync covers may be enough
+            (void) pthread_cond_wait(&uringLogger.syncDone, &uringLogger.lock);
+            continue;
+        }
+
+        if (uringLogger.submitted < target)
+        {
+            submitFilling();
+        }
+        waitForWrites();
+
+        // Producers keep on logging meanwhile, the next sync covers their records as a group
+        const uint64_t end = uringLogger.submitted;
+        uringLogger.syncing = true;
+        (void) pthread_mutex_unlock(&uringLogger.lock);
+        (void) syncFile(uringLogger.fd);
+        (void) pthread_mutex_lock(&uringLogger.lock);
+        uringLogger.durable = end;
+        uringLogger.syncing = false;
+        (void) pthread_cond_broadcast(&uringLogger.syncDone);
+    }
+}
+
+/**
+ * Write the buffered records every period, whether their buffer filled up or not.
+ */
+static void* flushLoop(void* arg)
+{
+    struct timespec deadline;
+
+    (void) arg;
+    (void) clock_gettime(CLOCK_REALTIME, &deadline);
+
+    (void) pthread_mutex_lock(&uringLogger.lock);
+    while (!uringLogger.stopFlusher)
+    {
+        deadline.tv_sec += (time_t)(uringLogger.flushPeriod / 1000u);
+        deadline.tv_nsec += (long) (uringLogger.flushPeriod % 1000u) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+
+        int waitResult = 0;
+        while (!uringLogger.stopFlusher && waitResult != ETIMEDOUT)
+        {
+            waitResult = pthread_cond_timedwait(&uringLogger.flusherChanged, &uringLogger.lock, &deadline);
+        }
+
+        if (!uringLogger.stopFlusher)
+        {
+            submitFilling();
+        }
+    }
+    (void) pthread_mutex_unlock(&uringLogger.lock);
+
+    return NULL;
+}
+
+void initUringLogger(const void* const param)
+{
+    const UringLoggerConfig* const config = (const UringLoggerConfig*) param;
+    void* memory = NULL;
+
+    if (uringLogger.fd >= 0)
+    {
+        return;
+    }
+
+    if (config == NULL || config->path == NULL || config->bufferSize > URING_MAX_BUFFER_SIZE || config->nbBuffers == 1 ||
+        config->nbBuffers > URING_MAX_BUFFERS)
+    {
+        uringLogger.status = LOG_INVALID_PARAMETER;
+        return;
+    }
+
+    uringLogger.bufferSize = (config->bufferSize == 0) ? URING_DEFAULT_BUFFER_SIZE : config->bufferSize;
+    uringLogger.nbBuffers = (config->nbBuffers == 0) ? URING_DEFAULT_NB_BUFFERS : config->nbBuffers;
+    uringLogger.syncLevel = config->syncLevel;
+    uringLogger.flushPeriod = config->flushPeriod;
+    uringLogger.filling = 0;
+    uringLogger.nbInFlight = 0;
+    uringLogger.syncing = false;
+    memset(uringLogger.sizes, 0, sizeof(uringLogger.sizes));
+    memset(uringLogger.inFlight, 0, sizeof(uringLogger.inFlight));
+
+    if (posix_memalign(&memory, BUFFER_ALIGNMENT, uringLogger.nbBuffers * uringLogger.bufferSize) != 0)
+    {
+        uringLogger.status = LOG_OUT_OF_MEMORY;
+        return;
+    }
+    uringLogger.memory = memory;
+
+    // Not opened in append mode: writes in flight go to the offsets they were given
+    uringLogger.fd = open(config->path, O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    const off_t end = (uringLogger.fd >= 0) ? lseek(uringLogger.fd, 0, SEEK_END) : -1;
+    if (end < 0)
+    {
+        closeUringLogger();
+        return;
+    }
+    uringLogger.submitted = (uint64_t) end;
+    uringLogger.durable = (uint64_t) end;
+
+    uringLogger.backend = URING_BACKEND_PWRITE;
+#ifdef URING_SUPPORTED
+    if (!config->forcePwrite && openUring(&uringLogger.ring))
+    {
+        uringLogger.backend = URING_BACKEND_IO_URING;
+    }
+#endif
+
+    if (config->flushPeriod != 0)
+    {
+        (void) pthread_mutex_lock(&uringLogger.lock);
+        uringLogger.stopFlusher = false;
+        uringLogger.hasFlusher = (pthread_create(&uringLogger.flusher, NULL, &flushLoop, NULL) == 0);
+        (void) pthread_mutex_unlock(&uringLogger.lock);
+        if (!uringLogger.hasFlusher)
+        {
+            closeUringLogger();
+            uringLogger.status = LOG_OUT_OF_MEMORY;
+            return;
+        }
+    }
+    uringLogger.status = LOG_OK;
+}
+
+void logToUringV2(const LogRecordV2* const logRecord, const LogFormat format)
+{
+    size_t length = 0;
+
+    (void) pthread_mutex_lock(&uringLogger.lock);
+    if (uringLogger.status == LOG_OK)
+    {
+        size_t* size = &uringLogger.sizes[uringLogger.filling];
+
+        length = logFormatLine((char*) &bufferAt(uringLogger.filling)[*size], uringLogger.bufferSize - *size, logRecord, format);
+        if (length > uringLogger.bufferSize - *size && *size > 0)
+        {
+            submitFilling();
+            size = &uringLogger.sizes[uringLogger.filling];
+            length = logFormatLine((char*) bufferAt(uringLogger.filling), uringLogger.bufferSize, logRecord, format);
+        }
+
+        // Records larger than a buffer are truncated
+        if (length > uringLogger.bufferSize)
+        {
+            length = uringLogger.bufferSize;
+            bufferAt(uringLogger.filling)[length - 1] = '\n';
+        }
+
+        *size += length;
+        const uint64_t end = uringLogger.submitted + *size;
+        if (*size == uringLogger.bufferSize)
+        {
+            submitFilling();
+        }
+
+        if (uringLogger.syncLevel != LEVEL_OFF && logRecord->level <= uringLogger.syncLevel)
+        {
+            syncUpTo(end);
+        }
+    }
+    (void) pthread_mutex_unlock(&uringLogger.lock);
+
+    REPORT_BYTES(length);
+}
+
+void flushUringLogger(void)
+{
+    (void) pthread_mutex_lock(&uringLogger.lock);
+    if (uringLogger.status == LOG_OK)
+    {
+        submitFilling();
+        waitForWrites();
+    }
+    (void) pthread_mutex_unlock(&uringLogger.lock);
+}
+
+void closeUringLogger(void)
+{
+    (void) pthread_mutex_lock(&uringLogger.lock);
+    const bool hasFlusher = uringLogger.hasFlusher;
+    uringLogger.stopFlusher = true;
+    uringLogger.hasFlusher = false;
+    (void) pthread_cond_broadcast(&uringLogger.flusherChanged);
+    (void) pthread_mutex_unlock(&uringLogger.lock);
+    if (hasFlusher)
+    {
+        (void) pthread_join(uringLogger.flusher, NULL);
+    }
+
+    flushUringLogger();
+
+    (void) pthread_mutex_lock(&uringLogger.lock);
+    while (uringLogger.syncing)
+    {
+        (void) pthread_cond_wait(&uringLogger.syncDone, &uringLogger.lock);
+    }
+    const LogResult status = uringLogger.status;
+    uringLogger.status = LOG_NOT_INITIALIZED;
+    (void) pthread_mutex_unlock(&uringLogger.lock);
+
+#ifdef URING_SUPPORTED
+    if (uringLogger.ring.fd >= 0)
+    {
+        closeUring(&uringLogger.ring);
+    }
+#endif
+    if (uringLogger.fd >= 0)
+    {
+        (void) close(uringLogger.fd);
+        uringLogger.fd = -1;
+    }
+    free(uringLogger.memory);
+    uringLogger.memory = NULL;
+    uringLogger.backend = URING_BACKEND_NONE;
+
+    // Keep the reason why initialization failed
+    uringLogger.status = (status == LOG_OK) ? LOG_NOT_INITIALIZED : status;
+}
+
+#else
+
+void initUringLogger(const void* const param)
+{
+    (void) param;
+    uringLogger.status = LOG_INVALID_PARAMETER;
+}
+
+void logToUringV2(const LogRecordV2* const logRecord, const LogFormat format)
+{
+    (void) logRecord;
+    (void) format;
+}
+
+void flushUringLogger(void)
+{
+}
+
+void closeUringLogger(void)
+{
+}
+
+#endif /* LOG_HAS_THREADS */
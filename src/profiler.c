@@ -0,0 +1,527 @@
+/**
+ * @file
+ *
+ * Profiler of the log call sites
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "slf4ec/slf4ecCtrl.h"
+#include "slf4ecPrivate.h"
+
+#ifdef USE_LOG_PROFILER
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef LOG_HAS_THREADS
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#endif
+
+#define MAX_PROBES (8) /**< Slots looked at before a site is accounted for with the calls without location */
+
+/**
+ * Sites profiled by a single thread. Only the owner writes, any thread may read.
+ */
+typedef struct LogProfileTable
+{
+    LogThreadSlot slot;                           /**< Slot of the table in the pool of all tables */
+    LogSiteProfile others;                        /**< Calls without location or beyond the profiled sites */
+    LogSiteProfile sites[LOG_PROFILER_MAX_SITES]; /**< Open addressing on the file and line, a slot being used once its file is set */
+} LogProfileTable;
+
+LOG_THREAD_LOCAL LogSiteProfile* logProfiling = NULL;
+
+static LOG_THREAD_LOCAL LogProfileTable* threadTable = NULL;
+
+/*
+ * Every table ever handed to a thread, so calls of exited threads are never lost.
+ * Tables are only pushed, never removed.
+ */
+static LogThreadSlots allTables = LOG_THREAD_SLOTS(LogProfileTable, 0, NULL);
+
+/*
+ * Used when no table can be allocated for a thread (or when there are no threads).
+ * Shared by several writers in that case, so only its "others" entry is used and increments may be lost.
+ */
+static LogProfileTable spareTable;
+
+/*
+ * Snapshot of the previous dump, sorted by site, so dumps report what happened in between
+ */
+static LogSiteProfile* previousDump = NULL;
+static size_t nbPreviousDump = 0;
+
+#ifdef LOG_HAS_THREADS
+static pthread_mutex_t dumpMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * Periodic dump
+ */
+static pthread_mutex_t dumperMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t dumperChanged = PTHREAD_COND_INITIALIZER;
+static pthread_t dumper;
+static bool hasDumper = false;
+static bool stopDumper = false;
+
+typedef struct
+{
+    Logger* logger;
+    uint32_t periodMs;
+    size_t nbSites;
+    LogProfileOrder order;
+} DumperConfig;
+
+static DumperConfig dumperConfig;
+
+static void lockDump(void)
+{
+    (void) pthread_mutex_lock(&dumpMutex);
+}
+
+static void unlockDump(void)
+{
+    (void) pthread_mutex_unlock(&dumpMutex);
+}
+#else
+static void lockDump(void)
+{
+}
+
+static void unlockDump(void)
+{
+}
+#endif
+
+static LogProfileTable* acquireTable(void)
+{
+    LogProfileTable* table = NULL;
+
+#ifdef LOG_HAS_THREADS
+    table = (LogProfileTable*) logThreadSlotAcquire(&allTables);
+#endif
+
+    if (table == NULL)
+    {
+        table = &spareTable;
+    }
+
+    threadTable = table;
+    return table;
+}
+
+static uint32_t hashSite(const char* const file, const uint32_t line)
+{
+    uint32_t hash = ((uint32_t)((uintptr_t) file >> 3) ^ (line * 40503u)) * 2654435761u;
+
+    return hash ^ (hash >> 16);
+}
+
+void logProfileCall(const char* const file, const uint32_t* const line, const char* const function)
+{
+    LogProfileTable* table = threadTable;
+    LogSiteProfile* profile;
+
+    if (table == NULL)
+    {
+        table = acquireTable();
+    }
+
+    profile = &table->others;
+    if (file != NULL && line != NULL && table != &spareTable)
+    {
+        const uint32_t hash = hashSite(file, *line);
+        uint_fast8_t probe;
+
+        for (probe = 0; probe < MAX_PROBES; probe++)
+        {
+            LogSiteProfile* const slot = &table->sites[(hash + probe) & (LOG_PROFILER_MAX_SITES - 1)];
+
+            // Only the owner writes the slots, no need for atomics to read them back
+            if (slot->file == file && slot->line == *line)
+            {
+                profile = slot;
+                break;
+            }
+            if (slot->file == NULL)
+            {
+                slot->line = *line;
+                slot->function = function;
+                LOG_ATOMIC_STORE_RELEASE(slot->file, file);
+                profile = slot;
+                break;
+            }
+        }
+    }
+
+    LOG_STATS_INC(profile->calls, 1);
+    logProfiling = profile;
+}
+
+static void addProfile(LogSiteProfile* const total, const LogSiteProfile* const profile)
+{
+    total->calls += LOG_ATOMIC_LOAD(profile->calls);
+    total->published += LOG_ATOMIC_LOAD(profile->published);
+    total->bytes += LOG_ATOMIC_LOAD(profile->bytes);
+    total->publishTime += LOG_ATOMIC_LOAD(profile->publishTime);
+}
+
+/**
+ * Order of the sites used to merge the tables: calls without location first, then by file and line.
+ * Files are compared by name since a site of a header has a copy of its file name in each translation unit.
+ */
+static int compareSites(const void* const a, const void* const b)
+{
+    const LogSiteProfile* const first = a;
+    const LogSiteProfile* const second = b;
+    int result;
+
+    if (first->file == NULL || second->file == NULL)
+    {
+        result = (first->file != NULL) - (second->file != NULL);
+    }
+    else
+    {
+        result = strcmp(first->file, second->file);
+        if (result == 0)
+        {
+            result = (first->line > second->line) - (first->line < second->line);
+        }
+    }
+
+    return result;
+}
+
+static LogCounter rankOf(const LogSiteProfile* const profile, const LogProfileOrder order)
+{
+    return (order == PROFILE_BY_BYTES) ? profile->bytes : (order == PROFILE_BY_TIME) ? profile->publishTime : profile->calls;
+}
+
+static LogProfileOrder rankOrder;
+
+static int compareRanks(const void* const a, const void* const b)
+{
+    const LogCounter first = rankOf(a, rankOrder);
+    const LogCounter second = rankOf(b, rankOrder);
+
+    return (first < second) - (first > second);
+}
+
+/**
+ * Merge the tables of every thread. Returns the sites sorted by ::compareSites, NULL when it cannot be allocated.
+ */
+static LogSiteProfile* mergeTables(size_t* const nbMerged)
+{
+    // Tables are only pushed in front, so the list from a single load of the head holds a fixed number of tables.
+    // Tables added meanwhile are left out.
+    const LogProfileTable* const head = (const LogProfileTable*) logThreadSlotsFirst(&allTables);
+    const LogProfileTable* table;
+    size_t nbTables = 1;
+    size_t nbSites = 0;
+    size_t i;
+
+    for (table = head; table != NULL; table = (const LogProfileTable*) table->slot.next)
+    {
+        nbTables++;
+    }
+
+    LogSiteProfile* const sites = calloc(nbTables * (LOG_PROFILER_MAX_SITES + 1), sizeof(LogSiteProfile));
+    if (sites == NULL)
+    {
+        return NULL;
+    }
+
+    // The calls without location of every table go to the first entry
+    addProfile(&sites[nbSites++], &spareTable.others);
+    for (table = head; table != NULL; table = (const LogProfileTable*) table->slot.next)
+    {
+        addProfile(&sites[0], &table->others);
+        for (i = 0; i < LOG_PROFILER_MAX_SITES; i++)
+        {
+            const char* const file = LOG_ATOMIC_LOAD_ACQUIRE(table->sites[i].file);
+            if (file != NULL)
+            {
+                sites[nbSites].file = file;
+                sites[nbSites].function = table->sites[i].function;
+                sites[nbSites].line = table->sites[i].line;
+                addProfile(&sites[nbSites++], &table->sites[i]);
+            }
+        }
+    }
+
+    qsort(&sites[1], nbSites - 1, sizeof(LogSiteProfile), &compareSites);
+    size_t nbUnique = 1;
+    for (i = 1; i < nbSites; i++)
+    {
+        if (nbUnique > 1 && compareSites(&sites[nbUnique - 1], &sites[i]) == 0)
+        {
+            sites[nbUnique - 1].calls += sites[i].calls;
+            sites[nbUnique - 1].published += sites[i].published;
+            sites[nbUnique - 1].bytes += sites[i].bytes;
+            sites[nbUnique - 1].publishTime += sites[i].publishTime;
+        }
+        else
+        {
+            sites[nbUnique++] = sites[i];
+        }
+    }
+
+    *nbMerged = nbUnique;
+    return sites;
+}
+
+/**
+ * Sort the sites from the worst to the best. Must be called with the dump locked.
+ */
+static void rankSites(LogSiteProfile* const sites, const size_t nbSites, const LogProfileOrder order)
+{
+    rankOrder = order;
+    qsort(sites, nbSites, sizeof(LogSiteProfile), &compareRanks);
+}
+
+static bool isOrderValid(const LogProfileOrder order)
+{
+    return order == PROFILE_BY_CALLS || order == PROFILE_BY_BYTES || order == PROFILE_BY_TIME;
+}
+
+LogResult getLogProfile(LogSiteProfile* const sites, size_t* const nbSites, const LogProfileOrder order)
+{
+    LogResult returnCode = LOG_OK;
+
+    if (sites == NULL || nbSites == NULL || !isOrderValid(order))
+    {
+        returnCode = LOG_INVALID_PARAMETER;
+    }
+    else
+    {
+        size_t nbMerged = 0;
+
+        lockDump();
+        LogSiteProfile* const merged = mergeTables(&nbMerged);
+        if (merged == NULL)
+        {
+            returnCode = LOG_OUT_OF_MEMORY;
+        }
+        else
+        {
+            rankSites(merged, nbMerged, order);
+            *nbSites = (nbMerged < *nbSites) ? nbMerged : *nbSites;
+            memcpy(sites, merged, *nbSites * sizeof(LogSiteProfile));
+            free(merged);
+        }
+        unlockDump();
+    }
+
+    return returnCode;
+}
+
+/**
+ * Subtract the profile of each site at the previous dump. Both arrays are sorted by ::compareSites.
+ */
+static void subtractPrevious(LogSiteProfile* const sites, const size_t nbSites)
+{
+    size_t previous = 0;
+    size_t i;
+
+    for (i = 0; i < nbSites && previous < nbPreviousDump; i++)
+    {
+        int order = compareSites(&previousDump[previous], &sites[i]);
+
+        // Sites never leave the tables, but may be merged differently when a table was added
+        while (order < 0 && ++previous < nbPreviousDump)
+        {
+            order = compareSites(&previousDump[previous], &sites[i]);
+        }
+        if (order == 0 && previous < nbPreviousDump)
+        {
+            sites[i].calls -= previousDump[previous].calls;
+            sites[i].published -= previousDump[previous].published;
+            sites[i].bytes -= previousDump[previous].bytes;
+            sites[i].publishTime -= previousDump[previous].publishTime;
+        }
+    }
+}
+
+static void publishLine(Logger* const logger, const char* const formatStr, ...)
+{
+    static LogCategory profilerCategory = {.name = "Profiler", .currentLogLevel = LEVEL_INFO};
+    const uint64_t timestamp = logTimeApi();
+    const uint8_t level = LEVEL_INFO;
+    va_list vaList;
+
+    va_start(vaList, formatStr);
+    if (logger->publishFctV2 != NULL)
+    {
+        const LogRecordV2 record = {.timestamp = timestamp, .category = &profilerCategory, .formatStr = formatStr, .vaList = &vaList, .level = level};
+        logger->publishFctV2(&record, logger->format);
+    }
+    else
+    {
+        const LogRecord record = {.category = &profilerCategory, .formatStr = formatStr, .timestamp = &timestamp, .level = &level, .vaList = &vaList};
+        logger->publishFct(&record, logger->format);
+    }
+    va_end(vaList);
+}
+
+LogResult dumpLogProfile(Logger* const logger, const size_t nbSites, const LogProfileOrder order)
+{
+    LogResult returnCode = LOG_OK;
+
+    if (logger == NULL || (logger->publishFct == NULL && logger->publishFctV2 == NULL) || !isOrderValid(order))
+    {
+        returnCode = LOG_INVALID_PARAMETER;
+    }
+    else
+    {
+        size_t nbMerged = 0;
+
+        lockDump();
+        LogSiteProfile* const merged = mergeTables(&nbMerged);
+        LogSiteProfile* const report = (merged != NULL) ? malloc(nbMerged * sizeof(LogSiteProfile)) : NULL;
+        if (report == NULL)
+        {
+            free(merged);
+            returnCode = LOG_OUT_OF_MEMORY;
+        }
+        else
+        {
+            size_t i;
+
+            memcpy(report, merged, nbMerged * sizeof(LogSiteProfile));
+            subtractPrevious(report, nbMerged);
+            rankSites(report, nbMerged, order);
+            for (i = 0; i < nbMerged && i < nbSites && rankOf(&report[i], order) > 0; i++)
+            {
+                publishLine(logger, "%s:%" PRIu32 " (%s) calls=%" PRIuPTR " published=%" PRIuPTR " bytes=%" PRIuPTR " time=%" PRIuPTR,
+                            (report[i].file != NULL) ? report[i].file : "other", report[i].line,
+                            (report[i].function != NULL) ? report[i].function : "-", report[i].calls, report[i].published,
+                            report[i].bytes, report[i].publishTime);
+            }
+            free(report);
+
+            free(previousDump);
+            previousDump = merged;
+            nbPreviousDump = nbMerged;
+        }
+        unlockDump();
+    }
+
+    return returnCode;
+}
+
+#ifdef LOG_HAS_THREADS
+static void* dumpLoop(void* arg)
+{
+    struct timespec deadline;
+
+    (void) arg;
+    (void) clock_gettime(CLOCK_REALTIME, &deadline);
+
+    (void) pthread_mutex_lock(&dumperMutex);
+    while (!stopDumper)
+    {
+        deadline.tv_sec += (time_t)(dumperConfig.periodMs / 1000u);
+        deadline.tv_nsec += (long) (dumperConfig.periodMs % 1000u) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+
+        int waitResult = 0;
+        while (!stopDumper && waitResult != ETIMEDOUT)
+        {
+            waitResult = pthread_cond_timedwait(&dumperChanged, &dumperMutex, &deadline);
+        }
+
+        if (!stopDumper)
+        {
+            (void) pthread_mutex_unlock(&dumperMutex);
+            (void) dumpLogProfile(dumperConfig.logger, dumperConfig.nbSites, dumperConfig.order);
+            (void) pthread_mutex_lock(&dumperMutex);
+        }
+    }
+    (void) pthread_mutex_unlock(&dumperMutex);
+
+    return NULL;
+}
+#endif
+
+LogResult startLogProfileDump(Logger* const logger, const uint32_t periodMs, const size_t nbSites, const LogProfileOrder order)
+{
+    LogResult returnCode = LOG_INVALID_PARAMETER;
+
+#ifdef LOG_HAS_THREADS
+    if (logger != NULL && (logger->publishFct != NULL || logger->publishFctV2 != NULL) && periodMs > 0 && isOrderValid(order))
+    {
+        (void) pthread_mutex_lock(&dumperMutex);
+        if (hasDumper)
+        {
+            returnCode = LOG_ALREADY_INITIALIZED;
+        }
+        else
+        {
+            const DumperConfig config = {logger, periodMs, nbSites, order};
+
+            dumperConfig = config;
+            stopDumper = false;
+            hasDumper = (pthread_create(&dumper, NULL, &dumpLoop, NULL) == 0);
+            returnCode = hasDumper ? LOG_OK : LOG_OUT_OF_MEMORY;
+        }
+        (void) pthread_mutex_unlock(&dumperMutex);
+    }
+#else
+    (void) logger;
+    (void) periodMs;
+    (void) nbSites;
+    (void) order;
+#endif
+
+    return returnCode;
+}
+
+void stopLogProfileDump(void)
+{
+#ifdef LOG_HAS_THREADS
+    (void) pthread_mutex_lock(&dumperMutex);
+    const bool isRunning = hasDumper;
+    stopDumper = true;
+    hasDumper = false;
+    (void) pthread_cond_broadcast(&dumperChanged);
+    (void) pthread_mutex_unlock(&dumperMutex);
+
+    if (isRunning)
+    {
+        (void) pthread_join(dumper, NULL);
+    }
+#endif
+}
+
+#endif /* USE_LOG_PROFILER */
@@ -32,21 +32,100 @@
  */
 
 #include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
 #include "slf4ec/slf4ec.h"
 #include "slf4ec/slf4ecCtrl.h"
+#include "slf4ec/logContext.h"
+#include "slf4ecPrivate.h"
+
+#ifdef USE_STATIC_LOGGERS
+#include "logStaticLoggers.h"
+#if defined(USE_LOG_STATS) || defined(USE_LOG_DEDUP)
+#error "USE_STATIC_LOGGERS publishes without the runtime loggers, their statistics and duplicates are not tracked"
+#endif
+#endif
+
+#ifdef LOG_HAS_THREADS
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 #define LOGGER_ALREADY_INITIALIZED "Logger already initialized!\n"
 #define LOGGER_NOT_INITIALIZED "Logger is not initialized!\n"
 
+#define MAX_ENTRIES (UINT16_MAX)
+
 const char* const logLevelNames[] = {"OFF", "FATAL", "ERROR", "WARN", "INFO", "DEBUG", "TRACE", "TEST"};
 
-static uint8_t nbCategories;
-static uint8_t nbLoggers;
-static LogCategory* const* categories;
-static Logger* const* loggers;
+/**
+ * Loggers wanting the records of a category
+ */
+typedef struct
+{
+    uint16_t nbLoggers;
+    Logger* const* loggers;
+} LogRoute;
+
+/**
+ * Immutable snapshot of the configured categories and loggers.
+ */
+typedef struct
+{
+    uint16_t nbCategories;
+    LogCategory* const* categories;
+    uint16_t nbLoggers;
+    Logger* const* loggers;
+    Logger** ownedLoggers; /**< Array allocated by a runtime change, freed once the snapshot is no longer in use */
+    LogRoute* routes;      /**< Routing table indexed by LogCategory::index. NULL when no logger filters categories */
+} LogConfig;
+
+/**
+ * Number of readers of each snapshot within a thread, counting the reentrant calls of its signal handlers.
+ * Each thread registers with its own counts so that logging threads never write to a shared cache line.
+ */
+typedef struct LogConfigReaders
+{
+    LogThreadSlot slot; /**< Slot of the counts in the pool of all counts */
+    uint32_t counts[2];
+} LogConfigReaders;
+
+#define READERS_ALIGNMENT (64) /**< Counts of different threads never share a cache line */
+
+/*
+ * Two snapshots are enough: a writer only builds a new one once every reader of the previous one is gone.
+ * Readers register against the snapshot they use so writers know when a snapshot can be reclaimed.
+ */
+static LogConfig configs[2];
+static uint8_t activeConfig = 0;
+
+/*
+ * Counts of every thread that ever logged, scanned by writers. Only pushed, never removed.
+ * The spare counts are shared by threads that could not get their own, or when there are no threads.
+ */
+static LogThreadSlots allReaders = LOG_THREAD_SLOTS(LogConfigReaders, READERS_ALIGNMENT, NULL);
+static LogConfigReaders spareReaders;
+static LOG_THREAD_LOCAL LogConfigReaders* threadReaders = NULL;
+
 static bool isInitialized = false;
+
+uint32_t logNbLevelOverrides = 0;
+static LOG_THREAD_LOCAL LogLevelOverride threadOverride = {LEVEL_OFF, 0, NULL};
 static const va_list emptyVaList;  // Cannot be a variable on the stack as we rely on default compiler initialization.
 
+#ifdef LOG_HAS_THREADS
+static pthread_mutex_t writerMutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+#ifdef LOG_CATEGORY_SECTION
+/*
+ * Bounds of the section gathering the categories defined with LOG_CATEGORY, provided by the linker.
+ * Weak since the section does not exist when no category is defined that way.
+ */
+extern LogCategory* const __start_slf4ec_categories[] __attribute__((weak));
+extern LogCategory* const __stop_slf4ec_categories[] __attribute__((weak));
+#endif
+
 static bool isCategoryActive(const LogCategory* const category, const uint8_t* const level);
 static LogResult _privateLog(const char* const file,
                              const uint32_t* const line,
@@ -55,107 +134,987 @@ static LogResult _privateLog(const char* const file,
                              const uint8_t* const level,
                              const char* const formatStr,
                              va_list vaList);
+static void publishRecord(const char* const file,
+                          const uint32_t* const line,
+                          const char* const function,
+                          const LogCategory* const category,
+                          const uint8_t level,
+                          const char* const formatStr,
+                          va_list* const vaList);
+
+/**
+ * Obtain the reader counts of the calling thread, released when it exits.
+ */
+static LogConfigReaders* acquireReaders(void)
+{
+    LogConfigReaders* readers = NULL;
+
+#ifdef LOG_HAS_THREADS
+    readers = (LogConfigReaders*) logThreadSlotAcquire(&allReaders);
+#endif
+
+    if (readers == NULL)
+    {
+        readers = &spareReaders;
+    }
+
+    threadReaders = readers;
+    return readers;
+}
+
+/**
+ * Obtain the current snapshot and prevent it from being reclaimed until ::exitConfig is called.
+ * Lock-free: only retries if a writer swapped the snapshot in the meantime. Only the counts of the calling thread are
+ * written, the read-modify-writes remain atomic as spare counts are shared.
+ */
+static inline const LogConfig* enterConfig(uint_fast8_t* const slot)
+{
+    LogConfigReaders* readers = threadReaders;
+    uint8_t index;
+
+    if (readers == NULL)
+    {
+        readers = acquireReaders();
+    }
+
+    for (;;)
+    {
+        index = LOG_ATOMIC_LOAD_ACQUIRE(activeConfig);
+        LOG_ATOMIC_ADD_SEQ_CST(readers->counts[index], 1);
+        if (LOG_ATOMIC_LOAD_SEQ_CST(activeConfig) == index)
+        {
+            break;
+        }
+        LOG_ATOMIC_SUB_RELEASE(readers->counts[index], 1);
+    }
+
+    *slot = index;
+    return &configs[index];
+}
 
-uint8_t getCategories(LogCategory* const** _categories)
+static inline void exitConfig(const uint_fast8_t slot)
 {
-    *_categories = categories;
+    LOG_ATOMIC_SUB_RELEASE(threadReaders->counts[slot], 1);
+}
+
+/**
+ * Wait for every thread to be done with a snapshot. Called once the snapshot was swapped: counts pushed after the list
+ * is loaded belong to threads that can only enter the new snapshot.
+ */
+static void waitForReaders(const uint8_t index)
+{
+    const LogConfigReaders* readers = &spareReaders;
+
+    while (readers != NULL)
+    {
+        if (LOG_ATOMIC_LOAD_SEQ_CST(readers->counts[index]) == 0)
+        {
+            readers = (readers == &spareReaders) ? (const LogConfigReaders*) logThreadSlotsFirst(&allReaders)
+                                                 : (const LogConfigReaders*) readers->slot.next;
+        }
+        else
+        {
+#ifdef LOG_HAS_THREADS
+            (void) sched_yield();
+#endif
+        }
+    }
+}
+
+static void lockWriters(void)
+{
+#ifdef LOG_HAS_THREADS
+    (void) pthread_mutex_lock(&writerMutex);
+#endif
+}
+
+static void unlockWriters(void)
+{
+#ifdef LOG_HAS_THREADS
+    (void) pthread_mutex_unlock(&writerMutex);
+#endif
+}
+
+/**
+ * Make @p next the current snapshot, then wait for every reader of the previous one to be done with it.
+ * Must be called with the writers locked.
+ */
+static void publishConfig(const LogConfig* const next)
+{
+    const uint8_t previous = activeConfig;
+    const uint8_t nextIndex = previous ^ 1;
+
+    configs[nextIndex] = *next;
+    LOG_ATOMIC_STORE_SEQ_CST(activeConfig, nextIndex);
+    waitForReaders(previous);
+
+    free(configs[previous].ownedLoggers);
+    configs[previous].ownedLoggers = NULL;
+    free(configs[previous].routes);
+    configs[previous].routes = NULL;
+}
+
+static bool isLoggerValid(const Logger* const logger)
+{
+    return logger != NULL && logger->initFct != NULL && (logger->publishFct != NULL || logger->publishFctV2 != NULL) &&
+           (logger->nbCategoryFilter == 0 || logger->categoryFilter != NULL);
+}
+
+static inline bool isCategoryConfigured(const LogConfig* const config, const LogCategory* const category)
+{
+    const uint16_t index = LOG_ATOMIC_LOAD(category->index);
+
+    return index < config->nbCategories && config->categories[index] == category;
+}
+
+static inline bool isCategoryWanted(const Logger* const logger, const LogCategory* const category)
+{
+    bool isWanted = (logger->nbCategoryFilter == 0);
+    uint_fast16_t i;
+
+    for (i = 0; !isWanted && i < logger->nbCategoryFilter; i++)
+    {
+        isWanted = (logger->categoryFilter[i] == category);
+    }
+
+    return isWanted;
+}
+
+/**
+ * Compile the category filters of the loggers of @p config into its routing table.
+ * Nothing is allocated unless at least one logger filters categories.
+ */
+static LogResult buildRoutes(LogConfig* const config)
+{
+    LogResult returnCode = LOG_OK;
+    bool isFiltering = false;
+    size_t nbEntries = 0;
+    uint_fast16_t category;
+    uint_fast16_t logger;
+
+    config->routes = NULL;
+
+    for (logger = 0; logger < config->nbLoggers; logger++)
+    {
+        isFiltering = isFiltering || (config->loggers[logger]->nbCategoryFilter > 0);
+    }
+
+    if (isFiltering && config->nbCategories > 0)
+    {
+        for (category = 0; category < config->nbCategories; category++)
+        {
+            for (logger = 0; logger < config->nbLoggers; logger++)
+            {
+                nbEntries += isCategoryWanted(config->loggers[logger], config->categories[category]) ? 1 : 0;
+            }
+        }
+
+        // Routes and their logger lists share a single allocation
+        LogRoute* const routes = malloc(config->nbCategories * sizeof(LogRoute) + nbEntries * sizeof(Logger*));
+
+        if (routes == NULL)
+        {
+            returnCode = LOG_OUT_OF_MEMORY;
+        }
+        else
+        {
+            Logger** entry = (Logger**) &routes[config->nbCategories];
+
+            for (category = 0; category < config->nbCategories; category++)
+            {
+                routes[category].nbLoggers = 0;
+                routes[category].loggers = entry;
+                for (logger = 0; logger < config->nbLoggers; logger++)
+                {
+                    if (isCategoryWanted(config->loggers[logger], config->categories[category]))
+                    {
+                        *entry++ = config->loggers[logger];
+                        routes[category].nbLoggers++;
+                    }
+                }
+            }
+            config->routes = routes;
+        }
+    }
+
+    return returnCode;
+}
+
+uint16_t getCategories(LogCategory* const** _categories)
+{
+    uint_fast8_t slot;
+    const LogConfig* const config = enterConfig(&slot);
+    const uint16_t nbCategories = config->nbCategories;
+
+    *_categories = config->categories;
+    exitConfig(slot);
+
     return nbCategories;
 }
 
-uint8_t getLoggers(Logger* const** _loggers)
+uint16_t getLoggers(Logger* const** _loggers)
+{
+    uint_fast8_t slot;
+    const LogConfig* const config = enterConfig(&slot);
+    const uint16_t nbLoggers = config->nbLoggers;
+
+    *_loggers = config->loggers;
+    exitConfig(slot);
+
+    return nbLoggers;
+}
+
+/**
+ * Configure the categories listed by the application followed by those registered with ::LOG_CATEGORY that are not
+ * listed, assigning each its index. Either array is used as is when the other one is empty, both are only merged otherwise.
+ * Linear: a category is known to be listed when the position given by its index holds it.
+ */
+static LogResult configureCategories(LogConfig* const config, const uint16_t nbListed, LogCategory* const* const listed)
+{
+    LogResult returnCode = LOG_OK;
+    LogCategory* const* registered = NULL;
+    size_t nbRegistered = 0;
+    uint_fast16_t i;
+
+#ifdef LOG_CATEGORY_SECTION
+    if (__start_slf4ec_categories != NULL)
+    {
+        registered = __start_slf4ec_categories;
+        nbRegistered = (size_t)(__stop_slf4ec_categories - __start_slf4ec_categories);
+    }
+#endif
+
+    for (i = 0; i < nbListed; i++)
+    {
+        listed[i]->index = (uint16_t) i;
+    }
+
+    config->nbCategories = nbListed;
+    config->categories = listed;
+
+    if (nbListed == 0 && nbRegistered > 0)
+    {
+        if (nbRegistered > MAX_ENTRIES)
+        {
+            returnCode = LOG_INVALID_PARAMETER;
+        }
+        else
+        {
+            for (i = 0; i < nbRegistered; i++)
+            {
+                registered[i]->index = (uint16_t) i;
+            }
+            config->nbCategories = (uint16_t) nbRegistered;
+            config->categories = registered;
+        }
+    }
+    else if (nbRegistered > 0)
+    {
+        // Never freed, like the arrays of ::addCategory
+        LogCategory** const categories = (nbListed + nbRegistered <= MAX_ENTRIES)
+                                             ? malloc((nbListed + nbRegistered) * sizeof(LogCategory*))
+                                             : NULL;
+
+        if (categories == NULL)
+        {
+            returnCode = (nbListed + nbRegistered <= MAX_ENTRIES) ? LOG_OUT_OF_MEMORY : LOG_INVALID_PARAMETER;
+        }
+        else
+        {
+            uint_fast16_t nbCategories = nbListed;
+            size_t j;
+
+            if (nbListed > 0)
+            {
+                memcpy(categories, listed, nbListed * sizeof(LogCategory*));
+            }
+            for (j = 0; j < nbRegistered; j++)
+            {
+                LogCategory* const category = registered[j];
+
+                if (category->index >= nbCategories || categories[category->index] != category)
+                {
+                    category->index = (uint16_t) nbCategories;
+                    categories[nbCategories++] = category;
+                }
+            }
+
+            config->nbCategories = (uint16_t) nbCategories;
+            config->categories = categories;
+        }
+    }
+
+    return returnCode;
+}
+
+LogResult initLogger(const uint16_t _nbCategories,
+                     LogCategory* const* _categories,
+                     const uint16_t _nbLoggers,
+                     Logger* const* _loggers)
+{
+    LogResult returnCode = LOG_OK;
+    bool allLoggersOk = true;
+
+    if ((_nbCategories > 0 && _categories == NULL) || (_nbLoggers > 0 && _loggers == NULL))
+    {
+        returnCode = LOG_INVALID_PARAMETER;
+    }
+    else
+    {
+        if (!isInitialized)
+        {
+            LogConfig* const config = &configs[activeConfig];
+
+            config->nbLoggers = _nbLoggers;
+            config->loggers = _loggers;
+            returnCode = configureCategories(config, _nbCategories, _categories);
+            allLoggersOk = (returnCode == LOG_OK);
+
+            uint_fast16_t i;
+            for (i = 0; allLoggersOk && i < _nbLoggers; i++)
+            {
+                if (!isLoggerValid(_loggers[i]))
+                {
+                    allLoggersOk = false;
+                    returnCode = LOG_INVALID_PARAMETER;
+                    break;
+                }
+                _loggers[i]->initFct(_loggers[i]->initArgs);
+#ifdef USE_LOG_STATS
+                logStatsAssign(_loggers[i]);
+#endif
+            }
+
+            if (allLoggersOk)
+            {
+                returnCode = buildRoutes(config);
+            }
+
+            isInitialized = (returnCode == LOG_OK);
+        }
+        else
+        {
+            returnCode = LOG_ALREADY_INITIALIZED;
+        }
+    }
+
+    return returnCode;
+}
+
+LogResult setLevels(const uint8_t level)
+{
+    LogResult returnCode = LOG_OK;
+
+#if LEVEL_MIN != 0
+#error "Need to add condition 'level < LEVEL_MIN' to if below"
+#endif
+
+    if (level > COMPILED_LOG_LEVEL)
+    {
+        returnCode = LOG_INVALID_PARAMETER;
+    }
+    else
+    {
+        if (isInitialized)
+        {
+            uint_fast8_t slot;
+            const LogConfig* const config = enterConfig(&slot);
+            uint_fast16_t i;
+            for (i = 0; i < config->nbCategories; i++)
+            {
+                LOG_ATOMIC_STORE(config->categories[i]->currentLogLevel, level);
+            }
+            exitConfig(slot);
+#ifdef USE_CALL_SITES
+            invalidateCallSites();
+#endif
+        }
+        else
+        {
+            returnCode = LOG_NOT_INITIALIZED;
+        }
+    }
+
+    return returnCode;
+}
+
+static int findLogger(const LogConfig* const config, const Logger* const logger)
+{
+    int index = -1;
+    uint_fast16_t i;
+
+    for (i = 0; i < config->nbLoggers; i++)
+    {
+        if (config->loggers[i] == logger)
+        {
+            index = i;
+            break;
+        }
+    }
+
+    return index;
+}
+
+/**
+ * Build and publish a snapshot where the logger at @p index is replaced by @p logger.
+ * @p index equal to the number of loggers appends, a NULL @p logger removes.
+ */
+static LogResult changeLogger(const LogConfig* const current, const uint_fast16_t index, Logger* const logger)
+{
+    LogResult returnCode = LOG_OK;
+    LogConfig next = *current;
+    const uint_fast16_t nbLoggers = current->nbLoggers + (index == current->nbLoggers ? 1 : 0) - (logger == NULL ? 1 : 0);
+    Logger** loggers = NULL;
+
+    if (nbLoggers > 0)
+    {
+        loggers = malloc(nbLoggers * sizeof(Logger*));
+    }
+
+    if (nbLoggers > 0 && loggers == NULL)
+    {
+        returnCode = LOG_OUT_OF_MEMORY;
+    }
+    else
+    {
+        uint_fast16_t from;
+        uint_fast16_t to = 0;
+
+        for (from = 0; from < current->nbLoggers; from++)
+        {
+            if (from != index)
+            {
+                loggers[to++] = current->loggers[from];
+            }
+            else if (logger != NULL)
+            {
+                loggers[to++] = logger;
+            }
+        }
+        if (index == current->nbLoggers)
+        {
+            loggers[to] = logger;
+        }
+
+        next.nbLoggers = nbLoggers;
+        next.loggers = loggers;
+        next.ownedLoggers = loggers;
+        returnCode = buildRoutes(&next);
+        if (returnCode == LOG_OK)
+        {
+            publishConfig(&next);
+        }
+        else
+        {
+            free(loggers);
+        }
+    }
+
+    return returnCode;
+}
+
+LogResult addLogger(Logger* const logger)
+{
+    LogResult returnCode = LOG_OK;
+
+    if (!isLoggerValid(logger))
+    {
+        returnCode = LOG_INVALID_PARAMETER;
+    }
+    else if (!isInitialized)
+    {
+        returnCode = LOG_NOT_INITIALIZED;
+    }
+    else
+    {
+        lockWriters();
+        const LogConfig* const current = &configs[activeConfig];
+
+        if (findLogger(current, logger) >= 0 || current->nbLoggers == MAX_ENTRIES)
+        {
+            returnCode = LOG_INVALID_PARAMETER;
+        }
+        else
+        {
+            logger->initFct(logger->initArgs);
+#ifdef USE_LOG_STATS
+            logStatsAssign(logger);
+#endif
+            returnCode = changeLogger(current, current->nbLoggers, logger);
+        }
+        unlockWriters();
+    }
+
+    return returnCode;
+}
+
+LogResult removeLogger(const Logger* const logger)
+{
+    LogResult returnCode = LOG_OK;
+
+    if (logger == NULL)
+    {
+        returnCode = LOG_INVALID_PARAMETER;
+    }
+    else if (!isInitialized)
+    {
+        returnCode = LOG_NOT_INITIALIZED;
+    }
+    else
+    {
+        lockWriters();
+        const LogConfig* const current = &configs[activeConfig];
+        const int index = findLogger(current, logger);
+
+        if (index < 0)
+        {
+            returnCode = LOG_INVALID_PARAMETER;
+        }
+        else
+        {
+            returnCode = changeLogger(current, (uint_fast16_t) index, NULL);
+        }
+        unlockWriters();
+    }
+
+    return returnCode;
+}
+
+LogResult replaceLogger(const Logger* const oldLogger, Logger* const newLogger)
+{
+    LogResult returnCode = LOG_OK;
+
+    if (oldLogger == NULL || !isLoggerValid(newLogger))
+    {
+        returnCode = LOG_INVALID_PARAMETER;
+    }
+    else if (!isInitialized)
+    {
+        returnCode = LOG_NOT_INITIALIZED;
+    }
+    else
+    {
+        lockWriters();
+        const LogConfig* const current = &configs[activeConfig];
+        const int index = findLogger(current, oldLogger);
+
+        if (index < 0 || findLogger(current, newLogger) >= 0)
+        {
+            returnCode = LOG_INVALID_PARAMETER;
+        }
+        else
+        {
+            newLogger->initFct(newLogger->initArgs);
+#ifdef USE_LOG_STATS
+            logStatsAssign(newLogger);
+#endif
+            returnCode = changeLogger(current, (uint_fast16_t) index, newLogger);
+        }
+        unlockWriters();
+    }
+
+    return returnCode;
+}
+
+LogResult addCategory(LogCategory* const category)
+{
+    LogResult returnCode = LOG_OK;
+
+    if (category == NULL)
+    {
+        returnCode = LOG_INVALID_PARAMETER;
+    }
+    else if (!isInitialized)
+    {
+        returnCode = LOG_NOT_INITIALIZED;
+    }
+    else
+    {
+        lockWriters();
+        LogConfig* const current = &configs[activeConfig];
+
+        if ((category->index < current->nbCategories && current->categories[category->index] == category) ||
+            current->nbCategories == MAX_ENTRIES)
+        {
+            returnCode = LOG_INVALID_PARAMETER;
+        }
+        else
+        {
+            // Never freed: the arrays handed out by getCategories remain valid
+            LogCategory** categories = malloc((current->nbCategories + 1) * sizeof(LogCategory*));
+
+            if (categories == NULL)
+            {
+                returnCode = LOG_OUT_OF_MEMORY;
+            }
+            else
+            {
+                LogConfig next = *current;
+
+                if (current->nbCategories > 0)
+                {
+                    memcpy(categories, current->categories, current->nbCategories * sizeof(LogCategory*));
+                }
+                categories[current->nbCategories] = category;
+
+                next.nbCategories = current->nbCategories + 1;
+                next.categories = categories;
+                returnCode = buildRoutes(&next);
+                if (returnCode == LOG_OK)
+                {
+                    // The logger array is shared with the next snapshot, hand it over so it is not reclaimed
+                    current->ownedLoggers = NULL;
+                    LOG_ATOMIC_STORE(category->index, current->nbCategories);
+                    publishConfig(&next);
+                }
+                else
+                {
+                    free(categories);
+                }
+            }
+        }
+        unlockWriters();
+    }
+
+    return returnCode;
+}
+
+#ifdef USE_LOG_STATS
+static inline int categoryIndex(const LogCategory* const category)
+{
+    int index = -1;
+    uint_fast8_t slot;
+
+    if (isCategoryConfigured(enterConfig(&slot), category))
+    {
+        index = category->index;
+    }
+    exitConfig(slot);
+
+    return index;
+}
+#endif
+
+/**
+ * Hand a record to a logger, through the legacy record if it only implements ::PublishLog.
+ */
+static inline void callLogger(const Logger* const logger, const LogRecordV2* const record, const LogRecord* const legacy)
+{
+    if (logger->publishFctV2 != NULL)
+    {
+        logger->publishFctV2(record, logger->format);
+    }
+    else
+    {
+        logger->publishFct(legacy, logger->format);
+    }
+}
+
+#ifdef USE_LOG_DEDUP
+/**
+ * Hand a record formatted by SLF4EC to a single logger.
+ */
+static void callLoggerFormatted(const Logger* const logger,
+                                const LogCategory* const category,
+                                const uint8_t level,
+                                const uint64_t timestamp,
+                                const char* const formatStr,
+                                ...)
+{
+    va_list ap;
+    va_start(ap, formatStr);
+
+    const LogRecordV2 record = {.timestamp = timestamp, .category = category, .formatStr = formatStr, .vaList = &ap, .level = level};
+    const LogRecord legacy = {.timestamp = &record.timestamp, .category = category, .level = &record.level, .formatStr = formatStr, .vaList = &ap};
+    callLogger(logger, &record, &legacy);
+
+    va_end(ap);
+}
+
+static void publishRepeated(const Logger* const logger, const LogRepeatedRun* const run, const uint64_t timestamp)
+{
+    if (run->repeated > 0 && run->category != NULL)
+    {
+        callLoggerFormatted(logger, run->category, run->level, timestamp, "Last message repeated %" PRIu32 " times", run->repeated);
+    }
+}
+
+/**
+ * Whether a logger suppresses a record as a duplicate of the previous one. Publishes the summary of the duplicates the
+ * record ends, if any.
+ */
+static inline bool isDuplicate(const Logger* const logger, const LogRecordV2* const record)
 {
-    *_loggers = loggers;
-    return nbLoggers;
+    bool isDuplicate = false;
+
+    if (logger->dedup != NULL)
+    {
+        LogRepeatedRun run;
+
+        isDuplicate = logDedupRecord(logger->dedup, record, &run);
+        publishRepeated(logger, &run, record->timestamp);
+    }
+
+    return isDuplicate;
 }
 
-LogResult initLogger(const uint8_t _nbCategories,
-                     LogCategory* const* _categories,
-                     const uint8_t _nbLoggers,
-                     Logger* const* _loggers)
+LogResult flushLogDuplicates(Logger* const logger)
 {
     LogResult returnCode = LOG_OK;
-    bool allLoggersOk = true;
 
-    if ((_nbCategories > 0 && _categories == NULL) || (_nbLoggers > 0 && _loggers == NULL))
+    if (logger == NULL || logger->dedup == NULL)
     {
         returnCode = LOG_INVALID_PARAMETER;
     }
+    else if (!isInitialized)
+    {
+        returnCode = LOG_NOT_INITIALIZED;
+    }
     else
     {
-        if (!isInitialized)
-        {
-            nbCategories = _nbCategories;
-            categories = _categories;
-            nbLoggers = _nbLoggers;
-            loggers = _loggers;
-
-            uint_fast8_t i;
-            for (i = 0; i < nbLoggers; i++)
-            {
-                if (loggers[i]->initFct == NULL || loggers[i]->publishFct == NULL)
-                {
-                    allLoggersOk = false;
-                    returnCode = LOG_INVALID_PARAMETER;
-                    break;
-                }
-                loggers[i]->initFct(loggers[i]->initArgs);
-            }
+        const uint64_t timestamp = logTimeApi();
+        size_t i;
 
-            isInitialized = allLoggersOk;
-        }
-        else
+        for (i = 0; i < LOG_DEDUP_SLOTS; i++)
         {
-            returnCode = LOG_ALREADY_INITIALIZED;
+            LogRepeatedRun run;
+
+            logDedupTakeRun(logger->dedup, i, &run, timestamp);
+            publishRepeated(logger, &run, timestamp);
         }
     }
 
     return returnCode;
 }
-
-LogResult setLevels(const uint8_t level)
+#else
+static inline bool isDuplicate(const Logger* const logger, const LogRecordV2* const record)
 {
-    LogResult returnCode = LOG_OK;
+    (void) logger;
+    (void) record;
 
-#if LEVEL_MIN != 0
-#error "Need to add condition 'level < LEVEL_MIN' to if below"
+    return false;
+}
 #endif
 
-    if (level > COMPILED_LOG_LEVEL)
+#ifdef USE_LOG_STATS
+static inline void publishToLogger(Logger* const logger, const LogRecordV2* const record, const LogRecord* const legacy, LogStatsBlock* const stats)
+{
+    // Duplicates are accounted for as filtered by the logger
+    if (LOG_ATOMIC_LOAD(logger->currentLogLevel) >= record->level && !isDuplicate(logger, record))
     {
-        returnCode = LOG_INVALID_PARAMETER;
+        logPublishingLogger = logger;
+        const uint64_t start = logTickApi();
+        callLogger(logger, record, legacy);
+        const uint64_t elapsed = logTickApi() - start;
+        logPublishingLogger = NULL;
+
+        const uint16_t statsIndex = LOG_ATOMIC_LOAD(logger->statsIndex);
+        if (statsIndex != 0)
+        {
+            LOG_STATS_INC(stats->loggers[statsIndex - 1].published, 1);
+            LOG_STATS_INC(stats->loggers[statsIndex - 1].publishTime, (LogCounter) elapsed);
+        }
+#ifdef USE_LOG_PROFILER
+        if (logProfiling != NULL)
+        {
+            LOG_STATS_INC(logProfiling->published, 1);
+        }
+#endif
+        if (logger->histogram != NULL)
+        {
+            logHistogramRecord(logger->histogram, elapsed);
+        }
+        logStatsCount(stats, STATS_PUBLISHED, -1, record->level);
     }
     else
     {
-        if (isInitialized)
-        {
-            uint_fast8_t i;
-            for (i = 0; i < nbCategories; i++)
-            {
-                categories[i]->currentLogLevel = level;
-            }
-        }
-        else
+        logStatsCount(stats, STATS_FILTERED_BY_LOGGER, -1, record->level);
+    }
+}
+#else
+static inline void publishToLogger(Logger* const logger, const LogRecordV2* const record, const LogRecord* const legacy)
+{
+    if (LOG_ATOMIC_LOAD(logger->currentLogLevel) >= record->level && !isDuplicate(logger, record))
+    {
+        callLogger(logger, record, legacy);
+    }
+}
+#endif
+
+#ifdef USE_STATIC_LOGGERS
+/*
+ * Expands to a direct call of a listed publishing function, guarded by the level the function was listed with
+ */
+#define PUBLISH_TO_STATIC_LOGGER(publishV2, format, maxLevel) \
+    if (record->level <= (maxLevel))                          \
+    {                                                         \
+        publishV2(record, format);                            \
+    }
+
+/**
+ * The loggers are fixed at compile time, so there is no configuration to enter nor array to walk.
+ */
+static void publishToLoggers(const LogRecordV2* const record)
+{
+    LOG_STATIC_LOGGERS(PUBLISH_TO_STATIC_LOGGER)
+}
+#else
+static void publishToLoggers(const LogRecordV2* const record)
+{
+    uint_fast8_t slot;
+    const LogConfig* const config = enterConfig(&slot);
+#ifdef USE_LOG_STATS
+    LogStatsBlock* const stats = logStatsBlock();
+#endif
+
+    // Loggers still implementing PublishLog get a record pointing into the v2 one
+    const bool hasLocation = (record->flags & LOG_RECORD_HAS_LOCATION) != 0;
+    const LogRecord legacy = {.file = hasLocation ? record->file : NULL,
+                              .line = hasLocation ? &record->line : NULL,
+                              .function = hasLocation ? record->function : NULL,
+                              .timestamp = &record->timestamp,
+                              .category = record->category,
+                              .level = &record->level,
+                              .formatStr = record->formatStr,
+                              .vaList = record->vaList,
+                              .context = (record->flags & LOG_RECORD_HAS_CONTEXT) ? record->context : NULL};
+
+    Logger* const* loggers = config->loggers;
+    uint_fast16_t nbLoggers = config->nbLoggers;
+    const bool isRouted = (config->routes != NULL) && isCategoryConfigured(config, record->category);
+
+    if (isRouted)
+    {
+        loggers = config->routes[record->category->index].loggers;
+        nbLoggers = config->routes[record->category->index].nbLoggers;
+    }
+
+    uint_fast16_t i;
+    for (i = 0; i < nbLoggers; i++)
+    {
+        // Categories that are not configured cannot be routed, fall back on checking each filter
+        if (isRouted || isCategoryWanted(loggers[i], record->category))
         {
-            returnCode = LOG_NOT_INITIALIZED;
+#ifdef USE_LOG_STATS
+            publishToLogger(loggers[i], record, &legacy, stats);
+#else
+            publishToLogger(loggers[i], record, &legacy);
+#endif
         }
     }
 
+    exitConfig(slot);
+}
+#endif
+
+void logRecordToV2(const LogRecord* const record, LogRecordV2* const recordV2)
+{
+    const bool hasLocation = record->file != NULL && record->line != NULL && record->function != NULL;
+
+    recordV2->timestamp = *record->timestamp;
+    recordV2->category = record->category;
+    recordV2->formatStr = record->formatStr;
+    recordV2->vaList = record->vaList;
+    recordV2->file = hasLocation ? record->file : NULL;
+    recordV2->function = hasLocation ? record->function : NULL;
+    recordV2->context = record->context;
+    recordV2->line = hasLocation ? *record->line : 0;
+    recordV2->level = *record->level;
+    recordV2->flags = (uint8_t)((hasLocation ? LOG_RECORD_HAS_LOCATION : 0) | ((record->context != NULL) ? LOG_RECORD_HAS_CONTEXT : 0));
+}
+
+static void publishFormatted(const LogCategory* const category, const uint8_t level, const uint64_t timestamp, const char* const formatStr, ...)
+{
+    va_list ap;
+    va_start(ap, formatStr);
+
+    const LogRecordV2 record = {.timestamp = timestamp, .category = category, .formatStr = formatStr, .vaList = &ap, .level = level};
+    publishToLoggers(&record);
+
+    va_end(ap);
+}
+
+void logPublishText(const LogCategory* const category, const uint8_t level, const uint64_t timestamp, const char* const text)
+{
+    if (isInitialized)
+    {
+#ifdef USE_LOG_STATS
+        logStatsCount(logStatsBlock(), STATS_CALLS, categoryIndex(category), level);
+#endif
+        publishFormatted(category, level, timestamp, "%s", text);
+    }
+}
+
+LogResult noLog()
+{
+    LogResult returnCode = LOG_OK;
+
+    if (!isInitialized)
+    {
+        returnCode = LOG_NOT_INITIALIZED;
+    }
+
     return returnCode;
 }
 
-static void publishToLoggers(const LogRecord* const record)
+LogResult noSpan(LogSpan* const span)
 {
-    int i;
-    for (i = 0; i < nbLoggers; i++)
+    span->category = NULL;
+
+    return noLog();
+}
+
+/**
+ * Hand a record of a span to the loggers. The arguments follow ::LOG_SPAN_BEGIN_FORMAT or ::LOG_SPAN_END_FORMAT.
+ */
+static void publishSpan(const LogSpan* const span, const uint64_t timestamp, const uint8_t flags, const char* const formatStr, ...)
+{
+    const LogContext* const context = logGetContext();
+    va_list vaList;
+
+    va_start(vaList, formatStr);
+    const LogRecordV2 record = {.timestamp = timestamp,
+                                .category = span->category,
+                                .formatStr = formatStr,
+                                .vaList = &vaList,
+                                .context = context,
+                                .level = span->level,
+                                .flags = (uint8_t)(flags | ((context != NULL) ? LOG_RECORD_HAS_CONTEXT : 0))};
+    publishToLoggers(&record);
+    va_end(vaList);
+}
+
+LogResult spanBegin(LogSpan* const span, const LogCategory* const category, const uint8_t level, const char* const name)
+{
+    LogResult returnCode = LOG_OK;
+
+    // Nothing more than a disabled log call when the span is filtered
+    span->category = NULL;
+    if (!isInitialized)
+    {
+        returnCode = LOG_NOT_INITIALIZED;
+    }
+    else if (isCategoryActive(category, &level))
     {
-        if (loggers[i]->currentLogLevel >= *record->level)
+        if (name == NULL)
+        {
+            returnCode = LOG_INVALID_PARAMETER;
+        }
+        else
         {
-            loggers[i]->publishFct(record, loggers[i]->format);
+            span->name = name;
+            span->level = level;
+            span->threadId = logThreadId();
+            span->start = logTimeApi();
+            span->category = category;
+            publishSpan(span, span->start, LOG_RECORD_SPAN_BEGIN, LOG_SPAN_BEGIN_FORMAT, name, span->threadId);
         }
     }
+
+    return returnCode;
 }
 
-LogResult noLog()
+LogResult spanEnd(LogSpan* const span)
 {
     LogResult returnCode = LOG_OK;
 
@@ -163,6 +1122,14 @@ LogResult noLog()
     {
         returnCode = LOG_NOT_INITIALIZED;
     }
+    else if (span->category != NULL)
+    {
+        // Ended even if the level changed in the meantime, so every span published is closed
+        const uint64_t end = logTimeApi();
+
+        publishSpan(span, end, LOG_RECORD_SPAN_END, LOG_SPAN_END_FORMAT, span->name, span->threadId, end - span->start);
+        span->category = NULL;
+    }
 
     return returnCode;
 }
@@ -231,6 +1198,114 @@ LogResult yfLogv(const char* const file,
     return res;
 }
 
+#ifdef LOG_CALL_SITE_SECTION
+/**
+ * Log from a call site. The site replaces the level check of the category.
+ */
+static LogResult siteLog(LogCallSite* const site, const LogCategory* const category, const char* const formatStr, va_list vaList)
+{
+    LogResult returnCode = LOG_NOT_INITIALIZED;
+
+    if (isInitialized)
+    {
+        returnCode = LOG_OK;
+#ifdef USE_LOG_STATS
+        const int index = categoryIndex(category);
+        logStatsCount(logStatsBlock(), STATS_CALLS, index, site->level);
+#endif
+#ifdef USE_LOG_PROFILER
+        // Sites are told apart even when their records carry no location
+        logProfileCall(site->file, &site->line, site->function);
+#endif
+
+        // The call site only skips the call itself when nothing is counted
+        if (LOG_ATOMIC_LOAD(site->disabledFor) != category && logSiteIsEnabled(site, category))
+        {
+            const bool hasLocation = site->hasLocation != 0;
+            va_list ap;
+
+            va_copy(ap, vaList);
+            publishRecord(hasLocation ? site->file : NULL, hasLocation ? &site->line : NULL, hasLocation ? site->function : NULL,
+                          category, site->level, formatStr, &ap);
+            va_end(ap);
+        }
+#ifdef USE_LOG_STATS
+        else
+        {
+            // Discarded by the level of the category or by the control of the site
+            logStatsCount(logStatsBlock(), STATS_FILTERED_BY_CATEGORY, index, site->level);
+        }
+#endif
+#ifdef USE_LOG_PROFILER
+        logProfiling = NULL;
+#endif
+    }
+
+    return returnCode;
+}
+
+LogResult siteLog0(LogCallSite* const site, const LogCategory* const category, const char* const msg)
+{
+    // Going through the variadic entry point gives an empty argument list, without casting away the const of emptyVaList
+    return siteLog1(site, category, msg);
+}
+
+LogResult siteLog1(LogCallSite* const site, const LogCategory* const category, const char* const formatStr, ...)
+{
+    LogResult returnCode;
+    va_list vaList;
+    va_start(vaList, formatStr);
+    returnCode = siteLog(site, category, formatStr, vaList);
+    va_end(vaList);
+    return returnCode;
+}
+
+LogResult siteLogv(LogCallSite* const site, const LogCategory* const category, const char* const formatStr, va_list vaList)
+{
+    return siteLog(site, category, formatStr, vaList);
+}
+#endif
+
+/**
+ * Build the record of a log call that is to be published and hand it to the loggers.
+ */
+static void publishRecord(const char* const file,
+                          const uint32_t* const line,
+                          const char* const function,
+                          const LogCategory* const category,
+                          const uint8_t level,
+                          const char* const formatStr,
+                          va_list* const vaList)
+{
+    const bool hasLocation = file != NULL && line != NULL && function != NULL;
+    const LogContext* const context = logGetContext();
+
+    LogRecordV2 curRecord =
+        {
+         .timestamp = logTimeApi(),
+         .category = category,
+         .formatStr = formatStr,
+         .vaList = vaList,
+         .file = file,
+         .function = function,
+         .context = context,
+         .line = hasLocation ? *line : 0,
+         .level = level,
+         .flags = (uint8_t)((hasLocation ? LOG_RECORD_HAS_LOCATION : 0) | ((context != NULL) ? LOG_RECORD_HAS_CONTEXT : 0))};
+
+#ifdef USE_LOG_PROFILER
+    LogSiteProfile* const profile = logProfiling;
+    const uint64_t start = logTickApi();
+#endif
+    publishToLoggers(&curRecord);
+#ifdef USE_LOG_PROFILER
+    if (profile != NULL)
+    {
+        LOG_STATS_INC(profile->publishTime, (LogCounter)(logTickApi() - start));
+    }
+#endif
+}
+
 static LogResult _privateLog(const char* const file,
                              const uint32_t* const line,
                              const char* const function,
@@ -247,33 +1322,138 @@ static LogResult _privateLog(const char* const file,
         return LOG_NOT_INITIALIZED;
     }
 
+#ifdef USE_LOG_STATS
+    const int index = categoryIndex(category);
+    logStatsCount(logStatsBlock(), STATS_CALLS, index, *level);
+#endif
+#ifdef USE_LOG_PROFILER
+    logProfileCall(file, line, function);
+#endif
+
     if (isCategoryActive(category, level))
     {
-        const uint64_t timestamp = logTimeApi();
+        publishRecord(file, line, function, category, *level, formatStr, &ap);
+    }
+#ifdef USE_LOG_STATS
+    else
+    {
+        logStatsCount(logStatsBlock(), STATS_FILTERED_BY_CATEGORY, index, *level);
+    }
+#endif
+#ifdef USE_LOG_PROFILER
+    logProfiling = NULL;
+#endif
+    va_end(ap);
+
+    return LOG_OK;
+}
+
+bool logThreadLevelAllows(const LogCategory* const category, const uint8_t level)
+{
+    bool isAllowed = false;
+
+    // Threads without override only pay for the shared count as long as no thread has one
+    if (LOG_ATOMIC_LOAD(logNbLevelOverrides) != 0 && threadOverride.level >= level)
+    {
+        uint_fast16_t i;
+
+        isAllowed = (threadOverride.nbCategories == 0);
+        for (i = 0; !isAllowed && i < threadOverride.nbCategories; i++)
+        {
+            isAllowed = (threadOverride.categories[i] == category);
+        }
+    }
+
+    return isAllowed;
+}
+
+#ifdef LOG_HAS_THREADS
+static pthread_key_t overrideKey;
+static pthread_once_t overrideKeyOnce = PTHREAD_ONCE_INIT;
+
+static void releaseOverride(void* levelOverride)
+{
+    // The thread exited while overriding, other threads must stop accounting for it
+    (void) levelOverride;
+    LOG_ATOMIC_SUB_RELEASE(logNbLevelOverrides, 1);
+}
+
+static void createOverrideKey(void)
+{
+    (void) pthread_key_create(&overrideKey, &releaseOverride);
+}
+#endif
+
+LogResult setThreadLevelOverride(const LogLevelOverride* const levelOverride)
+{
+    LogResult returnCode = LOG_OK;
+    const bool isOverriding = (levelOverride != NULL && levelOverride->level != LEVEL_OFF);
+
+    if (isOverriding && (levelOverride->level > LEVEL_MAX || (levelOverride->nbCategories > 0 && levelOverride->categories == NULL)))
+    {
+        returnCode = LOG_INVALID_PARAMETER;
+    }
+    else
+    {
+        const bool wasOverriding = (threadOverride.level != LEVEL_OFF);
+
+        if (isOverriding)
+        {
+            threadOverride = *levelOverride;
+        }
+        else
+        {
+            threadOverride.level = LEVEL_OFF;
+        }
 
-        LogRecord curRecord =
+        if (isOverriding && !wasOverriding)
+        {
+#ifdef LOG_HAS_THREADS
+            (void) pthread_once(&overrideKeyOnce, &createOverrideKey);
+            (void) pthread_setspecific(overrideKey, &threadOverride);
+#endif
+            // Sites remembering they are disabled must be evaluated again against the override
+            if (LOG_ATOMIC_ADD_SEQ_CST(logNbLevelOverrides, 1) == 0)
             {
-             .file = file,
-             .line = line,
-             .function = function,
-             .timestamp = &timestamp,
-             .category = category,
-             .level = level,
-             .formatStr = formatStr,
-             .vaList = &ap};
+#ifdef USE_CALL_SITES
+                invalidateCallSites();
+#endif
+            }
+        }
+        else if (!isOverriding && wasOverriding)
+        {
+#ifdef LOG_HAS_THREADS
+            (void) pthread_setspecific(overrideKey, NULL);
+#endif
+            LOG_ATOMIC_SUB_RELEASE(logNbLevelOverrides, 1);
+        }
+    }
+
+    return returnCode;
+}
+
+LogResult getThreadLevelOverride(LogLevelOverride* const levelOverride)
+{
+    LogResult returnCode = LOG_OK;
 
-        publishToLoggers(&curRecord);
+    if (levelOverride == NULL)
+    {
+        returnCode = LOG_INVALID_PARAMETER;
+    }
+    else
+    {
+        *levelOverride = threadOverride;
     }
-    va_end(ap);
 
-    return LOG_OK;
+    return returnCode;
 }
 
 static inline bool isCategoryActive(const LogCategory* const category, const uint8_t* const level)
 {
     bool isActive = false;
 
-    if (category->currentLogLevel >= *level)
+    if (LOG_ATOMIC_LOAD(category->currentLogLevel) >= *level ||
+        (LOG_ATOMIC_LOAD(logNbLevelOverrides) != 0 && logThreadLevelAllows(category, *level)))
     {
         isActive = true;
     }
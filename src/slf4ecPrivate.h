@@ -0,0 +1,534 @@
+/**
+ * @file
+ *
+ * Definitions shared between SLF4EC's modules. Not part of the public API.
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef SLF4EC_PRIVATE_H_
+#define SLF4EC_PRIVATE_H_
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "slf4ec/slf4ecTypes.h"
+
+/*
+ ************************************************************
+ * Platform abstraction
+ ************************************************************
+ */
+
+/**
+ * Defined when building for a hosted target where logging can happen from several threads (POSIX threads available).
+ * Bare-metal targets are considered single core where only interrupts can preempt the application.
+ * Windows builds are not threaded either: MinGW counters still use the GCC atomics below, but per-thread state is shared
+ * and no writer thread is started, so SLF4EC must only be called from a single thread there.
+ */
+#if defined(__unix__) || defined(__APPLE__)
+#define LOG_HAS_THREADS
+#endif
+
+#ifdef LOG_HAS_THREADS
+#include <pthread.h>
+#endif
+
+#if defined(LOG_HAS_THREADS) && defined(__GNUC__)
+#define LOG_THREAD_LOCAL __thread
+#else
+#define LOG_THREAD_LOCAL
+#endif
+
+#if defined(__GNUC__)
+#define LOG_ATOMIC_LOAD(var) __atomic_load_n(&(var), __ATOMIC_RELAXED)
+#define LOG_ATOMIC_STORE(var, value) __atomic_store_n(&(var), (value), __ATOMIC_RELAXED)
+#define LOG_ATOMIC_ADD(var, value) __atomic_fetch_add(&(var), (value), __ATOMIC_RELAXED)
+#define LOG_ATOMIC_LOAD_ACQUIRE(var) __atomic_load_n(&(var), __ATOMIC_ACQUIRE)
+#define LOG_ATOMIC_STORE_RELEASE(var, value) __atomic_store_n(&(var), (value), __ATOMIC_RELEASE)
+#define LOG_ATOMIC_CAS(var, expected, desired) \
+    __atomic_compare_exchange_n(&(var), &(expected), (desired), false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#define LOG_ATOMIC_LOAD_SEQ_CST(var) __atomic_load_n(&(var), __ATOMIC_SEQ_CST)
+#define LOG_ATOMIC_STORE_SEQ_CST(var, value) __atomic_store_n(&(var), (value), __ATOMIC_SEQ_CST)
+#define LOG_ATOMIC_ADD_SEQ_CST(var, value) __atomic_fetch_add(&(var), (value), __ATOMIC_SEQ_CST)
+#define LOG_ATOMIC_CAS_SEQ_CST(var, expected, desired) \
+    __atomic_compare_exchange_n(&(var), &(expected), (desired), false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)
+#define LOG_ATOMIC_SUB_RELEASE(var, value) __atomic_fetch_sub(&(var), (value), __ATOMIC_RELEASE)
+#else
+// Single core targets only: word sized accesses are atomic but read-modify-write operations are not.
+
+/**
+ * Add to an unsigned integer of any size, returning its previous value like __atomic_fetch_add.
+ */
+static inline uintmax_t logFetchAdd(void* const var, const size_t size, const uintmax_t value)
+{
+    uintmax_t previous;
+
+    switch (size)
+    {
+        case sizeof(uint8_t):
+            previous = *(uint8_t*) var;
+            *(uint8_t*) var = (uint8_t)(previous + value);
+            break;
+        case sizeof(uint16_t):
+            previous = *(uint16_t*) var;
+            *(uint16_t*) var = (uint16_t)(previous + value);
+            break;
+        case sizeof(uint32_t):
+            previous = *(uint32_t*) var;
+            *(uint32_t*) var = (uint32_t)(previous + value);
+            break;
+        default:
+            previous = *(uint64_t*) var;
+            *(uint64_t*) var = (uint64_t)(previous + value);
+            break;
+    }
+
+    return previous;
+}
+
+#define LOG_ATOMIC_LOAD(var) (var)
+#define LOG_ATOMIC_STORE(var, value) ((var) = (value))
+#define LOG_ATOMIC_ADD(var, value) logFetchAdd(&(var), sizeof(var), (uintmax_t)(value))
+#define LOG_ATOMIC_LOAD_ACQUIRE(var) (var)
+#define LOG_ATOMIC_STORE_RELEASE(var, value) ((var) = (value))
+#define LOG_ATOMIC_CAS(var, expected, desired) \
+    (((var) == (expected)) ? ((var) = (desired), true) : ((expected) = (var), false))
+#define LOG_ATOMIC_LOAD_SEQ_CST(var) (var)
+#define LOG_ATOMIC_STORE_SEQ_CST(var, value) ((var) = (value))
+#define LOG_ATOMIC_ADD_SEQ_CST(var, value) LOG_ATOMIC_ADD(var, value)
+#define LOG_ATOMIC_CAS_SEQ_CST(var, expected, desired) LOG_ATOMIC_CAS(var, expected, desired)
+#define LOG_ATOMIC_SUB_RELEASE(var, value) logFetchAdd(&(var), sizeof(var), (uintmax_t) 0 - (uintmax_t)(value))
+#endif
+
+/*
+ ************************************************************
+ * Thread slots
+ ************************************************************
+ */
+
+/**
+ * Header of a slot of a ::LogThreadSlots pool, first member of the slot. Only the owner thread writes the rest of the
+ * slot, any thread may read it.
+ */
+typedef struct LogThreadSlot
+{
+    struct LogThreadSlot* next; /**< Next slot of the pool */
+    uint8_t inUse;              /**< Whether a thread currently owns the slot */
+} LogThreadSlot;
+
+/**
+ * Slots handed one per thread. Slots are only pushed, never removed, so their content outlives the threads: the slot of
+ * an exited thread is released when it exits and claimed as is by the next thread acquiring one.
+ */
+typedef struct
+{
+    size_t size;                       /**< Size of a slot, header included */
+    size_t alignment;                  /**< Alignment of the slots, 0 for the one of malloc. Only honored with threads. */
+    bool (*init)(LogThreadSlot* slot); /**< Optional, called on a zeroed slot before it is pushed. False to give it up. */
+    LogThreadSlot* all;                /**< Every slot of the pool, pushed in front with a sequentially consistent swap */
+    uint8_t hasKey;                    /**< Whether LogThreadSlots::key was created */
+#ifdef LOG_HAS_THREADS
+    pthread_key_t key; /**< Releases the slot of an exiting thread */
+#endif
+} LogThreadSlots;
+
+/**
+ * Declare a pool of slots of a given type, whose first member is a ::LogThreadSlot.
+ */
+#define LOG_THREAD_SLOTS(type, slotAlignment, slotInit)                        \
+    {                                                                          \
+        .size = sizeof(type), .alignment = (slotAlignment), .init = (slotInit) \
+    }
+
+/**
+ * Hand a slot to the calling thread: a slot released by an exited thread if any, a new one otherwise.
+ * With threads, the slot is released when the thread exits.
+ *
+ * @param [in,out] pool Pool of the slot
+ * @return Slot owned by the calling thread, NULL when none can be allocated
+ */
+LogThreadSlot* logThreadSlotAcquire(LogThreadSlots* const pool);
+
+/**
+ * First slot of a pool, the others being reached through LogThreadSlot::next. Sequentially consistent, so that slots
+ * pushed after the load are acquired after any sequentially consistent access preceding it.
+ *
+ * @param [in] pool Pool of the slots
+ * @return First slot, NULL when the pool is empty
+ */
+static inline LogThreadSlot* logThreadSlotsFirst(LogThreadSlots* const pool)
+{
+    return LOG_ATOMIC_LOAD_SEQ_CST(pool->all);
+}
+
+/*
+ ************************************************************
+ * Publishing
+ ************************************************************
+ */
+
+/**
+ * Publish an already formatted record to the configured loggers, as if it was logged with "%s".
+ * Ignored when logging is not initialized.
+ *
+ * @param [in] category Category of the record
+ * @param [in] level Level of the record
+ * @param [in] timestamp Time at which the record was produced
+ * @param [in] text Formatted message
+ */
+void logPublishText(const LogCategory* const category, const uint8_t level, const uint64_t timestamp, const char* const text);
+
+/**
+ * Format a record as a text line, as the file logger writes it, followed by a new line.
+ *
+ * @param [out] buffer Where to format
+ * @param [in] capacity Size of @p buffer
+ * @param [in] record Record to format. Its arguments are not consumed
+ * @param [in] format Format of the line
+ * @return Length of the formatted record. When not below @p capacity, the record did not fit.
+ */
+size_t logFormatLine(char* const buffer, const size_t capacity, const LogRecordV2* const record, const LogFormat format);
+
+/**
+ * Identifier of the calling thread, as shown in its ::LogContext. Available without @p USE_LOG_CONTEXT.
+ *
+ * @return Thread ID on Linux, a sequence number elsewhere
+ */
+uint32_t logThreadId(void);
+
+/*
+ ************************************************************
+ * Format strings
+ ************************************************************
+ */
+
+/**
+ * Length modifier of a conversion
+ */
+typedef enum
+{
+    LOG_LENGTH_NONE = 0,
+    LOG_LENGTH_CHAR,       /**< hh */
+    LOG_LENGTH_SHORT,      /**< h */
+    LOG_LENGTH_LONG,       /**< l */
+    LOG_LENGTH_LONG_LONG,  /**< ll */
+    LOG_LENGTH_SIZE,       /**< z */
+    LOG_LENGTH_MAX,        /**< j */
+    LOG_LENGTH_PTRDIFF,    /**< t */
+    LOG_LENGTH_LONG_DOUBLE /**< L */
+} LogArgLength;
+
+/**
+ * Conversion specification of a format string
+ */
+typedef struct
+{
+    size_t width;
+    size_t precision;
+    bool hasPrecision;
+    bool isLeftAligned;
+    bool isZeroPadded;
+    LogArgLength length;
+    char conversion; /**< Conversion character, '\0' when the format string ended first */
+} LogConversion;
+
+/**
+ * Parse the conversion specification following a '%'. The '+', ' ' and '#' flags are skipped.
+ * Reentrant, so usable from signal handlers.
+ *
+ * @param [in] format Format string, just past the '%'
+ * @param [out] conversion Parsed specification
+ * @param [in,out] args Arguments, from which a width or precision given as '*' is taken. NULL to leave them to the
+ * caller, in which case they are parsed as 0
+ * @return Format string past the conversion
+ */
+const char* logParseConversion(const char* format, LogConversion* const conversion, va_list* const args);
+
+/**
+ * Take the argument of a signed integer conversion.
+ */
+intmax_t logSignedArgument(const LogArgLength length, va_list* const args);
+
+/**
+ * Take the argument of an unsigned integer conversion.
+ */
+uintmax_t logUnsignedArgument(const LogArgLength length, va_list* const args);
+
+/*
+ ************************************************************
+ * Deferred formatting
+ ************************************************************
+ */
+
+/**
+ * Called by ::logReplayRecord with each record replayed. The record is only valid during the call.
+ */
+typedef void (*LogReplayFct)(const LogRecordV2* const record, void* const arg);
+
+/**
+ * Copy a record into a self-contained entry, to be formatted later by another thread. The format string is walked to
+ * take the arguments by value, strings (and the context, if any) being copied, so nothing points to memory of the caller.
+ * Records whose arguments cannot be taken (e.g. '%n') are formatted right away instead.
+ *
+ * @param [out] buffer Where to write the entry, aligned on 8 bytes
+ * @param [in] capacity Size of @p buffer
+ * @param [in] record Record to capture. Its arguments are not consumed
+ * @return Size of the entry, a multiple of 8. 0 when it does not fit in @p capacity.
+ */
+size_t logCaptureRecord(void* const buffer, const size_t capacity, const LogRecordV2* const record);
+
+/**
+ * Rebuild a record captured by ::logCaptureRecord and hand it to @p fct. Its message is formatted and given as "%s",
+ * except for the records of spans which keep the arguments of their format.
+ *
+ * @param [in] entry Entry written by ::logCaptureRecord
+ * @param [in] fct Function receiving the record
+ * @param [in] arg Passed to @p fct
+ */
+void logReplayRecord(const void* const entry, const LogReplayFct fct, void* const arg);
+
+/*
+ ************************************************************
+ * Level overrides
+ ************************************************************
+ */
+
+/**
+ * Number of threads with a level override. Call sites do not remember they are disabled while it is not 0.
+ */
+extern uint32_t logNbLevelOverrides;
+
+/*
+ ************************************************************
+ * Call sites
+ ************************************************************
+ */
+
+#ifdef USE_CALL_SITES
+/**
+ * Whether a call site logs against a category. Remembers the category in the site when it does not.
+ *
+ * @param [in] site Call site
+ * @param [in] category Category the site logs against
+ * @return Whether the call is to be published
+ */
+bool logSiteIsEnabled(LogCallSite* const site, const LogCategory* const category);
+#endif
+
+/*
+ ************************************************************
+ * Statistics
+ ************************************************************
+ */
+
+#ifdef USE_LOG_STATS
+
+/**
+ * Maximum number of categories tracked individually by the statistics. Categories beyond are only accounted for in the per-level counters.
+ */
+#ifndef LOG_STATS_MAX_CATEGORIES
+#define LOG_STATS_MAX_CATEGORIES (64)
+#endif
+
+/**
+ * Maximum number of loggers tracked by the statistics. Loggers configured beyond are not accounted for.
+ */
+#ifndef LOG_STATS_MAX_LOGGERS
+#define LOG_STATS_MAX_LOGGERS (16)
+#endif
+
+/**
+ * Kinds of per-level counters
+ */
+typedef enum
+{
+    STATS_CALLS = 0,
+    STATS_FILTERED_BY_CATEGORY,
+    STATS_FILTERED_BY_LOGGER,
+    STATS_PUBLISHED,
+    STATS_NB_KINDS
+} LogStatsKind;
+
+/**
+ * Counters owned by a single thread. Only the owner writes, any thread may read.
+ */
+typedef struct LogStatsBlock
+{
+    LogThreadSlot slot;                                    /**< Slot of the block in the pool of all blocks */
+    LogCounter levels[STATS_NB_KINDS][LEVEL_MAX + 1];      /**< Per-level counters */
+    LogCategoryStats categories[LOG_STATS_MAX_CATEGORIES]; /**< Per-category counters, indexed by LogCategory::index */
+    LoggerStats loggers[LOG_STATS_MAX_LOGGERS];            /**< Per-logger counters, indexed by Logger::statsIndex - 1 */
+} LogStatsBlock;
+
+extern LOG_THREAD_LOCAL LogStatsBlock* logThreadStats;
+extern LOG_THREAD_LOCAL Logger* logPublishingLogger;
+
+LogStatsBlock* logStatsAcquire(void);
+
+/**
+ * Give a logger its counters in the statistics blocks, the first time it is configured.
+ * Called with the writers serialized.
+ *
+ * @param [in] logger Logger being configured
+ */
+void logStatsAssign(Logger* const logger);
+
+#ifdef LOG_HAS_THREADS
+// Blocks have a single writer, no need for a locked read-modify-write
+#define LOG_STATS_INC(counter, value) LOG_ATOMIC_STORE(counter, LOG_ATOMIC_LOAD(counter) + (value))
+#else
+// Interrupts may log as well
+#define LOG_STATS_INC(counter, value) LOG_ATOMIC_ADD(counter, value)
+#endif
+
+/**
+ * Obtain the statistics block of the calling thread.
+ */
+static inline LogStatsBlock* logStatsBlock(void)
+{
+    LogStatsBlock* block = logThreadStats;
+
+    if (block == NULL)
+    {
+        block = logStatsAcquire();
+    }
+
+    return block;
+}
+
+/**
+ * Account for a log call.
+ *
+ * @param [in] block Block of the calling thread
+ * @param [in] kind Counter to increment
+ * @param [in] categoryIndex Index of the category or a negative value if the category is not configured
+ * @param [in] level Level of the log call
+ */
+static inline void logStatsCount(LogStatsBlock* const block, const LogStatsKind kind, const int categoryIndex, const uint8_t level)
+{
+    if (level <= LEVEL_MAX)
+    {
+        LOG_STATS_INC(block->levels[kind][level], 1);
+    }
+
+    if (categoryIndex >= 0 && categoryIndex < LOG_STATS_MAX_CATEGORIES)
+    {
+        if (kind == STATS_CALLS)
+        {
+            LOG_STATS_INC(block->categories[categoryIndex].calls, 1);
+        }
+        else if (kind == STATS_FILTERED_BY_CATEGORY)
+        {
+            LOG_STATS_INC(block->categories[categoryIndex].filtered, 1);
+        }
+    }
+}
+
+#endif /* USE_LOG_STATS */
+
+/*
+ ************************************************************
+ * Profiler
+ ************************************************************
+ */
+
+#ifdef USE_LOG_PROFILER
+
+#ifndef USE_LOG_STATS
+#error "USE_LOG_PROFILER requires USE_LOG_STATS"
+#endif
+
+/**
+ * Number of call sites profiled by each thread. Must be a power of 2.
+ */
+#ifndef LOG_PROFILER_MAX_SITES
+#define LOG_PROFILER_MAX_SITES (256)
+#endif
+
+#if (LOG_PROFILER_MAX_SITES & (LOG_PROFILER_MAX_SITES - 1)) != 0
+#error "LOG_PROFILER_MAX_SITES must be a power of 2"
+#endif
+
+/**
+ * Profile of the site whose records are being published by the thread. NULL when not publishing for a call site.
+ */
+extern LOG_THREAD_LOCAL LogSiteProfile* logProfiling;
+
+/**
+ * Account for a log call in the table of the calling thread and make its site the one being profiled.
+ *
+ * @param [in] file Path to the source code file of the call, NULL when unknown
+ * @param [in] line Line number of the call, NULL when unknown
+ * @param [in] function Name of the function of the call
+ */
+void logProfileCall(const char* const file, const uint32_t* const line, const char* const function);
+
+#endif /* USE_LOG_PROFILER */
+
+/*
+ ************************************************************
+ * Duplicate suppression
+ ************************************************************
+ */
+
+#ifdef USE_LOG_DEDUP
+/**
+ * Run of duplicates to be summarized
+ */
+typedef struct
+{
+    const LogCategory* category;
+    uint32_t repeated; /**< Number of duplicates, 0 when there is nothing to summarize */
+    uint8_t level;
+} LogRepeatedRun;
+
+/**
+ * Compare a record with the previous record of its category. Never waits: a record whose slot is in use by another
+ * thread is published as is.
+ *
+ * @param [in] dedup Duplicate suppression of the logger
+ * @param [in] record Record to compare. Its arguments are not consumed
+ * @param [out] run Run of duplicates to summarize before the record is published
+ * @return Whether the record duplicates the previous one and must not be published
+ */
+bool logDedupRecord(LogDedup* const dedup, const LogRecordV2* const record, LogRepeatedRun* const run);
+
+/**
+ * Take the run of duplicates of a slot that is not summarized yet.
+ *
+ * @param [in] dedup Duplicate suppression of the logger
+ * @param [in] slot Index of the slot
+ * @param [out] run Run of duplicates to summarize
+ * @param [in] timestamp Current time
+ */
+void logDedupTakeRun(LogDedup* const dedup, const size_t slot, LogRepeatedRun* const run, const uint64_t timestamp);
+#endif
+
+#endif /* SLF4EC_PRIVATE_H_ */
@@ -0,0 +1,196 @@
+/**
+ * @file
+ *
+ * Logging statistics
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "slf4ec/slf4ecCtrl.h"
+#include "slf4ecPrivate.h"
+
+#ifdef USE_LOG_STATS
+
+#include <string.h>
+
+LOG_THREAD_LOCAL LogStatsBlock* logThreadStats = NULL;
+LOG_THREAD_LOCAL Logger* logPublishingLogger = NULL;
+
+/*
+ * Every block ever handed to a thread, so counters of exited threads are never lost.
+ */
+static LogThreadSlots allBlocks = LOG_THREAD_SLOTS(LogStatsBlock, 0, NULL);
+
+/*
+ * Used when no block can be allocated for a thread (or when there are no threads).
+ * Shared by several writers in that case so increments may be lost.
+ */
+static LogStatsBlock spareBlock;
+
+/*
+ * Number of loggers given counters so far. Counters are never handed back, a logger removed then added again keeps its own.
+ */
+static uint16_t nbAssignedLoggers = 0;
+
+LogStatsBlock* logStatsAcquire(void)
+{
+    LogStatsBlock* block = NULL;
+
+#ifdef LOG_HAS_THREADS
+    block = (LogStatsBlock*) logThreadSlotAcquire(&allBlocks);
+#endif
+
+    if (block == NULL)
+    {
+        block = &spareBlock;
+    }
+
+    logThreadStats = block;
+    return block;
+}
+
+void logStatsAssign(Logger* const logger)
+{
+    if (LOG_ATOMIC_LOAD(logger->statsIndex) == 0 && nbAssignedLoggers < LOG_STATS_MAX_LOGGERS)
+    {
+        nbAssignedLoggers++;
+        // Published along with the configuration holding the logger
+        LOG_ATOMIC_STORE(logger->statsIndex, nbAssignedLoggers);
+    }
+}
+
+static void addBlock(LogStats* const stats, LogStatsBlock* const block)
+{
+    uint_fast8_t level;
+
+    for (level = 0; level <= LEVEL_MAX; level++)
+    {
+        stats->calls[level] += LOG_ATOMIC_LOAD(block->levels[STATS_CALLS][level]);
+        stats->filteredByCategory[level] += LOG_ATOMIC_LOAD(block->levels[STATS_FILTERED_BY_CATEGORY][level]);
+        stats->filteredByLogger[level] += LOG_ATOMIC_LOAD(block->levels[STATS_FILTERED_BY_LOGGER][level]);
+        stats->published[level] += LOG_ATOMIC_LOAD(block->levels[STATS_PUBLISHED][level]);
+    }
+}
+
+LogResult getLogStats(LogStats* const stats)
+{
+    LogResult returnCode = LOG_OK;
+
+    if (stats == NULL)
+    {
+        returnCode = LOG_INVALID_PARAMETER;
+    }
+    else
+    {
+        LogStatsBlock* block;
+
+        memset(stats, 0, sizeof(LogStats));
+        addBlock(stats, &spareBlock);
+        for (block = (LogStatsBlock*) logThreadSlotsFirst(&allBlocks); block != NULL; block = (LogStatsBlock*) block->slot.next)
+        {
+            addBlock(stats, block);
+        }
+    }
+
+    return returnCode;
+}
+
+LogResult getCategoryStats(const LogCategory* const category, LogCategoryStats* const stats)
+{
+    LogResult returnCode = LOG_OK;
+    LogCategory* const* categories;
+    uint16_t nbCategories = getCategories(&categories);
+
+    if (category == NULL || stats == NULL || category->index >= nbCategories || categories[category->index] != category ||
+        category->index >= LOG_STATS_MAX_CATEGORIES)
+    {
+        returnCode = LOG_INVALID_PARAMETER;
+    }
+    else
+    {
+        LogStatsBlock* block = &spareBlock;
+
+        stats->calls = LOG_ATOMIC_LOAD(block->categories[category->index].calls);
+        stats->filtered = LOG_ATOMIC_LOAD(block->categories[category->index].filtered);
+        for (block = (LogStatsBlock*) logThreadSlotsFirst(&allBlocks); block != NULL; block = (LogStatsBlock*) block->slot.next)
+        {
+            stats->calls += LOG_ATOMIC_LOAD(block->categories[category->index].calls);
+            stats->filtered += LOG_ATOMIC_LOAD(block->categories[category->index].filtered);
+        }
+    }
+
+    return returnCode;
+}
+
+LogResult getLoggerStats(const Logger* const logger, LoggerStats* const stats)
+{
+    LogResult returnCode = LOG_OK;
+    const uint16_t statsIndex = (logger != NULL) ? LOG_ATOMIC_LOAD(logger->statsIndex) : 0;
+
+    if (statsIndex == 0 || stats == NULL)
+    {
+        returnCode = LOG_INVALID_PARAMETER;
+    }
+    else
+    {
+        LogStatsBlock* block = &spareBlock;
+        const LoggerStats* counters = &block->loggers[statsIndex - 1];
+
+        stats->published = LOG_ATOMIC_LOAD(counters->published);
+        stats->bytes = LOG_ATOMIC_LOAD(counters->bytes);
+        stats->publishTime = LOG_ATOMIC_LOAD(counters->publishTime);
+        for (block = (LogStatsBlock*) logThreadSlotsFirst(&allBlocks); block != NULL; block = (LogStatsBlock*) block->slot.next)
+        {
+            counters = &block->loggers[statsIndex - 1];
+            stats->published += LOG_ATOMIC_LOAD(counters->published);
+            stats->bytes += LOG_ATOMIC_LOAD(counters->bytes);
+            stats->publishTime += LOG_ATOMIC_LOAD(counters->publishTime);
+        }
+    }
+
+    return returnCode;
+}
+
+void logReportBytes(const size_t nbBytes)
+{
+    Logger* logger = logPublishingLogger;
+    const uint16_t statsIndex = (logger != NULL) ? LOG_ATOMIC_LOAD(logger->statsIndex) : 0;
+
+    if (statsIndex != 0)
+    {
+        LOG_STATS_INC(logStatsBlock()->loggers[statsIndex - 1].bytes, nbBytes);
+    }
+#ifdef USE_LOG_PROFILER
+    if (logger != NULL && logProfiling != NULL)
+    {
+        LOG_STATS_INC(logProfiling->bytes, nbBytes);
+    }
+#endif
+}
+
+#endif /* USE_LOG_STATS */
@@ -0,0 +1,146 @@
+/**
+ * @file
+ *
+ * Tests of the categories defined with LOG_CATEGORY
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "testCategories.h"
+
+#include "slf4ec/log.h"
+#include "slf4ec/slf4ecCtrl.h"
+
+#define NB_MANY_CATEGORIES (300)
+
+static uint64_t getTimestamp(void)
+{
+    return 42;
+}
+
+const GetLogTimestamp logTimeApi = &getTimestamp;
+
+static const uint8_t noArg = 0;
+static uint32_t nbPublished = 0;
+static uint32_t nbFiltered = 0;
+
+LOG_CATEGORY(Network, LEVEL_INFO);
+LOG_CATEGORY(Storage, LEVEL_INFO);
+
+static LogCategory listed = {.name = "Listed", .currentLogLevel = LEVEL_INFO};
+static LogCategory* categories[] = {&listed, &Storage};
+static LogCategory many[NB_MANY_CATEGORIES];
+
+static void sinkInit(const void* const config)
+{
+    (void) config;
+}
+
+static void sinkPublisher(const LogRecordV2* const record, const LogFormat format)
+{
+    (void) record;
+    (void) format;
+    nbPublished++;
+}
+
+static void filteredPublisher(const LogRecordV2* const record, const LogFormat format)
+{
+    (void) record;
+    (void) format;
+    nbFiltered++;
+}
+
+static Logger sink = {.loggerName = "Sink", .initFct = &sinkInit, .initArgs = &noArg, .format = FORMAT_FULL, .currentLogLevel = LEVEL_MAX, .publishFctV2 = &sinkPublisher};
+static Logger* loggers[] = {&sink};
+
+static LogCategory* const lastOfMany[] = {&many[NB_MANY_CATEGORIES - 1]};
+static Logger filtered = {.loggerName = "Filtered", .initFct = &sinkInit, .initArgs = &noArg, .format = FORMAT_FULL, .currentLogLevel = LEVEL_MAX, .categoryFilter = lastOfMany, .nbCategoryFilter = 1, .publishFctV2 = &filteredPublisher};
+
+void categoriesDiscovered(void** state)
+{
+    (void) state;
+
+    LogCategory* const* configured;
+
+    // Storage is both listed and defined with LOG_CATEGORY, it must only be configured once
+    assert_int_equal(LOG_OK, initLogger(2, categories, 1, loggers));
+    assert_int_equal(3, getCategories(&configured));
+    assert_ptr_equal(&listed, configured[0]);
+    assert_ptr_equal(&Storage, configured[1]);
+    assert_ptr_equal(&Network, configured[2]);
+    assert_string_equal("Network", Network.name);
+    assert_int_equal(0, listed.index);
+    assert_int_equal(1, Storage.index);
+    assert_int_equal(2, Network.index);
+
+    // Discovered categories are configured: they follow setLevels
+    assert_int_equal(LOG_OK, setLevels(LEVEL_WARN));
+    assert_int_equal(LEVEL_WARN, Network.currentLogLevel);
+    nbPublished = 0;
+    logInfo(Network, "Filtered");
+    logWarn(Network, "Published");
+    assert_int_equal(1, nbPublished);
+}
+
+void categoriesBeyond255(void** state)
+{
+    (void) state;
+
+    LogCategory* const* configured;
+    uint16_t i;
+
+    for (i = 0; i < NB_MANY_CATEGORIES; i++)
+    {
+        assert_int_equal(LOG_OK, addCategory(&many[i]));
+    }
+    assert_int_equal(LOG_INVALID_PARAMETER, addCategory(&many[NB_MANY_CATEGORIES - 1]));
+
+    assert_int_equal(3 + NB_MANY_CATEGORIES, getCategories(&configured));
+    for (i = 0; i < NB_MANY_CATEGORIES; i++)
+    {
+        assert_int_equal(3 + i, many[i].index);
+        assert_ptr_equal(&many[i], configured[many[i].index]);
+    }
+
+    assert_int_equal(LOG_OK, setLevels(LEVEL_ERROR));
+    assert_int_equal(LEVEL_ERROR, many[NB_MANY_CATEGORIES - 1].currentLogLevel);
+}
+
+void categoriesRoutedBeyond255(void** state)
+{
+    (void) state;
+
+    assert_int_equal(LOG_OK, addLogger(&filtered));
+
+    nbPublished = 0;
+    nbFiltered = 0;
+    logError(many[NB_MANY_CATEGORIES - 1], "Routed to both loggers");
+    logError(many[NB_MANY_CATEGORIES - 2], "Only routed to the sink");
+    assert_int_equal(2, nbPublished);
+    assert_int_equal(1, nbFiltered);
+}
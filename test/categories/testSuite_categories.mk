@@ -0,0 +1,10 @@
+Test/Inc/categories := \
+  include \
+  test/mocks
+
+Test/Def/categories :=
+
+Test/Src/categories := \
+  src/slf4ec.c \
+  src/logThreadSlots.c \
+  src/logContext.c
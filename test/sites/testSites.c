@@ -0,0 +1,333 @@
+/**
+ * @file
+ *
+ * Tests of the log call sites
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "testSites.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "slf4ec/log.h"
+#include "slf4ec/slf4ecCtrl.h"
+
+static uint64_t getTimestamp(void)
+{
+    return 42;
+}
+
+const GetLogTimestamp logTimeApi = &getTimestamp;
+
+static const uint8_t noArg = 0;
+static uint32_t nbPublished = 0;
+static char lastMessage[128];
+
+static LogCategory netCategory = {.name = "Net", .currentLogLevel = LEVEL_INFO};
+static LogCategory diskCategory = {.name = "Disk", .currentLogLevel = LEVEL_INFO};
+static LogCategory* categories[] = {&netCategory, &diskCategory};
+
+static void sinkInit(const void* const config)
+{
+    (void) config;
+}
+
+static void sinkPublisher(const LogRecordV2* const record, const LogFormat format)
+{
+    va_list args;
+
+    (void) format;
+    va_copy(args, *record->vaList);
+    (void) vsnprintf(lastMessage, sizeof(lastMessage), record->formatStr, args);
+    va_end(args);
+    nbPublished++;
+}
+
+static Logger sink = {.loggerName = "Sink", .initFct = &sinkInit, .initArgs = &noArg, .format = FORMAT_FULL, .currentLogLevel = LEVEL_MAX, .publishFctV2 = &sinkPublisher};
+static Logger* loggers[] = {&sink};
+
+/*
+ * Call sites used by the tests, the functions and formats being matched by name
+ */
+
+static void sendPacket(const int length)
+{
+    (void) logInfo(netCategory, "Sending %d bytes", length);
+    (void) logDebug(netCategory, "Packet of %d bytes queued", length);
+}
+
+static void receivePacket(const int length)
+{
+    (void) logDebug(netCategory, "Packet of %d bytes received", length);
+}
+
+static void writeBlock(void)
+{
+    (void) logDebug(diskCategory, "Block written");
+}
+
+static void logAgainst(LogCategory* const category)
+{
+    (void) logDebug(*category, "Shared site");
+}
+
+/**
+ * Number of records published by a call, along with its message.
+ */
+#define PUBLISHED(call) (nbPublished = 0, lastMessage[0] = '\0', (call), nbPublished)
+
+static LogCallSite* findSite(const char* const function, const uint8_t level)
+{
+    LogCallSite* sites;
+    const size_t nbSites = getCallSites(&sites);
+    size_t i;
+
+    for (i = 0; i < nbSites; i++)
+    {
+        if (strcmp(sites[i].function, function) == 0 && sites[i].level == level)
+        {
+            return &sites[i];
+        }
+    }
+
+    return NULL;
+}
+
+void sitesBadParams(void** state)
+{
+    (void) state;
+
+    const LogSiteQuery any = {NULL, NULL, 0, 0, NULL};
+
+    assert_int_equal(LOG_INVALID_PARAMETER, setCallSites(NULL, LOG_SITE_ENABLED, NULL));
+    assert_int_equal(LOG_INVALID_PARAMETER, setCallSites(&any, (LogSiteControl) 3, NULL));
+
+    // Sites do not log before initialization
+    assert_int_equal(LOG_NOT_INITIALIZED, logInfo(netCategory, "Too early"));
+    assert_int_equal(LOG_OK, initLogger(2, categories, 1, loggers));
+}
+
+void sitesRegistered(void** state)
+{
+    (void) state;
+
+    const LogCallSite* const site = findSite("sendPacket", LEVEL_DEBUG);
+
+    assert_non_null(site);
+    assert_non_null(strstr(site->file, "testSites.c"));
+    assert_string_equal("Packet of %d bytes queued", site->formatStr);
+    assert_int_equal(1, site->hasLocation);
+    assert_int_equal(LOG_SITE_DEFAULT, site->control);
+    assert_non_null(findSite("sendPacket", LEVEL_INFO));
+    assert_non_null(findSite("receivePacket", LEVEL_DEBUG));
+    assert_null(findSite("receivePacket", LEVEL_INFO));
+}
+
+void sitesFollowCategory(void** state)
+{
+    (void) state;
+
+    LogCallSite* const site = findSite("sendPacket", LEVEL_DEBUG);
+
+    assert_int_equal(1, PUBLISHED(sendPacket(10)));
+    assert_string_equal("Sending 10 bytes", lastMessage);
+
+    // The disabled site remembers it, the next call does not reach SLF4EC
+    assert_true(site->disabledFor == &netCategory);
+
+    assert_int_equal(LOG_OK, setLevels(LEVEL_DEBUG));
+    assert_null(site->disabledFor);
+    assert_int_equal(2, PUBLISHED(sendPacket(20)));
+    assert_string_equal("Packet of 20 bytes queued", lastMessage);
+
+    assert_int_equal(LOG_OK, setLevels(LEVEL_INFO));
+    assert_int_equal(1, PUBLISHED(sendPacket(30)));
+
+    // Levels changed directly are only seen once the sites are invalidated
+    netCategory.currentLogLevel = LEVEL_DEBUG;
+    assert_int_equal(1, PUBLISHED(sendPacket(40)));
+    invalidateCallSites();
+    assert_int_equal(2, PUBLISHED(sendPacket(50)));
+    assert_int_equal(LOG_OK, setLevels(LEVEL_INFO));
+}
+
+void sitesEnableFunction(void** state)
+{
+    (void) state;
+
+    const LogSiteQuery receiving = {NULL, "receivePacket", 0, 0, NULL};
+    uint32_t nbSites = 0;
+
+    assert_int_equal(0, PUBLISHED(receivePacket(1)));
+
+    // Debug records of a single function, the other sites of the category keep following its level
+    assert_int_equal(LOG_OK, setCallSites(&receiving, LOG_SITE_ENABLED, &nbSites));
+    assert_int_equal(1, nbSites);
+    assert_int_equal(1, PUBLISHED(receivePacket(2)));
+    assert_string_equal("Packet of 2 bytes received", lastMessage);
+    assert_int_equal(1, PUBLISHED(sendPacket(3)));
+    assert_string_equal("Sending 3 bytes", lastMessage);
+
+    // Still enabled whatever the level of the category
+    assert_int_equal(LOG_OK, setLevels(LEVEL_OFF));
+    assert_int_equal(1, PUBLISHED(receivePacket(4)));
+    assert_int_equal(0, PUBLISHED(sendPacket(5)));
+    assert_int_equal(LOG_OK, setLevels(LEVEL_INFO));
+
+    assert_int_equal(LOG_OK, setCallSites(&receiving, LOG_SITE_DEFAULT, &nbSites));
+    assert_int_equal(0, PUBLISHED(receivePacket(6)));
+}
+
+void sitesQuery(void** state)
+{
+    (void) state;
+
+    const LogCallSite* const site = findSite("sendPacket", LEVEL_INFO);
+    const LogSiteQuery byFormat = {NULL, NULL, 0, 0, "bytes"};
+    const LogSiteQuery byLine = {"sites/testSites.c", NULL, site->line, site->line, NULL};
+    const LogSiteQuery otherFile = {"Sites.c", NULL, 0, 0, NULL};
+    const LogSiteQuery byFile = {"testSites.c", NULL, 0, 0, NULL};
+    const LogSiteQuery none = {NULL, "noSuchFunction", 0, 0, NULL};
+    uint32_t nbSites = 0;
+
+    assert_int_equal(LOG_OK, setCallSites(&byFormat, LOG_SITE_ENABLED, &nbSites));
+    assert_int_equal(3, nbSites);
+    assert_int_equal(2, PUBLISHED(sendPacket(1)));
+    assert_int_equal(1, PUBLISHED(receivePacket(2)));
+    assert_int_equal(0, PUBLISHED(writeBlock()));
+
+    // Disabling the info site of sendPacket by its line
+    assert_int_equal(LOG_OK, setCallSites(&byLine, LOG_SITE_DISABLED, &nbSites));
+    assert_int_equal(1, nbSites);
+    assert_int_equal(1, PUBLISHED(sendPacket(3)));
+    assert_string_equal("Packet of 3 bytes queued", lastMessage);
+
+    // Files match on whole path components
+    assert_int_equal(LOG_OK, setCallSites(&otherFile, LOG_SITE_DEFAULT, &nbSites));
+    assert_int_equal(0, nbSites);
+    assert_int_equal(LOG_OK, setCallSites(&none, LOG_SITE_DEFAULT, &nbSites));
+    assert_int_equal(0, nbSites);
+
+    assert_int_equal(LOG_OK, setCallSites(&byFile, LOG_SITE_DEFAULT, &nbSites));
+    assert_true(nbSites >= 5);
+    assert_int_equal(1, PUBLISHED(sendPacket(4)));
+    assert_string_equal("Sending 4 bytes", lastMessage);
+}
+
+void sitesSeveralCategories(void** state)
+{
+    (void) state;
+
+    // A site disabled for a category still logs against another one
+    diskCategory.currentLogLevel = LEVEL_DEBUG;
+    invalidateCallSites();
+    assert_int_equal(0, PUBLISHED(logAgainst(&netCategory)));
+    assert_int_equal(1, PUBLISHED(logAgainst(&diskCategory)));
+    assert_int_equal(0, PUBLISHED(logAgainst(&netCategory)));
+    assert_int_equal(1, PUBLISHED(logAgainst(&diskCategory)));
+    assert_int_equal(1, PUBLISHED(writeBlock()));
+    assert_string_equal("Block written", lastMessage);
+}
+
+void sitesLevelOverride(void** state)
+{
+    (void) state;
+
+    const LogLevelOverride debug = {LEVEL_DEBUG, 0, NULL};
+    LogCallSite* const site = findSite("sendPacket", LEVEL_DEBUG);
+
+    assert_int_equal(LOG_OK, setLevels(LEVEL_INFO));
+    assert_int_equal(1, PUBLISHED(sendPacket(1)));
+    assert_true(site->disabledFor == &netCategory);
+
+    // Disabled sites are evaluated again, and no longer remember it while a thread overrides levels
+    assert_int_equal(LOG_OK, setThreadLevelOverride(&debug));
+    assert_null(site->disabledFor);
+    assert_int_equal(2, PUBLISHED(sendPacket(2)));
+
+    assert_int_equal(LOG_OK, setThreadLevelOverride(NULL));
+    assert_int_equal(1, PUBLISHED(sendPacket(3)));
+    assert_true(site->disabledFor == &netCategory);
+}
+
+static void* overrideAndExit(void* arg)
+{
+    const LogLevelOverride debug = {LEVEL_DEBUG, 0, NULL};
+
+    (void) arg;
+    (void) setThreadLevelOverride(&debug);
+
+    return NULL;
+}
+
+void sitesOverrideThreadExit(void** state)
+{
+    (void) state;
+
+    LogCallSite* const site = findSite("sendPacket", LEVEL_DEBUG);
+    pthread_t thread;
+
+    assert_int_equal(LOG_OK, setLevels(LEVEL_INFO));
+    assert_int_equal(0, pthread_create(&thread, NULL, &overrideAndExit, NULL));
+    assert_int_equal(0, pthread_join(thread, NULL));
+
+    // The override went away with the thread, disabled sites are remembered again
+    assert_int_equal(1, PUBLISHED(sendPacket(1)));
+    assert_true(site->disabledFor == &netCategory);
+}
+
+void sitesOverrideAfterCaching(void** state)
+{
+    (void) state;
+
+    LogCategory* const diskOnly[] = {&diskCategory};
+    const LogLevelOverride debugDisk = {LEVEL_DEBUG, 1, diskOnly};
+    LogCallSite* const diskSite = findSite("writeBlock", LEVEL_DEBUG);
+    LogCallSite* const netSite = findSite("sendPacket", LEVEL_DEBUG);
+
+    assert_int_equal(LOG_OK, setLevels(LEVEL_INFO));
+    assert_int_equal(0, PUBLISHED(writeBlock()));
+    assert_int_equal(1, PUBLISHED(sendPacket(1)));
+    assert_true(diskSite->disabledFor == &diskCategory);
+    assert_true(netSite->disabledFor == &netCategory);
+
+    // The first override forgets the cached verdicts, sites of other categories stay disabled for the thread
+    assert_int_equal(LOG_OK, setThreadLevelOverride(&debugDisk));
+    assert_null(diskSite->disabledFor);
+    assert_int_equal(1, PUBLISHED(writeBlock()));
+    assert_string_equal("Block written", lastMessage);
+    assert_int_equal(1, PUBLISHED(sendPacket(2)));
+    assert_string_equal("Sending 2 bytes", lastMessage);
+
+    assert_int_equal(LOG_OK, setThreadLevelOverride(NULL));
+    assert_int_equal(0, PUBLISHED(writeBlock()));
+    assert_true(diskSite->disabledFor == &diskCategory);
+}
@@ -0,0 +1,12 @@
+Test/Inc/sites := \
+  include \
+  test/mocks
+
+Test/Def/sites := \
+  USE_CALL_SITES
+
+Test/Src/sites := \
+  src/slf4ec.c \
+  src/logThreadSlots.c \
+  src/logSites.c \
+  src/logContext.c
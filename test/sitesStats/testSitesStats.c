@@ -0,0 +1,145 @@
+/**
+ * @file
+ *
+ * Tests of the statistics of the log call sites
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "testSitesStats.h"
+
+#include <string.h>
+
+#include "slf4ec/log.h"
+#include "slf4ec/slf4ecCtrl.h"
+
+static uint64_t getTimestamp(void)
+{
+    return 42;
+}
+
+const GetLogTimestamp logTimeApi = &getTimestamp;
+const GetLogTimestamp logTickApi = &getTimestamp;
+
+static const uint8_t noArg = 0;
+static uint32_t nbPublished = 0;
+
+static LogCategory netCategory = {.name = "Net", .currentLogLevel = LEVEL_INFO};
+static LogCategory* categories[] = {&netCategory};
+
+static void sinkInit(const void* const config)
+{
+    (void) config;
+}
+
+static void sinkPublisher(const LogRecordV2* const record, const LogFormat format)
+{
+    (void) record;
+    (void) format;
+    nbPublished++;
+}
+
+static Logger sink = {.loggerName = "Sink", .initFct = &sinkInit, .initArgs = &noArg, .format = FORMAT_FULL, .currentLogLevel = LEVEL_MAX, .publishFctV2 = &sinkPublisher};
+static Logger* loggers[] = {&sink};
+
+static void sendPacket(const int length)
+{
+    (void) logInfo(netCategory, "Sending %d bytes", length);
+    (void) logDebug(netCategory, "Packet of %d bytes queued", length);
+}
+
+static LogCallSite* findSite(const char* const function, const uint8_t level)
+{
+    LogCallSite* sites;
+    const size_t nbSites = getCallSites(&sites);
+    size_t i;
+
+    for (i = 0; i < nbSites; i++)
+    {
+        if (strcmp(sites[i].function, function) == 0 && sites[i].level == level)
+        {
+            return &sites[i];
+        }
+    }
+
+    return NULL;
+}
+
+void sitesStatsCountFiltered(void** state)
+{
+    (void) state;
+
+    LogStats before, after;
+    LogCategoryStats categoryBefore, categoryAfter;
+    LogCallSite* const site = findSite("sendPacket", LEVEL_DEBUG);
+
+    assert_int_equal(LOG_OK, initLogger(1, categories, 1, loggers));
+    assert_int_equal(LOG_OK, getLogStats(&before));
+    assert_int_equal(LOG_OK, getCategoryStats(&netCategory, &categoryBefore));
+
+    // The debug site remembers it is disabled, its calls are still counted
+    sendPacket(1);
+    assert_true(site->disabledFor == &netCategory);
+    sendPacket(2);
+    sendPacket(3);
+
+    assert_int_equal(LOG_OK, getLogStats(&after));
+    assert_int_equal(LOG_OK, getCategoryStats(&netCategory, &categoryAfter));
+    assert_int_equal(3, nbPublished);
+    assert_int_equal(before.calls[LEVEL_INFO] + 3, after.calls[LEVEL_INFO]);
+    assert_int_equal(before.calls[LEVEL_DEBUG] + 3, after.calls[LEVEL_DEBUG]);
+    assert_int_equal(before.filteredByCategory[LEVEL_DEBUG] + 3, after.filteredByCategory[LEVEL_DEBUG]);
+    assert_int_equal(before.published[LEVEL_INFO] + 3, after.published[LEVEL_INFO]);
+    assert_int_equal(categoryBefore.calls + 6, categoryAfter.calls);
+    assert_int_equal(categoryBefore.filtered + 3, categoryAfter.filtered);
+}
+
+void sitesStatsProfileFiltered(void** state)
+{
+    (void) state;
+
+    const LogCallSite* const site = findSite("sendPacket", LEVEL_DEBUG);
+    LogSiteProfile profile[8];
+    size_t nbSites = sizeof(profile) / sizeof(profile[0]);
+    size_t i;
+    const LogSiteProfile* found = NULL;
+
+    assert_int_equal(LOG_OK, getLogProfile(profile, &nbSites, PROFILE_BY_CALLS));
+    for (i = 0; i < nbSites; i++)
+    {
+        if (profile[i].file != NULL && profile[i].line == site->line && strcmp(profile[i].file, site->file) == 0)
+        {
+            found = &profile[i];
+        }
+    }
+
+    // Filtered sites are profiled as well
+    assert_non_null(found);
+    assert_int_equal(3, found->calls);
+    assert_int_equal(0, found->published);
+}
@@ -0,0 +1,17 @@
+Test/Inc/sitesStats := \
+  include \
+  test/mocks
+
+Test/Def/sitesStats := \
+  USE_CALL_SITES \
+  USE_LOG_STATS \
+  USE_LOG_PROFILER
+
+Test/Src/sitesStats := \
+  src/slf4ec.c \
+  src/logThreadSlots.c \
+  src/logSites.c \
+  src/logContext.c \
+  src/stats.c \
+  src/profiler.c \
+  src/histogram.c
@@ -0,0 +1,300 @@
+/**
+ * @file
+ *
+ * Test async.c
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "testAsync.h"
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "slf4ec/slf4ecCtrl.h"
+#include "slf4ec/logger/async.h"
+
+#define MAX_MESSAGES (512)
+#define NB_THREADS (4)
+#define RECORDS_PER_THREAD (2000)
+
+static LogCategory asyncCategory = {.name = "asyncCategory", .currentLogLevel = LEVEL_MAX};
+static char messages[MAX_MESSAGES][128];
+static LogRecordV2 published[MAX_MESSAGES];
+static LogContext publishedContext;
+static size_t nbPublished = 0;
+static uint32_t spanThread = 0;
+static uint64_t spanDuration = 0;
+
+static void targetInit(const void* const config)
+{
+    (void) config;
+}
+
+static void targetPublisher(const LogRecordV2* const record, const LogFormat format)
+{
+    va_list ap;
+    (void) format;
+
+    va_copy(ap, *record->vaList);
+    if ((record->flags & (LOG_RECORD_SPAN_BEGIN | LOG_RECORD_SPAN_END)) != 0)
+    {
+        strcpy(messages[nbPublished % MAX_MESSAGES], va_arg(ap, const char*) );
+        spanThread = va_arg(ap, uint32_t);
+        spanDuration = va_arg(ap, uint64_t);
+    }
+    else
+    {
+        vsnprintf(messages[nbPublished % MAX_MESSAGES], sizeof(messages[0]), record->formatStr, ap);
+    }
+    va_end(ap);
+
+    if ((record->flags & LOG_RECORD_HAS_CONTEXT) != 0)
+    {
+        publishedContext = *record->context;
+    }
+    published[nbPublished % MAX_MESSAGES] = *record;
+    nbPublished++;
+}
+
+static Logger target = {.loggerName = "Target", .initFct = &targetInit, .initArgs = NULL, .format = FORMAT_MSG_ONLY, .currentLogLevel = LEVEL_MAX, .publishFctV2 = &targetPublisher};
+
+static void logRecord(const uint8_t flags, const LogContext* const context, const char* const formatStr, ...)
+{
+    va_list args;
+
+    va_start(args, formatStr);
+    const LogRecordV2 record = {.timestamp = 42,
+                                .category = &asyncCategory,
+                                .formatStr = formatStr,
+                                .vaList = &args,
+                                .file = "file.c",
+                                .function = "function",
+                                .context = context,
+                                .line = 17,
+                                .level = LEVEL_INFO,
+                                .flags = flags};
+    logToAsyncV2(&record, FORMAT_FULL);
+    va_end(args);
+}
+
+static void openAsync(const uint32_t arenaSize, const uint32_t drainPeriod)
+{
+    const AsyncLoggerConfig config = {&target, arenaSize, drainPeriod};
+
+    nbPublished = 0;
+    initAsyncLogger(&config);
+    assert_int_equal(LOG_OK, getAsyncLoggerStatus());
+}
+
+/**
+ * Format as the target logger would have if the record had been published right away
+ */
+static const char* format(char* const buffer, const char* const formatStr, ...)
+{
+    va_list args;
+
+    va_start(args, formatStr);
+    vsnprintf(buffer, sizeof(messages[0]), formatStr, args);
+    va_end(args);
+
+    return buffer;
+}
+
+void asyncBadParams(void** state)
+{
+    (void) state;
+    Logger noPublisher = {.loggerName = "NoPublisher", .initFct = &targetInit, .initArgs = NULL, .format = FORMAT_MSG_ONLY, .currentLogLevel = LEVEL_MAX, .publishFct = NULL, .publishFctV2 = NULL};
+    AsyncLoggerConfig config = {NULL, 0, 0};
+
+    initAsyncLogger(NULL);
+    assert_int_equal(LOG_INVALID_PARAMETER, getAsyncLoggerStatus());
+    initAsyncLogger(&config);
+    assert_int_equal(LOG_INVALID_PARAMETER, getAsyncLoggerStatus());
+    config.target = &noPublisher;
+    initAsyncLogger(&config);
+    assert_int_equal(LOG_INVALID_PARAMETER, getAsyncLoggerStatus());
+    config.target = &target;
+    config.arenaSize = ASYNC_MIN_ARENA_SIZE + 8;
+    initAsyncLogger(&config);
+    assert_int_equal(LOG_INVALID_PARAMETER, getAsyncLoggerStatus());
+
+    // Ignored until initialized
+    nbPublished = 0;
+    logRecord(0, NULL, "Nowhere");
+    flushAsyncLogger();
+    closeAsyncLogger();
+    assert_int_equal(0, nbPublished);
+}
+
+void asyncStackArguments(void** state)
+{
+    (void) state;
+    char buffer[32];
+    char expected[128];
+    const long double precise = 2.5L;
+    int written = 0;
+
+    openAsync(0, 0);
+
+    // Formatted by the drain, once the buffers are gone
+    strcpy(buffer, "first");
+    logRecord(0, NULL, "Buffer %s, %5.2f|%-4d|%*d|%.*s|%c%%|%lld|%hhu|%zx|%Lg|%+d|%#o", buffer, 3.14159, 7, 6, -42, 3, "truncated", 'z',
+              -1234567890123LL, 300, (size_t) 0xBEEF, precise, 5, 8);
+    strcpy(buffer, "second");
+    logRecord(0, NULL, "Buffer %s, %-*d| %.*s|%s", buffer, -5, 1, -1, "negative precision", (const char*) NULL);
+    memset(buffer, 'X', sizeof(buffer) - 1);
+    // Not captured, formatted right away
+    logRecord(0, NULL, "Written%n %ls", &written, L"wide");
+    assert_int_equal(0, nbPublished);
+    assert_int_equal(7, written);
+
+    flushAsyncLogger();
+    assert_int_equal(3, nbPublished);
+    assert_string_equal(format(expected, "Buffer %s, %5.2f|%-4d|%*d|%.*s|%c%%|%lld|%hhu|%zx|%Lg|%+d|%#o", "first", 3.14159, 7, 6, -42, 3,
+                               "truncated", 'z', -1234567890123LL, 300, (size_t) 0xBEEF, precise, 5, 8),
+                        messages[0]);
+    assert_string_equal(format(expected, "Buffer %s, %-*d| %.*s|%s", "second", -5, 1, -1, "negative precision", (const char*) NULL),
+                        messages[1]);
+    assert_string_equal("Written wide", messages[2]);
+    assert_int_equal(42, published[0].timestamp);
+    assert_int_equal(17, published[0].line);
+    assert_string_equal("function", published[0].function);
+    assert_ptr_equal(&asyncCategory, published[0].category);
+
+    // Nothing left
+    flushAsyncLogger();
+    assert_int_equal(3, nbPublished);
+    closeAsyncLogger();
+}
+
+void asyncArenaFull(void** state)
+{
+    (void) state;
+    char text[200];
+    char expected[256];
+    int round;
+    int i;
+
+    memset(text, 'a', sizeof(text) - 1);
+    text[sizeof(text) - 1] = '\0';
+    openAsync(ASYNC_MIN_ARENA_SIZE, 0);
+
+    // Each round goes around the arena, some records have to wrap
+    for (round = 0; round < 5; round++)
+    {
+        const uint64_t dropped = getAsyncLoggerDropped();
+        int logged = 0;
+
+        nbPublished = 0;
+        for (i = 0; getAsyncLoggerDropped() == dropped; i++)
+        {
+            logRecord(0, NULL, "%d %s", i, text);
+            logged++;
+        }
+        flushAsyncLogger();
+        assert_int_equal(logged - 1, nbPublished);
+        assert_string_equal(format(expected, "%d %s", 0, text), messages[0]);
+
+        // The arena was reclaimed as a whole
+        logRecord(0, NULL, "After round %d", round);
+        flushAsyncLogger();
+        assert_string_equal(format(expected, "After round %d", round), messages[(nbPublished - 1) % MAX_MESSAGES]);
+
+        // Shift the start of the next round
+        logRecord(0, NULL, "%.*s", round * 8, text);
+        flushAsyncLogger();
+    }
+    closeAsyncLogger();
+}
+
+void asyncSpanAndContext(void** state)
+{
+    (void) state;
+    char value[16] = "17";
+    LogContext context = {4242, "worker", 1, {{"request", value}}};
+
+    openAsync(0, 0);
+    logRecord(LOG_RECORD_SPAN_END | LOG_RECORD_HAS_CONTEXT, &context, LOG_SPAN_END_FORMAT, "parse", (uint32_t) 99, (uint64_t) 1234);
+    strcpy(value, "gone");
+    strcpy(context.threadName, "other");
+    flushAsyncLogger();
+
+    assert_int_equal(1, nbPublished);
+    assert_int_equal(LOG_RECORD_SPAN_END | LOG_RECORD_HAS_CONTEXT, published[0].flags);
+    assert_string_equal("parse", messages[0]);
+    assert_int_equal(99, spanThread);
+    assert_int_equal(1234, spanDuration);
+    assert_int_equal(4242, publishedContext.threadId);
+    assert_string_equal("worker", publishedContext.threadName);
+    assert_int_equal(1, publishedContext.nbEntries);
+    assert_string_equal("request", publishedContext.entries[0].key);
+    assert_string_equal("17", publishedContext.entries[0].value);
+    closeAsyncLogger();
+}
+
+static void* logFromThread(void* arg)
+{
+    char name[16];
+    int i;
+
+    (void) snprintf(name, sizeof(name), "thread%d", *(int*) arg);
+    for (i = 0; i < RECORDS_PER_THREAD; i++)
+    {
+        logRecord(0, NULL, "%s record %d", name, i);
+    }
+
+    return NULL;
+}
+
+void asyncThreads(void** state)
+{
+    (void) state;
+    pthread_t threads[NB_THREADS];
+    int ids[NB_THREADS];
+    int i;
+
+    openAsync(1u << 14, 1);
+    const uint64_t dropped = getAsyncLoggerDropped();
+    for (i = 0; i < NB_THREADS; i++)
+    {
+        ids[i] = i;
+        assert_int_equal(0, pthread_create(&threads[i], NULL, &logFromThread, &ids[i]));
+    }
+    for (i = 0; i < NB_THREADS; i++)
+    {
+        assert_int_equal(0, pthread_join(threads[i], NULL));
+    }
+    closeAsyncLogger();
+
+    assert_int_equal(NB_THREADS * RECORDS_PER_THREAD, nbPublished + (getAsyncLoggerDropped() - dropped));
+    assert_true(strncmp(messages[0], "thread", strlen("thread")) == 0);
+    assert_true(strstr(messages[0], " record ") != NULL);
+}
@@ -0,0 +1,545 @@
+/**
+ * @file
+ *
+ * Tests for the file logger
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "testFile.h"
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "slf4ec/logger/file.h"
+
+#define TEST_FILE "testFileLogger.log"
+#define ANY_TIME_FROM (0)
+#define ANY_TIME_TO (UINT64_MAX)
+#define NB_RECORDS (500)
+
+extern LogCategory dummyCategory;
+
+static LogCategory fileCategory = {.name = "fileCategory", .currentLogLevel = LEVEL_MAX};
+static char expected[65536];
+static char actual[65536];
+static uint8_t block[FILE_MAX_BLOCK_SIZE];
+
+static void logRecordv(const LogCategory* const category,
+                       const uint8_t level,
+                       const uint64_t timestamp,
+                       const LogFormat format,
+                       const char* const formatStr,
+                       va_list vaList)
+{
+    va_list args;
+
+    // A va_list parameter decays to a pointer on some architectures, LogRecord needs the real type
+    va_copy(args, vaList);
+    LogRecord record = {.category = category, .formatStr = formatStr, .timestamp = &timestamp, .level = &level, .vaList = &args};
+    logToFile(&record, format);
+    va_end(args);
+}
+
+static void logRecord(const LogFormat format, const char* const formatStr, ...)
+{
+    va_list vaList;
+
+    va_start(vaList, formatStr);
+    logRecordv(&fileCategory, LEVEL_INFO, 42, format, formatStr, vaList);
+    va_end(vaList);
+}
+
+static void logRecordAt(const LogCategory* const category, const uint8_t level, const uint64_t timestamp, const char* const formatStr, ...)
+{
+    va_list vaList;
+
+    va_start(vaList, formatStr);
+    logRecordv(category, level, timestamp, FORMAT_MSG_ONLY, formatStr, vaList);
+    va_end(vaList);
+}
+
+static size_t logManyRecords(void)
+{
+    size_t size = 0;
+    int i;
+
+    for (i = 0; i < NB_RECORDS; i++)
+    {
+        logRecord(FORMAT_FULL, "Record %d of %s", i, "the test");
+        size += sprintf(&expected[size], "[INFO][fileCategory][42] - Record %d of the test\n", i);
+    }
+
+    return size;
+}
+
+static size_t readText(void)
+{
+    FILE* file = fopen(TEST_FILE, "rb");
+    size_t size = fread(actual, 1, sizeof(actual), file);
+
+    fclose(file);
+    return size;
+}
+
+static size_t readBlocks(int* const nbBlocks, int* const nbCompressed)
+{
+    FILE* file = fopen(TEST_FILE, "rb");
+    FileBlockHeader header;
+    size_t size = 0;
+
+    *nbBlocks = 0;
+    *nbCompressed = 0;
+    while (readFileBlock(file, &header, block, sizeof(block)))
+    {
+        memcpy(&actual[size], block, header.rawSize);
+        size += header.rawSize;
+        (*nbBlocks)++;
+        *nbCompressed += (header.flags & FILE_BLOCK_COMPRESSED) ? 1 : 0;
+    }
+
+    fclose(file);
+    return size;
+}
+
+void fileBadParams(void** state)
+{
+    (void) state;
+
+    const FileLoggerConfig noPath = {.path = NULL, .encoding = FILE_ENCODING_TEXT};
+    const FileLoggerConfig blockTooLarge = {.path = TEST_FILE, .encoding = FILE_ENCODING_TEXT, .blockSize = FILE_MAX_BLOCK_SIZE + 1};
+
+    initFileLogger(NULL);
+    assert_int_equal(LOG_INVALID_PARAMETER, getFileLoggerStatus());
+    initFileLogger(&noPath);
+    assert_int_equal(LOG_INVALID_PARAMETER, getFileLoggerStatus());
+    initFileLogger(&blockTooLarge);
+    assert_int_equal(LOG_INVALID_PARAMETER, getFileLoggerStatus());
+
+    // Dropped silently
+    logRecord(FORMAT_FULL, "Not logged");
+}
+
+void fileText(void** state)
+{
+    (void) state;
+
+    const FileLoggerConfig config = {.path = TEST_FILE, .encoding = FILE_ENCODING_TEXT};
+
+    remove(TEST_FILE);
+    initFileLogger(&config);
+    assert_int_equal(LOG_OK, getFileLoggerStatus());
+    // Not configured to rotate
+    assert_int_equal(LOG_INVALID_PARAMETER, requestFileRotation());
+
+    logRecord(FORMAT_FULL, "First %s", "record");
+    logRecord(FORMAT_MSG_ONLY, "Second record %d", 2);
+    closeFileLogger();
+    assert_int_equal(LOG_NOT_INITIALIZED, getFileLoggerStatus());
+
+    const char* const text = "[INFO][fileCategory][42] - First record\nSecond record 2\n";
+    assert_int_equal(strlen(text), readText());
+    assert_memory_equal(text, actual, strlen(text));
+
+    remove(TEST_FILE);
+}
+
+void fileCompressedBlocks(void** state)
+{
+    (void) state;
+
+    const FileLoggerConfig config = {.path = TEST_FILE, .encoding = FILE_ENCODING_COMPRESSED, .blockSize = 2048};
+    int nbBlocks;
+    int nbCompressed;
+
+    remove(TEST_FILE);
+    initFileLogger(&config);
+    const size_t size = logManyRecords();
+    closeFileLogger();
+
+    assert_int_equal(size, readBlocks(&nbBlocks, &nbCompressed));
+    assert_memory_equal(expected, actual, size);
+    assert_true(nbBlocks > 1);
+    assert_int_equal(nbBlocks, nbCompressed);
+
+    FILE* file = fopen(TEST_FILE, "rb");
+    fseek(file, 0, SEEK_END);
+    assert_true((size_t) ftell(file) * 3 < size);
+    fclose(file);
+
+    remove(TEST_FILE);
+}
+
+void fileTruncated(void** state)
+{
+    (void) state;
+
+    const FileLoggerConfig config = {.path = TEST_FILE, .encoding = FILE_ENCODING_BLOCKS, .blockSize = 1024};
+    int nbBlocks;
+    int nbCompressed;
+
+    remove(TEST_FILE);
+    initFileLogger(&config);
+    (void) logManyRecords();
+    closeFileLogger();
+
+    // Drop the end of the last block
+    FILE* file = fopen(TEST_FILE, "rb");
+    const size_t fileSize = fread(actual, 1, sizeof(actual), file);
+    fclose(file);
+    file = fopen(TEST_FILE, "wb");
+    fwrite(actual, 1, fileSize - 10, file);
+    fclose(file);
+
+    const size_t size = readBlocks(&nbBlocks, &nbCompressed);
+    assert_true(nbBlocks > 1);
+    assert_int_equal(0, nbCompressed);
+    assert_true(size > 0);
+    assert_true(size < fileSize);
+    assert_memory_equal(expected, actual, size);
+    assert_int_equal('\n', actual[size - 1]);
+
+    // Without the index, the block headers are scanned
+    FileIndex index;
+    file = fopen(TEST_FILE, "rb");
+    assert_int_equal(LOG_OK, openFileIndex(file, &index));
+    assert_int_equal(nbBlocks, index.nbBlocks);
+    closeFileIndex(&index);
+    fclose(file);
+
+    remove(TEST_FILE);
+}
+
+void fileLongRecord(void** state)
+{
+    (void) state;
+
+    const FileLoggerConfig config = {.path = TEST_FILE, .encoding = FILE_ENCODING_BLOCKS, .blockSize = 64};
+    int nbBlocks;
+    int nbCompressed;
+
+    remove(TEST_FILE);
+    initFileLogger(&config);
+    logRecord(FORMAT_MSG_ONLY, "short");
+    logRecord(FORMAT_MSG_ONLY, "%0100d", 1);
+    closeFileLogger();
+
+    assert_int_equal(6 + 64, readBlocks(&nbBlocks, &nbCompressed));
+    assert_int_equal(2, nbBlocks);
+    assert_memory_equal("short\n0000", actual, 10);
+    assert_int_equal('\n', actual[6 + 63]);
+
+    remove(TEST_FILE);
+}
+
+/**
+ * Log records 0 to NB_RECORDS - 1 with their number as timestamp. Records 100 to 199 use another category and record
+ * 250 is the only error.
+ */
+static void logIndexedRecords(const FileLoggerConfig* const config)
+{
+    int i;
+
+    initFileLogger(config);
+    for (i = 0; i < NB_RECORDS; i++)
+    {
+        logRecordAt((i >= 100 && i < 200) ? &fileCategory : &dummyCategory, (i == 250) ? LEVEL_ERROR : LEVEL_INFO, i,
+                    "Record %03d", i);
+    }
+    closeFileLogger();
+}
+
+/**
+ * Read every block matching @p query. Returns the number of blocks, their text is concatenated in actual.
+ */
+static uint32_t readMatchingBlocks(const FileIndex* const index, const FileQuery* const query)
+{
+    FileBlockHeader header;
+    uint32_t nbMatching = 0;
+    uint32_t position;
+    size_t size = 0;
+
+    for (position = findFileBlock(index, query, 0); position < index->nbBlocks; position = findFileBlock(index, query, position + 1))
+    {
+        assert_true(readIndexedBlock(index, position, &header, block, sizeof(block)));
+        memcpy(&actual[size], block, header.rawSize);
+        size += header.rawSize;
+        nbMatching++;
+    }
+    actual[size] = 0;
+
+    return nbMatching;
+}
+
+void fileIndexedQuery(void** state)
+{
+    (void) state;
+
+    const FileLoggerConfig config = {.path = TEST_FILE, .encoding = FILE_ENCODING_COMPRESSED, .blockSize = 256};
+    const FileQuery all = {ANY_TIME_FROM, ANY_TIME_TO, -1, LEVEL_MAX};
+    const FileQuery timeRange = {300, 310, -1, LEVEL_MAX};
+    const FileQuery errors = {ANY_TIME_FROM, ANY_TIME_TO, -1, LEVEL_ERROR};
+    const FileQuery otherCategory = {130, 170, 0, LEVEL_MAX};
+    FileIndex index;
+
+    dummyCategory.index = 0;
+    remove(TEST_FILE);
+    logIndexedRecords(&config);
+
+    FILE* file = fopen(TEST_FILE, "rb");
+    assert_int_equal(LOG_OK, openFileIndex(file, &index));
+    assert_true(index.nbBlocks > 10);
+    assert_int_equal(index.nbBlocks, readMatchingBlocks(&index, &all));
+
+    // Only the blocks holding the records looked for are read
+    assert_true(readMatchingBlocks(&index, &timeRange) <= 2);
+    assert_non_null(strstr(actual, "Record 300\n"));
+    assert_non_null(strstr(actual, "Record 310\n"));
+
+    assert_int_equal(1, readMatchingBlocks(&index, &errors));
+    assert_non_null(strstr(actual, "Record 250\n"));
+
+    assert_int_equal(0, readMatchingBlocks(&index, &otherCategory));
+
+    closeFileIndex(&index);
+    fclose(file);
+    remove(TEST_FILE);
+}
+
+void fileIndexAppended(void** state)
+{
+    (void) state;
+
+    const FileLoggerConfig config = {.path = TEST_FILE, .encoding = FILE_ENCODING_BLOCKS, .blockSize = 256};
+    const FileQuery all = {ANY_TIME_FROM, ANY_TIME_TO, -1, LEVEL_MAX};
+    FileIndex index;
+    uint32_t nbBlocks;
+
+    remove(TEST_FILE);
+    logIndexedRecords(&config);
+
+    FILE* file = fopen(TEST_FILE, "rb");
+    assert_int_equal(LOG_OK, openFileIndex(file, &index));
+    nbBlocks = index.nbBlocks;
+    closeFileIndex(&index);
+    fclose(file);
+
+    // The second run appends its blocks and index after the first index
+    logIndexedRecords(&config);
+
+    file = fopen(TEST_FILE, "rb");
+    assert_int_equal(LOG_OK, openFileIndex(file, &index));
+    assert_int_equal(2 * nbBlocks, index.nbBlocks);
+    assert_int_equal(2 * nbBlocks, readMatchingBlocks(&index, &all));
+    closeFileIndex(&index);
+    fclose(file);
+
+    remove(TEST_FILE);
+}
+
+/**
+ * Remove the test file and every file rotated from it.
+ */
+static void removeRotatedFiles(void)
+{
+    char path[64];
+    int number;
+
+    remove(TEST_FILE);
+    remove(TEST_FILE FILE_NEXT_SUFFIX);
+    for (number = 1; number <= NB_RECORDS; number++)
+    {
+        sprintf(path, "%s.%d", TEST_FILE, number);
+        remove(path);
+    }
+}
+
+/**
+ * Append the content of a rotated file to actual.
+ */
+static size_t appendFile(const char* const path, const size_t size)
+{
+    FILE* file = fopen(path, "rb");
+    size_t read = 0;
+
+    if (file != NULL)
+    {
+        read = fread(&actual[size], 1, sizeof(actual) - size, file);
+        fclose(file);
+    }
+
+    return size + read;
+}
+
+/**
+ * The next file is opened in the background, wait for it so that the next rotation is not deferred.
+ */
+static void waitForNextFile(void)
+{
+    FILE* file = NULL;
+    int i;
+
+    for (i = 0; i < 1000 && file == NULL; i++)
+    {
+        file = fopen(TEST_FILE FILE_NEXT_SUFFIX, "rb");
+        usleep(1000);
+    }
+    assert_non_null(file);
+    fclose(file);
+
+    // Let the archival thread hand it over
+    usleep(10000);
+}
+
+void fileRotateBySize(void** state)
+{
+    (void) state;
+
+    const FileLoggerConfig config = {.path = TEST_FILE, .encoding = FILE_ENCODING_TEXT, .blockSize = 1024, .rotateBytes = 4096, .keepFiles = 3};
+    char path[64];
+    size_t expectedSize = 0;
+    size_t size = 0;
+    int nbRotated = 0;
+    int number;
+    int i;
+
+    removeRotatedFiles();
+    initFileLogger(&config);
+    assert_int_equal(LOG_OK, getFileLoggerStatus());
+    for (i = 0; i < NB_RECORDS; i++)
+    {
+        // Several rotations, more than the files kept
+        if (i % 50 == 0)
+        {
+            waitForNextFile();
+        }
+        logRecord(FORMAT_FULL, "Record %d of %s", i, "the test");
+        expectedSize += sprintf(&expected[expectedSize], "[INFO][fileCategory][42] - Record %d of the test\n", i);
+        if (i % 50 == 49)
+        {
+            flushFileLogger();
+        }
+    }
+    closeFileLogger();
+
+    // Only the newest rotated files are kept, oldest first they hold the records preceding the current file
+    for (number = 1; number <= NB_RECORDS; number++)
+    {
+        sprintf(path, "%s.%d", TEST_FILE, number);
+        const size_t previousSize = size;
+        size = appendFile(path, size);
+        nbRotated += (size > previousSize) ? 1 : 0;
+    }
+    size = appendFile(TEST_FILE, size);
+
+    assert_int_equal(3, nbRotated);
+    assert_true(size < expectedSize);
+    assert_memory_equal(&expected[expectedSize - size], actual, size);
+    assert_null(fopen(TEST_FILE FILE_NEXT_SUFFIX, "rb"));
+
+    removeRotatedFiles();
+}
+
+void fileRotateOnRequest(void** state)
+{
+    (void) state;
+
+    // Neither by size nor by age
+    const FileLoggerConfig config = {.path = TEST_FILE, .encoding = FILE_ENCODING_BLOCKS, .blockSize = 1024, .rotateOnRequest = true};
+    const FileQuery all = {ANY_TIME_FROM, ANY_TIME_TO, -1, LEVEL_MAX};
+    FileIndex index;
+    FILE* file;
+
+    removeRotatedFiles();
+    initFileLogger(&config);
+    logRecord(FORMAT_MSG_ONLY, "Before");
+    flushFileLogger();
+
+    waitForNextFile();
+    assert_int_equal(LOG_OK, requestFileRotation());
+    logRecord(FORMAT_MSG_ONLY, "After");
+    closeFileLogger();
+
+    // The rotated file keeps its index
+    file = fopen(TEST_FILE ".1", "rb");
+    assert_non_null(file);
+    assert_int_equal(LOG_OK, openFileIndex(file, &index));
+    assert_int_equal(1, readMatchingBlocks(&index, &all));
+    assert_string_equal("Before\n", actual);
+    closeFileIndex(&index);
+    fclose(file);
+
+    file = fopen(TEST_FILE, "rb");
+    assert_int_equal(LOG_OK, openFileIndex(file, &index));
+    assert_int_equal(1, readMatchingBlocks(&index, &all));
+    assert_string_equal("After\n", actual);
+    closeFileIndex(&index);
+    fclose(file);
+
+    removeRotatedFiles();
+}
+
+void fileCompressArchives(void** state)
+{
+    (void) state;
+
+    const FileLoggerConfig config = {.path = TEST_FILE, .encoding = FILE_ENCODING_TEXT, .blockSize = 256, .rotateOnRequest = true, .compressArchives = true};
+    const FileQuery all = {ANY_TIME_FROM, ANY_TIME_TO, -1, LEVEL_MAX};
+    FileIndex index;
+    FILE* file;
+
+    removeRotatedFiles();
+    initFileLogger(&config);
+    const size_t size = logManyRecords();
+    flushFileLogger();
+
+    waitForNextFile();
+    assert_int_equal(LOG_OK, requestFileRotation());
+    logRecord(FORMAT_MSG_ONLY, "After");
+    closeFileLogger();
+
+    // The rotated text became compressed blocks of whole lines, the file in use stays text
+    file = fopen(TEST_FILE ".1", "rb");
+    assert_non_null(file);
+    assert_int_equal(LOG_OK, openFileIndex(file, &index));
+    assert_true(index.nbBlocks >= size / 256);
+    assert_int_equal(index.nbBlocks, readMatchingBlocks(&index, &all));
+    assert_int_equal(size, strlen(actual));
+    assert_memory_equal(expected, actual, size);
+    assert_true(fseek(file, 0, SEEK_END) == 0 && (size_t) ftell(file) < size);
+    closeFileIndex(&index);
+    fclose(file);
+
+    assert_int_equal(strlen("After\n"), readText());
+    assert_memory_equal("After\n", actual, strlen("After\n"));
+
+    removeRotatedFiles();
+}
@@ -0,0 +1,57 @@
+/**
+ * @file
+ *
+ * Tests for the file logger
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TEST_FILE_H_
+#define TEST_FILE_H_
+
+#include <cmockery.h>
+
+#define FILE_TESTS                       \
+    , unit_test(fileBadParams),          \
+        unit_test(fileText),             \
+        unit_test(fileCompressedBlocks), \
+        unit_test(fileTruncated),        \
+        unit_test(fileLongRecord), unit_test(fileIndexedQuery), unit_test(fileIndexAppended), unit_test(fileRotateBySize), unit_test(fileRotateOnRequest), unit_test(fileCompressArchives)
+
+void fileBadParams(void** state);
+void fileText(void** state);
+void fileCompressedBlocks(void** state);
+void fileTruncated(void** state);
+void fileLongRecord(void** state);
+void fileIndexedQuery(void** state);
+void fileIndexAppended(void** state);
+void fileRotateBySize(void** state);
+void fileRotateOnRequest(void** state);
+void fileCompressArchives(void** state);
+
+#endif /* TEST_FILE_H_ */
@@ -0,0 +1,222 @@
+/**
+ * @file
+ *
+ * Tests for the shared memory logger and its reader
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "testShm.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "slf4ec/logger/shm.h"
+
+#define NB_RECORDS (60)
+
+static LogCategory shmCategory = {.name = "shmCategory", .currentLogLevel = LEVEL_MAX};
+static char ringName[SHM_RING_NAME_LENGTH];
+static char expected[8192];
+static char actual[8192];
+
+static void logRecord(const LogFormat format, const char* const formatStr, ...)
+{
+    const uint64_t timestamp = 42;
+    const uint8_t level = LEVEL_INFO;
+    va_list args;
+
+    va_start(args, formatStr);
+    LogRecord record = {.category = &shmCategory, .formatStr = formatStr, .timestamp = &timestamp, .level = &level, .vaList = &args};
+    logToShm(&record, format);
+    va_end(args);
+}
+
+static void initRing(const char* const suffix, const uint32_t capacity)
+{
+    (void) snprintf(ringName, sizeof(ringName), SHM_RING_PREFIX "test.%s.%ld", suffix, (long) getpid());
+    const ShmLoggerConfig config = {ringName, capacity};
+
+    initShmLogger(&config);
+    assert_int_equal(LOG_OK, getShmLoggerStatus());
+}
+
+static void closeRing(ShmRing* const ring)
+{
+    closeShmRing(ring, false);
+    closeShmLogger();
+    assert_int_equal(0, shm_unlink(ringName));
+}
+
+void shmBadParams(void** state)
+{
+    (void) state;
+    ShmRing ring;
+    ShmLoggerConfig config = {NULL, 5000};
+
+    initShmLogger(NULL);
+    assert_int_equal(LOG_INVALID_PARAMETER, getShmLoggerStatus());
+    initShmLogger(&config);
+    assert_int_equal(LOG_INVALID_PARAMETER, getShmLoggerStatus());
+    config.capacity = SHM_MIN_CAPACITY / 2;
+    initShmLogger(&config);
+    assert_int_equal(LOG_INVALID_PARAMETER, getShmLoggerStatus());
+    config.capacity = 0;
+    config.name = "noSlash";
+    initShmLogger(&config);
+    assert_int_equal(LOG_INVALID_PARAMETER, getShmLoggerStatus());
+    closeShmLogger();
+
+    // Ignored until initialized
+    logRecord(FORMAT_FULL, "Nowhere");
+
+    assert_int_equal(LOG_INVALID_PARAMETER, openShmRing(NULL, &ring));
+    assert_int_equal(LOG_INVALID_PARAMETER, openShmRing("noSlash", &ring));
+    assert_int_equal(LOG_NOT_INITIALIZED, openShmRing(SHM_RING_PREFIX "test.missing", &ring));
+}
+
+void shmRoundTrip(void** state)
+{
+    (void) state;
+    ShmRing ring;
+    char longText[2 * SHM_MAX_RECORD_SIZE];
+
+    initRing("roundTrip", SHM_MIN_CAPACITY);
+    assert_int_equal(LOG_OK, openShmRing(ringName, &ring));
+    assert_false(isShmRingOrphaned(&ring));
+    assert_int_equal(0, readShmRing(&ring, actual, sizeof(actual)));
+
+    logRecord(FORMAT_FULL, "Record %d of %s", 1, "the test");
+    logRecord(FORMAT_MSG_ONLY, "Message only");
+    size_t size = readShmRing(&ring, actual, sizeof(actual));
+    actual[size] = '\0';
+    assert_string_equal("[INFO][shmCategory][42] - Record 1 of the test\nMessage only\n", actual);
+    assert_int_equal(0, readShmRing(&ring, actual, sizeof(actual)));
+
+    // Records too long are truncated, still ending the line
+    memset(longText, 'x', sizeof(longText) - 1);
+    longText[sizeof(longText) - 1] = '\0';
+    logRecord(FORMAT_MSG_ONLY, "%s", longText);
+    size = readShmRing(&ring, actual, sizeof(actual));
+    assert_int_equal(SHM_MAX_RECORD_SIZE, size);
+    assert_int_equal('x', actual[size - 2]);
+    assert_int_equal('\n', actual[size - 1]);
+
+    // A record is never split between two reads
+    logRecord(FORMAT_MSG_ONLY, "Split");
+    assert_int_equal(0, readShmRing(&ring, actual, 4));
+    assert_int_equal(6, readShmRing(&ring, actual, 6));
+    assert_int_equal(0, getShmRingDropped(&ring));
+
+    closeRing(&ring);
+}
+
+void shmWrapAndFull(void** state)
+{
+    (void) state;
+    ShmRing ring;
+    size_t expectedSize = 0;
+    size_t size = 0;
+    int nbFit = 0;
+    int i;
+
+    initRing("wrap", SHM_MIN_CAPACITY);
+    assert_int_equal(LOG_OK, openShmRing(ringName, &ring));
+
+    // Nothing read: the ring fills up and the records after are dropped
+    for (i = 0; i < NB_RECORDS; i++)
+    {
+        logRecord(FORMAT_MSG_ONLY, "Record %02d %080d", i, 0);
+        const uint64_t dropped = getShmRingDropped(&ring);
+        if (dropped == 0)
+        {
+            expectedSize += sprintf(&expected[expectedSize], "Record %02d %080d\n", i, 0);
+            nbFit++;
+        }
+    }
+    assert_true(nbFit > 0 && nbFit < NB_RECORDS);
+    assert_int_equal(NB_RECORDS - nbFit, getShmRingDropped(&ring));
+    size = readShmRing(&ring, actual, sizeof(actual));
+    assert_int_equal(expectedSize, size);
+    assert_memory_equal(expected, actual, size);
+
+    // Read as it goes: entries wrap around the end of the ring and none is lost
+    expectedSize = 0;
+    size = 0;
+    for (i = 0; i < NB_RECORDS; i++)
+    {
+        logRecord(FORMAT_MSG_ONLY, "Wrapped %02d %0*d", i, i, 0);
+        expectedSize += sprintf(&expected[expectedSize], "Wrapped %02d %0*d\n", i, i, 0);
+        if (i % 10 == 9)
+        {
+            size += readShmRing(&ring, &actual[size], sizeof(actual) - size);
+        }
+    }
+    assert_int_equal(NB_RECORDS - nbFit, getShmRingDropped(&ring));
+    assert_int_equal(expectedSize, size);
+    assert_memory_equal(expected, actual, size);
+
+    closeRing(&ring);
+}
+
+void shmCrashedProducer(void** state)
+{
+    (void) state;
+    ShmRing ring;
+    int status;
+
+    (void) snprintf(ringName, sizeof(ringName), SHM_RING_PREFIX "test.crashed.%ld", (long) getpid());
+    const pid_t child = fork();
+    assert_true(child >= 0);
+    if (child == 0)
+    {
+        const ShmLoggerConfig config = {ringName, SHM_MIN_CAPACITY};
+
+        initShmLogger(&config);
+        logRecord(FORMAT_MSG_ONLY, "Before %s", "exiting");
+        logRecord(FORMAT_MSG_ONLY, "Last words");
+        // Exits without closing the logger
+        _exit(0);
+    }
+    assert_int_equal(child, waitpid(child, &status, 0));
+
+    // Records written before the process exited are still there
+    assert_int_equal(LOG_OK, openShmRing(ringName, &ring));
+    assert_true(isShmRingOrphaned(&ring));
+    const size_t size = readShmRing(&ring, actual, sizeof(actual));
+    actual[size] = '\0';
+    assert_string_equal("Before exiting\nLast words\n", actual);
+
+    // Removed once drained
+    closeShmRing(&ring, true);
+    assert_int_equal(LOG_NOT_INITIALIZED, openShmRing(ringName, &ring));
+}
@@ -40,7 +40,7 @@
 #include "slf4ec/logger/stdout.h"
 #include "slf4ec/slf4ecTypes.h"
 
-LogCategory stdoutCategory = {"stdoutCategory", LEVEL_WARN};
+LogCategory stdoutCategory = {.name = "stdoutCategory", .currentLogLevel = LEVEL_WARN};
 char message[8192];
 
 void outputMessage(char* logMessage)
@@ -0,0 +1,163 @@
+/**
+ * @file
+ *
+ * Test trace.c
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "testTrace.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "slf4ec/log.h"
+#include "slf4ec/slf4ecCtrl.h"
+#include "slf4ec/logger/trace.h"
+
+extern LogCategory dummyCategory;
+
+static LogCategory traceCategory = {.name = "trace\"Category", .currentLogLevel = LEVEL_MAX};
+static char tracePath[64];
+static char expected[2048];
+static char actual[2048];
+
+static void logRecord(const uint64_t timestamp, const LogContext* const context, const char* const formatStr, ...)
+{
+    va_list args;
+
+    va_start(args, formatStr);
+    const LogRecordV2 record = {.timestamp = timestamp,
+                                .category = &traceCategory,
+                                .formatStr = formatStr,
+                                .vaList = &args,
+                                .context = context,
+                                .level = LEVEL_INFO,
+                                .flags = (context != NULL) ? LOG_RECORD_HAS_CONTEXT : 0};
+    logToTraceV2(&record, FORMAT_FULL);
+    va_end(args);
+}
+
+static void openTrace(const char* const suffix, const uint64_t unitsPerSecond)
+{
+    (void) snprintf(tracePath, sizeof(tracePath), "/tmp/slf4ec.test.%s.%ld.json", suffix, (long) getpid());
+    const TraceLoggerConfig config = {tracePath, unitsPerSecond};
+
+    initTraceLogger(&config);
+    assert_int_equal(LOG_OK, getTraceLoggerStatus());
+}
+
+/**
+ * Close the trace and read it back, without the leading process name
+ */
+static const char* readTrace(void)
+{
+    FILE* file;
+    size_t size;
+
+    closeTraceLogger();
+    file = fopen(tracePath, "r");
+    assert_true(file != NULL);
+    size = fread(actual, 1, sizeof(actual) - 1, file);
+    actual[size] = '\0';
+    fclose(file);
+    assert_int_equal(0, unlink(tracePath));
+
+    const char* const events = strstr(actual, "\"slf4ec\"}}");
+    assert_true(actual[0] == '[' && events != NULL);
+    return events + strlen("\"slf4ec\"}}");
+}
+
+void traceBadParams(void** state)
+{
+    (void) state;
+    TraceLoggerConfig config = {NULL, 0};
+
+    initTraceLogger(NULL);
+    assert_int_equal(LOG_INVALID_PARAMETER, getTraceLoggerStatus());
+    initTraceLogger(&config);
+    assert_int_equal(LOG_INVALID_PARAMETER, getTraceLoggerStatus());
+    config.path = "/nonexistent/directory/trace.json";
+    initTraceLogger(&config);
+    assert_int_equal(LOG_NOT_INITIALIZED, getTraceLoggerStatus());
+    closeTraceLogger();
+
+    // Ignored until initialized
+    logRecord(0, NULL, "Nowhere");
+}
+
+void traceSpanEvents(void** state)
+{
+    (void) state;
+    const uint8_t level = LEVEL_DEBUG;
+    LogSpan span;
+
+    openTrace("spans", 0);
+    Logger traceLogger = {.loggerName = "TraceLogger", .initFct = &initTraceLogger, .initArgs = NULL, .format = FORMAT_FULL, .currentLogLevel = LEVEL_MAX, .publishFctV2 = &logToTraceV2};
+
+    dummyCategory.currentLogLevel = LEVEL_MAX;
+    // Already initialized, the configuration is not needed again
+    assert_int_equal(LOG_OK, addLogger(&traceLogger));
+    assert_int_equal(LOG_OK, logSpanBegin(span, dummyCategory, level, "parse \"request\""));
+    const uint32_t threadId = span.threadId;
+    assert_int_equal(LOG_OK, logSpanEnd(span));
+    assert_int_equal(LOG_OK, removeLogger(&traceLogger));
+    dummyCategory.currentLogLevel = LEVEL_INFO;
+
+    // The test timestamps are all UINT64_MAX microseconds
+    snprintf(expected, sizeof(expected),
+             ",\n{\"name\":\"parse \\\"request\\\"\",\"cat\":\"DummyCategory\",\"ph\":\"B\",\"ts\":18446744073709551615.000,\"pid\":%ld,\"tid\":%" PRIu32 "}"
+             ",\n{\"name\":\"parse \\\"request\\\"\",\"cat\":\"DummyCategory\",\"ph\":\"E\",\"ts\":18446744073709551615.000,\"pid\":%ld,\"tid\":%" PRIu32 "}"
+             "\n]\n",
+             (long) getpid(), threadId, (long) getpid(), threadId);
+    assert_string_equal(expected, readTrace());
+}
+
+void traceInstantEvents(void** state)
+{
+    (void) state;
+    const LogContext context = {4242, "worker", 0, {{NULL, NULL}}};
+    const uint32_t threadId = (uint32_t) syscall(SYS_gettid);
+
+    openTrace("instants", 3);
+    logRecord(1, NULL, "Line\nwith %s", "\\");
+    logRecord(3000, NULL, "Seconds");
+    // Thread taken from the context when there is one
+    logRecord(5, &context, "Context");
+
+    snprintf(expected, sizeof(expected),
+             ",\n{\"name\":\"Line\\u000awith \\\\\",\"cat\":\"trace\\\"Category\",\"ph\":\"i\",\"s\":\"t\",\"ts\":333333.333,\"pid\":%ld,\"tid\":%" PRIu32 "}"
+             ",\n{\"name\":\"Seconds\",\"cat\":\"trace\\\"Category\",\"ph\":\"i\",\"s\":\"t\",\"ts\":1000000000.000,\"pid\":%ld,\"tid\":%" PRIu32 "}"
+             ",\n{\"name\":\"Context\",\"cat\":\"trace\\\"Category\",\"ph\":\"i\",\"s\":\"t\",\"ts\":1666666.666,\"pid\":%ld,\"tid\":4242}"
+             "\n]\n",
+             (long) getpid(), threadId, (long) getpid(), threadId, (long) getpid());
+    assert_string_equal(expected, readTrace());
+}
@@ -0,0 +1,251 @@
+/**
+ * @file
+ *
+ * Tests for the io_uring file logger
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "testUring.h"
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "slf4ec/logger/uring.h"
+
+#if defined(__linux__) && defined(__has_include)
+// clang-format off
+#if __has_include(<linux/io_uring.h>)
+// clang-format on
+#define URING_SUPPORTED
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+#define TEST_FILE "testUringLogger.log"
+#define NB_RECORDS (500)
+#define NB_THREADS (4)
+#define NB_SYNCED_RECORDS (100)
+#define FLUSH_PERIOD (20)
+
+static LogCategory uringCategory = {.name = "uringCategory", .currentLogLevel = LEVEL_MAX};
+static char expected[65536];
+static char actual[65536];
+
+static void logRecord(const uint8_t level, const char* const formatStr, ...)
+{
+    const uint64_t timestamp = 42;
+    va_list args;
+
+    va_start(args, formatStr);
+    LogRecord record = {.category = &uringCategory, .formatStr = formatStr, .timestamp = &timestamp, .level = &level, .vaList = &args};
+    logToUring(&record, FORMAT_MSG_ONLY);
+    va_end(args);
+}
+
+/**
+ * Whether the kernel running the tests lets this process create a ring
+ */
+static bool isUringAvailable(void)
+{
+    bool isAvailable = false;
+#ifdef URING_SUPPORTED
+    struct io_uring_params params;
+
+    memset(&params, 0, sizeof(params));
+    const int fd = (int) syscall(__NR_io_uring_setup, 2, &params);
+    if (fd >= 0)
+    {
+        isAvailable = true;
+        (void) close(fd);
+    }
+#endif
+
+    return isAvailable;
+}
+
+static size_t readText(void)
+{
+    FILE* file = fopen(TEST_FILE, "rb");
+    size_t size = fread(actual, 1, sizeof(actual), file);
+
+    fclose(file);
+    return size;
+}
+
+void uringBadParams(void** state)
+{
+    (void) state;
+
+    const UringLoggerConfig noPath = {NULL, 0, 0, LEVEL_OFF, false, 0};
+    const UringLoggerConfig bufferTooLarge = {TEST_FILE, URING_MAX_BUFFER_SIZE + 1, 0, LEVEL_OFF, false, 0};
+    const UringLoggerConfig singleBuffer = {TEST_FILE, 0, 1, LEVEL_OFF, false, 0};
+    const UringLoggerConfig tooManyBuffers = {TEST_FILE, 0, URING_MAX_BUFFERS + 1, LEVEL_OFF, false, 0};
+
+    initUringLogger(NULL);
+    assert_int_equal(LOG_INVALID_PARAMETER, getUringLoggerStatus());
+    initUringLogger(&noPath);
+    assert_int_equal(LOG_INVALID_PARAMETER, getUringLoggerStatus());
+    initUringLogger(&bufferTooLarge);
+    assert_int_equal(LOG_INVALID_PARAMETER, getUringLoggerStatus());
+    initUringLogger(&singleBuffer);
+    assert_int_equal(LOG_INVALID_PARAMETER, getUringLoggerStatus());
+    initUringLogger(&tooManyBuffers);
+    assert_int_equal(LOG_INVALID_PARAMETER, getUringLoggerStatus());
+    assert_int_equal(URING_BACKEND_NONE, getUringLoggerBackend());
+
+    // Dropped silently
+    logRecord(LEVEL_INFO, "Not logged");
+}
+
+void uringText(void** state)
+{
+    (void) state;
+    int forcePwrite;
+    int i;
+
+    for (forcePwrite = 0; forcePwrite <= 1; forcePwrite++)
+    {
+        // Small buffers so several writes are in flight, appended after what the file holds
+        const UringLoggerConfig config = {TEST_FILE, 1024, 4, LEVEL_OFF, forcePwrite, 0};
+        FILE* file = fopen(TEST_FILE, "wb");
+        size_t size = (size_t) sprintf(expected, "Existing\n");
+
+        fputs(expected, file);
+        fclose(file);
+
+        initUringLogger(&config);
+        assert_int_equal(LOG_OK, getUringLoggerStatus());
+        if (forcePwrite)
+        {
+            assert_int_equal(URING_BACKEND_PWRITE, getUringLoggerBackend());
+        }
+        else
+        {
+            // Falls back on pwrite only when io_uring is not available on the host running the tests
+            assert_int_equal(isUringAvailable() ? URING_BACKEND_IO_URING : URING_BACKEND_PWRITE, getUringLoggerBackend());
+        }
+
+        for (i = 0; i < NB_RECORDS; i++)
+        {
+            logRecord(LEVEL_INFO, "Record %d of %s", i, "the test");
+            size += (size_t) sprintf(&expected[size], "Record %d of the test\n", i);
+        }
+        closeUringLogger();
+        assert_int_equal(LOG_NOT_INITIALIZED, getUringLoggerStatus());
+
+        assert_int_equal(size, readText());
+        assert_memory_equal(expected, actual, size);
+        remove(TEST_FILE);
+    }
+}
+
+static void* logSynced(void* arg)
+{
+    const int thread = (int) (intptr_t) arg;
+    int i;
+
+    for (i = 0; i < NB_SYNCED_RECORDS; i++)
+    {
+        logRecord(LEVEL_ERROR, "Thread %d record %03d", thread, i);
+    }
+
+    return NULL;
+}
+
+void uringSync(void** state)
+{
+    (void) state;
+    const UringLoggerConfig config = {TEST_FILE, 0, 0, LEVEL_ERROR, false, 0};
+    pthread_t threads[NB_THREADS];
+    int i;
+
+    remove(TEST_FILE);
+    initUringLogger(&config);
+    assert_int_equal(LOG_OK, getUringLoggerStatus());
+
+    // Less severe records wait for the buffer to fill up, until a synced record takes them along
+    logRecord(LEVEL_INFO, "Buffered");
+    assert_int_equal(0, readText());
+    logRecord(LEVEL_ERROR, "Synced");
+    const char* const text = "Buffered\nSynced\n";
+    assert_int_equal(strlen(text), readText());
+    assert_memory_equal(text, actual, strlen(text));
+
+    // Every synced record is in the file when its log call returns, whichever producer issued the sync
+    for (i = 0; i < NB_THREADS; i++)
+    {
+        assert_int_equal(0, pthread_create(&threads[i], NULL, &logSynced, (void*) (intptr_t) i));
+    }
+    for (i = 0; i < NB_THREADS; i++)
+    {
+        assert_int_equal(0, pthread_join(threads[i], NULL));
+    }
+    const size_t size = readText();
+    assert_int_equal(strlen(text) + NB_THREADS * NB_SYNCED_RECORDS * strlen("Thread 0 record 000\n"), size);
+    for (i = 0; i < NB_THREADS; i++)
+    {
+        char last[32];
+
+        (void) sprintf(last, "Thread %d record %03d\n", i, NB_SYNCED_RECORDS - 1);
+        actual[size] = '\0';
+        assert_true(strstr(actual, last) != NULL);
+    }
+
+    closeUringLogger();
+    remove(TEST_FILE);
+}
+
+void uringFlushPeriod(void** state)
+{
+    (void) state;
+    const UringLoggerConfig config = {TEST_FILE, 0, 0, LEVEL_OFF, false, FLUSH_PERIOD};
+    const char* const text = "Quiet\n";
+    int i;
+
+    remove(TEST_FILE);
+    initUringLogger(&config);
+    assert_int_equal(LOG_OK, getUringLoggerStatus());
+
+    // Written by the flusher although the buffer is far from full
+    logRecord(LEVEL_INFO, "Quiet");
+    for (i = 0; i < 100 && readText() == 0; i++)
+    {
+        (void) usleep(FLUSH_PERIOD * 1000);
+    }
+    assert_int_equal(strlen(text), readText());
+    assert_memory_equal(text, actual, strlen(text));
+
+    closeUringLogger();
+    assert_int_equal(strlen(text), readText());
+    remove(TEST_FILE);
+}
@@ -0,0 +1,127 @@
+/**
+ * @file
+ *
+ * Tests for the block compression
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "testCompress.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "slf4ec/logCompress.h"
+
+#define TEXT_SIZE (16384)
+
+static LogCompressTable table;
+static uint8_t text[LOG_COMPRESS_MAX_INPUT + 1];
+static uint8_t compressed[LOG_COMPRESS_BOUND(LOG_COMPRESS_MAX_INPUT + 1)];
+static uint8_t decompressed[LOG_COMPRESS_MAX_INPUT];
+
+static size_t buildLogText(void)
+{
+    size_t size = 0;
+    int i;
+
+    for (i = 0; size < TEXT_SIZE - 100; i++)
+    {
+        size += sprintf((char*) &text[size], "[INFO][Network][%d]main.c:%d(main) - Peer %d connected\n", 1000 + i, i % 97, i % 13);
+    }
+
+    return size;
+}
+
+void compressRoundTrip(void** state)
+{
+    (void) state;
+
+    const size_t size = buildLogText();
+    const size_t compressedSize = logCompress(text, size, compressed, sizeof(compressed), &table);
+
+    assert_true(compressedSize > 0);
+    assert_true(compressedSize * 4 < size);
+    assert_int_equal(LOG_OK, logDecompress(compressed, compressedSize, decompressed, size));
+    assert_memory_equal(text, decompressed, size);
+
+    // Empty and tiny blocks are only made of literals
+    assert_int_equal(1, logCompress(text, 0, compressed, sizeof(compressed), &table));
+    assert_int_equal(LOG_OK, logDecompress(compressed, 1, decompressed, 0));
+    assert_int_equal(4, logCompress(text, 3, compressed, sizeof(compressed), &table));
+    assert_int_equal(LOG_OK, logDecompress(compressed, 4, decompressed, 3));
+    assert_memory_equal(text, decompressed, 3);
+}
+
+void compressIncompressible(void** state)
+{
+    (void) state;
+
+    uint32_t seed = 1;
+    size_t i;
+
+    for (i = 0; i < TEXT_SIZE; i++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        text[i] = (uint8_t)(seed >> 16);
+    }
+
+    assert_int_equal(0, logCompress(text, TEXT_SIZE, compressed, TEXT_SIZE, &table));
+
+    const size_t compressedSize = logCompress(text, TEXT_SIZE, compressed, LOG_COMPRESS_BOUND(TEXT_SIZE), &table);
+    assert_true(compressedSize > 0);
+    assert_int_equal(LOG_OK, logDecompress(compressed, compressedSize, decompressed, TEXT_SIZE));
+    assert_memory_equal(text, decompressed, TEXT_SIZE);
+}
+
+void compressTooLarge(void** state)
+{
+    (void) state;
+
+    memset(text, 'a', sizeof(text));
+    assert_int_equal(0, logCompress(text, LOG_COMPRESS_MAX_INPUT + 1, compressed, sizeof(compressed), &table));
+
+    const size_t compressedSize = logCompress(text, LOG_COMPRESS_MAX_INPUT, compressed, sizeof(compressed), &table);
+    assert_true(compressedSize > 0);
+    assert_int_equal(LOG_OK, logDecompress(compressed, compressedSize, decompressed, LOG_COMPRESS_MAX_INPUT));
+    assert_memory_equal(text, decompressed, LOG_COMPRESS_MAX_INPUT);
+}
+
+void decompressCorrupted(void** state)
+{
+    (void) state;
+
+    const size_t size = buildLogText();
+    const size_t compressedSize = logCompress(text, size, compressed, sizeof(compressed), &table);
+
+    // Wrong size, truncated input and offset beyond the start of the block
+    assert_int_equal(LOG_INVALID_PARAMETER, logDecompress(compressed, compressedSize, decompressed, size - 1));
+    assert_int_equal(LOG_INVALID_PARAMETER, logDecompress(compressed, compressedSize - 3, decompressed, size));
+
+    const uint8_t badOffset[] = {0x10, 'a', 0x10, 0x00};
+    assert_int_equal(LOG_INVALID_PARAMETER, logDecompress(badOffset, sizeof(badOffset), decompressed, 5));
+}
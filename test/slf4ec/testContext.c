@@ -0,0 +1,151 @@
+/**
+ * @file
+ *
+ * Unit tests of the diagnostic context
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "testContext.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "slf4ec/log.h"
+#include "slf4ec/logContext.h"
+#include "slf4ec/slf4ecCtrl.h"
+#include "slf4ec/logger/stdout.h"
+
+extern LogCategory dummyCategory;
+extern char message[8192];
+
+static Logger contextLogger = {.loggerName = "ContextLogger", .initFct = &initStdOut, .initArgs = NULL, .format = FORMAT_CONTEXT, .currentLogLevel = LEVEL_MAX, .publishFct = &logToStdOut};
+
+void contextPushPop(void** state)
+{
+    (void) state;
+    const LogContext* const context = logGetContext();
+    int i;
+
+    assert_int_equal(LOG_INVALID_PARAMETER, logContextPush(NULL, "value"));
+    assert_int_equal(LOG_INVALID_PARAMETER, logContextPush("key", NULL));
+    assert_int_equal(LOG_INVALID_PARAMETER, logContextPop("key"));
+
+    for (i = 0; i < LOG_CONTEXT_MAX_ENTRIES; i++)
+    {
+        assert_int_equal(LOG_OK, logContextPush("key", "value"));
+    }
+    assert_int_equal(LOG_OUT_OF_MEMORY, logContextPush("extra", "value"));
+    assert_int_equal(LOG_CONTEXT_MAX_ENTRIES, context->nbEntries);
+
+    // Unbalanced pops are refused
+    assert_int_equal(LOG_INVALID_PARAMETER, logContextPop("extra"));
+    for (i = 0; i < LOG_CONTEXT_MAX_ENTRIES; i++)
+    {
+        assert_int_equal(LOG_OK, logContextPop("key"));
+    }
+    assert_int_equal(0, context->nbEntries);
+    assert_int_not_equal(0, context->threadId);
+}
+
+void contextFormat(void** state)
+{
+    (void) state;
+    LogContext context = {.threadId = 42};
+    char buffer[64];
+    char expected[64];
+
+    assert_int_equal(strlen("[42]"), logFormatContext(buffer, sizeof(buffer), &context));
+    assert_string_equal("[42]", buffer);
+
+    strcpy(context.threadName, "worker");
+    context.entries[0].key = "request";
+    context.entries[0].value = "17";
+    context.entries[1].key = "connection";
+    context.entries[1].value = "3";
+    context.nbEntries = 2;
+    strcpy(expected, "[worker:42]{request=17 connection=3}");
+    assert_int_equal(strlen(expected), logFormatContext(buffer, sizeof(buffer), &context));
+    assert_string_equal(expected, buffer);
+
+    // Truncated like snprintf
+    assert_int_equal(strlen(expected), logFormatContext(buffer, 12, &context));
+    assert_string_equal("[worker:42]", buffer);
+}
+
+void contextInRecord(void** state)
+{
+    (void) state;
+    char expected[128];
+
+    logContextSetThreadName("main");
+    assert_int_equal(LOG_OK, logContextPush("request", "17"));
+    assert_int_equal(LOG_OK, addLogger(&contextLogger));
+
+    logInfo(dummyCategory, "With context");
+    sprintf(expected, "[main:%" PRIu32 "]{request=17}", logGetContext()->threadId);
+    assert_true(strstr(message, expected) != NULL);
+
+    // Same record without context for the other formats
+    assert_int_equal(LOG_OK, logContextPop("request"));
+    logInfo(dummyCategory, "Without entries");
+    sprintf(expected, "[main:%" PRIu32 "]", logGetContext()->threadId);
+    assert_true(strstr(message, expected) != NULL);
+    assert_true(strchr(message, '{') == NULL);
+
+    assert_int_equal(LOG_OK, removeLogger(&contextLogger));
+    logContextSetThreadName(NULL);
+    assert_string_equal("", logGetContext()->threadName);
+}
+
+static void* otherThread(void* arg)
+{
+    const LogContext* const context = logGetContext();
+
+    logContextSetThreadName("otherThreadWithAVeryLongName");
+    *(const LogContext**) arg = context;
+    return (context->nbEntries == 0 && strlen(context->threadName) == LOG_CONTEXT_NAME_LENGTH - 1) ? arg : NULL;
+}
+
+void contextPerThread(void** state)
+{
+    (void) state;
+    const LogContext* other = NULL;
+    void* result = NULL;
+    pthread_t thread;
+
+    assert_int_equal(LOG_OK, logContextPush("request", "17"));
+    assert_int_equal(0, pthread_create(&thread, NULL, &otherThread, &other));
+    assert_int_equal(0, pthread_join(thread, &result));
+
+    assert_true(result != NULL);
+    assert_true(other != logGetContext());
+    assert_int_equal(1, logGetContext()->nbEntries);
+    assert_int_equal(LOG_OK, logContextPop("request"));
+}
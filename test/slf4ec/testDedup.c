@@ -0,0 +1,213 @@
+/**
+ * @file
+ *
+ * Test logDedup.c
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "testDedup.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "slf4ec/log.h"
+#include "slf4ec/slf4ecCtrl.h"
+
+#ifdef USE_LOG_DEDUP
+
+#define MAX_MESSAGES (8)
+
+extern LogCategory dummyCategory;
+
+static const uint8_t noArg = 0;
+static char messages[MAX_MESSAGES][64];
+static size_t nbMessages = 0;
+static LogDedup dedup;
+
+static void dedupInit(const void* const config)
+{
+    (void) config;
+}
+
+static void dedupPublisher(const LogRecordV2* const record, const LogFormat format)
+{
+    (void) format;
+
+    if (nbMessages < MAX_MESSAGES)
+    {
+        va_list ap;
+        va_copy(ap, *record->vaList);
+        vsnprintf(messages[nbMessages++], sizeof(messages[0]), record->formatStr, ap);
+        va_end(ap);
+    }
+}
+
+static Logger dedupLogger = {.loggerName = "DedupLogger", .initFct = &dedupInit, .initArgs = &noArg, .format = FORMAT_MSG_ONLY, .currentLogLevel = LEVEL_MAX, .publishFctV2 = &dedupPublisher};
+static Logger plainLogger = {.loggerName = "PlainLogger", .initFct = &dedupInit, .initArgs = &noArg, .format = FORMAT_MSG_ONLY, .currentLogLevel = LEVEL_MAX, .publishFctV2 = &dedupPublisher};
+
+static void startDedup(void)
+{
+    memset(&dedup, 0, sizeof(dedup));
+    dedupLogger.dedup = &dedup;
+    nbMessages = 0;
+    dummyCategory.currentLogLevel = LEVEL_MAX;
+    assert_int_equal(LOG_OK, addLogger(&dedupLogger));
+}
+
+static void stopDedup(void)
+{
+    assert_int_equal(LOG_OK, removeLogger(&dedupLogger));
+    dummyCategory.currentLogLevel = LEVEL_INFO;
+}
+
+static void retry(const int attempt)
+{
+    logWarn(dummyCategory, "Connection failed, attempt %d", attempt);
+}
+
+static void linkDown(const char* const interface)
+{
+    logInfo(dummyCategory, "Link down on %s", interface);
+}
+
+void dedupBadParams(void** state)
+{
+    (void) state;
+
+    assert_int_equal(LOG_INVALID_PARAMETER, flushLogDuplicates(NULL));
+    assert_int_equal(LOG_INVALID_PARAMETER, flushLogDuplicates(&plainLogger));
+}
+
+void dedupSuppressRepeats(void** state)
+{
+    (void) state;
+
+    int i;
+
+    startDedup();
+    for (i = 0; i < 5; i++)
+    {
+        retry(3);
+    }
+    logWarn(dummyCategory, "Connected");
+    stopDedup();
+
+    assert_int_equal(3, nbMessages);
+    assert_string_equal("Connection failed, attempt 3", messages[0]);
+    assert_string_equal("Last message repeated 4 times", messages[1]);
+    assert_string_equal("Connected", messages[2]);
+    assert_int_equal(4, dedup.suppressed);
+}
+
+void dedupCompareArguments(void** state)
+{
+    (void) state;
+
+    char first[] = "eth0";
+    char second[] = "eth0";
+
+    startDedup();
+    retry(1);
+    retry(2);
+    // Strings are compared by content
+    linkDown(first);
+    linkDown(second);
+    linkDown("eth1");
+    stopDedup();
+
+    assert_int_equal(5, nbMessages);
+    assert_string_equal("Connection failed, attempt 1", messages[0]);
+    assert_string_equal("Connection failed, attempt 2", messages[1]);
+    assert_string_equal("Link down on eth0", messages[2]);
+    assert_string_equal("Last message repeated 1 times", messages[3]);
+    assert_string_equal("Link down on eth1", messages[4]);
+    assert_int_equal(1, dedup.suppressed);
+}
+
+void dedupFlush(void** state)
+{
+    (void) state;
+
+    startDedup();
+    retry(1);
+    retry(1);
+    retry(1);
+    assert_int_equal(LOG_OK, flushLogDuplicates(&dedupLogger));
+    assert_int_equal(2, nbMessages);
+    assert_string_equal("Last message repeated 2 times", messages[1]);
+
+    // The run goes on, only what follows the flush is summarized
+    retry(1);
+    assert_int_equal(LOG_OK, flushLogDuplicates(&dedupLogger));
+    assert_int_equal(LOG_OK, flushLogDuplicates(&dedupLogger));
+    stopDedup();
+
+    assert_int_equal(3, nbMessages);
+    assert_string_equal("Last message repeated 1 times", messages[2]);
+}
+
+void dedupUncomparable(void** state)
+{
+    (void) state;
+
+    int i;
+
+    startDedup();
+    // The argument of an unknown conversion cannot be taken, such records are always published
+    for (i = 0; i < 2; i++)
+    {
+        logInfo(dummyCategory, "Value %Q", 1);
+    }
+    stopDedup();
+
+    assert_int_equal(2, nbMessages);
+    assert_int_equal(0, dedup.suppressed);
+}
+
+void dedupHashCollision(void** state)
+{
+    (void) state;
+
+    LogDedupSlot* const slot = &dedup.slots[dummyCategory.index % LOG_DEDUP_SLOTS];
+    uint64_t retryHash;
+
+    startDedup();
+    retry(7);
+    retryHash = slot->hash;
+    linkDown("eth0");
+    // As if both records had the same hash, the other differences still tell them apart
+    slot->hash = retryHash;
+    retry(7);
+    stopDedup();
+
+    assert_int_equal(3, nbMessages);
+    assert_string_equal("Connection failed, attempt 7", messages[2]);
+    assert_int_equal(0, dedup.suppressed);
+}
+
+#endif
@@ -0,0 +1,58 @@
+/**
+ * @file
+ *
+ * Test logDedup.c
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TEST_DEDUP_H_
+#define TEST_DEDUP_H_
+
+#include <cmockery.h>
+
+#ifdef USE_LOG_DEDUP
+#define DEDUP_TESTS                       \
+    , unit_test(dedupBadParams),          \
+        unit_test(dedupSuppressRepeats),  \
+        unit_test(dedupCompareArguments), \
+        unit_test(dedupFlush),            \
+        unit_test(dedupUncomparable),     \
+        unit_test(dedupHashCollision)
+#else
+#define DEDUP_TESTS
+#endif
+
+void dedupBadParams(void** state);
+void dedupSuppressRepeats(void** state);
+void dedupCompareArguments(void** state);
+void dedupFlush(void** state);
+void dedupUncomparable(void** state);
+void dedupHashCollision(void** state);
+
+#endif /* TEST_DEDUP_H_ */
@@ -0,0 +1,148 @@
+/**
+ * @file
+ *
+ * Tests for histogram.c
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "testHistogram.h"
+
+#include <string.h>
+
+#include "slf4ec/log.h"
+#include "slf4ec/slf4ecCtrl.h"
+
+#ifdef USE_LOG_STATS
+
+extern LogCategory dummyCategory;
+extern Logger dummyLogger;
+
+static LogHistogram histogram;
+
+void histogramEmpty(void** state)
+{
+    (void) state;
+
+    memset(&histogram, 0, sizeof(histogram));
+    assert_int_equal(0, logHistogramPercentile(&histogram, 500000));
+    assert_int_equal(0, logHistogramPercentile(&histogram, 1000000));
+}
+
+void histogramSmallValues(void** state)
+{
+    (void) state;
+
+    // Values below LOG_HISTOGRAM_SUB_BUCKETS are exact
+    memset(&histogram, 0, sizeof(histogram));
+    logHistogramRecord(&histogram, 3);
+    logHistogramRecord(&histogram, 7);
+
+    assert_int_equal(2, histogram.count);
+    assert_int_equal(7, histogram.max);
+    assert_int_equal(3, logHistogramPercentile(&histogram, 500000));
+    assert_int_equal(7, logHistogramPercentile(&histogram, 990000));
+}
+
+void histogramPercentiles(void** state)
+{
+    (void) state;
+
+    uint64_t value;
+
+    memset(&histogram, 0, sizeof(histogram));
+    for (value = 1; value <= 100000; value++)
+    {
+        logHistogramRecord(&histogram, value);
+    }
+
+    // Relative error is bounded by the width of a bucket
+    assert_in_range(logHistogramPercentile(&histogram, 500000), 50000, 50000 + 50000 / (LOG_HISTOGRAM_SUB_BUCKETS / 2));
+    assert_in_range(logHistogramPercentile(&histogram, 990000), 99000, 100000);
+    assert_in_range(logHistogramPercentile(&histogram, 999000), 99900, 100000);
+    assert_int_equal(100000, logHistogramPercentile(&histogram, 1000000));
+    assert_int_equal(100000, histogram.max);
+}
+
+void histogramSaturates(void** state)
+{
+    (void) state;
+
+    memset(&histogram, 0, sizeof(histogram));
+    logHistogramRecord(&histogram, UINT64_MAX);
+
+    assert_int_equal(LOG_HISTOGRAM_MAX_VALUE, histogram.max);
+    assert_int_equal(1, histogram.buckets[LOG_HISTOGRAM_NB_BUCKETS - 1]);
+    assert_int_equal(LOG_HISTOGRAM_MAX_VALUE, logHistogramPercentile(&histogram, 500000));
+}
+
+void histogramReset(void** state)
+{
+    (void) state;
+
+    logHistogramRecord(&histogram, 1000);
+    logHistogramReset(&histogram);
+
+    assert_int_equal(0, histogram.count);
+    assert_int_equal(0, histogram.max);
+    assert_int_equal(0, logHistogramPercentile(&histogram, 500000));
+}
+
+void histogramLoggerLatency(void** state)
+{
+    (void) state;
+
+    LogLatency latency;
+
+    dummyLogger.histogram = NULL;
+    assert_int_equal(LOG_INVALID_PARAMETER, getLoggerLatency(&dummyLogger, &latency));
+    assert_int_equal(LOG_INVALID_PARAMETER, getLoggerLatency(NULL, &latency));
+
+    logHistogramReset(&histogram);
+    dummyLogger.histogram = &histogram;
+    dummyLogger.currentLogLevel = LEVEL_MAX;
+    dummyCategory.currentLogLevel = LEVEL_MAX;
+
+    logInfo(dummyCategory, "Timed");
+    logInfo(dummyCategory, "Timed");
+
+    assert_int_equal(LOG_OK, getLoggerLatency(&dummyLogger, &latency));
+    assert_int_equal(LOG_INVALID_PARAMETER, getLoggerLatency(&dummyLogger, NULL));
+
+    // The test tick counter advances by one on every read
+    assert_int_equal(2, latency.count);
+    assert_int_equal(1, latency.p50);
+    assert_int_equal(1, latency.p99);
+    assert_int_equal(1, latency.p999);
+    assert_int_equal(1, latency.max);
+
+    dummyLogger.histogram = NULL;
+    dummyCategory.currentLogLevel = LEVEL_INFO;
+}
+
+#endif /* USE_LOG_STATS */
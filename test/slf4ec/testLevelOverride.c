@@ -0,0 +1,173 @@
+/**
+ * @file
+ *
+ * Test the level overrides of the threads
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "testLevelOverride.h"
+
+#include <pthread.h>
+#include "slf4ec/log.h"
+#include "slf4ec/slf4ecCtrl.h"
+
+extern LogCategory dummyCategory;
+
+static const uint8_t noArg = 0;
+static uint32_t nbPublished = 0;
+static LogCategory otherCategory = {.name = "Other", .currentLogLevel = LEVEL_INFO};
+
+static void countInit(const void* const config)
+{
+    (void) config;
+}
+
+static void countPublisher(const LogRecordV2* const record, const LogFormat format)
+{
+    (void) record;
+    (void) format;
+    __atomic_add_fetch(&nbPublished, 1, __ATOMIC_RELAXED);
+}
+
+static Logger countLogger = {.loggerName = "CountLogger", .initFct = &countInit, .initArgs = &noArg, .format = FORMAT_FULL, .currentLogLevel = LEVEL_MAX, .publishFctV2 = &countPublisher};
+
+/**
+ * Number of records published by a call
+ */
+#define PUBLISHED(call) (nbPublished = 0, (call), nbPublished)
+
+static void startCounting(void)
+{
+    dummyCategory.currentLogLevel = LEVEL_INFO;
+    assert_int_equal(LOG_OK, addLogger(&countLogger));
+}
+
+static void stopCounting(void)
+{
+    assert_int_equal(LOG_OK, setThreadLevelOverride(NULL));
+    assert_int_equal(LOG_OK, removeLogger(&countLogger));
+}
+
+void overrideBadParams(void** state)
+{
+    (void) state;
+
+    const LogLevelOverride badLevel = {LEVEL_MAX + 1, 0, NULL};
+    const LogLevelOverride noCategories = {LEVEL_TRACE, 1, NULL};
+    LogLevelOverride current;
+
+    assert_int_equal(LOG_INVALID_PARAMETER, setThreadLevelOverride(&badLevel));
+    assert_int_equal(LOG_INVALID_PARAMETER, setThreadLevelOverride(&noCategories));
+    assert_int_equal(LOG_INVALID_PARAMETER, getThreadLevelOverride(NULL));
+
+    assert_int_equal(LOG_OK, getThreadLevelOverride(&current));
+    assert_int_equal(LEVEL_OFF, current.level);
+}
+
+void overrideAllCategories(void** state)
+{
+    (void) state;
+
+    const LogLevelOverride trace = {LEVEL_TRACE, 0, NULL};
+    LogLevelOverride current;
+
+    startCounting();
+    assert_int_equal(0, PUBLISHED(logDebug(dummyCategory, "Filtered")));
+
+    assert_int_equal(LOG_OK, setThreadLevelOverride(&trace));
+    assert_int_equal(1, PUBLISHED(logDebug(dummyCategory, "Traced")));
+    assert_int_equal(1, PUBLISHED(logTrace(dummyCategory, "Traced")));
+    assert_int_equal(0, PUBLISHED(logTest(dummyCategory, "Still filtered")));
+    assert_true(logIsActive(dummyCategory, LEVEL_TRACE));
+    assert_int_equal(LEVEL_INFO, dummyCategory.currentLogLevel);
+
+    assert_int_equal(LOG_OK, getThreadLevelOverride(&current));
+    assert_int_equal(LEVEL_TRACE, current.level);
+    assert_int_equal(0, current.nbCategories);
+
+    stopCounting();
+    assert_int_equal(0, PUBLISHED(logDebug(dummyCategory, "Filtered again")));
+    assert_false(logIsActive(dummyCategory, LEVEL_TRACE));
+}
+
+void overrideSomeCategories(void** state)
+{
+    (void) state;
+
+    LogCategory* const overridden[] = {&otherCategory};
+    const LogLevelOverride debug = {LEVEL_DEBUG, 1, overridden};
+
+    startCounting();
+    assert_int_equal(LOG_OK, setThreadLevelOverride(&debug));
+    assert_int_equal(1, PUBLISHED(logDebug(otherCategory, "Overridden")));
+    assert_int_equal(0, PUBLISHED(logDebug(dummyCategory, "Not overridden")));
+    stopCounting();
+}
+
+static void* logFromOtherThread(void* arg)
+{
+    const LogLevelOverride* const propagated = arg;
+
+    if (propagated != NULL)
+    {
+        (void) setThreadLevelOverride(propagated);
+    }
+    (void) logDebug(dummyCategory, "From another thread");
+    (void) setThreadLevelOverride(NULL);
+
+    return NULL;
+}
+
+static uint32_t publishedByOtherThread(LogLevelOverride* const propagated)
+{
+    pthread_t thread;
+
+    nbPublished = 0;
+    assert_int_equal(0, pthread_create(&thread, NULL, &logFromOtherThread, propagated));
+    assert_int_equal(0, pthread_join(thread, NULL));
+
+    return nbPublished;
+}
+
+void overrideOnlyThisThread(void** state)
+{
+    (void) state;
+
+    const LogLevelOverride debug = {LEVEL_DEBUG, 0, NULL};
+    LogLevelOverride propagated;
+
+    startCounting();
+    assert_int_equal(LOG_OK, setThreadLevelOverride(&debug));
+    assert_int_equal(0, publishedByOtherThread(NULL));
+
+    // Work done on behalf of this thread follows its override
+    assert_int_equal(LOG_OK, getThreadLevelOverride(&propagated));
+    assert_int_equal(1, publishedByOtherThread(&propagated));
+    stopCounting();
+}
@@ -32,6 +32,7 @@
  */
 
 #include <stdbool.h>
+#include <string.h>
 #include "testLog.h"
 
 #define INVALID_TIME (-1LLU);
@@ -81,12 +82,16 @@ void dummyPublisher(const LogRecord* const logRecord, const LogFormat format)
     curFct = (char*) logRecord->function;
     curLevel = *logRecord->level;
     curFormatStr = (char*) logRecord->formatStr;
+
+#ifdef USE_LOG_STATS
+    logReportBytes(strlen(logRecord->formatStr));
+#endif
 }
 
-LogCategory dummyCategory = {"DummyCategory", LEVEL_INFO};
-Logger dummyLogger = {"DummyLogger", &dummyInit, &expectedArg, FORMAT_FULL, LEVEL_DEBUG, &dummyPublisher};
-Logger noInitLogger = {"NoInitLogger", NULL, &expectedArg, FORMAT_FULL, LEVEL_DEBUG, &dummyPublisher};
-Logger noPublishLogger = {"NoPublishLogger", &dummyInit, &expectedArg, FORMAT_FULL, LEVEL_DEBUG, NULL};
+LogCategory dummyCategory = {.name = "DummyCategory", .currentLogLevel = LEVEL_INFO};
+Logger dummyLogger = {.loggerName = "DummyLogger", .initFct = &dummyInit, .initArgs = &expectedArg, .format = FORMAT_FULL, .currentLogLevel = LEVEL_DEBUG, .publishFct = &dummyPublisher};
+Logger noInitLogger = {.loggerName = "NoInitLogger", .initFct = NULL, .initArgs = &expectedArg, .format = FORMAT_FULL, .currentLogLevel = LEVEL_DEBUG, .publishFct = &dummyPublisher};
+Logger noPublishLogger = {.loggerName = "NoPublishLogger", .initFct = &dummyInit, .initArgs = &expectedArg, .format = FORMAT_FULL, .currentLogLevel = LEVEL_DEBUG, .publishFct = NULL};
 
 static LogCategory* const dummyCategories[] = {
     &dummyCategory};
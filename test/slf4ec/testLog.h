@@ -37,7 +37,25 @@
 #include "slf4ec/log.h"
 #include "slf4ec/slf4ecCtrl.h"
 #include "testStdout.h"
+#include "testStats.h"
+#include "testProfiler.h"
+#include "testDedup.h"
+#include "testLevelOverride.h"
+#include "testHistogram.h"
+#include "testRuntimeConfig.h"
+#include "testRouting.h"
+#include "testCompress.h"
+#include "testFile.h"
+#include "testContext.h"
+#include "testRecordV2.h"
+#include "testSignal.h"
+#include "testShm.h"
+#include "testUring.h"
+#include "testSpan.h"
+#include "testTrace.h"
+#include "testAsync.h"
 
+// clang-format off
 #define LOG_TESTS                                  \
     unit_test(initializeBadParams),                \
         unit_test(setLevelsNotInitialized),        \
@@ -54,7 +72,25 @@
         unit_test(testLogWithVaArgWithoutLocInfo), \
         unit_test(testLogInfo),                    \
         unit_test(testLogLevelNames),              \
-        STDOUT_TESTS
+        STDOUT_TESTS                               \
+        STATS_TESTS                                \
+        PROFILER_TESTS                             \
+        DEDUP_TESTS                                \
+        LEVEL_OVERRIDE_TESTS                       \
+        HISTOGRAM_TESTS                            \
+        RUNTIME_CONFIG_TESTS                       \
+        ROUTING_TESTS                              \
+        COMPRESS_TESTS                             \
+        FILE_TESTS                                 \
+        CONTEXT_TESTS                              \
+        RECORD_V2_TESTS                            \
+        SIGNAL_TESTS                               \
+        SHM_TESTS                                  \
+        URING_TESTS                                \
+        SPAN_TESTS                                 \
+        TRACE_TESTS                                \
+        ASYNC_TESTS
+// clang-format on
 
 void initializeBadParams(void** state);
 void setLevelsNotInitialized(void** state);
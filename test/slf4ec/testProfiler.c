@@ -0,0 +1,221 @@
+/**
+ * @file
+ *
+ * Test profiler.c
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "testProfiler.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "slf4ec/log.h"
+#include "slf4ec/slf4ecCtrl.h"
+
+#ifdef USE_LOG_PROFILER
+
+#define MAX_SITES (64)
+
+extern LogCategory dummyCategory;
+extern Logger dummyLogger;
+
+static char dumped[8][256];
+static size_t nbDumped = 0;
+
+static void dumpPublisher(const LogRecord* const logRecord, const LogFormat format)
+{
+    (void) format;
+
+    if (nbDumped < sizeof(dumped) / sizeof(dumped[0]))
+    {
+        va_list ap;
+        va_copy(ap, *logRecord->vaList);
+        vsnprintf(dumped[nbDumped], sizeof(dumped[0]), logRecord->formatStr, ap);
+        va_end(ap);
+        __atomic_store_n(&nbDumped, nbDumped + 1, __ATOMIC_RELEASE);
+    }
+}
+
+static Logger dumpLogger = {.loggerName = "DumpLogger", .initFct = NULL, .initArgs = NULL, .format = FORMAT_MSG_ONLY, .currentLogLevel = LEVEL_MAX, .publishFct = &dumpPublisher};
+
+/**
+ * Profile of the site of this file at a given line, zeroed when it never logged
+ */
+static LogSiteProfile findSite(const uint32_t line)
+{
+    LogSiteProfile sites[MAX_SITES];
+    LogSiteProfile found = {0};
+    size_t nbSites = MAX_SITES;
+    size_t i;
+
+    assert_int_equal(LOG_OK, getLogProfile(sites, &nbSites, PROFILE_BY_CALLS));
+    for (i = 0; i < nbSites; i++)
+    {
+        if (sites[i].file != NULL && strcmp(sites[i].file, __FILE__) == 0 && sites[i].line == line)
+        {
+            found = sites[i];
+        }
+    }
+
+    return found;
+}
+
+static void logTimes(const int nbTimes, const int site)
+{
+    int i;
+
+    for (i = 0; i < nbTimes; i++)
+    {
+        switch (site)
+        {
+            case 0:
+                logInfo(dummyCategory, "First");
+                break;
+            case 1:
+                logInfo(dummyCategory, "Second");
+                break;
+            default:
+                logInfo(dummyCategory, "Third");
+                break;
+        }
+    }
+}
+
+void profilerBadParams(void** state)
+{
+    (void) state;
+
+    LogSiteProfile site;
+    size_t nbSites = 1;
+
+    assert_int_equal(LOG_INVALID_PARAMETER, getLogProfile(NULL, &nbSites, PROFILE_BY_CALLS));
+    assert_int_equal(LOG_INVALID_PARAMETER, getLogProfile(&site, NULL, PROFILE_BY_CALLS));
+    assert_int_equal(LOG_INVALID_PARAMETER, getLogProfile(&site, &nbSites, (LogProfileOrder) 42));
+    assert_int_equal(LOG_INVALID_PARAMETER, dumpLogProfile(NULL, 1, PROFILE_BY_CALLS));
+    assert_int_equal(LOG_INVALID_PARAMETER, dumpLogProfile(&dumpLogger, 1, (LogProfileOrder) 42));
+    assert_int_equal(LOG_INVALID_PARAMETER, startLogProfileDump(&dumpLogger, 0, 1, PROFILE_BY_CALLS));
+}
+
+void profilerCountSite(void** state)
+{
+    (void) state;
+
+    int i;
+
+    dummyCategory.currentLogLevel = LEVEL_INFO;
+    dummyLogger.currentLogLevel = LEVEL_MAX;
+
+    for (i = 0; i < 3; i++)
+    {
+        logDebug(dummyCategory, "Filtered");
+        logInfo(dummyCategory, "12345");
+    }
+
+    const LogSiteProfile filtered = findSite(__LINE__ - 4);
+    const LogSiteProfile published = findSite(__LINE__ - 4);
+
+    assert_int_equal(3, filtered.calls);
+    assert_int_equal(0, filtered.published);
+    assert_int_equal(0, filtered.bytes);
+    assert_string_equal(__FUNCTION__, filtered.function);
+
+    assert_int_equal(3, published.calls);
+    assert_int_equal(3, published.published);
+    assert_int_equal(15, published.bytes);
+    assert_true(published.publishTime > 0);
+}
+
+void profilerTopSites(void** state)
+{
+    (void) state;
+
+    LogSiteProfile sites[2];
+    size_t nbSites = 2;
+
+    logTimes(1000, 0);
+    logTimes(2000, 1);
+    logTimes(10, 2);
+
+    assert_int_equal(LOG_OK, getLogProfile(sites, &nbSites, PROFILE_BY_CALLS));
+    assert_int_equal(2, nbSites);
+    assert_string_equal(__FILE__, sites[0].file);
+    assert_string_equal(__FILE__, sites[1].file);
+    assert_int_equal(2000, sites[0].calls);
+    assert_int_equal(1000, sites[1].calls);
+    assert_true(sites[0].line > sites[1].line);
+
+    nbSites = 2;
+    assert_int_equal(LOG_OK, getLogProfile(sites, &nbSites, PROFILE_BY_BYTES));
+    assert_int_equal(2000 * strlen("Second"), sites[0].bytes);
+    assert_int_equal(1000 * strlen("First"), sites[1].bytes);
+}
+
+void profilerDumpDeltas(void** state)
+{
+    (void) state;
+
+    nbDumped = 0;
+    assert_int_equal(LOG_OK, dumpLogProfile(&dumpLogger, 1, PROFILE_BY_CALLS));
+    assert_int_equal(1, nbDumped);
+
+    logTimes(3, 2);
+
+    nbDumped = 0;
+    assert_int_equal(LOG_OK, dumpLogProfile(&dumpLogger, 2, PROFILE_BY_CALLS));
+    assert_int_equal(1, nbDumped);
+    assert_int_equal(0, strncmp(__FILE__ ":", dumped[0], strlen(__FILE__ ":")));
+    assert_true(strstr(dumped[0], " (logTimes) calls=3 published=3 bytes=15 time=") != NULL);
+
+    // Nothing logged since
+    nbDumped = 0;
+    assert_int_equal(LOG_OK, dumpLogProfile(&dumpLogger, 2, PROFILE_BY_CALLS));
+    assert_int_equal(0, nbDumped);
+}
+
+void profilerPeriodicDump(void** state)
+{
+    (void) state;
+
+    nbDumped = 0;
+    assert_int_equal(LOG_OK, startLogProfileDump(&dumpLogger, 10, 1, PROFILE_BY_CALLS));
+    assert_int_equal(LOG_ALREADY_INITIALIZED, startLogProfileDump(&dumpLogger, 10, 1, PROFILE_BY_CALLS));
+
+    logTimes(1, 0);
+    while (__atomic_load_n(&nbDumped, __ATOMIC_ACQUIRE) == 0)
+    {
+        usleep(1000);
+    }
+
+    stopLogProfileDump();
+    stopLogProfileDump();
+    assert_true(strstr(dumped[0], "calls=1 ") != NULL);
+}
+
+#endif
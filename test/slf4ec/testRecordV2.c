@@ -0,0 +1,124 @@
+/**
+ * @file
+ *
+ * Unit tests of the version 2 log records
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "testRecordV2.h"
+
+#include <string.h>
+
+#include "slf4ec/log.h"
+#include "slf4ec/slf4ecCtrl.h"
+
+extern LogCategory dummyCategory;
+
+static const uint8_t noArg = 0;
+static LogRecordV2 lastRecord;
+static uint32_t lastLegacyLine = 0;
+static int nbPublished = 0;
+
+static void recordInit(const void* const config)
+{
+    (void) config;
+}
+
+static void recordPublisherV2(const LogRecordV2* const logRecord, const LogFormat format)
+{
+    (void) format;
+    nbPublished++;
+    lastRecord = *logRecord;
+}
+
+static void legacyPublisher(const LogRecord* const logRecord, const LogFormat format)
+{
+    (void) format;
+    nbPublished++;
+    lastLegacyLine = (logRecord->line != NULL) ? *logRecord->line : 0;
+}
+
+static Logger recordLogger = {.loggerName = "RecordV2", .initFct = &recordInit, .initArgs = &noArg, .format = FORMAT_FULL, .currentLogLevel = LEVEL_MAX, .publishFctV2 = &recordPublisherV2};
+static Logger legacyLogger = {.loggerName = "Legacy", .initFct = &recordInit, .initArgs = &noArg, .format = FORMAT_FULL, .currentLogLevel = LEVEL_MAX, .publishFct = &legacyPublisher};
+
+void recordV2Publish(void** state)
+{
+    (void) state;
+
+    assert_int_equal(LOG_OK, addLogger(&recordLogger));
+    assert_int_equal(LOG_OK, addLogger(&legacyLogger));
+    nbPublished = 0;
+
+    const uint32_t line = __LINE__ + 1;
+    logWarn(dummyCategory, "Record %d", 2);
+
+    // Both kinds of loggers receive the same event
+    assert_int_equal(2, nbPublished);
+    assert_int_equal(LEVEL_WARN, lastRecord.level);
+    assert_int_equal(&dummyCategory, lastRecord.category);
+    assert_string_equal("Record %d", lastRecord.formatStr);
+    assert_true((lastRecord.flags & LOG_RECORD_HAS_LOCATION) != 0);
+    assert_int_equal(line, lastRecord.line);
+    assert_int_equal(line, lastLegacyLine);
+    assert_true(strstr(lastRecord.file, "testRecordV2.c") != NULL);
+
+    assert_int_equal(LOG_OK, removeLogger(&recordLogger));
+    assert_int_equal(LOG_OK, removeLogger(&legacyLogger));
+}
+
+void recordV2FromLegacy(void** state)
+{
+    (void) state;
+    const uint64_t timestamp = 42;
+    const uint8_t level = LEVEL_ERROR;
+    const uint32_t line = 7;
+    va_list vaList;
+    LogRecordV2 record;
+
+    const LogRecord partial = {.file = __FILE__, .line = NULL, .function = __func__, .timestamp = &timestamp, .category = &dummyCategory, .level = &level, .formatStr = "Partial", .vaList = &vaList};
+    logRecordToV2(&partial, &record);
+    assert_int_equal(42, record.timestamp);
+    assert_int_equal(LEVEL_ERROR, record.level);
+    assert_int_equal(&vaList, record.vaList);
+    assert_int_equal(0, record.flags);
+
+    const LogRecord full = {.file = __FILE__, .line = &line, .function = __func__, .timestamp = &timestamp, .category = &dummyCategory, .level = &level, .formatStr = "Full", .vaList = &vaList};
+    logRecordToV2(&full, &record);
+    assert_int_equal(LOG_RECORD_HAS_LOCATION, record.flags);
+    assert_int_equal(7, record.line);
+    assert_string_equal(__func__, record.function);
+}
+
+void recordV2Layout(void** state)
+{
+    (void) state;
+
+    // One cache line on 64 bits hosts
+    assert_true(sizeof(LogRecordV2) <= 64);
+}
@@ -0,0 +1,109 @@
+/**
+ * @file
+ *
+ * Tests for the routing of categories to loggers
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "testRouting.h"
+
+#include "slf4ec/log.h"
+#include "slf4ec/slf4ecCtrl.h"
+
+extern LogCategory dummyCategory;
+extern Logger dummyLogger;
+
+static const uint8_t noArg = 0;
+static int published = 0;
+static const LogCategory* lastCategory = NULL;
+
+static void routingInit(const void* const config)
+{
+    (void) config;
+}
+
+static void routingPublisher(const LogRecord* const logRecord, const LogFormat format)
+{
+    (void) format;
+    published++;
+    lastCategory = logRecord->category;
+}
+
+static LogCategory auditCategory = {.name = "Audit", .currentLogLevel = LEVEL_MAX};
+static LogCategory unconfiguredCategory = {.name = "Unconfigured", .currentLogLevel = LEVEL_MAX};
+static LogCategory* const auditOnly[] = {&auditCategory};
+
+static Logger auditLogger = {.loggerName = "AuditLogger", .initFct = &routingInit, .initArgs = &noArg, .format = FORMAT_FULL, .currentLogLevel = LEVEL_MAX, .publishFct = &routingPublisher, .categoryFilter = auditOnly, .nbCategoryFilter = 1};
+static Logger noFilterLogger = {.loggerName = "NoFilter", .initFct = &routingInit, .initArgs = &noArg, .format = FORMAT_FULL, .currentLogLevel = LEVEL_MAX, .publishFct = &routingPublisher, .nbCategoryFilter = 1};
+
+void routingBadParams(void** state)
+{
+    (void) state;
+
+    assert_int_equal(LOG_INVALID_PARAMETER, addLogger(&noFilterLogger));
+}
+
+void routingByCategory(void** state)
+{
+    (void) state;
+
+    assert_int_equal(LOG_OK, addCategory(&auditCategory));
+    assert_int_equal(LOG_OK, addLogger(&auditLogger));
+
+    dummyCategory.currentLogLevel = LEVEL_MAX;
+    published = 0;
+
+    logInfo(dummyCategory, "Not routed to the audit logger");
+    assert_int_equal(0, published);
+
+    logInfo(auditCategory, "Routed to the audit logger");
+    assert_int_equal(1, published);
+    assert_int_equal(&auditCategory, lastCategory);
+
+    auditLogger.currentLogLevel = LEVEL_WARN;
+    logInfo(auditCategory, "Routed but filtered by the level of the audit logger");
+    assert_int_equal(1, published);
+    auditLogger.currentLogLevel = LEVEL_MAX;
+
+    dummyCategory.currentLogLevel = LEVEL_INFO;
+}
+
+void routingUnconfiguredCategory(void** state)
+{
+    (void) state;
+
+    published = 0;
+
+    logInfo(unconfiguredCategory, "Only published to loggers without a filter");
+    assert_int_equal(0, published);
+
+    assert_int_equal(LOG_OK, removeLogger(&auditLogger));
+    logInfo(auditCategory, "Audit logger removed");
+    assert_int_equal(0, published);
+}
@@ -0,0 +1,248 @@
+/**
+ * @file
+ *
+ * Tests for runtime configuration changes
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "testRuntimeConfig.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include "slf4ec/log.h"
+#include "slf4ec/slf4ecCtrl.h"
+
+#define NB_LOGGING_THREADS (3)
+#define NB_CHANGES (1000)
+
+extern LogCategory dummyCategory;
+extern Logger dummyLogger;
+
+static const uint8_t noArg = 0;
+static int initCalls = 0;
+static int published[2];
+
+static void countingInit(const void* const config)
+{
+    (void) config;
+    initCalls++;
+}
+
+static void countingPublisher0(const LogRecord* const logRecord, const LogFormat format)
+{
+    (void) logRecord;
+    (void) format;
+    __atomic_fetch_add(&published[0], 1, __ATOMIC_RELAXED);
+}
+
+static void countingPublisher1(const LogRecord* const logRecord, const LogFormat format)
+{
+    (void) logRecord;
+    (void) format;
+    __atomic_fetch_add(&published[1], 1, __ATOMIC_RELAXED);
+}
+
+static Logger runtimeLogger0 = {.loggerName = "RuntimeLogger0", .initFct = &countingInit, .initArgs = &noArg, .format = FORMAT_FULL, .currentLogLevel = LEVEL_MAX, .publishFct = &countingPublisher0};
+static Logger runtimeLogger1 = {.loggerName = "RuntimeLogger1", .initFct = &countingInit, .initArgs = &noArg, .format = FORMAT_FULL, .currentLogLevel = LEVEL_MAX, .publishFct = &countingPublisher1};
+static Logger noPublishRuntimeLogger = {.loggerName = "NoPublish", .initFct = &countingInit, .initArgs = &noArg, .format = FORMAT_FULL, .currentLogLevel = LEVEL_MAX, .publishFct = NULL};
+static LogCategory runtimeCategory = {.name = "RuntimeCategory", .currentLogLevel = LEVEL_MAX};
+
+void runtimeConfigBadParams(void** state)
+{
+    (void) state;
+
+    assert_int_equal(LOG_INVALID_PARAMETER, addLogger(NULL));
+    assert_int_equal(LOG_INVALID_PARAMETER, addLogger(&noPublishRuntimeLogger));
+    assert_int_equal(LOG_INVALID_PARAMETER, addLogger(&dummyLogger));
+    assert_int_equal(LOG_INVALID_PARAMETER, removeLogger(NULL));
+    assert_int_equal(LOG_INVALID_PARAMETER, removeLogger(&runtimeLogger0));
+    assert_int_equal(LOG_INVALID_PARAMETER, replaceLogger(&runtimeLogger0, &runtimeLogger1));
+    assert_int_equal(LOG_INVALID_PARAMETER, replaceLogger(&dummyLogger, &dummyLogger));
+    assert_int_equal(LOG_INVALID_PARAMETER, replaceLogger(&dummyLogger, &noPublishRuntimeLogger));
+    assert_int_equal(LOG_INVALID_PARAMETER, addCategory(NULL));
+    assert_int_equal(LOG_INVALID_PARAMETER, addCategory(&dummyCategory));
+}
+
+void runtimeAddRemoveLogger(void** state)
+{
+    (void) state;
+
+    Logger* const* loggers;
+    const int initBefore = initCalls;
+
+    dummyCategory.currentLogLevel = LEVEL_MAX;
+    published[0] = 0;
+
+    assert_int_equal(LOG_OK, addLogger(&runtimeLogger0));
+    assert_int_equal(initBefore + 1, initCalls);
+    assert_int_equal(2, getLoggers(&loggers));
+    assert_int_equal(&dummyLogger, loggers[0]);
+    assert_int_equal(&runtimeLogger0, loggers[1]);
+
+    logInfo(dummyCategory, "Published to both loggers");
+    assert_int_equal(1, published[0]);
+
+    assert_int_equal(LOG_OK, removeLogger(&runtimeLogger0));
+    assert_int_equal(1, getLoggers(&loggers));
+    assert_int_equal(&dummyLogger, loggers[0]);
+
+    logInfo(dummyCategory, "Published to the initial logger only");
+    assert_int_equal(1, published[0]);
+
+    dummyCategory.currentLogLevel = LEVEL_INFO;
+}
+
+void runtimeReplaceLogger(void** state)
+{
+    (void) state;
+
+    Logger* const* loggers;
+
+    published[0] = 0;
+    published[1] = 0;
+
+    assert_int_equal(LOG_OK, addLogger(&runtimeLogger0));
+    assert_int_equal(LOG_OK, replaceLogger(&dummyLogger, &runtimeLogger1));
+    assert_int_equal(2, getLoggers(&loggers));
+    assert_int_equal(&runtimeLogger1, loggers[0]);
+    assert_int_equal(&runtimeLogger0, loggers[1]);
+
+    logWarn(dummyCategory, "Published to both runtime loggers");
+    assert_int_equal(1, published[0]);
+    assert_int_equal(1, published[1]);
+
+    assert_int_equal(LOG_OK, replaceLogger(&runtimeLogger1, &dummyLogger));
+    assert_int_equal(LOG_OK, removeLogger(&runtimeLogger0));
+    assert_int_equal(1, getLoggers(&loggers));
+    assert_int_equal(&dummyLogger, loggers[0]);
+}
+
+void runtimeAddCategory(void** state)
+{
+    (void) state;
+
+    LogCategory* const* categories;
+
+    assert_int_equal(LOG_OK, addCategory(&runtimeCategory));
+    assert_int_equal(LOG_INVALID_PARAMETER, addCategory(&runtimeCategory));
+    assert_int_equal(2, getCategories(&categories));
+    assert_int_equal(&dummyCategory, categories[0]);
+    assert_int_equal(&runtimeCategory, categories[1]);
+    assert_int_equal(1, runtimeCategory.index);
+
+    assert_int_equal(LOG_OK, setLevels(LEVEL_WARN));
+    assert_int_equal(LEVEL_WARN, runtimeCategory.currentLogLevel);
+
+    dummyCategory.currentLogLevel = LEVEL_INFO;
+}
+
+static bool stopLogging;
+static int nbLogged;
+
+static void* loggingThread(void* arg)
+{
+    (void) arg;
+
+    while (!__atomic_load_n(&stopLogging, __ATOMIC_RELAXED))
+    {
+        logError(runtimeCategory, "Logging while the configuration changes");
+        __atomic_fetch_add(&nbLogged, 1, __ATOMIC_RELAXED);
+    }
+
+    return NULL;
+}
+
+/**
+ * Wait until the logging threads made a counter go past a value.
+ */
+static void waitAbove(const int* const counter, const int value)
+{
+    while (__atomic_load_n(counter, __ATOMIC_RELAXED) <= value)
+    {
+        sched_yield();
+    }
+}
+
+void runtimeChangesWhileLogging(void** state)
+{
+    (void) state;
+
+    pthread_t threads[NB_LOGGING_THREADS];
+    int round;
+    int i;
+    const uint8_t dummyLevel = dummyLogger.currentLogLevel;
+    const uint8_t runtimeLevel = runtimeCategory.currentLogLevel;
+
+    // Only the counting loggers publish, dummyLogger is not meant to be called from several threads
+    dummyLogger.currentLogLevel = LEVEL_OFF;
+    runtimeCategory.currentLogLevel = LEVEL_MAX;
+
+    // The second round of threads takes over the reader counts of the first
+    for (round = 0; round < 2; round++)
+    {
+        stopLogging = false;
+        for (i = 0; i < NB_LOGGING_THREADS; i++)
+        {
+            assert_int_equal(0, pthread_create(&threads[i], NULL, &loggingThread, NULL));
+        }
+
+        for (i = 0; i < NB_CHANGES; i++)
+        {
+            assert_int_equal(LOG_OK, addLogger(&runtimeLogger0));
+            assert_int_equal(LOG_OK, replaceLogger(&runtimeLogger0, &runtimeLogger1));
+            assert_int_equal(LOG_OK, removeLogger(&runtimeLogger1));
+        }
+
+        // Added and replacing loggers get records, no record reaches a logger once its removal returned
+        assert_int_equal(LOG_OK, addLogger(&runtimeLogger0));
+        waitAbove(&published[0], __atomic_load_n(&published[0], __ATOMIC_RELAXED));
+        assert_int_equal(LOG_OK, replaceLogger(&runtimeLogger0, &runtimeLogger1));
+        const int replaced = __atomic_load_n(&published[0], __ATOMIC_RELAXED);
+        waitAbove(&published[1], __atomic_load_n(&published[1], __ATOMIC_RELAXED));
+        assert_int_equal(LOG_OK, removeLogger(&runtimeLogger1));
+        const int removed = __atomic_load_n(&published[1], __ATOMIC_RELAXED);
+        waitAbove(&nbLogged, __atomic_load_n(&nbLogged, __ATOMIC_RELAXED) + 100 * NB_LOGGING_THREADS);
+        assert_int_equal(replaced, __atomic_load_n(&published[0], __ATOMIC_RELAXED));
+        assert_int_equal(removed, __atomic_load_n(&published[1], __ATOMIC_RELAXED));
+
+        __atomic_store_n(&stopLogging, true, __ATOMIC_RELAXED);
+        for (i = 0; i < NB_LOGGING_THREADS; i++)
+        {
+            assert_int_equal(0, pthread_join(threads[i], NULL));
+        }
+    }
+
+    Logger* const* loggers;
+    assert_int_equal(1, getLoggers(&loggers));
+    assert_int_equal(&dummyLogger, loggers[0]);
+
+    dummyLogger.currentLogLevel = dummyLevel;
+    runtimeCategory.currentLogLevel = runtimeLevel;
+}
@@ -0,0 +1,281 @@
+/**
+ * @file
+ *
+ * Unit tests for the signal-safe logging path
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "testSignal.h"
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "slf4ec/log.h"
+#include "slf4ec/logSignal.h"
+#include "slf4ec/slf4ecCtrl.h"
+
+#define NB_LOAD_THREADS (4)
+#define NB_SIGNALS (5000)
+
+static const uint8_t noArg = 0;
+static LogCategory signalCategory = {.name = "SignalCategory", .currentLogLevel = LEVEL_MAX};
+static LogCategory loadCategory = {.name = "LoadCategory", .currentLogLevel = LEVEL_MAX};
+static char lastText[LOG_SIGNAL_RECORD_SIZE];
+static uint32_t nbSignalRecords = 0;
+static uint32_t nbLoadRecords = 0;
+static uint32_t nbHandled = 0;
+static uint8_t stopLoad = 0;
+
+static void signalInit(const void* const config)
+{
+    (void) config;
+}
+
+static void signalPublisher(const LogRecordV2* const logRecord, const LogFormat format)
+{
+    (void) format;
+
+    if (logRecord->category == &signalCategory && logRecord->level == LEVEL_TRACE)
+    {
+        va_list args;
+        va_copy(args, *logRecord->vaList);
+        (void) vsnprintf(lastText, sizeof(lastText), logRecord->formatStr, args);
+        va_end(args);
+        __atomic_fetch_add(&nbSignalRecords, 1, __ATOMIC_RELAXED);
+    }
+    else
+    {
+        __atomic_fetch_add(&nbLoadRecords, 1, __ATOMIC_RELAXED);
+    }
+}
+
+static Logger signalLogger = {.loggerName = "Signal", .initFct = &signalInit, .initArgs = &noArg, .format = FORMAT_FULL, .currentLogLevel = LEVEL_MAX, .publishFctV2 = &signalPublisher};
+
+static size_t format(char* const buffer, const size_t capacity, const char* const formatStr, ...)
+{
+    va_list args;
+
+    va_start(args, formatStr);
+    const size_t length = logSignalFormatv(buffer, capacity, formatStr, args);
+    va_end(args);
+
+    return length;
+}
+
+static void handler(int signum)
+{
+    (void) signum;
+    const uint32_t n = __atomic_fetch_add(&nbHandled, 1, __ATOMIC_RELAXED);
+    (void) logSignalSafe(&signalCategory, LEVEL_TRACE, "Signal %u %s", n, "handled");
+}
+
+static void installHandler(struct sigaction* const previous)
+{
+    struct sigaction action;
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = &handler;
+    action.sa_flags = SA_RESTART;
+    (void) sigemptyset(&action.sa_mask);
+    assert_int_equal(0, sigaction(SIGUSR1, &action, previous));
+}
+
+void signalFormat(void** state)
+{
+    (void) state;
+    char buffer[64];
+    char expected[64];
+    int value = 0;
+
+    assert_int_equal(19, format(buffer, sizeof(buffer), "%d %i %u %%", -42, 17, 4000000000u));
+    assert_string_equal("-42 17 4000000000 %", buffer);
+
+    format(buffer, sizeof(buffer), "[%5d][%-5d][%05d][%x][%X][%o]", 12, 12, -12, 0xbeef, 0xbeef, 8);
+    assert_string_equal("[   12][12   ][-0012][beef][BEEF][10]", buffer);
+
+    format(buffer, sizeof(buffer), "%hhu %hd %ld %lld %zu %jd %td", 257, 65537, -1L, -9000000000LL, (size_t) 7, (intmax_t) -3, (ptrdiff_t) 5);
+    assert_string_equal("1 1 -1 -9000000000 7 -3 5", buffer);
+
+    format(buffer, sizeof(buffer), "%c|%s|%-4s|%4s|%.2s|%*d|%s", 'x', "str", "ab", "ab", "abc", 3, 1, (const char*) NULL);
+    assert_string_equal("x|str|ab  |  ab|ab|  1|(null)", buffer);
+
+    format(buffer, sizeof(buffer), "%p", (void*) &value);
+    snprintf(expected, sizeof(expected), "%p", (void*) &value);
+    assert_string_equal(expected, buffer);
+
+    format(buffer, sizeof(buffer), "%lld", (long long) INT64_MIN);
+    assert_string_equal("-9223372036854775808", buffer);
+
+    // Truncated and always terminated
+    assert_int_equal(4, format(buffer, 5, "%s", "truncated"));
+    assert_string_equal("trun", buffer);
+    assert_int_equal(0, format(buffer, 1, "abc"));
+    assert_string_equal("", buffer);
+
+    // Unsupported conversions stop the formatting
+    format(buffer, sizeof(buffer), "%d %f %d", 1, 2.0, 3);
+    assert_string_equal("1 %f", buffer);
+}
+
+void signalWrite(void** state)
+{
+    (void) state;
+    struct sigaction previous;
+    int fds[2];
+    char output[LOG_SIGNAL_RECORD_SIZE * 2];
+
+    assert_int_equal(0, pipe(fds));
+    const LogSignalConfig config = {LOG_SIGNAL_WRITE, fds[1], 0};
+
+    assert_int_equal(LOG_NOT_INITIALIZED, logSignalSafe(&signalCategory, LEVEL_TRACE, "Not yet"));
+    assert_int_equal(LOG_OK, initSignalLog(&config));
+    assert_int_equal(LOG_ALREADY_INITIALIZED, initSignalLog(&config));
+    assert_int_equal(LOG_INVALID_PARAMETER, logSignalSafe(NULL, LEVEL_TRACE, "No category"));
+
+    installHandler(&previous);
+    nbHandled = 0;
+    assert_int_equal(0, raise(SIGUSR1));
+    assert_int_equal(0, sigaction(SIGUSR1, &previous, NULL));
+    assert_int_equal(1, nbHandled);
+
+    const ssize_t length = read(fds[0], output, sizeof(output) - 1);
+    assert_true(length > 0);
+    output[length] = '\0';
+    assert_true(strncmp("[TRACE][SignalCategory][", output, 24) == 0);
+    assert_true(strstr(output, "] - Signal 0 handled\n") != NULL);
+    assert_int_equal('\n', output[length - 1]);
+
+    // Nothing is written once filtered
+    signalCategory.currentLogLevel = LEVEL_INFO;
+    assert_int_equal(LOG_OK, logSignalSafe(&signalCategory, LEVEL_TRACE, "Filtered"));
+    signalCategory.currentLogLevel = LEVEL_MAX;
+
+    closeSignalLog();
+    close(fds[1]);
+    assert_int_equal(0, read(fds[0], output, sizeof(output)));
+    close(fds[0]);
+}
+
+void signalDefer(void** state)
+{
+    (void) state;
+    const LogSignalConfig config = {LOG_SIGNAL_DEFER, -1, 0};
+    uint32_t i;
+
+    assert_int_equal(LOG_OK, addLogger(&signalLogger));
+    assert_int_equal(LOG_OK, initSignalLog(&config));
+    nbSignalRecords = 0;
+
+    // Fill the buffer, the last records are dropped
+    for (i = 0; i < LOG_SIGNAL_SLOTS + 2; i++)
+    {
+        const LogResult expected = (i < LOG_SIGNAL_SLOTS) ? LOG_OK : LOG_OUT_OF_MEMORY;
+        assert_int_equal(expected, logSignalSafe(&signalCategory, LEVEL_TRACE, "Deferred %u", i));
+    }
+    assert_int_equal(0, nbSignalRecords);
+    assert_int_equal(2, getSignalLogDropped());
+
+    assert_int_equal(LOG_SIGNAL_SLOTS, drainSignalLog());
+    assert_int_equal(LOG_SIGNAL_SLOTS, nbSignalRecords);
+    assert_int_equal(0, strncmp("Deferred", lastText, 8));
+    assert_int_equal(0, drainSignalLog());
+
+    // Room again once drained
+    assert_int_equal(LOG_OK, logSignalSafe(&signalCategory, LEVEL_TRACE, "After %s", "drain"));
+    closeSignalLog();
+    assert_int_equal(LOG_SIGNAL_SLOTS + 1, nbSignalRecords);
+    assert_string_equal("After drain", lastText);
+
+    assert_int_equal(LOG_OK, removeLogger(&signalLogger));
+}
+
+static void* loadThread(void* arg)
+{
+    (void) arg;
+    uint32_t i = 0;
+
+    while (!__atomic_load_n(&stopLoad, __ATOMIC_RELAXED))
+    {
+        // Only the signal logger accepts trace records
+        logTrace(loadCategory, "Load %u", i++);
+    }
+
+    return NULL;
+}
+
+void signalDeferUnderLoad(void** state)
+{
+    (void) state;
+    const LogSignalConfig config = {LOG_SIGNAL_DEFER, -1, 1};
+    const uint32_t dropped = getSignalLogDropped();
+    pthread_t threads[NB_LOAD_THREADS];
+    struct sigaction previous;
+    uint32_t i;
+
+    assert_int_equal(LOG_OK, addLogger(&signalLogger));
+    assert_int_equal(LOG_OK, initSignalLog(&config));
+    installHandler(&previous);
+    nbSignalRecords = 0;
+    nbLoadRecords = 0;
+    nbHandled = 0;
+    stopLoad = 0;
+
+    for (i = 0; i < NB_LOAD_THREADS; i++)
+    {
+        assert_int_equal(0, pthread_create(&threads[i], NULL, &loadThread, NULL));
+    }
+
+    // Interrupt the logging threads while they are in the middle of publishing
+    for (i = 0; i < NB_SIGNALS; i++)
+    {
+        assert_int_equal(0, pthread_kill(threads[i % NB_LOAD_THREADS], SIGUSR1));
+        if ((i % 64) == 0)
+        {
+            (void) usleep(100);
+        }
+    }
+
+    __atomic_store_n(&stopLoad, 1, __ATOMIC_RELAXED);
+    for (i = 0; i < NB_LOAD_THREADS; i++)
+    {
+        assert_int_equal(0, pthread_join(threads[i], NULL));
+    }
+    assert_int_equal(0, sigaction(SIGUSR1, &previous, NULL));
+    closeSignalLog();
+
+    // Pending signals of the same kind are merged, so fewer than NB_SIGNALS may be handled, but none is lost
+    assert_true(nbHandled > 0);
+    assert_true(nbLoadRecords > 0);
+    assert_int_equal(nbHandled, nbSignalRecords + getSignalLogDropped() - dropped);
+
+    assert_int_equal(LOG_OK, removeLogger(&signalLogger));
+}
@@ -0,0 +1,186 @@
+/**
+ * @file
+ *
+ * Test spans
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "testSpan.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "slf4ec/log.h"
+#include "slf4ec/slf4ecCtrl.h"
+
+#define MAX_SPAN_RECORDS (8)
+
+/**
+ * What a logger received from a span record
+ */
+typedef struct
+{
+    char name[32];
+    uint32_t threadId;
+    uint64_t duration;
+    uint8_t flags;
+    uint8_t level;
+} SpanRecord;
+
+extern LogCategory dummyCategory;
+
+static const uint8_t noArg = 0;
+static SpanRecord records[MAX_SPAN_RECORDS];
+static size_t nbRecords = 0;
+static char lastMessage[128];
+
+static void spanInit(const void* const config)
+{
+    (void) config;
+}
+
+static void spanPublisher(const LogRecordV2* const record, const LogFormat format)
+{
+    (void) format;
+    va_list ap;
+
+    va_copy(ap, *record->vaList);
+    vsnprintf(lastMessage, sizeof(lastMessage), record->formatStr, ap);
+    va_end(ap);
+
+    if (nbRecords < MAX_SPAN_RECORDS)
+    {
+        SpanRecord* const spanRecord = &records[nbRecords++];
+
+        memset(spanRecord, 0, sizeof(SpanRecord));
+        spanRecord->flags = record->flags;
+        spanRecord->level = record->level;
+        if ((record->flags & (LOG_RECORD_SPAN_BEGIN | LOG_RECORD_SPAN_END)) != 0)
+        {
+            va_copy(ap, *record->vaList);
+            strncpy(spanRecord->name, va_arg(ap, const char*), sizeof(spanRecord->name) - 1);
+            spanRecord->threadId = va_arg(ap, uint32_t);
+            if ((record->flags & LOG_RECORD_SPAN_END) != 0)
+            {
+                spanRecord->duration = va_arg(ap, uint64_t);
+            }
+            va_end(ap);
+        }
+    }
+}
+
+static Logger spanLogger = {.loggerName = "SpanLogger", .initFct = &spanInit, .initArgs = &noArg, .format = FORMAT_MSG_ONLY, .currentLogLevel = LEVEL_MAX, .publishFctV2 = &spanPublisher};
+
+static void startSpans(const uint8_t level)
+{
+    nbRecords = 0;
+    dummyCategory.currentLogLevel = level;
+    assert_int_equal(LOG_OK, addLogger(&spanLogger));
+}
+
+static void stopSpans(void)
+{
+    dummyCategory.currentLogLevel = LEVEL_INFO;
+    assert_int_equal(LOG_OK, removeLogger(&spanLogger));
+}
+
+void spanBadParams(void** state)
+{
+    (void) state;
+    LogSpan span;
+
+    startSpans(LEVEL_MAX);
+    assert_int_equal(LOG_INVALID_PARAMETER, logSpanBegin(span, dummyCategory, LEVEL_DEBUG, NULL));
+    assert_null(span.category);
+    assert_int_equal(LOG_OK, logSpanEnd(span));
+    assert_int_equal(0, nbRecords);
+    stopSpans();
+}
+
+void spanFiltered(void** state)
+{
+    (void) state;
+    LogSpan span;
+
+    startSpans(LEVEL_INFO);
+    assert_int_equal(LOG_OK, logSpanBegin(span, dummyCategory, LEVEL_DEBUG, "filtered"));
+    assert_null(span.category);
+    assert_int_equal(LOG_OK, logSpanEnd(span));
+    assert_int_equal(0, nbRecords);
+
+    // Published as the level allows, ended even if it does not anymore
+    assert_int_equal(LOG_OK, logSpanBegin(span, dummyCategory, LEVEL_INFO, "lowered"));
+    dummyCategory.currentLogLevel = LEVEL_WARN;
+    assert_int_equal(LOG_OK, logSpanEnd(span));
+    assert_int_equal(2, nbRecords);
+    stopSpans();
+}
+
+void spanRecords(void** state)
+{
+    (void) state;
+    LogSpan outer;
+    LogSpan inner;
+    char expected[128];
+
+    startSpans(LEVEL_MAX);
+    assert_int_equal(LOG_OK, logSpanBegin(outer, dummyCategory, LEVEL_DEBUG, "outer"));
+    assert_ptr_equal(&dummyCategory, outer.category);
+    snprintf(expected, sizeof(expected), "Span outer begins on thread %" PRIu32, outer.threadId);
+    assert_string_equal(expected, lastMessage);
+
+    assert_int_equal(LOG_OK, logSpanBegin(inner, dummyCategory, LEVEL_TRACE, "inner"));
+    assert_int_equal(LOG_OK, logSpanEnd(inner));
+    snprintf(expected, sizeof(expected), "Span inner ends on thread %" PRIu32 " after 0", inner.threadId);
+    assert_string_equal(expected, lastMessage);
+    assert_int_equal(LOG_OK, logSpanEnd(outer));
+
+    // Ending twice publishes nothing more
+    assert_int_equal(LOG_OK, logSpanEnd(outer));
+    assert_int_equal(4, nbRecords);
+
+    assert_int_equal(LOG_RECORD_SPAN_BEGIN, records[0].flags & (LOG_RECORD_SPAN_BEGIN | LOG_RECORD_SPAN_END));
+    assert_string_equal("outer", records[0].name);
+    assert_int_equal(LEVEL_DEBUG, records[0].level);
+    assert_int_equal(LOG_RECORD_SPAN_BEGIN, records[1].flags & (LOG_RECORD_SPAN_BEGIN | LOG_RECORD_SPAN_END));
+    assert_string_equal("inner", records[1].name);
+    assert_int_equal(LEVEL_TRACE, records[1].level);
+    assert_int_equal(LOG_RECORD_SPAN_END, records[2].flags & (LOG_RECORD_SPAN_BEGIN | LOG_RECORD_SPAN_END));
+    assert_string_equal("inner", records[2].name);
+    assert_int_equal(0, records[2].duration);
+    assert_int_equal(LOG_RECORD_SPAN_END, records[3].flags & (LOG_RECORD_SPAN_BEGIN | LOG_RECORD_SPAN_END));
+    assert_string_equal("outer", records[3].name);
+    assert_int_equal(LEVEL_DEBUG, records[3].level);
+    assert_int_equal(records[0].threadId, records[3].threadId);
+    assert_true(records[0].threadId != 0);
+
+    // Other records are not spans
+    assert_int_equal(LOG_OK, logInfo(dummyCategory, "Not a span"));
+    assert_int_equal(0, records[4].flags & (LOG_RECORD_SPAN_BEGIN | LOG_RECORD_SPAN_END));
+    stopSpans();
+}
@@ -0,0 +1,153 @@
+/**
+ * @file
+ *
+ * Tests for stats.c
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "testStats.h"
+
+#include "slf4ec/log.h"
+#include "slf4ec/slf4ecCtrl.h"
+
+#ifdef USE_LOG_STATS
+
+extern LogCategory dummyCategory;
+extern Logger dummyLogger;
+
+static LogCategory unknownCategory = {.name = "UnknownCategory", .currentLogLevel = LEVEL_MAX};
+static Logger unknownLogger = {.loggerName = "UnknownLogger", .currentLogLevel = LEVEL_MAX};
+static uint64_t tick = 0;
+
+// Also called by the loggers of the threads of runtimeChangesWhileLogging
+static uint64_t getTick(void)
+{
+    return __atomic_fetch_add(&tick, 1, __ATOMIC_RELAXED);
+}
+const GetLogTimestamp logTickApi = &getTick;
+
+void statsBadParams(void** state)
+{
+    (void) state;
+
+    LogCategoryStats categoryStats;
+    LoggerStats loggerStats;
+
+    assert_int_equal(LOG_INVALID_PARAMETER, getLogStats(NULL));
+    assert_int_equal(LOG_INVALID_PARAMETER, getCategoryStats(NULL, &categoryStats));
+    assert_int_equal(LOG_INVALID_PARAMETER, getCategoryStats(&dummyCategory, NULL));
+    assert_int_equal(LOG_INVALID_PARAMETER, getCategoryStats(&unknownCategory, &categoryStats));
+    assert_int_equal(LOG_INVALID_PARAMETER, getLoggerStats(NULL, &loggerStats));
+    assert_int_equal(LOG_INVALID_PARAMETER, getLoggerStats(&dummyLogger, NULL));
+    assert_int_equal(LOG_INVALID_PARAMETER, getLoggerStats(&unknownLogger, &loggerStats));
+}
+
+void statsCountCalls(void** state)
+{
+    (void) state;
+
+    LogStats before, after;
+    LogCategoryStats categoryBefore, categoryAfter;
+
+    dummyCategory.currentLogLevel = LEVEL_INFO;
+    dummyLogger.currentLogLevel = LEVEL_MAX;
+
+    assert_int_equal(LOG_OK, getLogStats(&before));
+    assert_int_equal(LOG_OK, getCategoryStats(&dummyCategory, &categoryBefore));
+
+    logInfo(dummyCategory, "Published");
+    logDebug(dummyCategory, "Filtered");
+    logInfo(unknownCategory, "Not configured");
+
+    assert_int_equal(LOG_OK, getLogStats(&after));
+    assert_int_equal(LOG_OK, getCategoryStats(&dummyCategory, &categoryAfter));
+
+    assert_int_equal(before.calls[LEVEL_INFO] + 2, after.calls[LEVEL_INFO]);
+    assert_int_equal(before.calls[LEVEL_DEBUG] + 1, after.calls[LEVEL_DEBUG]);
+    assert_int_equal(before.filteredByCategory[LEVEL_INFO], after.filteredByCategory[LEVEL_INFO]);
+    assert_int_equal(before.filteredByCategory[LEVEL_DEBUG] + 1, after.filteredByCategory[LEVEL_DEBUG]);
+    assert_int_equal(before.published[LEVEL_INFO] + 2, after.published[LEVEL_INFO]);
+    assert_int_equal(before.published[LEVEL_DEBUG], after.published[LEVEL_DEBUG]);
+
+    assert_int_equal(categoryBefore.calls + 2, categoryAfter.calls);
+    assert_int_equal(categoryBefore.filtered + 1, categoryAfter.filtered);
+}
+
+void statsCountFilteredByLogger(void** state)
+{
+    (void) state;
+
+    LogStats before, after;
+
+    dummyCategory.currentLogLevel = LEVEL_MAX;
+    dummyLogger.currentLogLevel = LEVEL_WARN;
+
+    assert_int_equal(LOG_OK, getLogStats(&before));
+    logInfo(dummyCategory, "Filtered by the logger");
+    assert_int_equal(LOG_OK, getLogStats(&after));
+
+    assert_int_equal(before.filteredByCategory[LEVEL_INFO], after.filteredByCategory[LEVEL_INFO]);
+    assert_int_equal(before.filteredByLogger[LEVEL_INFO] + 1, after.filteredByLogger[LEVEL_INFO]);
+    assert_int_equal(before.published[LEVEL_INFO], after.published[LEVEL_INFO]);
+
+    dummyLogger.currentLogLevel = LEVEL_MAX;
+    dummyCategory.currentLogLevel = LEVEL_INFO;
+}
+
+void statsLogger(void** state)
+{
+    (void) state;
+
+    LoggerStats before, after;
+
+    dummyLogger.currentLogLevel = LEVEL_MAX;
+
+    assert_int_equal(LOG_OK, getLoggerStats(&dummyLogger, &before));
+    logWarn(dummyCategory, "12345");
+    assert_int_equal(LOG_OK, getLoggerStats(&dummyLogger, &after));
+
+    assert_int_equal(before.published + 1, after.published);
+    assert_int_equal(before.bytes + 5, after.bytes);
+    assert_int_equal(before.publishTime + 1, after.publishTime);
+}
+
+void statsReportBytesOutsideLogger(void** state)
+{
+    (void) state;
+
+    LoggerStats before, after;
+
+    assert_int_equal(LOG_OK, getLoggerStats(&dummyLogger, &before));
+    logReportBytes(42);
+    assert_int_equal(LOG_OK, getLoggerStats(&dummyLogger, &after));
+
+    assert_int_equal(before.bytes, after.bytes);
+}
+
+#endif /* USE_LOG_STATS */
@@ -2,6 +2,28 @@ Test/Inc/slf4ec := \
   include \
   test/mocks
 
+Test/Def/slf4ec := \
+  USE_LOG_STATS \
+  USE_LOG_PROFILER \
+  USE_LOG_DEDUP \
+  USE_LOG_CONTEXT
+
 Test/Src/slf4ec := \
   src/slf4ec.c \
+  src/logThreadSlots.c \
+  src/stats.c \
+  src/profiler.c \
+  src/histogram.c \
+  src/logCompress.c \
+  src/logContext.c \
+  src/logSignal.c \
+  src/logFormatWalk.c \
+  src/logCapture.c \
+  src/logDedup.c \
+  src/logger/async.c \
+  src/logger/file.c \
+  src/logger/format.c \
+  src/logger/shm.c \
+  src/logger/trace.c \
+  src/logger/uring.c \
   src/logger/stdout.c
\ No newline at end of file
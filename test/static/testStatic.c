@@ -0,0 +1,125 @@
+/**
+ * @file
+ *
+ * Tests of the loggers bound at compile time
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "testStatic.h"
+
+#include "slf4ec/log.h"
+#include "slf4ec/slf4ecCtrl.h"
+#include "logStaticLoggers.h"
+
+static uint64_t getTimestamp(void)
+{
+    return 42;
+}
+
+const GetLogTimestamp logTimeApi = &getTimestamp;
+
+static const uint8_t noArg = 0;
+static uint32_t nbFull = 0;
+static uint32_t nbWarn = 0;
+static uint32_t nbRuntime = 0;
+static LogFormat lastFullFormat;
+static LogFormat lastWarnFormat;
+static uint8_t lastLevel;
+
+static LogCategory staticCategory = {.name = "Static", .currentLogLevel = LEVEL_MAX};
+static LogCategory* categories[] = {&staticCategory};
+
+void fullPublisher(const LogRecordV2* const record, const LogFormat format)
+{
+    lastFullFormat = format;
+    lastLevel = record->level;
+    nbFull++;
+}
+
+void warnPublisher(const LogRecordV2* const record, const LogFormat format)
+{
+    lastWarnFormat = format;
+    lastLevel = record->level;
+    nbWarn++;
+}
+
+static void runtimeInit(const void* const config)
+{
+    (void) config;
+}
+
+static void runtimePublisher(const LogRecordV2* const record, const LogFormat format)
+{
+    (void) record;
+    (void) format;
+    nbRuntime++;
+}
+
+static Logger runtimeLogger = {.loggerName = "Runtime", .initFct = &runtimeInit, .initArgs = &noArg, .format = FORMAT_FULL, .currentLogLevel = LEVEL_MAX, .publishFctV2 = &runtimePublisher};
+static Logger* loggers[] = {&runtimeLogger};
+
+void staticLevelAndFormat(void** state)
+{
+    (void) state;
+
+    assert_int_equal(LOG_OK, initLogger(1, categories, 1, loggers));
+
+    // Each function gets the format and level it was listed with
+    assert_int_equal(LOG_OK, logInfo(staticCategory, "Info"));
+    assert_int_equal(1, nbFull);
+    assert_int_equal(0, nbWarn);
+    assert_int_equal(FORMAT_FULL, lastFullFormat);
+    assert_int_equal(LEVEL_INFO, lastLevel);
+
+    assert_int_equal(LOG_OK, logError(staticCategory, "Error"));
+    assert_int_equal(2, nbFull);
+    assert_int_equal(1, nbWarn);
+    assert_int_equal(FORMAT_MSG_ONLY, lastWarnFormat);
+    assert_int_equal(LEVEL_ERROR, lastLevel);
+
+    // Categories still filter before the loggers
+    staticCategory.currentLogLevel = LEVEL_ERROR;
+    assert_int_equal(LOG_OK, logWarn(staticCategory, "Warn"));
+    assert_int_equal(2, nbFull);
+    assert_int_equal(1, nbWarn);
+    staticCategory.currentLogLevel = LEVEL_MAX;
+}
+
+void staticRuntimeLoggers(void** state)
+{
+    (void) state;
+
+    // Loggers configured at runtime are initialized but never published to
+    assert_int_equal(LOG_OK, removeLogger(&runtimeLogger));
+    assert_int_equal(LOG_OK, addLogger(&runtimeLogger));
+    nbFull = 0;
+    assert_int_equal(LOG_OK, logError(staticCategory, "Error"));
+    assert_int_equal(1, nbFull);
+    assert_int_equal(0, nbRuntime);
+}
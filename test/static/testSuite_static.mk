@@ -0,0 +1,11 @@
+Test/Inc/static := \
+  include \
+  test/mocks
+
+Test/Def/static := \
+  USE_STATIC_LOGGERS
+
+Test/Src/static := \
+  src/slf4ec.c \
+  src/logThreadSlots.c \
+  src/logContext.c
@@ -0,0 +1,354 @@
+/**
+ * @file
+ *
+ * Multi-threaded stress and scaling tests of the logging core
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "testStress.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "slf4ec/log.h"
+#include "slf4ec/slf4ecCtrl.h"
+
+#define NB_CATEGORIES (4)
+#define MAX_THREADS (64)
+#define DEFAULT_RECORDS (20000)
+#define MESSAGE_LENGTH (64)
+
+/**
+ * What a checksum sink observed. Records are published from the logging thread, so each thread only touches its own
+ * entries and the main thread reads them once the logging threads are joined.
+ */
+typedef struct
+{
+    uint32_t next[MAX_THREADS];     /**< Next sequence number expected from each thread */
+    uint32_t received[MAX_THREADS]; /**< Checked records received from each thread */
+    uint32_t corrupted;             /**< Records whose content does not match their checksum */
+    uint32_t misordered;            /**< Checked records lost, duplicated or received out of order */
+} SinkState;
+
+typedef struct
+{
+    uint32_t index;
+    uint32_t nbRecords;
+    uint32_t failures;
+} Worker;
+
+static uint64_t getTimestamp(void)
+{
+    struct timespec now;
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+}
+
+const GetLogTimestamp logTimeApi = &getTimestamp;
+const GetLogTimestamp logTickApi = &getTimestamp;
+
+static const uint8_t noArg = 0;
+static SinkState sinkStates[3];
+static uint32_t nbThreads = 0;
+static uint32_t nbRecords = DEFAULT_RECORDS;
+static uint8_t stopFlipping = 0;
+static pthread_barrier_t startBarrier;
+
+static LogCategory stressCategories[NB_CATEGORIES] = {
+    {.name = "Stress0", .currentLogLevel = LEVEL_MAX},
+    {.name = "Stress1", .currentLogLevel = LEVEL_MAX},
+    {.name = "Stress2", .currentLogLevel = LEVEL_MAX},
+    {.name = "Stress3", .currentLogLevel = LEVEL_MAX}};
+
+static uint32_t checksum(const char kind, const uint32_t thread, const uint32_t category, const uint32_t sequence)
+{
+    return (sequence * 2654435761u) ^ (thread << 24) ^ (category << 16) ^ (uint32_t) kind;
+}
+
+static uint8_t levelOf(const char kind)
+{
+    return (kind == 'I') ? LEVEL_INFO : (kind == 'D') ? LEVEL_DEBUG : LEVEL_TRACE;
+}
+
+/**
+ * Verify a record produced by ::logRecords. Info and debug records are never filtered by the level flips so each one
+ * must be received exactly once and in order, trace records may be filtered.
+ */
+static void checkRecord(SinkState* const state, const LogRecordV2* const record)
+{
+    char message[MESSAGE_LENGTH];
+    unsigned int thread, category, sequence, sum;
+    char kind;
+    va_list args;
+
+    va_copy(args, *record->vaList);
+    (void) vsnprintf(message, sizeof(message), record->formatStr, args);
+    va_end(args);
+
+    if (sscanf(message, "%c %u %u %u %x", &kind, &thread, &category, &sequence, &sum) != 5 || thread >= MAX_THREADS ||
+        category >= NB_CATEGORIES || sum != checksum(kind, thread, category, sequence) ||
+        record->category != &stressCategories[category] || record->level != levelOf(kind))
+    {
+        __atomic_fetch_add(&state->corrupted, 1, __ATOMIC_RELAXED);
+    }
+    else if (kind != 'T')
+    {
+        if (sequence != state->next[thread])
+        {
+            __atomic_fetch_add(&state->misordered, 1, __ATOMIC_RELAXED);
+        }
+        state->next[thread] = sequence + 1;
+        state->received[thread]++;
+    }
+}
+
+static void sinkInit(const void* const config)
+{
+    (void) config;
+}
+
+static void sinkPublisher0(const LogRecordV2* const record, const LogFormat format)
+{
+    (void) format;
+    checkRecord(&sinkStates[0], record);
+}
+
+static void sinkPublisher1(const LogRecordV2* const record, const LogFormat format)
+{
+    (void) format;
+    checkRecord(&sinkStates[1], record);
+}
+
+static void churnPublisher(const LogRecordV2* const record, const LogFormat format)
+{
+    (void) format;
+    checkRecord(&sinkStates[2], record);
+}
+
+static Logger sink0 = {.loggerName = "Sink0", .initFct = &sinkInit, .initArgs = &noArg, .format = FORMAT_FULL, .currentLogLevel = LEVEL_MAX, .publishFctV2 = &sinkPublisher0};
+static Logger sink1 = {.loggerName = "Sink1", .initFct = &sinkInit, .initArgs = &noArg, .format = FORMAT_FULL, .currentLogLevel = LEVEL_MAX, .publishFctV2 = &sinkPublisher1};
+
+/* Added and removed while records are logged, so only the integrity of what it receives can be checked */
+static Logger churnLogger = {.loggerName = "Churn", .initFct = &sinkInit, .initArgs = &noArg, .format = FORMAT_FULL, .currentLogLevel = LEVEL_MAX, .publishFctV2 = &churnPublisher};
+
+static uint32_t getSetting(const char* const name, const uint32_t defaultValue, const uint32_t maxValue)
+{
+    const char* const value = getenv(name);
+    uint32_t setting = defaultValue;
+
+    if (value != NULL && atoi(value) > 0)
+    {
+        setting = (uint32_t) atoi(value);
+    }
+
+    return (setting > maxValue) ? maxValue : setting;
+}
+
+static void* logRecords(void* const arg)
+{
+    Worker* const worker = arg;
+    uint32_t i;
+
+    (void) pthread_barrier_wait(&startBarrier);
+
+    for (i = 0; i < worker->nbRecords; i++)
+    {
+        const uint32_t category = i % NB_CATEGORIES;
+        const LogCategory* const logCategory = &stressCategories[category];
+        LogResult result;
+
+        if ((i & 1) == 0)
+        {
+            result = logInfo(*logCategory, "I %u %u %u %08x", worker->index, category, i, checksum('I', worker->index, category, i));
+        }
+        else
+        {
+            result = logDebug(*logCategory, "D %u %u %u %08x", worker->index, category, i, checksum('D', worker->index, category, i));
+        }
+
+        if ((i & 3) == 0)
+        {
+            result |= logTrace(*logCategory, "T %u %u %u %08x", worker->index, category, i, checksum('T', worker->index, category, i));
+        }
+
+        if (result != LOG_OK)
+        {
+            worker->failures++;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Change levels and loggers while records are logged. Info and debug records must always get through.
+ */
+static void* flipLevels(void* const arg)
+{
+    static const uint8_t levels[] = {LEVEL_DEBUG, LEVEL_TRACE, LEVEL_MAX};
+    uint32_t* const nbFlips = arg;
+    uint32_t i = 0;
+
+    while (!__atomic_load_n(&stopFlipping, __ATOMIC_RELAXED))
+    {
+        (void) setLevels(levels[i % 3]);
+        __atomic_store_n(&sink0.currentLogLevel, levels[(i + 1) % 2], __ATOMIC_RELAXED);
+        __atomic_store_n(&sink1.currentLogLevel, levels[i % 2], __ATOMIC_RELAXED);
+
+        if ((i & 15) == 0)
+        {
+            (void) (((i & 16) == 0) ? addLogger(&churnLogger) : removeLogger(&churnLogger));
+        }
+        i++;
+    }
+
+    *nbFlips = i;
+    return NULL;
+}
+
+/**
+ * Log from @p threadCount threads, optionally flipping levels meanwhile.
+ *
+ * @return Elapsed time in nanoseconds
+ */
+static uint64_t runWorkers(const uint32_t threadCount, const bool flip)
+{
+    pthread_t threads[MAX_THREADS];
+    Worker workers[MAX_THREADS];
+    pthread_t flipper;
+    uint32_t nbFlips = 0;
+    uint32_t i;
+
+    memset(sinkStates, 0, sizeof(sinkStates));
+    stopFlipping = 0;
+    assert_int_equal(0, pthread_barrier_init(&startBarrier, NULL, threadCount + 1));
+
+    for (i = 0; i < threadCount; i++)
+    {
+        workers[i].index = i;
+        workers[i].nbRecords = nbRecords;
+        workers[i].failures = 0;
+        assert_int_equal(0, pthread_create(&threads[i], NULL, &logRecords, &workers[i]));
+    }
+    if (flip)
+    {
+        assert_int_equal(0, pthread_create(&flipper, NULL, &flipLevels, &nbFlips));
+    }
+
+    (void) pthread_barrier_wait(&startBarrier);
+    const uint64_t start = getTimestamp();
+    for (i = 0; i < threadCount; i++)
+    {
+        assert_int_equal(0, pthread_join(threads[i], NULL));
+    }
+    const uint64_t elapsed = getTimestamp() - start;
+
+    if (flip)
+    {
+        __atomic_store_n(&stopFlipping, 1, __ATOMIC_RELAXED);
+        assert_int_equal(0, pthread_join(flipper, NULL));
+        assert_true(nbFlips > 0);
+        (void) removeLogger(&churnLogger);
+    }
+    (void) pthread_barrier_destroy(&startBarrier);
+
+    // Every info and debug record reached both sinks, once and intact
+    for (i = 0; i < threadCount; i++)
+    {
+        assert_int_equal(0, workers[i].failures);
+        assert_int_equal(nbRecords, sinkStates[0].received[i]);
+        assert_int_equal(nbRecords, sinkStates[1].received[i]);
+    }
+    assert_int_equal(0, sinkStates[0].corrupted + sinkStates[1].corrupted + sinkStates[2].corrupted);
+    assert_int_equal(0, sinkStates[0].misordered + sinkStates[1].misordered);
+
+    return elapsed;
+}
+
+void stressInitialize(void** state)
+{
+    (void) state;
+    static LogCategory* const categories[NB_CATEGORIES] = {&stressCategories[0], &stressCategories[1], &stressCategories[2], &stressCategories[3]};
+    static Logger* const loggers[] = {&sink0, &sink1};
+    const long nbCores = sysconf(_SC_NPROCESSORS_ONLN);
+
+    nbThreads = getSetting("STRESS_THREADS", (nbCores > 1) ? (uint32_t) nbCores : 2, MAX_THREADS);
+    nbRecords = getSetting("STRESS_RECORDS", DEFAULT_RECORDS, UINT32_MAX / 2);
+
+    assert_int_equal(LOG_OK, initLogger(NB_CATEGORIES, categories, 2, loggers));
+}
+
+void stressIntegrity(void** state)
+{
+    (void) state;
+    LogStats before;
+    LogStats after;
+
+    assert_int_equal(LOG_OK, getLogStats(&before));
+    (void) runWorkers(nbThreads, true);
+    assert_int_equal(LOG_OK, getLogStats(&after));
+
+    // Statistics of exited threads are kept
+    const uint64_t expected = (uint64_t) nbThreads * nbRecords / 2;
+    assert_int_equal(expected, after.calls[LEVEL_INFO] - before.calls[LEVEL_INFO]);
+    assert_int_equal(expected, after.calls[LEVEL_DEBUG] - before.calls[LEVEL_DEBUG]);
+}
+
+void stressScaling(void** state)
+{
+    (void) state;
+    double singleThreaded = 0;
+    uint32_t threadCount;
+
+    (void) setLevels(LEVEL_DEBUG);
+    printf("%8s %14s %8s\n", "threads", "records/s", "speedup");
+    // Powers of two, then the requested number of threads
+    for (threadCount = 1;; threadCount = (threadCount * 2 < nbThreads) ? threadCount * 2 : nbThreads)
+    {
+        const uint64_t elapsed = runWorkers(threadCount, false);
+        const double throughput = (double) threadCount * nbRecords * 1e9 / (double) ((elapsed > 0) ? elapsed : 1);
+
+        if (threadCount == 1)
+        {
+            singleThreaded = throughput;
+        }
+        printf("%8u %14.0f %8.2f\n", threadCount, throughput, throughput / singleThreaded);
+
+        if (threadCount == nbThreads)
+        {
+            break;
+        }
+    }
+}
@@ -0,0 +1,14 @@
+Test/Inc/stress := \
+  include \
+  test/mocks
+
+Test/Def/stress := \
+  USE_LOG_STATS \
+  USE_LOG_CONTEXT
+
+Test/Src/stress := \
+  src/slf4ec.c \
+  src/logThreadSlots.c \
+  src/stats.c \
+  src/histogram.c \
+  src/logContext.c
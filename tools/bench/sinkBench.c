@@ -0,0 +1,347 @@
+/**
+ * @file
+ *
+ * Throughput of the loggers writing to files, in a single harness
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Usage: sinkBench [-n records] [-t threads] [-o directory] [sinks...]
+ *
+ * Each sink is measured in its own process, as loggers are singletons: the producer threads log the same records,
+ * then the sink is flushed and closed, all of it being timed. User and system CPU times of the process are reported
+ * along, the system time being what io_uring is meant to save.
+ */
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "slf4ec/log.h"
+#include "slf4ec/slf4ecCtrl.h"
+#include "slf4ec/logger/file.h"
+#include "slf4ec/logger/stdout.h"
+#include "slf4ec/logger/uring.h"
+
+#define MAX_THREADS (64)
+#define MMAP_RECORD_SIZE (256)
+
+static uint64_t getTimestamp(void)
+{
+    static uint64_t timestamp = 0;
+
+    return __atomic_add_fetch(&timestamp, 1, __ATOMIC_RELAXED);
+}
+const GetLogTimestamp logTimeApi = &getTimestamp;
+
+#ifdef USE_LOG_STATS
+const GetLogTimestamp logTickApi = &getTimestamp;
+#endif
+
+static LogCategory benchCategory = {.name = "Bench", .currentLogLevel = LEVEL_MAX};
+static unsigned long nbRecords = 1000000;
+static unsigned long nbThreads = 1;
+static char path[1024];
+
+/*
+ * Reference sink: records formatted straight into a file mapped in memory, no system call at all
+ */
+static struct
+{
+    uint8_t* data;
+    size_t capacity;
+    size_t size;
+    int fd;
+} mmapSink;
+
+static void initMmapSink(const void* const param)
+{
+    (void) param;
+    mmapSink.capacity = (size_t) nbRecords * MMAP_RECORD_SIZE;
+    mmapSink.fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (mmapSink.fd >= 0 && ftruncate(mmapSink.fd, (off_t) mmapSink.capacity) == 0)
+    {
+        void* const data = mmap(NULL, mmapSink.capacity, PROT_READ | PROT_WRITE, MAP_SHARED, mmapSink.fd, 0);
+        mmapSink.data = (data != MAP_FAILED) ? data : NULL;
+    }
+}
+
+static void logToMmapSink(const LogRecordV2* const record, const LogFormat format)
+{
+    char text[MMAP_RECORD_SIZE];
+    va_list args;
+
+    (void) format;
+    int length = snprintf(text, sizeof(text), "[%s][%s][%" PRIu64 "] - ", logLevelNames[record->level], record->category->name,
+                          record->timestamp);
+    va_copy(args, *record->vaList);
+    length += vsnprintf(&text[length], sizeof(text) - (size_t) length - 1, record->formatStr, args);
+    va_end(args);
+    length = (length < (int) sizeof(text) - 1) ? length : (int) sizeof(text) - 1;
+    text[length++] = '\n';
+
+    const size_t offset = __atomic_fetch_add(&mmapSink.size, (size_t) length, __ATOMIC_RELAXED);
+    if (mmapSink.data != NULL && offset + (size_t) length <= mmapSink.capacity)
+    {
+        memcpy(&mmapSink.data[offset], text, (size_t) length);
+    }
+}
+
+static void closeMmapSink(void)
+{
+    (void) munmap(mmapSink.data, mmapSink.capacity);
+    (void) ftruncate(mmapSink.fd, (off_t)((mmapSink.size < mmapSink.capacity) ? mmapSink.size : mmapSink.capacity));
+    (void) close(mmapSink.fd);
+}
+
+static void closeStdOutSink(void)
+{
+    (void) fflush(stdout);
+}
+
+static FileLoggerConfig fileConfig = {.path = path, .encoding = FILE_ENCODING_TEXT};
+static UringLoggerConfig uringConfig = {path, 0, 0, LEVEL_OFF, false, 0};
+static UringLoggerConfig pwriteConfig = {path, 0, 0, LEVEL_OFF, true, 0};
+static UringLoggerConfig uringSyncConfig = {path, 0, 0, LEVEL_ERROR, false, 0};
+
+static Logger stdoutLogger = {.loggerName = "stdout", .initFct = &initStdOut, .initArgs = NULL, .format = FORMAT_FULL, .currentLogLevel = LEVEL_MAX, .publishFctV2 = &logToStdOutV2};
+static Logger mmapLogger = {.loggerName = "mmap", .initFct = &initMmapSink, .initArgs = NULL, .format = FORMAT_FULL, .currentLogLevel = LEVEL_MAX, .publishFctV2 = &logToMmapSink};
+static Logger fileLogger = {.loggerName = "file", .initFct = &initFileLogger, .initArgs = &fileConfig, .format = FORMAT_FULL, .currentLogLevel = LEVEL_MAX, .publishFctV2 = &logToFileV2};
+static Logger uringLogger = {.loggerName = "uring", .initFct = &initUringLogger, .initArgs = &uringConfig, .format = FORMAT_FULL, .currentLogLevel = LEVEL_MAX, .publishFctV2 = &logToUringV2};
+static Logger pwriteLogger = {.loggerName = "pwrite", .initFct = &initUringLogger, .initArgs = &pwriteConfig, .format = FORMAT_FULL, .currentLogLevel = LEVEL_MAX, .publishFctV2 = &logToUringV2};
+static Logger uringSyncLogger = {.loggerName = "uringSync", .initFct = &initUringLogger, .initArgs = &uringSyncConfig, .format = FORMAT_FULL, .currentLogLevel = LEVEL_MAX, .publishFctV2 = &logToUringV2};
+
+typedef struct
+{
+    Logger* logger;
+    void (*close)(void);
+} Sink;
+
+static const Sink sinks[] = {
+    {&stdoutLogger, &closeStdOutSink},
+    {&mmapLogger, &closeMmapSink},
+    {&fileLogger, &closeFileLogger},
+    {&uringLogger, &closeUringLogger},
+    {&pwriteLogger, &closeUringLogger},
+    {&uringSyncLogger, &closeUringLogger},
+};
+#define NB_SINKS (sizeof(sinks) / sizeof(sinks[0]))
+
+static uint64_t now(void)
+{
+    struct timespec time;
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t) time.tv_sec * 1000000000u + (uint64_t) time.tv_nsec;
+}
+
+static void* produce(void* arg)
+{
+    const unsigned long thread = (unsigned long) (uintptr_t) arg;
+    unsigned long i;
+
+    for (i = thread; i < nbRecords; i += nbThreads)
+    {
+        // One record in a thousand asks for durability, for the sinks syncing on errors
+        if (i % 1000 == 999)
+        {
+            logError(benchCategory, "Record %lu from thread %lu, value %d", i, thread, (int) (i * 7));
+        }
+        else
+        {
+            logInfo(benchCategory, "Record %lu from thread %lu, value %d", i, thread, (int) (i * 7));
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Measure a sink, in a child process. Returns the elapsed time in nanoseconds through the pipe.
+ */
+static void measure(const Sink* const sink, const int result)
+{
+    LogCategory* categories[] = {&benchCategory};
+    Logger* loggers[] = {sink->logger};
+    pthread_t threads[MAX_THREADS];
+    unsigned long i;
+
+    // The stdout logger writes to the same kind of file as the others
+    if (sink->logger == &stdoutLogger && freopen(path, "w", stdout) == NULL)
+    {
+        _exit(EXIT_FAILURE);
+    }
+
+    const uint64_t start = now();
+    if (initLogger(1, categories, 1, loggers) != LOG_OK)
+    {
+        _exit(EXIT_FAILURE);
+    }
+    // Rows named after io_uring must not silently measure pwrite
+    if (sink->logger->initArgs != NULL && sink->logger->initFct == &initUringLogger &&
+        !((const UringLoggerConfig*) sink->logger->initArgs)->forcePwrite && getUringLoggerBackend() != URING_BACKEND_IO_URING)
+    {
+        fprintf(stderr, "[%s] io_uring is not available\n", sink->logger->loggerName);
+        _exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < nbThreads; i++)
+    {
+        (void) pthread_create(&threads[i], NULL, &produce, (void*) (uintptr_t) i);
+    }
+    for (i = 0; i < nbThreads; i++)
+    {
+        (void) pthread_join(threads[i], NULL);
+    }
+    sink->close();
+    const uint64_t elapsed = now() - start;
+
+    _exit((write(result, &elapsed, sizeof(elapsed)) == sizeof(elapsed)) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+static bool run(const Sink* const sink, const char* const directory)
+{
+    struct rusage usage;
+    struct stat status;
+    uint64_t elapsed = 0;
+    int result[2];
+    int exitStatus;
+
+    (void) snprintf(path, sizeof(path), "%s/%s.log", directory, sink->logger->loggerName);
+    (void) remove(path);
+    if (pipe(result) != 0)
+    {
+        return false;
+    }
+
+    // Nothing buffered is inherited by the child
+    (void) fflush(stdout);
+    const pid_t child = fork();
+    if (child == 0)
+    {
+        (void) close(result[0]);
+        measure(sink, result[1]);
+    }
+    (void) close(result[1]);
+    const bool isRead = (child > 0) && read(result[0], &elapsed, sizeof(elapsed)) == sizeof(elapsed);
+    (void) close(result[0]);
+    if (child < 0 || wait4(child, &exitStatus, 0, &usage) != child || !isRead)
+    {
+        fprintf(stderr, "[%s] failed\n", sink->logger->loggerName);
+        return false;
+    }
+
+    const double seconds = (double) elapsed / 1e9;
+    const uint64_t size = (stat(path, &status) == 0) ? (uint64_t) status.st_size : 0;
+    printf("%-10s %10.1f %12.2f %10.1f %10ld %10ld\n", sink->logger->loggerName, (double) elapsed / (double) nbRecords,
+           (double) nbRecords / seconds / 1e6, (double) size / seconds / 1e6,
+           usage.ru_utime.tv_sec * 1000 + usage.ru_utime.tv_usec / 1000, usage.ru_stime.tv_sec * 1000 + usage.ru_stime.tv_usec / 1000);
+    (void) fflush(stdout);
+    (void) remove(path);
+
+    return true;
+}
+
+static void usage(void)
+{
+    size_t i;
+
+    fprintf(stderr,
+            "Usage: sinkBench [options] [sinks...]\n"
+            "  -n records    Records to log (default 1000000)\n"
+            "  -t threads    Producer threads (default 1)\n"
+            "  -o directory  Where the sinks write (default .)\n"
+            "Sinks:");
+    for (i = 0; i < NB_SINKS; i++)
+    {
+        fprintf(stderr, " %s", sinks[i].logger->loggerName);
+    }
+    fprintf(stderr, "\n");
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char* argv[])
+{
+    const char* directory = ".";
+    int returnCode = EXIT_SUCCESS;
+    int option;
+    size_t i;
+
+    while ((option = getopt(argc, argv, "n:t:o:")) != -1)
+    {
+        switch (option)
+        {
+            case 'n':
+                nbRecords = strtoul(optarg, NULL, 0);
+                break;
+            case 't':
+                nbThreads = strtoul(optarg, NULL, 0);
+                break;
+            case 'o':
+                directory = optarg;
+                break;
+            default:
+                usage();
+                break;
+        }
+    }
+    if (nbRecords == 0 || nbThreads == 0 || nbThreads > MAX_THREADS)
+    {
+        usage();
+    }
+
+    printf("%lu records, %lu threads\n", nbRecords, nbThreads);
+    printf("%-10s %10s %12s %10s %10s %10s\n", "sink", "ns/record", "Mrecords/s", "MB/s", "user ms", "system ms");
+    for (i = 0; i < NB_SINKS; i++)
+    {
+        int arg;
+        bool isSelected = (optind == argc);
+
+        for (arg = optind; arg < argc; arg++)
+        {
+            isSelected = isSelected || strcmp(argv[arg], sinks[i].logger->loggerName) == 0;
+        }
+        if (isSelected && !run(&sinks[i], directory))
+        {
+            returnCode = EXIT_FAILURE;
+        }
+    }
+
+    return returnCode;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file
+ *
+ * Synthetic translation unit full of log call sites, measured by sizeReport.sh
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "slf4ec/log.h"
+
+/**
+ * Number of call sites below, read by sizeReport.sh to report the cost of a single one.
+ */
+#define NB_CALL_SITES (112)
+
+extern LogCategory sizeCategory;
+
+#ifndef SIZE_BASELINE
+// Every site gets its own message, as in real code where strings are rarely shared
+#define CALL_SITES(id)                                           \
+    void callSites##id(const int value)                          \
+    {                                                            \
+        logFatal(sizeCategory, "Fatal site " #id);               \
+        logFatal(sizeCategory, "Fatal value " #id " %d", value); \
+        logError(sizeCategory, "Error site " #id);               \
+        logError(sizeCategory, "Error value " #id " %d", value); \
+        logWarn(sizeCategory, "Warn site " #id);                 \
+        logWarn(sizeCategory, "Warn value " #id " %d", value);   \
+        logInfo(sizeCategory, "Info site " #id);                 \
+        logInfo(sizeCategory, "Info value " #id " %d", value);   \
+        logDebug(sizeCategory, "Debug site " #id);               \
+        logDebug(sizeCategory, "Debug value " #id " %d", value); \
+        logTrace(sizeCategory, "Trace site " #id);               \
+        logTrace(sizeCategory, "Trace value " #id " %d", value); \
+        logTest(sizeCategory, "Test site " #id);                 \
+        logTest(sizeCategory, "Test value " #id " %d", value);   \
+    }
+#else
+// Same functions without any call site, subtracted from the measurement
+#define CALL_SITES(id)                  \
+    void callSites##id(const int value) \
+    {                                   \
+        (void) value;                   \
+    }
+#endif
+
+CALL_SITES(0)
+CALL_SITES(1)
+CALL_SITES(2)
+CALL_SITES(3)
+CALL_SITES(4)
+CALL_SITES(5)
+CALL_SITES(6)
+CALL_SITES(7)
@@ -0,0 +1,126 @@
+#!/bin/bash
+#################################################################################
+#            ___________      .__.__  .__  .__               __                 #
+#            \__    ___/______|__|  | |  | |__|____    _____/  |_               #
+#              |    |  \_  __ \  |  | |  | |  \__  \  /    \   __\              #
+#              |    |   |  | \/  |  |_|  |_|  |/ __ \|   |  \  |                #
+#              |____|   |__|  |__|____/____/__(____  /___|  /__|                #
+#                                                  \/     \/                    #
+#                                         Networks Inc.                         #
+# File:    sizeReport.sh                                                        #
+#                                                                               #
+# Code size and stack usage of the logging library                              #
+#                                                                               #
+# Author:  Jérémie Faucher-Goulet                                               #
+#                                                                               #
+#   www.trilliantinc.com                                                        #
+#                                                                               #
+# The MIT License (MIT)                                                         #
+#                                                                               #
+# Copyright (c) 2015 Trilliant                                                  #
+#                                                                               #
+# Permission is hereby granted, free of charge, to any person obtaining a copy  #
+# of this software and associated documentation files (the "Software"), to deal #
+# in the Software without restriction, including without limitation the rights  #
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell     #
+# copies of the Software, and to permit persons to whom the Software is         #
+# furnished to do so, subject to the following conditions:                      #
+#                                                                               #
+# The above copyright notice and this permission notice shall be included in    #
+# all copies or substantial portions of the Software.                           #
+#                                                                               #
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    #
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      #
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   #
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        #
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, #
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     #
+# THE SOFTWARE.                                                                 #
+#################################################################################
+
+
+#################################################################################
+# Builds the library and tools/size/callSites.c for each COMPILED_LOG_LEVEL and #
+# USE_LOCATION_INFO combination, and prints one line per combination with:      #
+#  - the .text and .rodata bytes of the library                                 #
+#  - the .text and .rodata bytes added by a single call site                    #
+#  - the stack used by each logging entry point (-fstack-usage), "-" when the   #
+#    function was inlined into its callers                                      #
+# Meant to be called by the "sizeReport" make target, which provides:           #
+#   CC, SIZE, CFLAGS   Toolchain of the architecture                            #
+#   DEFINES            Library defines, other than the ones of the matrix       #
+#   INCLUDES           Include paths, as compiler options                       #
+#   LIB_SRC            Library sources                                          #
+#                                                                               #
+# Usage: sizeReport.sh <arch> <root> <output dir>                               #
+#################################################################################
+
+set -e -o pipefail
+
+ARCH=$1
+ROOT=$2
+OUTPUT_DIR=$3
+
+LEVELS="LEVEL_OFF LEVEL_FATAL LEVEL_ERROR LEVEL_WARN LEVEL_INFO LEVEL_DEBUG LEVEL_TRACE LEVEL_TEST"
+ENTRY_POINTS="_privateLog yfLog1 nfLog1 logFull"
+CALL_SITES="$ROOT/tools/size/callSites.c"
+COMPILE_LOG="$OUTPUT_DIR/$ARCH-compile.err"
+NB_CALL_SITES=$(sed -n 's/^#define NB_CALL_SITES (\([0-9]*\))$/\1/p' "$CALL_SITES")
+
+# Sum of the code and read-only data sections of objects, as "<text> <rodata>"
+sections() {
+    $SIZE -A "$@" | awk '$1 ~ /^\.text/ { text += $2 } $1 ~ /^\.rodata/ { rodata += $2 } END { print text + 0, rodata + 0 }'
+}
+
+# Stack used by a function according to the .su files of a directory
+stackUsage() {
+    find "$1" -name "*.su" -exec cat {} + | awk -F'\t' -v fct="$2" '
+        { n = split($1, location, ":"); if (location[n] == fct) { usage = $2; found = 1 } }
+        END { print found ? usage : "-" }'
+}
+
+compile() {
+    local object=$1
+    shift
+    mkdir -p "$(dirname "$object")"
+    if ! $CC $CFLAGS -fstack-usage "$@" $INCLUDES -o "$object" 2>> "$COMPILE_LOG"; then
+        echo "Failed to compile [$object], see [$COMPILE_LOG]" >&2
+        exit 1
+    fi
+}
+
+rm -f "$COMPILE_LOG"
+printf "%-10s %-12s %-9s %9s %9s %10s %10s" "arch" "level" "location" "libText" "libRodata" "siteText" "siteRodata"
+for fct in $ENTRY_POINTS; do
+    printf " %12s" "$fct"
+done
+printf "\n"
+
+for location in no yes; do
+    for level in $LEVELS; do
+        defines="$DEFINES -DCOMPILED_LOG_LEVEL=$level"
+        if [ "$location" = "yes" ]; then
+            defines="$defines -DUSE_LOCATION_INFO"
+        fi
+        objDir="$OUTPUT_DIR/$ARCH/$level-$location"
+        rm -rf "$objDir"
+
+        for src in $LIB_SRC; do
+            compile "$objDir/lib/${src%.c}.o" "$ROOT/$src" $defines
+        done
+        compile "$objDir/sites/callSites.o" "$CALL_SITES" $defines
+        compile "$objDir/baseline/callSites.o" "$CALL_SITES" $defines -DSIZE_BASELINE
+
+        read -r libText libRodata <<< "$(sections $(find "$objDir/lib" -name "*.o" | sort))"
+        read -r siteText siteRodata <<< "$(sections "$objDir/sites/callSites.o")"
+        read -r baseText baseRodata <<< "$(sections "$objDir/baseline/callSites.o")"
+
+        printf "%-10s %-12s %-9s %9d %9d %10.1f %10.1f" "$ARCH" "$level" "$location" "$libText" "$libRodata" \
+            "$(awk -v delta=$((siteText - baseText)) -v n="$NB_CALL_SITES" 'BEGIN { print delta / n }')" \
+            "$(awk -v delta=$((siteRodata - baseRodata)) -v n="$NB_CALL_SITES" 'BEGIN { print delta / n }')"
+        for fct in $ENTRY_POINTS; do
+            printf " %12s" "$(stackUsage "$objDir/lib" "$fct")"
+        done
+        printf "\n"
+    done
+done
@@ -0,0 +1,291 @@
+/**
+ * @file
+ *
+ * Collector draining the shared memory rings of logging processes
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Usage: logCollector [-o output] [-i interval] [-1] [rings...]
+ *
+ * Drains the rings written by the shared memory logger of each process into a single output. Without ring names, all
+ * rings found under /dev/shm are drained and new ones are picked up as processes start. Records of a ring stay in
+ * order, records of different rings are interleaved as they are drained. Rings of processes that exited are removed
+ * once empty.
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "slf4ec/slf4ecCtrl.h"
+#include "slf4ec/logger/shm.h"
+
+#define READ_BUFFER_SIZE (1024 * 1024)
+#define OUTPUT_BUFFER_SIZE (4 * 1024 * 1024)
+#define MAX_RINGS (256)
+#define SHM_DIRECTORY "/dev/shm"
+
+/* Not used by the tool, needed by the library */
+static uint64_t getTimestamp(void)
+{
+    return 0;
+}
+const GetLogTimestamp logTimeApi = &getTimestamp;
+
+#ifdef USE_LOG_STATS
+const GetLogTimestamp logTickApi = &getTimestamp;
+#endif
+
+typedef struct
+{
+    ShmRing ring;
+    uint64_t dropped; /**< Drops already reported */
+    bool isOpen;
+} Ring;
+
+static Ring rings[MAX_RINGS];
+static size_t nbRings = 0;
+static char buffer[READ_BUFFER_SIZE];
+static FILE* output;
+static volatile sig_atomic_t stopping = 0;
+
+static void stop(int signal)
+{
+    (void) signal;
+    stopping = 1;
+}
+
+static Ring* findRing(const char* const name)
+{
+    size_t i;
+
+    for (i = 0; i < nbRings; i++)
+    {
+        if (rings[i].isOpen && strcmp(rings[i].ring.name, name) == 0)
+        {
+            return &rings[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void openRing(const char* const name)
+{
+    size_t i;
+
+    if (findRing(name) != NULL)
+    {
+        return;
+    }
+
+    for (i = 0; i < MAX_RINGS; i++)
+    {
+        if (!rings[i].isOpen)
+        {
+            // Rings not initialized yet are retried on the next scan
+            if (openShmRing(name, &rings[i].ring) == LOG_OK)
+            {
+                rings[i].dropped = 0;
+                rings[i].isOpen = true;
+                nbRings = (i >= nbRings) ? i + 1 : nbRings;
+            }
+            return;
+        }
+    }
+
+    fprintf(stderr, "Too many rings, ignoring [%s]\n", name);
+}
+
+static void scanRings(void)
+{
+    DIR* const directory = opendir(SHM_DIRECTORY);
+    const struct dirent* entry;
+    const size_t prefixLength = strlen(SHM_RING_PREFIX) - 1;
+
+    if (directory == NULL)
+    {
+        return;
+    }
+
+    while ((entry = readdir(directory)) != NULL)
+    {
+        char name[SHM_RING_NAME_LENGTH];
+
+        // Names are listed without their leading '/'
+        if (strncmp(entry->d_name, &SHM_RING_PREFIX[1], prefixLength) == 0 &&
+            snprintf(name, sizeof(name), "/%s", entry->d_name) < (int) sizeof(name))
+        {
+            openRing(name);
+        }
+    }
+
+    (void) closedir(directory);
+}
+
+static void reportDropped(Ring* const ring)
+{
+    const uint64_t dropped = getShmRingDropped(&ring->ring);
+
+    if (dropped != ring->dropped)
+    {
+        fprintf(stderr, "[%s] %" PRIu64 " records dropped\n", ring->ring.name, dropped - ring->dropped);
+        ring->dropped = dropped;
+    }
+}
+
+/**
+ * Drain every open ring once. Returns whether anything was read.
+ */
+static bool drainRings(const bool removeOrphans)
+{
+    bool hasRead = false;
+    size_t i;
+
+    for (i = 0; i < nbRings; i++)
+    {
+        Ring* const ring = &rings[i];
+        size_t length;
+
+        if (!ring->isOpen)
+        {
+            continue;
+        }
+
+        // Checked before reading so that nothing written before the process exited is left behind
+        const bool isOrphaned = removeOrphans && isShmRingOrphaned(&ring->ring);
+
+        while ((length = readShmRing(&ring->ring, buffer, sizeof(buffer))) > 0)
+        {
+            (void) fwrite(buffer, 1, length, output);
+            hasRead = true;
+        }
+        reportDropped(ring);
+
+        if (isOrphaned)
+        {
+            closeShmRing(&ring->ring, true);
+            ring->isOpen = false;
+        }
+    }
+
+    return hasRead;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "Usage: logCollector [options] [rings...]\n"
+            "  -o output    Append records to this file instead of the standard output\n"
+            "  -i interval  Time to wait when all rings are empty, in milliseconds (default 10)\n"
+            "  -1           Drain the rings once and exit\n"
+            "Without rings, every ring found in " SHM_DIRECTORY " is drained.\n");
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char* argv[])
+{
+    const char* outputPath = NULL;
+    unsigned long interval = 10;
+    bool once = false;
+    int option;
+    int i;
+
+    while ((option = getopt(argc, argv, "o:i:1")) != -1)
+    {
+        switch (option)
+        {
+            case 'o':
+                outputPath = optarg;
+                break;
+            case 'i':
+                interval = strtoul(optarg, NULL, 0);
+                break;
+            case '1':
+                once = true;
+                break;
+            default:
+                usage();
+                break;
+        }
+    }
+
+    output = (outputPath != NULL) ? fopen(outputPath, "a") : stdout;
+    if (output == NULL)
+    {
+        fprintf(stderr, "Cannot open [%s]: %s\n", outputPath, strerror(errno));
+        return EXIT_FAILURE;
+    }
+    (void) setvbuf(output, NULL, _IOFBF, OUTPUT_BUFFER_SIZE);
+
+    (void) signal(SIGINT, &stop);
+    (void) signal(SIGTERM, &stop);
+
+    const bool scan = (optind == argc);
+    do
+    {
+        if (scan)
+        {
+            scanRings();
+        }
+        else
+        {
+            for (i = optind; i < argc; i++)
+            {
+                openRing(argv[i]);
+            }
+        }
+
+        // Only rings found by scanning are removed, named ones are expected to come back
+        if (!drainRings(scan) && !once)
+        {
+            (void) fflush(output);
+            (void) usleep((useconds_t)(interval * 1000));
+        }
+    } while (!once && !stopping);
+
+    // Last pass for what was written while stopping
+    (void) drainRings(false);
+    for (i = 0; i < (int) nbRings; i++)
+    {
+        if (rings[i].isOpen)
+        {
+            closeShmRing(&rings[i].ring, scan);
+        }
+    }
+
+    return (fclose(output) == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
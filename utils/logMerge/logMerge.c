@@ -0,0 +1,521 @@
+/**
+ * @file
+ *
+ * Merge SLF4EC logs of several processes or devices in timestamp order
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Usage: logMerge [-w window] [-p] files...
+ *
+ * Inputs are expected to be in timestamp order, give or take the window: a record may come after records up to
+ * 'window' more recent than itself in the same input. Records are only held while they could still be preceded by a
+ * record of another input, so memory is bounded by the window rather than by the size of the inputs.
+ * Lines without the "[LEVEL][Category][timestamp]" prefix stay attached to the record before them.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "slf4ec/slf4ecCtrl.h"
+#include "slf4ec/logger/file.h"
+
+#define OUTPUT_BUFFER_SIZE (1024 * 1024)
+
+/* Not used by the tool, needed by the library */
+static uint64_t getTimestamp(void)
+{
+    return 0;
+}
+const GetLogTimestamp logTimeApi = &getTimestamp;
+
+#ifdef USE_LOG_STATS
+const GetLogTimestamp logTickApi = &getTimestamp;
+#endif
+
+/**
+ * Decoded block, kept until its last record is written
+ */
+typedef struct
+{
+    size_t references;
+    uint8_t text[FILE_MAX_BLOCK_SIZE];
+} Block;
+
+typedef struct
+{
+    const char* path;
+    bool isBlocks;
+    const char* data; /**< Text to read, mapped file or decoded block */
+    size_t size;
+    size_t position;
+    size_t mappedSize;
+    FILE* file;   /**< Block files only */
+    Block* block; /**< Block files only, block being read */
+    uint64_t lastTimestamp;
+    uint64_t maxTimestamp; /**< Highest timestamp read so far */
+} Input;
+
+/**
+ * Record waiting to be written. Text is never copied, it points into the mapped file or into its block.
+ */
+typedef struct
+{
+    uint64_t timestamp;
+    uint64_t sequence; /**< Read order, keeps records with the same timestamp in order */
+    const char* text;
+    size_t length;
+    Input* input;
+    Block* block;
+} Record;
+
+static Input* inputs;
+static uint64_t window = 0;
+static bool prefixPath = false;
+static uint64_t sequence = 0;
+
+/* Min heap of the records read so far, by timestamp */
+static Record* records;
+static size_t nbRecords = 0;
+static size_t recordCapacity = 0;
+
+/* Min heap of the inputs not exhausted yet, by highest timestamp read */
+static Input** active;
+static size_t nbActive = 0;
+
+static void outOfMemory(void)
+{
+    fprintf(stderr, "Out of memory\n");
+    exit(EXIT_FAILURE);
+}
+
+static inline bool isRecordBefore(const Record* const first, const Record* const second)
+{
+    return first->timestamp < second->timestamp || (first->timestamp == second->timestamp && first->sequence < second->sequence);
+}
+
+static void pushRecord(const Record* const record)
+{
+    size_t position = nbRecords++;
+
+    if (nbRecords > recordCapacity)
+    {
+        recordCapacity *= 2;
+        records = realloc(records, recordCapacity * sizeof(Record));
+        if (records == NULL)
+        {
+            outOfMemory();
+        }
+    }
+
+    while (position > 0 && isRecordBefore(record, &records[(position - 1) / 2]))
+    {
+        records[position] = records[(position - 1) / 2];
+        position = (position - 1) / 2;
+    }
+    records[position] = *record;
+}
+
+static void popRecord(void)
+{
+    const Record last = records[--nbRecords];
+    size_t position = 0;
+
+    for (;;)
+    {
+        size_t child = 2 * position + 1;
+
+        if (child >= nbRecords)
+        {
+            break;
+        }
+        if (child + 1 < nbRecords && isRecordBefore(&records[child + 1], &records[child]))
+        {
+            child++;
+        }
+        if (!isRecordBefore(&records[child], &last))
+        {
+            break;
+        }
+        records[position] = records[child];
+        position = child;
+    }
+    records[position] = last;
+}
+
+/**
+ * Restore the heap order of the inputs after the maximum timestamp of the first one grew or after it was replaced.
+ */
+static void siftActive(void)
+{
+    Input* const first = active[0];
+    size_t position = 0;
+
+    for (;;)
+    {
+        size_t child = 2 * position + 1;
+
+        if (child >= nbActive)
+        {
+            break;
+        }
+        if (child + 1 < nbActive && active[child + 1]->maxTimestamp < active[child]->maxTimestamp)
+        {
+            child++;
+        }
+        if (active[child]->maxTimestamp >= first->maxTimestamp)
+        {
+            break;
+        }
+        active[position] = active[child];
+        position = child;
+    }
+    active[position] = first;
+}
+
+static int compareInputs(const void* a, const void* b)
+{
+    const uint64_t first = (*(Input * const*) a)->maxTimestamp;
+    const uint64_t second = (*(Input * const*) b)->maxTimestamp;
+
+    return (first > second) - (first < second);
+}
+
+static void releaseBlock(Block* const block)
+{
+    if (block != NULL && --block->references == 0)
+    {
+        free(block);
+    }
+}
+
+/**
+ * Decode the next block of a block file. Returns false at the end of the file.
+ */
+static bool nextBlock(Input* const input)
+{
+    FileBlockHeader header;
+    Block* block = input->block;
+
+    // Records still waiting keep the current block, decode into a new one
+    if (block->references > 1)
+    {
+        block->references--;
+        block = malloc(sizeof(Block));
+        if (block == NULL)
+        {
+            outOfMemory();
+        }
+        block->references = 1;
+        input->block = block;
+    }
+
+    const bool hasBlock = readFileBlock(input->file, &header, block->text, sizeof(block->text));
+
+    input->data = (const char*) block->text;
+    input->size = hasBlock ? header.rawSize : 0;
+    input->position = 0;
+
+    return hasBlock;
+}
+
+/**
+ * Timestamp from the "[LEVEL][Category][timestamp]" prefix. Returns false when the line has none.
+ */
+static bool parseTimestamp(const char* const line, const size_t length, uint64_t* const timestamp)
+{
+    const char* const end = line + length;
+    const char* field = line;
+    int i;
+
+    for (i = 0; i < 2; i++)
+    {
+        if (field >= end || * field != '[' || (field = memchr(field, ']', (size_t)(end - field))) == NULL)
+        {
+            return false;
+        }
+        field++;
+    }
+
+    if (field >= end || *field != '[')
+    {
+        return false;
+    }
+
+    *timestamp = 0;
+    for (field++; field < end && *field >= '0' && *field <= '9'; field++)
+    {
+        *timestamp = *timestamp * 10 + (uint64_t)(*field - '0');
+    }
+
+    return field < end && *field == ']';
+}
+
+/**
+ * Read the next record of an input, with the lines that follow it without a prefix.
+ *
+ * @return false once the input is exhausted.
+ */
+static bool readRecord(Input* const input, Record* const record)
+{
+    if (input->position >= input->size && !(input->isBlocks && nextBlock(input)))
+    {
+        return false;
+    }
+
+    const char* const start = &input->data[input->position];
+    const char* const end = &input->data[input->size];
+    const char* line = start;
+
+    record->timestamp = input->lastTimestamp;
+    (void) parseTimestamp(line, (size_t)(end - line), &record->timestamp);
+
+    // Records never span blocks, the logger only cuts blocks between records
+    do
+    {
+        const char* const newLine = memchr(line, '\n', (size_t)(end - line));
+        uint64_t timestamp;
+
+        line = (newLine != NULL) ? newLine + 1 : end;
+        if (line < end && parseTimestamp(line, (size_t)(end - line), &timestamp))
+        {
+            break;
+        }
+    } while (line < end);
+
+    record->text = start;
+    record->length = (size_t)(line - start);
+    record->sequence = sequence++;
+    record->input = input;
+    record->block = input->block;
+    if (input->block != NULL)
+    {
+        input->block->references++;
+    }
+
+    input->position += record->length;
+    input->lastTimestamp = record->timestamp;
+    input->maxTimestamp = (record->timestamp > input->maxTimestamp) ? record->timestamp : input->maxTimestamp;
+
+    return true;
+}
+
+static void writeRecord(const Record* const record)
+{
+    if (prefixPath)
+    {
+        (void) fputs(record->input->path, stdout);
+        (void) fputs(": ", stdout);
+    }
+    (void) fwrite(record->text, 1, record->length, stdout);
+    if (record->text[record->length - 1] != '\n')
+    {
+        (void) putchar('\n');
+    }
+}
+
+static bool openInput(Input* const input)
+{
+    bool isOpen = false;
+    struct stat info;
+    const int fd = open(input->path, O_RDONLY);
+    char magic[4] = {0};
+
+    if (fd >= 0 && fstat(fd, &info) == 0)
+    {
+        isOpen = true;
+        if (read(fd, magic, sizeof(magic)) == sizeof(magic) &&
+            (memcmp(magic, FILE_BLOCK_MAGIC, 4) == 0 || memcmp(magic, FILE_INDEX_MAGIC, 4) == 0))
+        {
+            // Blocks are decoded one at a time
+            input->isBlocks = true;
+            input->file = fopen(input->path, "rb");
+            input->block = malloc(sizeof(Block));
+            isOpen = input->file != NULL && input->block != NULL;
+            if (input->block != NULL)
+            {
+                input->block->references = 1;
+            }
+        }
+        else if (info.st_size > 0)
+        {
+            input->mappedSize = (size_t) info.st_size;
+            input->data = mmap(NULL, input->mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            isOpen = input->data != MAP_FAILED;
+            if (isOpen)
+            {
+                (void) madvise((void*) input->data, input->mappedSize, MADV_SEQUENTIAL);
+                input->size = input->mappedSize;
+            }
+            else
+            {
+                input->data = NULL;
+                input->mappedSize = 0;
+            }
+        }
+    }
+
+    if (!isOpen)
+    {
+        fprintf(stderr, "%s: %s\n", input->path, strerror(errno));
+    }
+    if (fd >= 0)
+    {
+        (void) close(fd);
+    }
+
+    return isOpen;
+}
+
+static void closeInput(Input* const input)
+{
+    if (input->mappedSize > 0)
+    {
+        (void) munmap((void*) input->data, input->mappedSize);
+    }
+    if (input->file != NULL)
+    {
+        (void) fclose(input->file);
+    }
+    releaseBlock(input->block);
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "Usage: logMerge [options] files...\n"
+            "  -w window  How far back in time a record may be within its input, in timestamp units (default 0)\n"
+            "  -p         Prefix every record with the path of its input\n");
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char* argv[])
+{
+    int returnCode = EXIT_SUCCESS;
+    int option;
+    int i;
+
+    while ((option = getopt(argc, argv, "w:p")) != -1)
+    {
+        switch (option)
+        {
+            case 'w':
+                window = strtoull(optarg, NULL, 0);
+                break;
+            case 'p':
+                prefixPath = true;
+                break;
+            default:
+                usage();
+                break;
+        }
+    }
+
+    const int nbInputs = argc - optind;
+    if (nbInputs <= 0)
+    {
+        usage();
+    }
+
+    recordCapacity = (size_t) nbInputs * 4;
+    inputs = calloc((size_t) nbInputs, sizeof(Input));
+    records = malloc(recordCapacity * sizeof(Record));
+    active = malloc((size_t) nbInputs * sizeof(Input*));
+    if (inputs == NULL || records == NULL || active == NULL)
+    {
+        outOfMemory();
+    }
+
+    (void) setvbuf(stdout, NULL, _IOFBF, OUTPUT_BUFFER_SIZE);
+
+    for (i = 0; i < nbInputs; i++)
+    {
+        Record record;
+
+        inputs[i].path = argv[optind + i];
+        if (!openInput(&inputs[i]))
+        {
+            returnCode = EXIT_FAILURE;
+        }
+        else if (readRecord(&inputs[i], &record))
+        {
+            pushRecord(&record);
+            active[nbActive++] = &inputs[i];
+        }
+    }
+    // A sorted array is a valid heap
+    qsort(active, nbActive, sizeof(Input*), &compareInputs);
+
+    while (nbRecords > 0 || nbActive > 0)
+    {
+        const Record* const oldest = &records[0];
+
+        // Every input must be past the window of the oldest record, otherwise one of them may still hold an older record
+        if (nbRecords > 0 && (nbActive == 0 || oldest->timestamp + window <= active[0]->maxTimestamp ||
+                              oldest->timestamp + window < oldest->timestamp))
+        {
+            writeRecord(oldest);
+            releaseBlock(oldest->block);
+            popRecord();
+        }
+        else
+        {
+            Record record;
+
+            if (readRecord(active[0], &record))
+            {
+                pushRecord(&record);
+            }
+            else
+            {
+                active[0] = active[--nbActive];
+            }
+            siftActive();
+        }
+    }
+
+    for (i = 0; i < nbInputs; i++)
+    {
+        closeInput(&inputs[i]);
+    }
+    free(records);
+    free(active);
+    free(inputs);
+    (void) fflush(stdout);
+
+    return returnCode;
+}
@@ -0,0 +1,587 @@
+/**
+ * @file
+ *
+ * Search SLF4EC logs, text or blocks written by the file logger
+ *
+ * @author Jérémie Faucher-Goulet
+ *
+ * @copyright Trilliant Inc. © 2015 - http://www.trilliantinc.com
+ *
+ * @License
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Trilliant
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Usage: logSearch [-l level] [-c category] [-i categoryIndex] [-f from] [-t to] [-s substring] [-j threads] files...
+ *
+ * Text files are mapped in memory and split in chunks searched in parallel. Lines are matched on the
+ * "[LEVEL][Category][timestamp]" prefix written by the loggers, lines without it only match when no level, category
+ * nor time range is given. Block files are searched through their index so only the blocks that may match are decoded.
+ */
+
+#define _GNU_SOURCE /* memmem */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "slf4ec/slf4ecCtrl.h"
+#include "slf4ec/logger/file.h"
+
+#define MAX_THREADS (64)
+#define MIN_CHUNK_SIZE (1024 * 1024)
+
+/* Not used by the tool, needed by the library */
+static uint64_t getTimestamp(void)
+{
+    return 0;
+}
+const GetLogTimestamp logTimeApi = &getTimestamp;
+
+#ifdef USE_LOG_STATS
+const GetLogTimestamp logTickApi = &getTimestamp;
+#endif
+
+typedef struct
+{
+    int level; /**< Least severe level wanted, negative for all */
+    const char* category;
+    size_t categoryLength;
+    int categoryIndex;
+    uint64_t from;
+    uint64_t to;
+    const char* substring;
+    size_t substringLength;
+    bool hasFieldFilter;
+} Filter;
+
+/**
+ * Matching lines of a unit of work, printed in order once every thread is done.
+ */
+typedef struct
+{
+    char* data;
+    size_t size;
+    size_t capacity;
+} Output;
+
+typedef struct
+{
+    const Filter* filter;
+    const char* start;
+    const char* end;
+    Output output;
+} TextChunk;
+
+typedef struct
+{
+    const Filter* filter;
+    const char* path;
+    const FileIndex* index;
+    const uint32_t* blocks;
+    uint32_t nbBlocks;
+    uint32_t first;
+    uint32_t step;
+    Output* outputs;
+} BlockWork;
+
+static Filter filter = {.level = -1, .categoryIndex = -1, .to = UINT64_MAX};
+static int nbThreads = 0;
+
+static void append(Output* const output, const char* const data, const size_t size)
+{
+    if (output->size + size > output->capacity)
+    {
+        size_t capacity = (output->capacity > 0) ? output->capacity * 2 : 4096;
+        while (capacity < output->size + size)
+        {
+            capacity *= 2;
+        }
+
+        char* const grown = realloc(output->data, capacity);
+        if (grown == NULL)
+        {
+            fprintf(stderr, "Out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+        output->data = grown;
+        output->capacity = capacity;
+    }
+
+    memcpy(&output->data[output->size], data, size);
+    output->size += size;
+}
+
+/**
+ * Find a substring. Candidates are found 16 bytes at a time by comparing the first and last characters of the needle.
+ */
+static const char* findSubstring(const char* const haystack, const size_t size, const char* const needle, const size_t length)
+{
+    size_t i = 0;
+
+#ifdef __SSE2__
+    if (length >= 2)
+    {
+        const __m128i first = _mm_set1_epi8(needle[0]);
+        const __m128i last = _mm_set1_epi8(needle[length - 1]);
+
+        for (; i + length - 1 + 16 <= size; i += 16)
+        {
+            const __m128i blockFirst = _mm_loadu_si128((const __m128i*) &haystack[i]);
+            const __m128i blockLast = _mm_loadu_si128((const __m128i*) &haystack[i + length - 1]);
+            unsigned int mask = (unsigned int) _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last)));
+
+            while (mask != 0)
+            {
+                const unsigned int bit = (unsigned int) __builtin_ctz(mask);
+                if (memcmp(&haystack[i + bit + 1], &needle[1], length - 2) == 0)
+                {
+                    return &haystack[i + bit];
+                }
+                mask &= mask - 1;
+            }
+        }
+    }
+#endif
+
+    return memmem(&haystack[i], size - i, needle, length);
+}
+
+/**
+ * Check the "[LEVEL][Category][timestamp]" prefix of a line against the filter.
+ */
+static bool isLineMatching(const char* const line, const size_t length)
+{
+    const char* const end = line + length;
+    const char* field;
+    const char* fieldEnd;
+
+    if (!filter.hasFieldFilter)
+    {
+        return true;
+    }
+
+    // Level
+    if (length < 2 || line[0] != '[' || (fieldEnd = memchr(line + 1, ']', length - 1)) == NULL)
+    {
+        return false;
+    }
+    if (filter.level >= 0)
+    {
+        int level;
+        bool isKnown = false;
+        for (level = 0; level <= filter.level && !isKnown; level++)
+        {
+            isKnown = strlen(logLevelNames[level]) == (size_t)(fieldEnd - line - 1) &&
+                      memcmp(logLevelNames[level], line + 1, (size_t)(fieldEnd - line - 1)) == 0;
+        }
+        if (!isKnown)
+        {
+            return false;
+        }
+    }
+
+    // Category
+    field = fieldEnd + 1;
+    if (field >= end || * field != '[' || (fieldEnd = memchr(field + 1, ']', (size_t)(end - field - 1))) == NULL)
+    {
+        return false;
+    }
+    if (filter.category != NULL &&
+        ((size_t)(fieldEnd - field - 1) != filter.categoryLength || memcmp(field + 1, filter.category, filter.categoryLength) != 0))
+    {
+        return false;
+    }
+
+    // Timestamp
+    field = fieldEnd + 1;
+    if (field >= end || *field != '[')
+    {
+        return false;
+    }
+    uint64_t timestamp = 0;
+    for (field++; field < end && *field >= '0' && *field <= '9'; field++)
+    {
+        timestamp = timestamp * 10 + (uint64_t)(*field - '0');
+    }
+
+    return field < end && *field == ']' && timestamp >= filter.from && timestamp <= filter.to;
+}
+
+/**
+ * Search a range of text holding whole lines.
+ */
+static void searchText(const char* const start, const char* const end, Output* const output)
+{
+    const char* position = start;
+
+    while (position < end)
+    {
+        const char* lineStart = position;
+
+        if (filter.substring != NULL)
+        {
+            // Jump straight to the next occurrence then back to the start of its line
+            const char* const found = findSubstring(position, (size_t)(end - position), filter.substring, filter.substringLength);
+            if (found == NULL)
+            {
+                break;
+            }
+            lineStart = found;
+            while (lineStart > position && lineStart[-1] != '\n')
+            {
+                lineStart--;
+            }
+        }
+
+        const char* newLine = memchr(lineStart, '\n', (size_t)(end - lineStart));
+        const char* const lineEnd = (newLine != NULL) ? newLine + 1 : end;
+
+        if (isLineMatching(lineStart, (size_t)(lineEnd - lineStart)))
+        {
+            append(output, lineStart, (size_t)(lineEnd - lineStart));
+            if (newLine == NULL)
+            {
+                append(output, "\n", 1);
+            }
+        }
+        position = lineEnd;
+    }
+}
+
+static void* searchChunk(void* arg)
+{
+    TextChunk* const chunk = (TextChunk*) arg;
+
+    searchText(chunk->start, chunk->end, &chunk->output);
+    return NULL;
+}
+
+static void writeOutput(Output* const output)
+{
+    (void) fwrite(output->data, 1, output->size, stdout);
+    free(output->data);
+    memset(output, 0, sizeof(Output));
+}
+
+static int searchTextFile(const char* const path, const char* const data, const size_t size)
+{
+    TextChunk chunks[MAX_THREADS] = {{0}};
+    pthread_t threads[MAX_THREADS];
+    size_t nbChunks = size / MIN_CHUNK_SIZE + 1;
+    size_t i;
+
+    nbChunks = (nbChunks < (size_t) nbThreads) ? nbChunks : (size_t) nbThreads;
+
+    // Chunk boundaries are moved to the start of the next line
+    const char* start = data;
+    for (i = 0; i < nbChunks; i++)
+    {
+        const char* end = (i + 1 < nbChunks) ? data + size / nbChunks * (i + 1) : data + size;
+        if (end < start)
+        {
+            end = start;
+        }
+        if (i + 1 < nbChunks && end < data + size)
+        {
+            const char* const newLine = memchr(end, '\n', (size_t)(data + size - end));
+            end = (newLine != NULL) ? newLine + 1 : data + size;
+        }
+
+        chunks[i] = (TextChunk){.filter = &filter, .start = start, .end = end};
+        start = end;
+    }
+
+    for (i = 1; i < nbChunks; i++)
+    {
+        if (pthread_create(&threads[i], NULL, &searchChunk, &chunks[i]) != 0)
+        {
+            fprintf(stderr, "%s: cannot start thread\n", path);
+            exit(EXIT_FAILURE);
+        }
+    }
+    (void) searchChunk(&chunks[0]);
+
+    for (i = 0; i < nbChunks; i++)
+    {
+        if (i > 0)
+        {
+            (void) pthread_join(threads[i], NULL);
+        }
+        writeOutput(&chunks[i].output);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static void* searchBlocks(void* arg)
+{
+    BlockWork* const work = (BlockWork*) arg;
+    FileIndex index = *work->index;
+    FileBlockHeader header;
+    uint8_t* const text = malloc(FILE_MAX_BLOCK_SIZE);
+    uint32_t i;
+
+    // Every thread reads through its own stream
+    index.file = fopen(work->path, "rb");
+
+    for (i = work->first; text != NULL && index.file != NULL && i < work->nbBlocks; i += work->step)
+    {
+        if (readIndexedBlock(&index, work->blocks[i], &header, text, FILE_MAX_BLOCK_SIZE))
+        {
+            searchText((const char*) text, (const char*) text + header.rawSize, &work->outputs[i]);
+        }
+        else
+        {
+            fprintf(stderr, "%s: block at %" PRIu64 " is corrupted\n", work->path, index.blocks[work->blocks[i]].offset);
+        }
+    }
+
+    if (index.file != NULL)
+    {
+        (void) fclose(index.file);
+    }
+    free(text);
+    return NULL;
+}
+
+static int searchBlockFile(const char* const path)
+{
+    FileIndex index;
+    FILE* const file = fopen(path, "rb");
+    const FileQuery query = {filter.from, filter.to, filter.categoryIndex, (filter.level >= 0) ? (uint8_t) filter.level : UINT8_MAX};
+    int returnCode = EXIT_FAILURE;
+
+    if (file == NULL || openFileIndex(file, &index) != LOG_OK)
+    {
+        fprintf(stderr, "%s: cannot read the index\n", path);
+    }
+    else
+    {
+        uint32_t* const blocks = malloc((index.nbBlocks + 1) * sizeof(uint32_t));
+        Output* const outputs = calloc(index.nbBlocks + 1, sizeof(Output));
+        BlockWork work[MAX_THREADS];
+        pthread_t threads[MAX_THREADS];
+        uint32_t nbBlocks = 0;
+        uint32_t block;
+        int i;
+
+        if (blocks != NULL && outputs != NULL)
+        {
+            for (block = findFileBlock(&index, &query, 0); block < index.nbBlocks; block = findFileBlock(&index, &query, block + 1))
+            {
+                blocks[nbBlocks++] = block;
+            }
+
+            const int nbWorkers = ((uint32_t) nbThreads < nbBlocks) ? nbThreads : (nbBlocks > 0 ? (int) nbBlocks : 1);
+            for (i = 0; i < nbWorkers; i++)
+            {
+                work[i] = (BlockWork){&filter, path, &index, blocks, nbBlocks, (uint32_t) i, (uint32_t) nbWorkers, outputs};
+                if (i > 0 && pthread_create(&threads[i], NULL, &searchBlocks, &work[i]) != 0)
+                {
+                    fprintf(stderr, "%s: cannot start thread\n", path);
+                    exit(EXIT_FAILURE);
+                }
+            }
+            (void) searchBlocks(&work[0]);
+            for (i = 1; i < nbWorkers; i++)
+            {
+                (void) pthread_join(threads[i], NULL);
+            }
+
+            for (block = 0; block < nbBlocks; block++)
+            {
+                writeOutput(&outputs[block]);
+            }
+            returnCode = EXIT_SUCCESS;
+        }
+
+        free(blocks);
+        free(outputs);
+        closeFileIndex(&index);
+    }
+
+    if (file != NULL)
+    {
+        (void) fclose(file);
+    }
+
+    return returnCode;
+}
+
+static int searchFile(const char* const path)
+{
+    int returnCode = EXIT_FAILURE;
+    struct stat info;
+    const int fd = open(path, O_RDONLY);
+
+    if (fd < 0 || fstat(fd, &info) != 0)
+    {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+    }
+    else if (info.st_size == 0)
+    {
+        returnCode = EXIT_SUCCESS;
+    }
+    else
+    {
+        const size_t size = (size_t) info.st_size;
+        const char* const data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (data == MAP_FAILED)
+        {
+            fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        }
+        else
+        {
+            (void) madvise((void*) data, size, MADV_SEQUENTIAL);
+            if (size >= 4 && (memcmp(data, FILE_BLOCK_MAGIC, 4) == 0 || memcmp(data, FILE_INDEX_MAGIC, 4) == 0))
+            {
+                returnCode = searchBlockFile(path);
+            }
+            else
+            {
+                returnCode = searchTextFile(path, data, size);
+            }
+            (void) munmap((void*) data, size);
+        }
+    }
+
+    if (fd >= 0)
+    {
+        (void) close(fd);
+    }
+
+    return returnCode;
+}
+
+static int parseLevel(const char* const name)
+{
+    int level;
+
+    for (level = 0; level <= LEVEL_MAX; level++)
+    {
+        if (strcmp(name, logLevelNames[level]) == 0)
+        {
+            return level;
+        }
+    }
+
+    return -1;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "Usage: logSearch [options] files...\n"
+            "  -l level      Records at this level or more severe (e.g. WARN)\n"
+            "  -c category   Records of this category\n"
+            "  -i index      Index of the category, lets block files skip blocks without it\n"
+            "  -f from       Records from this timestamp\n"
+            "  -t to         Records up to this timestamp\n"
+            "  -s substring  Records holding this text\n"
+            "  -j threads    Number of threads, defaults to the number of processors\n");
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char* argv[])
+{
+    int returnCode = EXIT_SUCCESS;
+    int option;
+
+    while ((option = getopt(argc, argv, "l:c:i:f:t:s:j:")) != -1)
+    {
+        switch (option)
+        {
+            case 'l':
+                filter.level = parseLevel(optarg);
+                if (filter.level < 0)
+                {
+                    usage();
+                }
+                break;
+            case 'c':
+                filter.category = optarg;
+                filter.categoryLength = strlen(optarg);
+                break;
+            case 'i':
+                filter.categoryIndex = atoi(optarg);
+                break;
+            case 'f':
+                filter.from = strtoull(optarg, NULL, 0);
+                break;
+            case 't':
+                filter.to = strtoull(optarg, NULL, 0);
+                break;
+            case 's':
+                filter.substring = optarg;
+                filter.substringLength = strlen(optarg);
+                break;
+            case 'j':
+                nbThreads = atoi(optarg);
+                break;
+            default:
+                usage();
+                break;
+        }
+    }
+
+    if (optind >= argc)
+    {
+        usage();
+    }
+
+    if (nbThreads <= 0)
+    {
+        nbThreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    nbThreads = (nbThreads < 1) ? 1 : (nbThreads > MAX_THREADS ? MAX_THREADS : nbThreads);
+
+    filter.hasFieldFilter = filter.level >= 0 || filter.category != NULL || filter.from > 0 || filter.to < UINT64_MAX;
+    if (filter.substring != NULL && filter.substringLength == 0)
+    {
+        filter.substring = NULL;
+    }
+
+    for (; optind < argc; optind++)
+    {
+        if (searchFile(argv[optind]) != EXIT_SUCCESS)
+        {
+            returnCode = EXIT_FAILURE;
+        }
+    }
+
+    return returnCode;
+}
@@ -43,6 +43,7 @@ ifeq ($(COMPILER),$(GCC_COMPILER))
     CC := gcc
     CXX := g++
     OBJDUMP := objdump
+    LDFLAGS += -pthread
 endif
 
 #################################################################################